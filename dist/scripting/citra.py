@@ -9,7 +9,8 @@ MAX_PACKET_SIZE = 48
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadLatencyStats = 3
 
 CITRA_PORT = 45987
 
@@ -90,6 +91,27 @@ class Citra:
                 return False
         return True
 
+    def read_latency_stats(self):
+        """
+        Returns the JSON of the SVC and service command latency stats, see
+        src/core/hle/latency_stats.h for its format
+        """
+        result = bytes()
+        while True:
+            request_data = struct.pack("II", len(result), MAX_REQUEST_DATA_SIZE)
+            request, request_id = self._generate_header(RequestType.ReadLatencyStats, len(request_data))
+            request += request_data
+            self.socket.sendto(request, (self.address, CITRA_PORT))
+
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.ReadLatencyStats)
+
+            if reply_data is None:
+                return None
+            if not reply_data:
+                return result.decode()
+            result += reply_data
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
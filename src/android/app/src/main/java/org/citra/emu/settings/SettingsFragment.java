@@ -189,6 +189,7 @@ public final class SettingsFragment extends Fragment {
         Setting isNew3DS = coreSection.getSetting(SettingsFile.KEY_IS_NEW_3DS);
         Setting systemRegion = coreSection.getSetting(SettingsFile.KEY_SYSTEM_REGION);
         Setting cpuJIT = coreSection.getSetting(SettingsFile.KEY_USE_CPU_JIT);
+        Setting fastmem = coreSection.getSetting(SettingsFile.KEY_USE_FASTMEM);
         Setting language = coreSection.getSetting(SettingsFile.KEY_SYSTEM_LANGUAGE);
         Setting font = coreSection.getSetting(SettingsFile.KEY_SHARED_FONT_TYPE);
         Setting theme = coreSection.getSetting(SettingsFile.KEY_THEME_PACKAGE);
@@ -202,6 +203,8 @@ public final class SettingsFragment extends Fragment {
                 R.string.setting_is_new_3ds, R.string.setting_is_new_3ds_desc, false, isNew3DS));
         sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_CPU_JIT, Settings.SECTION_INI_CORE,
                 R.string.setting_enable_cpu_jit, 0, true, cpuJIT));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_FASTMEM, Settings.SECTION_INI_CORE,
+                R.string.setting_use_fastmem, R.string.setting_use_fastmem_desc, false, fastmem));
         sl.add(new SingleChoiceSetting(SettingsFile.KEY_SYSTEM_REGION, Settings.SECTION_INI_CORE,
                 R.string.setting_region_value, 0,
                 R.array.systemRegionEntries, R.array.systemRegionValues, -1,
@@ -6,6 +6,7 @@ namespace Config {
 
 // core
 const ConfigInfo<bool> USE_CPU_JIT{{"Core", "use_cpu_jit"}, true};
+const ConfigInfo<bool> USE_FASTMEM{{"Core", "use_fastmem"}, false};
 const ConfigInfo<bool> IS_NEW_3DS{{"Core", "is_new_3ds"}, false};
 const ConfigInfo<bool> USE_GAME_CONFIG{{"Core", "use_game_config"}, false};
 const ConfigInfo<bool> USE_VIRTUAL_SD{{"Core", "use_virtual_sd"}, true};
@@ -20,6 +21,7 @@ const ConfigInfo<bool> USE_GLES{{"Renderer", "use_gles"}, true};
 const ConfigInfo<bool> SHOW_FPS{{"Renderer", "show_fps"}, true};
 const ConfigInfo<bool> USE_HW_SHADER{{"Renderer", "use_hw_shader"}, true};
 const ConfigInfo<bool> USE_SHADER_JIT{{"Renderer", "use_shader_jit"}, false};
+const ConfigInfo<u8> SW_RASTERIZER_THREADS{{"Renderer", "sw_rasterizer_threads"}, 0};
 const ConfigInfo<Settings::AccurateMul> SHADERS_ACCURATE_MUL{{"Renderer", "accurate_mul_type"},
                                                              Settings::AccurateMul::OFF};
 const ConfigInfo<u16> RESOLUTION_FACTOR{{"Renderer", "resolution_factor"}, 1};
@@ -69,6 +71,7 @@ const ConfigInfo<bool> USE_PRESENT_THREAD{{"Debug", "use_present_thread"}, true}
 const ConfigInfo<bool> SHADOW_RENDERING{{"Debug", "shadow_rendering"}, true};
 const ConfigInfo<bool> CPU_USAGE_LIMIT{{"Debug", "cpu_usage_limit"}, false};
 const ConfigInfo<std::string> LLE_MODULES{{"Debug", "lle_modules"}, ""};
+const ConfigInfo<bool> RECORD_LATENCY_STATS{{"Debug", "record_latency_stats"}, false};
 
 // controls
 const ConfigInfo<std::string> BUTTON_A{{"Controls", "button_a"}, "code:96"};
@@ -17,6 +17,7 @@ namespace Config {
 
 // core
 extern const ConfigInfo<bool> USE_CPU_JIT;
+extern const ConfigInfo<bool> USE_FASTMEM;
 extern const ConfigInfo<bool> IS_NEW_3DS;
 extern const ConfigInfo<bool> USE_GAME_CONFIG;
 extern const ConfigInfo<bool> USE_VIRTUAL_SD;
@@ -29,6 +30,7 @@ extern const ConfigInfo<bool> USE_GLES;
 extern const ConfigInfo<bool> SHOW_FPS;
 extern const ConfigInfo<bool> USE_HW_SHADER;
 extern const ConfigInfo<bool> USE_SHADER_JIT;
+extern const ConfigInfo<u8> SW_RASTERIZER_THREADS;
 extern const ConfigInfo<Settings::AccurateMul> SHADERS_ACCURATE_MUL;
 extern const ConfigInfo<u16> RESOLUTION_FACTOR;
 extern const ConfigInfo<bool> USE_FRAME_LIMIT;
@@ -72,6 +74,7 @@ extern const ConfigInfo<bool> USE_PRESENT_THREAD;
 extern const ConfigInfo<bool> SHADOW_RENDERING;
 extern const ConfigInfo<bool> CPU_USAGE_LIMIT;
 extern const ConfigInfo<std::string> LLE_MODULES;
+extern const ConfigInfo<bool> RECORD_LATENCY_STATS;
 
 // controls
 extern const ConfigInfo<std::string> BUTTON_A;
@@ -26,7 +26,7 @@ static constexpr std::array<EGLint, 15> egl_attribs{EGL_SURFACE_TYPE,
 static constexpr std::array<EGLint, 5> egl_empty_attribs{EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
 static constexpr std::array<EGLint, 4> egl_context_attribs{EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
 
-class SharedContext_Android {
+class SharedContext_Android : public Frontend::GraphicsContext {
 public:
     SharedContext_Android(EGLDisplay egl_display, EGLConfig egl_config,
                           EGLContext egl_share_context)
@@ -35,7 +35,7 @@ public:
           egl_context{eglCreateContext(egl_display, egl_config, egl_share_context,
                                        egl_context_attribs.data())} {}
 
-    ~SharedContext_Android() {
+    ~SharedContext_Android() override {
         if (!eglDestroySurface(egl_display, egl_surface)) {
             LOG_CRITICAL(Frontend, "eglDestroySurface() failed");
         }
@@ -45,11 +45,11 @@ public:
         }
     }
 
-    void MakeCurrent() {
+    void MakeCurrent() override {
         eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
     }
 
-    void DoneCurrent() {
+    void DoneCurrent() override {
         eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
 
@@ -202,6 +202,10 @@ void EGLAndroid::SwapBuffers() {
     eglSwapBuffers(egl_display, egl_surface);
 }
 
+std::unique_ptr<Frontend::GraphicsContext> EGLAndroid::CreateSharedContext() const {
+    return std::make_unique<SharedContext_Android>(egl_display, egl_config, egl_context);
+}
+
 void EGLAndroid::PollEvents() {
     if (!new_window) {
         return;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include <EGL/egl.h>
@@ -24,6 +25,7 @@ public:
     void DoneCurrent() override;
     void PollEvents() override;
     void SwapBuffers() override;
+    std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
 
     void TryPresenting();
     void StopPresenting();
@@ -441,6 +441,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Config::Load();
     // system
     Settings::values.use_cpu_jit = Config::Get(Config::USE_CPU_JIT);
+    Settings::values.use_fastmem = Config::Get(Config::USE_FASTMEM);
     Settings::values.is_new_3ds = Config::Get(Config::IS_NEW_3DS);
     Settings::values.use_virtual_sd = Config::Get(Config::USE_VIRTUAL_SD);
     Settings::values.region_value = Config::Get(Config::SYSTEM_REGION);
@@ -457,6 +458,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.use_hw_renderer = Config::Get(Config::USE_HW_RENDERER);
     Settings::values.use_hw_shader = Config::Get(Config::USE_HW_SHADER);
     Settings::values.use_shader_jit = Config::Get(Config::USE_SHADER_JIT);
+    Settings::values.sw_rasterizer_threads = Config::Get(Config::SW_RASTERIZER_THREADS);
     Settings::values.shaders_accurate_mul = Config::Get(Config::SHADERS_ACCURATE_MUL);
     Settings::values.use_frame_limit = Config::Get(Config::USE_FRAME_LIMIT);
     Settings::values.frame_limit = Config::Get(Config::FRAME_LIMIT);
@@ -479,6 +481,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.shadow_rendering = Config::Get(Config::SHADOW_RENDERING);
     Settings::values.use_present_thread = Config::Get(Config::USE_PRESENT_THREAD);
     Settings::values.core_downcount_hack = Config::Get(Config::CPU_USAGE_LIMIT);
+    Settings::values.record_latency_stats = Config::Get(Config::RECORD_LATENCY_STATS);
     u8 shaderType = Config::Get(Config::SHADER_TYPE);
     if (shaderType == 0) {
         Settings::values.use_separable_shader = false;
@@ -507,7 +510,6 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.y2r_perform_hack = false;
     Settings::values.y2r_event_delay = false;
     Settings::values.force_texture_filter = 0;
-    Settings::values.stream_buffer_hack = !Settings::values.use_present_thread;
     Settings::values.use_fence_sync = Config::Get(Config::USE_FENCE_SYNC);
 
     // profile
@@ -104,6 +104,11 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.use_cpu_jit_cache =
+        sdl2_config->GetBoolean("Core", "use_cpu_jit_cache", false);
+    Settings::values.use_fastmem = sdl2_config->GetBoolean("Core", "use_fastmem", false);
+    Settings::values.use_cpu_threads =
+        sdl2_config->GetBoolean("Core", "use_cpu_threads", false);
     Settings::values.cpu_clock_percentage =
         sdl2_config->GetInteger("Core", "cpu_clock_percentage", 100);
 
@@ -121,11 +126,15 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_mul =
         sdl2_config->GetBoolean("Renderer", "shaders_accurate_mul", false);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u8>(sdl2_config->GetInteger("Renderer", "sw_rasterizer_threads", 0));
     Settings::values.resolution_factor =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "resolution_factor", 1));
     Settings::values.use_frame_limit = sdl2_config->GetBoolean("Renderer", "use_frame_limit", true);
     Settings::values.use_disk_shader_cache =
         sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
+    Settings::values.async_shader_compile =
+        sdl2_config->GetBoolean("Renderer", "async_shader_compile", false);
     Settings::values.frame_limit =
         static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit", 100));
     Settings::values.use_vsync_new =
@@ -252,6 +261,8 @@ void Config::ReadValues() {
     // Debugging
     Settings::values.record_frame_times =
         sdl2_config->GetBoolean("Debugging", "record_frame_times", false);
+    Settings::values.record_latency_stats =
+        sdl2_config->GetBoolean("Debugging", "record_latency_stats", false);
     Settings::values.use_gdbstub = sdl2_config->GetBoolean("Debugging", "use_gdbstub", false);
     Settings::values.gdbstub_port =
         static_cast<u16>(sdl2_config->GetInteger("Debugging", "gdbstub_port", 24689));
@@ -91,6 +91,20 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to remember the code the JIT compiles for each title, and compile it again at boot
+# 0 (default): Off, 1: On
+use_cpu_jit_cache =
+
+# Whether the JIT accesses the emulated memory through a mirror of the 3DS address space, which
+# avoids a page table lookup on each access. Only supported on Linux.
+# 0 (default): Off, 1: On
+use_fastmem =
+
+# Whether the CPU cores of a New 3DS run on host threads of their own. Needs the JIT, and is
+# ignored while recording or playing a movie, or with the GDB stub, to stay deterministic.
+# 0 (default): Off, 1: On
+use_cpu_threads =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance of the game at the risk of freezing.
 # Overclocking may fix lag that happens on console, but also comes with the risk of freezing.
@@ -118,6 +132,10 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Number of threads used by the software renderer to rasterize screen tiles in parallel
+# 0 (default): One per host core, 1: Single-threaded, Otherwise the number of threads
+sw_rasterizer_threads =
+
 # Forces VSync on the display thread. Usually doesn't impact performance, but on some drivers it can
 # so only turn this off if you notice a speed difference.
 # 0: Off, 1 (default): On
@@ -127,6 +145,12 @@ use_vsync_new =
 # 0: Off, 1 (default. On)
 use_disk_shader_cache =
 
+# Compiles new shaders on background threads. Until they're ready, the draws that need them use an
+# uber shader that reads the fragment state from uniforms, or are skipped if it can't draw them.
+# Needs a frontend that can share its graphics context
+# 0 (default): Off, 1: On
+async_shader_compile =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -289,6 +313,9 @@ log_filter = *:Info
 [Debugging]
 # Record frame time data, can be found in the log directory. Boolean value
 record_frame_times =
+# Record the latency of the SVCs and service commands, dumped to latency_stats.json in the log
+# directory. Boolean value
+record_latency_stats =
 # Port for listening to GDB connections.
 use_gdbstub=false
 gdbstub_port=24689
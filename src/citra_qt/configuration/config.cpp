@@ -256,6 +256,11 @@ void Config::ReadCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     Settings::values.use_cpu_jit = ReadSetting(QStringLiteral("use_cpu_jit"), true).toBool();
+    Settings::values.use_cpu_jit_cache =
+        ReadSetting(QStringLiteral("use_cpu_jit_cache"), false).toBool();
+    Settings::values.use_fastmem = ReadSetting(QStringLiteral("use_fastmem"), false).toBool();
+    Settings::values.use_cpu_threads =
+        ReadSetting(QStringLiteral("use_cpu_threads"), false).toBool();
     Settings::values.cpu_clock_percentage =
         ReadSetting(QStringLiteral("cpu_clock_percentage"), 100).toInt();
 
@@ -276,6 +281,8 @@ void Config::ReadDebuggingValues() {
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     Settings::values.record_frame_times =
         qt_config->value(QStringLiteral("record_frame_times"), false).toBool();
+    Settings::values.record_latency_stats =
+        qt_config->value(QStringLiteral("record_latency_stats"), false).toBool();
     Settings::values.use_gdbstub = ReadSetting(QStringLiteral("use_gdbstub"), false).toBool();
     Settings::values.gdbstub_port = ReadSetting(QStringLiteral("gdbstub_port"), 24689).toInt();
 
@@ -442,6 +449,8 @@ void Config::ReadRendererValues() {
     Settings::values.shaders_accurate_mul =
         ReadSetting(QStringLiteral("shaders_accurate_mul"), false).toBool();
     Settings::values.use_shader_jit = ReadSetting(QStringLiteral("use_shader_jit"), true).toBool();
+    Settings::values.async_shader_compile =
+        ReadSetting(QStringLiteral("async_shader_compile"), false).toBool();
     Settings::values.use_vsync_new = ReadSetting(QStringLiteral("use_vsync_new"), true).toBool();
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting(QStringLiteral("resolution_factor"), 1).toInt());
@@ -786,6 +795,9 @@ void Config::SaveCoreValues() {
     qt_config->beginGroup(QStringLiteral("Core"));
 
     WriteSetting(QStringLiteral("use_cpu_jit"), Settings::values.use_cpu_jit, true);
+    WriteSetting(QStringLiteral("use_cpu_jit_cache"), Settings::values.use_cpu_jit_cache, false);
+    WriteSetting(QStringLiteral("use_fastmem"), Settings::values.use_fastmem, false);
+    WriteSetting(QStringLiteral("use_cpu_threads"), Settings::values.use_cpu_threads, false);
     WriteSetting(QStringLiteral("cpu_clock_percentage"), Settings::values.cpu_clock_percentage,
                  100);
 
@@ -805,6 +817,8 @@ void Config::SaveDebuggingValues() {
 
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     qt_config->setValue(QStringLiteral("record_frame_times"), Settings::values.record_frame_times);
+    qt_config->setValue(QStringLiteral("record_latency_stats"),
+                        Settings::values.record_latency_stats);
     WriteSetting(QStringLiteral("use_gdbstub"), Settings::values.use_gdbstub, false);
     WriteSetting(QStringLiteral("gdbstub_port"), Settings::values.gdbstub_port, 24689);
 
@@ -927,6 +941,8 @@ void Config::SaveRendererValues() {
     WriteSetting(QStringLiteral("shaders_accurate_mul"), Settings::values.shaders_accurate_mul,
                  false);
     WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit, true);
+    WriteSetting(QStringLiteral("async_shader_compile"), Settings::values.async_shader_compile,
+                 false);
     WriteSetting(QStringLiteral("use_vsync_new"), Settings::values.use_vsync_new, true);
     WriteSetting(QStringLiteral("resolution_factor"), Settings::values.resolution_factor, 1);
     WriteSetting(QStringLiteral("use_frame_limit"), Settings::values.use_frame_limit, true);
@@ -25,6 +25,11 @@
 #include <utility>
 #include <sys/stat.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#include "common/string_util.h"
+#endif
+
 // This namespace has various generic functions related to files and paths.
 // The code still needs a ton of cleanup.
 // REMEMBER: strdup considered harmful!
@@ -190,8 +195,15 @@ bool DeleteDir(const std::string& filename) {
 
 bool Rename(const std::string& srcFilename, const std::string& destFilename) {
     LOG_TRACE(Common_Filesystem, "{} --> {}", srcFilename, destFilename);
+#ifdef _WIN32
+    // rename fails if the destination exists on Windows
+    if (MoveFileExW(Common::UTF8ToUTF16W(srcFilename).c_str(),
+                    Common::UTF8ToUTF16W(destFilename).c_str(), MOVEFILE_REPLACE_EXISTING))
+        return true;
+#else
     if (rename(srcFilename.c_str(), destFilename.c_str()) == 0)
         return true;
+#endif
     LOG_ERROR(Common_Filesystem, "failed {} --> {}: {}", srcFilename, destFilename,
               GetLastErrorMsg());
     return false;
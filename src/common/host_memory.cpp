@@ -0,0 +1,146 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef __ANDROID__
+#include <linux/memfd.h>
+#endif
+#endif
+
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "common/host_memory.h"
+#include "common/logging/log.h"
+
+namespace Common {
+
+#ifdef __linux__
+
+static int CreateMemoryFile(const char* name) {
+#ifdef __ANDROID__
+    // Bionic only declares memfd_create from API level 30, but the kernel has it since Linux 3.17.
+    // On older kernels this fails, and the memory is allocated normally.
+    return static_cast<int>(syscall(__NR_memfd_create, name, MFD_CLOEXEC));
+#else
+    return memfd_create(name, MFD_CLOEXEC);
+#endif
+}
+
+bool HostMemory::IsSupported() {
+    return true;
+}
+
+HostMemory::HostMemory(std::size_t size) : size(size) {
+    fd = CreateMemoryFile("HostMemory");
+    if (fd == -1) {
+        LOG_ERROR(Common_Memory, "memfd_create failed: {}", GetLastErrorMsg());
+        return;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        LOG_ERROR(Common_Memory, "ftruncate failed: {}", GetLastErrorMsg());
+        return;
+    }
+
+    void* pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (pointer == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "mmap failed: {}", GetLastErrorMsg());
+        return;
+    }
+    base = static_cast<u8*>(pointer);
+}
+
+HostMemory::~HostMemory() {
+    if (base != nullptr) {
+        munmap(base, size);
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+}
+
+AddressSpace::AddressSpace(std::size_t size) : size(size) {
+    // Only address space is reserved, pages are committed by the views mapped into it
+    void* pointer =
+        mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pointer == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Reserving {:#X} bytes failed: {}", size, GetLastErrorMsg());
+        return;
+    }
+    base = static_cast<u8*>(pointer);
+}
+
+AddressSpace::~AddressSpace() {
+    if (base != nullptr) {
+        munmap(base, size);
+    }
+}
+
+bool AddressSpace::Map(std::size_t virtual_offset, const HostMemory& memory,
+                       std::size_t memory_offset, std::size_t length) {
+    ASSERT(virtual_offset + length <= size && memory_offset + length <= memory.size);
+    void* pointer = mmap(base + virtual_offset, length, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_FIXED, memory.fd, static_cast<off_t>(memory_offset));
+    if (pointer == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "mmap failed: {}", GetLastErrorMsg());
+        return false;
+    }
+    return true;
+}
+
+bool AddressSpace::Unmap(std::size_t virtual_offset, std::size_t length) {
+    ASSERT(virtual_offset + length <= size);
+    void* pointer = mmap(base + virtual_offset, length, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    if (pointer == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "mmap failed: {}", GetLastErrorMsg());
+        return false;
+    }
+    return true;
+}
+
+bool AddressSpace::Protect(std::size_t virtual_offset, std::size_t length, bool accessible) {
+    ASSERT(virtual_offset + length <= size);
+    const int result =
+        mprotect(base + virtual_offset, length, accessible ? PROT_READ | PROT_WRITE : PROT_NONE);
+    if (result != 0) {
+        LOG_ERROR(Common_Memory, "mprotect failed: {}", GetLastErrorMsg());
+        return false;
+    }
+    return true;
+}
+
+#else
+
+// Neither is created on other hosts, so the caller falls back to normal memory
+
+bool HostMemory::IsSupported() {
+    return false;
+}
+
+HostMemory::HostMemory(std::size_t size) : size(size) {}
+HostMemory::~HostMemory() = default;
+
+AddressSpace::AddressSpace(std::size_t size) : size(size) {}
+AddressSpace::~AddressSpace() = default;
+
+bool AddressSpace::Map(std::size_t, const HostMemory&, std::size_t, std::size_t) {
+    return false;
+}
+
+bool AddressSpace::Unmap(std::size_t, std::size_t) {
+    return false;
+}
+
+bool AddressSpace::Protect(std::size_t, std::size_t, bool) {
+    return false;
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,91 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Host memory backed by an anonymous file, so that its pages can be mapped at more than one host
+ * address. Only supported on Linux, IsValid returns false elsewhere or if the allocation failed.
+ */
+class HostMemory {
+public:
+    explicit HostMemory(std::size_t size);
+    ~HostMemory();
+
+    /// Returns whether host memory and address spaces can be created on this host
+    static bool IsSupported();
+
+    HostMemory(const HostMemory&) = delete;
+    HostMemory& operator=(const HostMemory&) = delete;
+
+    bool IsValid() const {
+        return base != nullptr;
+    }
+
+    /// Returns the main mapping of the memory
+    u8* BasePointer() const {
+        return base;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    /// Returns whether the pointer is inside the main mapping
+    bool Contains(const u8* pointer) const {
+        return pointer >= base && pointer < base + size;
+    }
+
+private:
+    friend class AddressSpace;
+
+    int fd = -1;
+    u8* base = nullptr;
+    std::size_t size;
+};
+
+/**
+ * Reservation of host address space that mirrors a guest address space, where each guest page is
+ * either a view of a HostMemory page or inaccessible.
+ */
+class AddressSpace {
+public:
+    explicit AddressSpace(std::size_t size);
+    ~AddressSpace();
+
+    AddressSpace(const AddressSpace&) = delete;
+    AddressSpace& operator=(const AddressSpace&) = delete;
+
+    bool IsValid() const {
+        return base != nullptr;
+    }
+
+    u8* BasePointer() const {
+        return base;
+    }
+
+    /// Makes the range a view of the memory at the offset, readable and writable
+    /// @returns false if the view could not be mapped
+    bool Map(std::size_t virtual_offset, const HostMemory& memory, std::size_t memory_offset,
+             std::size_t length);
+
+    /// Makes the range inaccessible and releases its view
+    /// @returns false if the view could not be released
+    bool Unmap(std::size_t virtual_offset, std::size_t length);
+
+    /// Changes whether the views in the range can be accessed, without remapping them
+    /// @returns false if the protection could not be changed
+    bool Protect(std::size_t virtual_offset, std::size_t length, bool accessible);
+
+private:
+    u8* base = nullptr;
+    std::size_t size;
+};
+
+} // namespace Common
@@ -135,6 +135,38 @@ std::string ReplaceAll(std::string result, const std::string& src, const std::st
     return result;
 }
 
+std::string EscapeJson(const std::string& str) {
+    static constexpr char hex_digits[] = "0123456789abcdef";
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += "\\u00";
+                escaped += hex_digits[c >> 4];
+                escaped += hex_digits[c & 0xF];
+            } else {
+                escaped += c;
+            }
+            break;
+        }
+    }
+    return escaped;
+}
+
 std::string UTF16ToUTF8(const std::u16string& input) {
 #ifdef _MSC_VER
     // Workaround for missing char16_t/char32_t instantiations in MSVC2017
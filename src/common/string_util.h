@@ -36,6 +36,9 @@ void BuildCompleteFilename(std::string& _CompleteFilename, const std::string& _P
                            const std::string& _Filename);
 std::string ReplaceAll(std::string result, const std::string& src, const std::string& dest);
 
+/// Escapes the string to be put between the quotes of a JSON string
+std::string EscapeJson(const std::string& str);
+
 std::string UTF16ToUTF8(const std::u16string& input);
 std::u16string UTF8ToUTF16(const std::string& input);
 
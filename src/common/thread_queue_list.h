@@ -5,122 +5,127 @@
 #pragma once
 
 #include <array>
-#include <deque>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
+/// Links of a thread in a ThreadQueueList, to be stored in the thread as `queue_links`
+template <class T>
+struct ThreadQueueLinks {
+    T prev{};
+    T next{};
+    bool queued = false;
+};
+
+/**
+ * Queues of threads by priority. The threads are linked through their `queue_links`, so queueing
+ * doesn't allocate, and a bit mask of the non-empty priorities gives the best thread at once. A
+ * thread can only be in one queue at a time.
+ */
 template <class T, unsigned int N>
 struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
-
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES = N;
+    static_assert(NUM_QUEUES <= 64, "The priorities have to fit in the bit mask");
 
     ThreadQueueList() = default;
 
     T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        if (used_priorities == 0) {
+            return T();
         }
-
-        return T();
+        return queues[LeastSignificantSetBit(used_priorities)].first;
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        if (used_priorities == 0) {
+            return T();
         }
-
-        return T();
+        return pop_front(LeastSignificantSetBit(used_priorities));
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        if (used_priorities == 0) {
+            return T();
         }
-
-        return T();
+        const Priority best = LeastSignificantSetBit(used_priorities);
+        if (best >= priority) {
+            return T();
+        }
+        return pop_front(best);
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        auto& links = thread_id->queue_links;
+        DEBUG_ASSERT(!links.queued);
+        Queue& queue = queues[priority];
+        links = {T(), queue.first, true};
+        (queue.first ? queue.first->queue_links.prev : queue.last) = thread_id;
+        queue.first = thread_id;
+        used_priorities |= u64{1} << priority;
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        auto& links = thread_id->queue_links;
+        DEBUG_ASSERT(!links.queued);
+        Queue& queue = queues[priority];
+        links = {queue.last, T(), true};
+        (queue.last ? queue.last->queue_links.next : queue.first) = thread_id;
+        queue.last = thread_id;
+        used_priorities |= u64{1} << priority;
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
+    /// Removes the thread from the queue of the priority, if it is queued
     void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        auto& links = thread_id->queue_links;
+        if (!links.queued) {
+            return;
+        }
+        DEBUG_ASSERT_MSG(contains(priority, thread_id), "Thread is not in the queue of priority {}",
+                         priority);
+
+        Queue& queue = queues[priority];
+        (links.prev ? links.prev->queue_links.next : queue.first) = links.next;
+        (links.next ? links.next->queue_links.prev : queue.last) = links.prev;
+        links = {};
+        if (!queue.first) {
+            used_priorities &= ~(u64{1} << priority);
+        }
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T first{};
+        T last{};
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
-    }
-
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
+    /// Walks the queue of the priority for the thread, to check the priority given by the callers
+    bool contains(Priority priority, const T& thread_id) const {
+        for (T it = queues[priority].first; it; it = it->queue_links.next) {
+            if (it == thread_id) {
+                return true;
             }
         }
+        return false;
+    }
 
-        cur->next_nonempty = first;
-        first = cur;
+    T pop_front(Priority priority) {
+        T thread_id = queues[priority].first;
+        remove(priority, thread_id);
+        return thread_id;
     }
 
-    // The first queue that's ever been used.
-    Queue* first = nullptr;
+    // Bit mask of the priority levels that have threads
+    u64 used_priorities = 0;
     // The priority level queues of thread ids.
     std::array<Queue, NUM_QUEUES> queues;
 };
@@ -2,17 +2,31 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 #include <dynarmic/A32/a32.h>
 #include <dynarmic/A32/context.h>
+// Versions of dynarmic that can share an exclusive monitor between the JITs have this header. Their
+// API is then checked by the overrides of the exclusive callbacks.
+#if __has_include(<dynarmic/exclusive_monitor.h>)
+#include <dynarmic/exclusive_monitor.h>
+#define DYNARMIC_HAS_GLOBAL_MONITOR
+#endif
 #include "common/assert.h"
+#include "common/atomic_ops.h"
 #include "common/microprofile.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
+#include "core/arm/dynarmic/arm_dynarmic_translation_cache.h"
 #include "core/core.h"
+#include "core/core_threads.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/kernel/svc.h"
+#include "core/loader/loader.h"
 #include "core/memory.h"
 #include "core/settings.h"
 
@@ -75,30 +89,61 @@ public:
         : parent(parent), svc_context(parent.system), memory(parent.memory) {}
     ~DynarmicUserCallbacks() = default;
 
+    // On a core thread, the accesses are done on the emulation thread, as they can reach the MMIO
+    // and the rasterizer cache
     std::uint8_t MemoryRead8(VAddr vaddr) override {
-        return memory.Read8(vaddr);
+        return RunOnEmuThread([&] { return memory.Read8(vaddr); });
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
-        return memory.Read16(vaddr);
+        return RunOnEmuThread([&] { return memory.Read16(vaddr); });
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
-        return memory.Read32(vaddr);
+        return RunOnEmuThread([&] { return memory.Read32(vaddr); });
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
-        return memory.Read64(vaddr);
+        return RunOnEmuThread([&] { return memory.Read64(vaddr); });
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
-        memory.Write8(vaddr, value);
+        RunOnEmuThread([&] { memory.Write8(vaddr, value); });
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
-        memory.Write16(vaddr, value);
+        RunOnEmuThread([&] { memory.Write16(vaddr, value); });
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
-        memory.Write32(vaddr, value);
+        RunOnEmuThread([&] { memory.Write32(vaddr, value); });
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
-        memory.Write64(vaddr, value);
+        RunOnEmuThread([&] { memory.Write64(vaddr, value); });
+    }
+
+#ifdef DYNARMIC_HAS_GLOBAL_MONITOR
+    // Only called with the global monitor, for the exclusive stores whose reservation still
+    // holds. They only succeed if the memory still holds the value of the exclusive load, as the
+    // other cores write to it directly.
+    bool MemoryWriteExclusive8(VAddr vaddr, std::uint8_t value, std::uint8_t expected) override {
+        return WriteExclusive(vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive16(VAddr vaddr, std::uint16_t value,
+                                std::uint16_t expected) override {
+        return WriteExclusive(vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive32(VAddr vaddr, std::uint32_t value,
+                                std::uint32_t expected) override {
+        return WriteExclusive(vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive64(VAddr vaddr, std::uint64_t value,
+                                std::uint64_t expected) override {
+        return WriteExclusive(vaddr, value, expected);
+    }
+#endif
+
+    // Dynarmic only reads code to translate it
+    std::uint32_t MemoryReadCode(VAddr vaddr) override {
+        if (parent.translation_cache) {
+            parent.RecordTranslation();
+        }
+        return RunOnEmuThread([&] { return memory.Read32(vaddr); });
     }
 
     void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {
@@ -108,7 +153,7 @@ public:
     }
 
     void CallSVC(std::uint32_t swi) override {
-        svc_context.CallSVC(swi);
+        RunOnEmuThread([&] { svc_context.CallSVC(swi); });
     }
 
     void ExceptionRaised(VAddr pc, Dynarmic::A32::Exception exception) override {
@@ -146,21 +191,127 @@ public:
         return static_cast<u64>(ticks <= 0 ? 0 : ticks);
     }
 
+    template <typename Function>
+    static auto RunOnEmuThread(Function&& function) -> decltype(function()) {
+        return Core::CoreThreads::RunOnEmuThread(std::forward<Function>(function));
+    }
+
+    // The emulation thread stops the cores before it removes the host pointer of a page, so the
+    // page table can be read here while they run
+    template <typename T>
+    bool WriteExclusive(VAddr vaddr, T value, T expected) {
+        u8* page = parent.current_page_table->pointers[vaddr >> Memory::PAGE_BITS];
+        if (page != nullptr) {
+            return Common::AtomicCompareAndSwap(
+                reinterpret_cast<volatile T*>(page + (vaddr & Memory::PAGE_MASK)), value, expected);
+        }
+
+        // The pages without a host pointer are only accessed on the emulation thread
+        return RunOnEmuThread([&] {
+            if constexpr (sizeof(T) == 1) {
+                if (memory.Read8(vaddr) != expected) {
+                    return false;
+                }
+                memory.Write8(vaddr, value);
+            } else if constexpr (sizeof(T) == 2) {
+                if (memory.Read16(vaddr) != expected) {
+                    return false;
+                }
+                memory.Write16(vaddr, value);
+            } else if constexpr (sizeof(T) == 4) {
+                if (memory.Read32(vaddr) != expected) {
+                    return false;
+                }
+                memory.Write32(vaddr, value);
+            } else {
+                if (memory.Read64(vaddr) != expected) {
+                    return false;
+                }
+                memory.Write64(vaddr, value);
+            }
+            return true;
+        });
+    }
+
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
 };
 
+/**
+ * Callbacks of the warm-up JIT, which only reads the code of the blocks from the page table. All
+ * the pages of the JIT are unmapped, so that the memory accesses of the blocks end up here as well,
+ * and are dropped along with their SVCs and exceptions.
+ */
+class DynarmicWarmUpCallbacks final : public Dynarmic::A32::UserCallbacks {
+public:
+    explicit DynarmicWarmUpCallbacks(const Memory::PageTable& page_table)
+        : page_table(page_table) {}
+    ~DynarmicWarmUpCallbacks() = default;
+
+    std::uint8_t MemoryRead8(VAddr vaddr) override {
+        return 0;
+    }
+    std::uint16_t MemoryRead16(VAddr vaddr) override {
+        return 0;
+    }
+    std::uint32_t MemoryRead32(VAddr vaddr) override {
+        return 0;
+    }
+    std::uint64_t MemoryRead64(VAddr vaddr) override {
+        return 0;
+    }
+
+    void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {}
+    void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {}
+    void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {}
+    void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {}
+
+    std::uint32_t MemoryReadCode(VAddr vaddr) override {
+        const u8* page = page_table.pointers[vaddr >> Memory::PAGE_BITS];
+        if (page == nullptr) {
+            return 0;
+        }
+
+        u32 value;
+        std::memcpy(&value, page + (vaddr & Memory::PAGE_MASK), sizeof(value));
+        return value;
+    }
+
+    void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {}
+    void CallSVC(std::uint32_t swi) override {}
+    void ExceptionRaised(VAddr pc, Dynarmic::A32::Exception exception) override {}
+
+    void AddTicks(std::uint64_t ticks) override {}
+    std::uint64_t GetTicksRemaining() override {
+        // Without ticks, dynarmic stops after the first block
+        return 0;
+    }
+
+private:
+    const Memory::PageTable& page_table;
+};
+
 ARM_Dynarmic::ARM_Dynarmic(Core::System* system, u32 id, std::shared_ptr<Core::Timing::Timer> timer)
     : ARM_Interface(id, timer), system(*system), memory(system->Memory()),
       cb(std::make_unique<DynarmicUserCallbacks>(*this)) {}
 
-ARM_Dynarmic::~ARM_Dynarmic() = default;
+ARM_Dynarmic::~ARM_Dynarmic() {
+    if (translation_cache) {
+        translation_cache->Save();
+    }
+}
 
 MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
+MICROPROFILE_DEFINE(ARM_Jit_WarmUp, "ARM JIT", "Warm-up", MP_RGB(255, 128, 64));
+
+/// Mode bits of the CPSR in user mode, the one guest code runs in
+constexpr u32 USER_MODE = 0x10;
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    // The cores running in parallel share the memory system, switched to the core of each request
+    ASSERT(Core::CoreThreads::IsCoreThread() ||
+           memory.GetCurrentPageTable() == current_page_table);
     MICROPROFILE_SCOPE(ARM_Jit);
 
     jit->Run();
@@ -278,12 +429,15 @@ void ARM_Dynarmic::PrepareReschedule() {
 
 void ARM_Dynarmic::ClearInstructionCache() {
     for (const auto& j : jits) {
-        j.second->ClearCache();
+        j.second.jit->ClearCache();
     }
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
     jit->InvalidateCacheRange(start_address, length);
+    if (translation_cache && current_page_table == title_page_table) {
+        translation_cache->InvalidateRange(start_address, length);
+    }
     LOG_DEBUG(Core_ARM11, "arm jit invalidate cache range");
 }
 
@@ -292,6 +446,12 @@ Memory::PageTable* ARM_Dynarmic::GetPageTable() const {
 }
 
 void ARM_Dynarmic::SetPageTable(Memory::PageTable* page_table) {
+    // The kernel switches to the core of each request of the core threads, while it is running
+    if (jit != nullptr && page_table == current_page_table &&
+        jits.at(page_table).fastmem_base == page_table->fastmem_base) {
+        return;
+    }
+
     current_page_table = page_table;
     Dynarmic::A32::Context ctx{};
     if (jit) {
@@ -299,16 +459,86 @@ void ARM_Dynarmic::SetPageTable(Memory::PageTable* page_table) {
     }
 
     auto iter = jits.find(current_page_table);
-    if (iter != jits.end()) {
-        jit = iter->second.get();
+    if (iter != jits.end() && iter->second.fastmem_base == current_page_table->fastmem_base) {
+        jit = iter->second.jit.get();
         jit->LoadContext(ctx);
         return;
     }
 
+    // A page table allocated where a destroyed one was has a new fastmem arena
+    if (iter != jits.end()) {
+        jits.erase(iter);
+    }
+
     auto new_jit = MakeJit();
     jit = new_jit.get();
     jit->LoadContext(ctx);
-    jits.emplace(current_page_table, std::move(new_jit));
+    jits.emplace(current_page_table, JitEntry{std::move(new_jit), current_page_table->fastmem_base});
+
+    // The code of the title is loaded by now, so the cache is checked against it while the rest
+    // of the system starts
+    u64 program_id = 0;
+    if (Settings::values.use_cpu_jit_cache && title_page_table == nullptr &&
+        IsTitlePageTable(program_id)) {
+        title_page_table = current_page_table;
+        translation_cache = std::make_unique<DynarmicTranslationCache>(program_id, GetID());
+        translation_cache->LoadAsync(*title_page_table, [this](const auto& entry_points) {
+            WarmUp(entry_points, *title_page_table);
+        });
+    }
+}
+
+bool ARM_Dynarmic::IsTitlePageTable(u64& program_id) const {
+    const auto process = system.Kernel().GetCurrentProcess();
+    if (process == nullptr || &process->vm_manager.page_table != current_page_table) {
+        return false;
+    }
+    if (system.GetAppLoader().ReadProgramId(program_id) != Loader::ResultStatus::Success) {
+        return false;
+    }
+    return process->codeset->program_id == program_id;
+}
+
+void ARM_Dynarmic::RecordTranslation() {
+    if (current_page_table != title_page_table) {
+        return;
+    }
+
+    // Dynarmic translates the block at the current PC
+    translation_cache->Record(
+        {jit->Regs()[15], jit->Cpsr() & DynarmicTranslationCache::CPSR_LOCATION_MASK,
+         jit->Fpscr() & DynarmicTranslationCache::FPSCR_MODE_MASK},
+        *current_page_table);
+}
+
+void ARM_Dynarmic::WarmUp(const std::vector<DynarmicTranslationCache::EntryPoint>& entry_points,
+                          const Memory::PageTable& page_table) const {
+    MICROPROFILE_SCOPE(ARM_Jit_WarmUp);
+
+    // Dynarmic can only compile a block by running it. The blocks are run once, from zeroed
+    // registers, on a JIT with a blank page table, a CP15 of its own and callbacks that drop
+    // everything, so that they can't reach the guest or this core.
+    DynarmicWarmUpCallbacks callbacks{page_table};
+    auto blank_pointers = std::make_unique<decltype(Memory::PageTable::pointers)>();
+    CP15State warm_up_cp15_state;
+
+    Dynarmic::A32::UserConfig config;
+    config.callbacks = &callbacks;
+    config.page_table = blank_pointers.get();
+    config.coprocessors[15] = std::make_shared<DynarmicCP15>(warm_up_cp15_state);
+    config.define_unpredictable_behaviour = true;
+    Dynarmic::A32::Jit warm_up_jit{config};
+
+    for (const auto& entry_point : entry_points) {
+        warm_up_jit.Regs() = {};
+        warm_up_jit.Regs()[15] = entry_point.pc;
+        warm_up_jit.SetCpsr(entry_point.cpsr | USER_MODE);
+        warm_up_jit.SetFpscr(entry_point.fpscr);
+        warm_up_jit.Run();
+    }
+
+    LOG_INFO(Core_ARM11, "Compiled {} cached blocks of core {} in the background",
+             entry_points.size(), GetID());
 }
 
 void ARM_Dynarmic::ServeBreak() {
@@ -318,12 +548,52 @@ void ARM_Dynarmic::ServeBreak() {
     GDBStub::SendTrap(thread, 5);
 }
 
+/// Whether this version of dynarmic can access the guest memory through a host mirror
+template <typename Config, typename = void>
+struct HasFastmem : std::false_type {};
+template <typename Config>
+struct HasFastmem<Config, std::void_t<decltype(std::declval<Config&>().fastmem_pointer)>>
+    : std::true_type {};
+
+bool ARM_Dynarmic::SupportsFastmem() {
+    return HasFastmem<Dynarmic::A32::UserConfig>::value;
+}
+
+std::shared_ptr<Dynarmic::ExclusiveMonitor> ARM_Dynarmic::MakeExclusiveMonitor() {
+#ifdef DYNARMIC_HAS_GLOBAL_MONITOR
+    return std::make_shared<Dynarmic::ExclusiveMonitor>(NUM_CORES);
+#else
+    return nullptr;
+#endif
+}
+
+/**
+ * Lets the JIT access the guest memory directly in the fastmem arena. Accesses to its inaccessible
+ * pages fault, and dynarmic's signal handler recompiles them to go through the callbacks. The
+ * arenas are only reserved if SupportsFastmem().
+ */
+template <typename Config>
+static void SetFastmemPointer(Config& config, u8* fastmem_base) {
+    if constexpr (HasFastmem<Config>::value) {
+        config.fastmem_pointer = fastmem_base;
+    }
+}
+
 std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.callbacks = cb.get();
     config.page_table = &current_page_table->pointers;
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
     config.define_unpredictable_behaviour = true;
+    SetFastmemPointer(config, current_page_table->fastmem_base);
+#ifdef DYNARMIC_HAS_GLOBAL_MONITOR
+    // The JITs of the cores running in parallel share the monitor of the system, so that an
+    // exclusive store of a core fails once another core wrote to the reserved address
+    if (Dynarmic::ExclusiveMonitor* monitor = system.GetExclusiveMonitor()) {
+        config.global_monitor = monitor;
+        config.processor_id = GetID();
+    }
+#endif
     return std::make_unique<Dynarmic::A32::Jit>(config);
 }
 
@@ -6,10 +6,16 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 #include <dynarmic/A32/a32.h>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
+#include "core/arm/dynarmic/arm_dynarmic_translation_cache.h"
+
+namespace Dynarmic {
+class ExclusiveMonitor;
+}
 
 namespace Memory {
 struct PageTable;
@@ -27,6 +33,18 @@ public:
     ARM_Dynarmic(Core::System* system, u32 id, std::shared_ptr<Core::Timing::Timer> timer);
     ~ARM_Dynarmic() override;
 
+    /// Number of JITs sharing the exclusive monitor, one per core
+    static constexpr u32 NUM_CORES = 4;
+
+    /**
+     * Makes the exclusive monitor shared by the JITs of all the cores, which they need to run in
+     * parallel, or returns null if this version of dynarmic can't share one
+     */
+    static std::shared_ptr<Dynarmic::ExclusiveMonitor> MakeExclusiveMonitor();
+
+    /// Whether this version of dynarmic can access the guest memory through a fastmem arena
+    static bool SupportsFastmem();
+
     void Run() override;
     void Step() override;
 
@@ -54,12 +72,25 @@ public:
     void SetPageTable(Memory::PageTable* page_table) override;
     void PurgeState() override;
 
+    /**
+     * Compiles the blocks at the entry points on a JIT of its own, which reads their code from the
+     * page table and runs them with all the pages unmapped and every access dropped. Nothing of
+     * this core or of the guest is changed, so it runs on the thread loading the translation cache.
+     */
+    void WarmUp(const std::vector<DynarmicTranslationCache::EntryPoint>& entry_points,
+                const Memory::PageTable& page_table) const;
+
 protected:
     Memory::PageTable* GetPageTable() const override;
 
 private:
     void ServeBreak();
 
+    /// Records the block dynarmic is translating in the translation cache
+    void RecordTranslation();
+    /// Whether the current page table is the one of the title, whose program ID is read
+    bool IsTitlePageTable(u64& program_id) const;
+
     friend class DynarmicUserCallbacks;
     Core::System& system;
     Memory::MemorySystem& memory;
@@ -71,5 +102,14 @@ private:
 
     Dynarmic::A32::Jit* jit = nullptr;
     Memory::PageTable* current_page_table = nullptr;
-    std::map<Memory::PageTable*, std::unique_ptr<Dynarmic::A32::Jit>> jits;
+    struct JitEntry {
+        std::unique_ptr<Dynarmic::A32::Jit> jit;
+        /// Fastmem arena of the page table when the JIT was made
+        u8* fastmem_base;
+    };
+    std::map<Memory::PageTable*, JitEntry> jits;
+
+    /// Translations of the page table of the title process, persisted between sessions
+    std::unique_ptr<DynarmicTranslationCache> translation_cache;
+    Memory::PageTable* title_page_table = nullptr;
 };
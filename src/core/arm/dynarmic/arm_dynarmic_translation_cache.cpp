@@ -0,0 +1,161 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/arm/dynarmic/arm_dynarmic_translation_cache.h"
+#include "core/cache_file.h"
+#include "core/memory.h"
+
+/// Version of the cache file, to be increased whenever its layout changes
+constexpr u32 TRANSLATION_CACHE_VERSION = 0x1;
+
+/// Maximum number of entry points per title and core. Each of them is compiled at boot.
+constexpr std::size_t MAX_ENTRY_POINTS = 0x8000;
+
+struct TranslationCacheHeader {
+    u32 version;
+};
+
+DynarmicTranslationCache::DynarmicTranslationCache(u64 program_id, u32 core_id)
+    : filename(fmt::format("{}{:016X}_{}.arm", FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                           program_id, core_id)) {}
+
+DynarmicTranslationCache::~DynarmicTranslationCache() {
+    if (pending_load.valid()) {
+        pending_load.wait();
+    }
+}
+
+static u64 HashPage(const u8* page) {
+    return Common::ComputeHash64(page, Memory::PAGE_SIZE);
+}
+
+void DynarmicTranslationCache::LoadAsync(const Memory::PageTable& page_table,
+                                         LoadCallback on_loaded) {
+    pending_load = std::async(std::launch::async, [this, &page_table, on_loaded] {
+        LoadResult result = Load(page_table);
+        if (!result.entry_points.empty()) {
+            on_loaded(result.entry_points);
+        }
+        return result;
+    });
+}
+
+DynarmicTranslationCache::LoadResult DynarmicTranslationCache::Load(
+    const Memory::PageTable& page_table) const {
+    LoadResult result;
+    if (!FileUtil::Exists(filename)) {
+        return result;
+    }
+
+    Core::CacheFile file(filename, Core::CacheFile::MODE_LOAD);
+
+    TranslationCacheHeader header{};
+    file.DoHeader(header);
+    if (header.version != TRANSLATION_CACHE_VERSION) {
+        FileUtil::Delete(filename);
+        return result;
+    }
+
+    std::vector<EntryPoint> saved_entry_points;
+    std::map<u32, u64> saved_page_hashes;
+    file.Do(saved_entry_points);
+    file.Do(saved_page_hashes);
+    if (!file.IsGood()) {
+        return result;
+    }
+
+    // Pages that were changed since, like those of a different version of the title or of a CRO
+    // that is not loaded yet, are left out with their entry points
+    for (const auto& [page_index, hash] : saved_page_hashes) {
+        const u8* page = page_table.pointers[page_index];
+        if (page != nullptr && HashPage(page) == hash) {
+            result.page_hashes.emplace(page_index, hash);
+        }
+    }
+
+    for (const EntryPoint& entry_point : saved_entry_points) {
+        if (result.page_hashes.count(entry_point.pc >> Memory::PAGE_BITS) != 0) {
+            result.entry_points.push_back(entry_point);
+        }
+    }
+
+    LOG_INFO(Core_ARM11, "Loaded {} of {} cached JIT entry points", result.entry_points.size(),
+             saved_entry_points.size());
+    return result;
+}
+
+std::vector<DynarmicTranslationCache::EntryPoint> DynarmicTranslationCache::TakeEntryPoints() {
+    if (!pending_load.valid()) {
+        return {};
+    }
+
+    LoadResult result = pending_load.get();
+    entry_points.insert(result.entry_points.begin(), result.entry_points.end());
+    page_hashes.merge(result.page_hashes);
+    return std::move(result.entry_points);
+}
+
+void DynarmicTranslationCache::Record(const EntryPoint& entry_point,
+                                      const Memory::PageTable& page_table) {
+    if (!(entry_point < last_recorded) && !(last_recorded < entry_point)) {
+        return;
+    }
+    last_recorded = entry_point;
+
+    if (entry_points.size() >= MAX_ENTRY_POINTS || entry_points.count(entry_point) != 0) {
+        return;
+    }
+
+    const u32 page_index = entry_point.pc >> Memory::PAGE_BITS;
+    if (page_hashes.count(page_index) == 0) {
+        const u8* page = page_table.pointers[page_index];
+        if (page == nullptr) {
+            return;
+        }
+        page_hashes.emplace(page_index, HashPage(page));
+    }
+
+    entry_points.insert(entry_point);
+    dirty = true;
+}
+
+void DynarmicTranslationCache::InvalidateRange(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    const u32 first_page = start_address >> Memory::PAGE_BITS;
+    const u32 last_page = static_cast<u32>((start_address + length - 1) >> Memory::PAGE_BITS);
+    page_hashes.erase(page_hashes.lower_bound(first_page), page_hashes.upper_bound(last_page));
+    last_recorded = {};
+}
+
+void DynarmicTranslationCache::Save() {
+    // Entry points of the previous sessions that were not warmed up are still worth keeping
+    TakeEntryPoints();
+    if (!dirty) {
+        return;
+    }
+
+    // Entry points whose page was invalidated and not recorded again have no valid hash
+    std::vector<EntryPoint> saved_entry_points;
+    for (const EntryPoint& entry_point : entry_points) {
+        if (page_hashes.count(entry_point.pc >> Memory::PAGE_BITS) != 0) {
+            saved_entry_points.push_back(entry_point);
+        }
+    }
+
+    Core::CacheFile file(filename, Core::CacheFile::MODE_SAVE);
+
+    TranslationCacheHeader header{TRANSLATION_CACHE_VERSION};
+    file.DoHeader(header);
+    file.Do(saved_entry_points);
+    file.Do(page_hashes);
+
+    dirty = false;
+}
@@ -0,0 +1,85 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Memory {
+struct PageTable;
+}
+
+/**
+ * Records the guest code dynarmic translates for a title, so that the JIT can be warmed up with it
+ * before the title runs the next time. An entry point is only kept if the code page it starts in
+ * has the same hash when the title is loaded again. Only translations are saved, the warm-up still
+ * compiles the code from the guest memory.
+ */
+class DynarmicTranslationCache {
+public:
+    /// Guest state a dynarmic block is translated for
+    struct EntryPoint {
+        u32 pc;
+        /// IT, E and T bits of the CPSR
+        u32 cpsr;
+        /// Mode bits of the FPSCR
+        u32 fpscr;
+
+        bool operator<(const EntryPoint& other) const {
+            return std::tie(pc, cpsr, fpscr) < std::tie(other.pc, other.cpsr, other.fpscr);
+        }
+    };
+
+    static constexpr u32 CPSR_LOCATION_MASK = 0x0600FE20;
+    static constexpr u32 FPSCR_MODE_MASK = 0x07F79F00;
+
+    DynarmicTranslationCache(u64 program_id, u32 core_id);
+    ~DynarmicTranslationCache();
+
+    /// Called on the loading thread with the entry points that are still valid
+    using LoadCallback = std::function<void(const std::vector<EntryPoint>&)>;
+
+    /**
+     * Reads the cache file in a background thread and checks its entry points against the pages,
+     * then calls on_loaded with them on that thread
+     */
+    void LoadAsync(const Memory::PageTable& page_table, LoadCallback on_loaded);
+
+    /// Waits for LoadAsync and returns the entry points that are still valid
+    std::vector<EntryPoint> TakeEntryPoints();
+
+    /// Records a translated entry point, if its page is mapped
+    void Record(const EntryPoint& entry_point, const Memory::PageTable& page_table);
+
+    /// Forgets the hashes of the pages in the range, they are hashed again by the next Record
+    void InvalidateRange(u32 start_address, std::size_t length);
+
+    void Save();
+
+private:
+    struct LoadResult {
+        std::vector<EntryPoint> entry_points;
+        std::map<u32, u64> page_hashes;
+    };
+
+    LoadResult Load(const Memory::PageTable& page_table) const;
+
+    std::string filename;
+    std::future<LoadResult> pending_load;
+
+    /// Entry points of this and earlier sessions, limited to MAX_ENTRY_POINTS
+    std::set<EntryPoint> entry_points;
+    /// Hashes of the pages the entry points start in, by page index
+    std::map<u32, u64> page_hashes;
+    /// Dynarmic reads each instruction of a block, all with the same entry point
+    EntryPoint last_recorded{};
+    bool dirty = false;
+};
@@ -84,12 +84,13 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    // The other cores still use trans_cache_buf, which is reset once full
+    state->instruction_cache.Clear();
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    // The stale translations stay in trans_cache_buf until it has to be reset
+    state->instruction_cache.InvalidateRange(start_address, length);
 }
 
 void ARM_DynCom::SetPageTable(Memory::PageTable* page_table) {
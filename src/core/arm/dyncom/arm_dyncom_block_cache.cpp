@@ -0,0 +1,69 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+
+/// The caches of all the cores, whose blocks are all in trans_cache_buf
+static std::vector<BlockCache*> block_caches;
+
+BlockCache::BlockCache() {
+    block_caches.push_back(this);
+}
+
+BlockCache::~BlockCache() {
+    block_caches.erase(std::find(block_caches.begin(), block_caches.end(), this));
+}
+
+void BlockCache::Insert(u32 address, u32 block) {
+    auto& directory = directories[address >> DIRECTORY_SHIFT];
+    if (directory == nullptr) {
+        directory = std::make_unique<Directory>();
+    }
+    auto& page = (*directory)[(address >> PAGE_BITS) & DIRECTORY_MASK];
+    if (page == nullptr) {
+        page = std::make_unique<Page>();
+        page->fill(NO_BLOCK);
+    }
+    (*page)[(address & PAGE_MASK) >> 1] = block;
+}
+
+void BlockCache::InvalidateRange(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    const u64 end_address = u64{start_address} + length - 1;
+    const u64 last_page = std::min<u64>(end_address >> PAGE_BITS, NUM_PAGES - 1);
+    u64 page_index = start_address >> PAGE_BITS;
+    while (page_index <= last_page) {
+        const auto& directory = directories[page_index >> DIRECTORY_BITS];
+        if (directory == nullptr) {
+            // Skips to the first page of the next directory
+            page_index = (page_index | DIRECTORY_MASK) + 1;
+            continue;
+        }
+        if (auto& page = (*directory)[page_index & DIRECTORY_MASK]) {
+            page->fill(NO_BLOCK);
+        }
+        ++page_index;
+    }
+
+    // Links from other pages may point into the invalidated ones
+    ++generation;
+}
+
+void BlockCache::Clear() {
+    for (auto& directory : directories) {
+        directory.reset();
+    }
+    ++generation;
+}
+
+void BlockCache::ClearAll() {
+    for (BlockCache* block_cache : block_caches) {
+        block_cache->Clear();
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include "common/common_types.h"
+
+/// Translated successor of a direct branch, patched into the branch once it has been resolved
+struct BlockLink {
+    /// Offset of the successor in trans_cache_buf
+    u32 block;
+    /// Generation of the BlockCache the link was made in, the link is stale if it differs
+    u64 generation;
+};
+
+/**
+ * Maps guest addresses to the offsets of their translated blocks in trans_cache_buf. Translated
+ * blocks never cross a page boundary, so there is one flat table of halfword entries per 4K page,
+ * allocated when a block of the page is first inserted, and invalidations work on whole pages. The
+ * pages are found through a two-level table whose second level is also allocated on first use.
+ */
+class BlockCache {
+public:
+    static constexpr u32 NO_BLOCK = 0xFFFFFFFF;
+
+    BlockCache();
+    ~BlockCache();
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /// Returns the offset of the block translated at the address, or NO_BLOCK
+    u32 Find(u32 address) const {
+        const Directory* directory = directories[address >> DIRECTORY_SHIFT].get();
+        if (directory == nullptr) {
+            return NO_BLOCK;
+        }
+        const Page* page = (*directory)[(address >> PAGE_BITS) & DIRECTORY_MASK].get();
+        if (page == nullptr) {
+            return NO_BLOCK;
+        }
+        return (*page)[(address & PAGE_MASK) >> 1];
+    }
+
+    void Insert(u32 address, u32 block);
+
+    /// Drops the blocks of all the pages overlapping the range, and all the links between blocks
+    void InvalidateRange(u32 start_address, std::size_t length);
+
+    /// Drops all the blocks, their translations stay in trans_cache_buf until it is reset
+    void Clear();
+
+    /// Drops the blocks of all the caches, to be followed by a reset of trans_cache_buf
+    static void ClearAll();
+
+    bool IsLinked(const BlockLink& link) const {
+        return link.generation == generation;
+    }
+
+    void Link(BlockLink& link, u32 block) const {
+        link.block = block;
+        link.generation = generation;
+    }
+
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1 << PAGE_BITS) - 1;
+    static constexpr std::size_t NUM_PAGES = std::size_t{1} << (32 - PAGE_BITS);
+    /// Each directory covers 4 MiB of the address space
+    static constexpr u32 DIRECTORY_BITS = 10;
+    static constexpr u32 DIRECTORY_MASK = (1 << DIRECTORY_BITS) - 1;
+    static constexpr u32 DIRECTORY_SHIFT = PAGE_BITS + DIRECTORY_BITS;
+    static constexpr std::size_t NUM_DIRECTORIES = std::size_t{1} << (32 - DIRECTORY_SHIFT);
+
+    /// Thumb instructions are halfword aligned, so a page holds up to 2048 blocks
+    using Page = std::array<u32, (PAGE_MASK + 1) / 2>;
+    using Directory = std::array<std::unique_ptr<Page>, DIRECTORY_MASK + 1>;
+
+    std::array<std::unique_ptr<Directory>, NUM_DIRECTORIES> directories;
+    /// Incremented by every invalidation, so that links never need to be searched for. Starts
+    /// above zero, which is the generation of the links of newly translated branches.
+    u64 generation = 1;
+};
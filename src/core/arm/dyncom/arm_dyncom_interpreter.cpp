@@ -856,7 +856,9 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
-    while (ret == TransExtData::NON_BRANCH) {
+    // Conditional direct branches don't end the block, their not taken path is linked to the
+    // instructions that follow them, which makes a superblock of the rest of the page.
+    while (ret == TransExtData::NON_BRANCH || ret == TransExtData::COND) {
         unsigned int inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
         size++;
@@ -867,9 +869,14 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
             inst_base->br = TransExtData::END_OF_PAGE;
         }
         ret = inst_base->br;
+
+        if (ret == TransExtData::COND) {
+            BlockLink* not_taken = (BlockLink*)inst_base->component;
+            cpu->instruction_cache.Link(*not_taken, static_cast<u32>(trans_cache_buf_top));
+        }
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, static_cast<u32>(bb_start));
 
     return KEEP_GOING;
 }
@@ -889,7 +896,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, static_cast<u32>(bb_start));
 
     return KEEP_GOING;
 }
@@ -1631,6 +1638,8 @@ unsigned InterpreterMainLoop(ARMul_State* cpu, Core::Timing::Timer* timer) {
     unsigned int num_instrs = 0;
 
     std::size_t ptr;
+    /// Link of the direct branch that last jumped to DISPATCH, patched with the resolved block
+    BlockLink* block_link = nullptr;
 
     LOAD_NZCVT;
 DISPATCH : {
@@ -1645,17 +1654,34 @@ DISPATCH : {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
-    // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    // Follow the link of a direct branch, otherwise find the cached instruction cream, otherwise
+    // translate it...
+    if (block_link != nullptr && cpu->instruction_cache.IsLinked(*block_link)) {
+        ptr = block_link->block;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        ptr = cpu->instruction_cache.Find(cpu->Reg[15]);
+        if (ptr == BlockCache::NO_BLOCK) {
+            // Blocks are only dropped by invalidations, so start over before the buffer is full.
+            // The other cores have their blocks in it as well.
+            if (trans_cache_buf_top > TRANS_CACHE_SIZE - TRANS_CACHE_RESERVE) {
+                ClearTransCache();
+                block_link = nullptr;
+            }
+
+            if (cpu->NumInstrsToExecute != 1) {
+                if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            } else {
+                if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            }
+        }
+
+        if (block_link != nullptr) {
+            cpu->instruction_cache.Link(*block_link, static_cast<u32>(ptr));
+        }
     }
+    block_link = nullptr;
 
 #ifndef ANDROID
     // Find breakpoint if one exists within the block
@@ -1768,17 +1794,19 @@ AND_INST : {
     GOTO_NEXT_INST;
 }
 BBL_INST : {
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
         if (inst_cream->L) {
             LINK_RTN_ADDR;
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
+        block_link = &inst_cream->taken;
         goto DISPATCH;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(bbl_inst));
+    block_link = &inst_cream->not_taken;
     goto DISPATCH;
 }
 BIC_INST : {
@@ -4330,15 +4358,19 @@ B_2_THUMB : {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
     INC_PC(sizeof(b_2_thumb));
+    block_link = &inst_cream->taken;
     goto DISPATCH;
 }
 B_COND_THUMB : {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
+        block_link = &inst_cream->taken;
+    } else {
         cpu->Reg[15] += 2;
+        block_link = &inst_cream->not_taken;
+    }
 
     INC_PC(sizeof(b_cond_thumb));
     goto DISPATCH;
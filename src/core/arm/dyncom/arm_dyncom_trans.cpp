@@ -1,6 +1,7 @@
 #include <cstdlib>
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
 #include "core/arm/dyncom/arm_dyncom_trans.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/armsupp.h"
@@ -9,6 +10,11 @@
 char trans_cache_buf[TRANS_CACHE_SIZE];
 size_t trans_cache_buf_top = 0;
 
+void ClearTransCache() {
+    BlockCache::ClearAll();
+    trans_cache_buf_top = 0;
+}
+
 static void* AllocBuffer(std::size_t size) {
     std::size_t start = trans_cache_buf_top;
     trans_cache_buf_top += size;
@@ -96,7 +102,11 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bbl)(unsigned int inst, int index) {
 
     if (BIT(inst, 24))
         inst_base->br = TransExtData::CALL;
+    if (inst_base->cond != ConditionCode::AL)
+        inst_base->br = TransExtData::COND;
 
+    inst_cream->not_taken = {BlockCache::NO_BLOCK, 0};
+    inst_cream->taken = {BlockCache::NO_BLOCK, 0};
     inst_cream->L = BIT(inst, 24);
     inst_cream->signed_immed_24 = BIT(inst, 23) ? NEGBRANCH : POSBRANCH;
 
@@ -1645,6 +1655,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_2_thumb)(unsigned int tinst, int ind
     arm_inst* inst_base = (arm_inst*)AllocBuffer(sizeof(arm_inst) + sizeof(b_2_thumb));
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
 
+    inst_cream->taken = {BlockCache::NO_BLOCK, 0};
     inst_cream->imm = ((tinst & 0x3FF) << 1) | ((tinst & (1 << 10)) ? 0xFFFFF800 : 0);
 
     inst_base->idx = index;
@@ -1659,8 +1670,10 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_cond_thumb)(unsigned int tinst, int
 
     inst_cream->imm = (((tinst & 0x7F) << 1) | ((tinst & (1 << 7)) ? 0xFFFFFF00 : 0));
     inst_cream->cond = ((tinst >> 8) & 0xf);
+    inst_cream->not_taken = {BlockCache::NO_BLOCK, 0};
+    inst_cream->taken = {BlockCache::NO_BLOCK, 0};
     inst_base->idx = index;
-    inst_base->br = TransExtData::DIRECT_BRANCH;
+    inst_base->br = TransExtData::COND;
 
     return inst_base;
 }
@@ -6,11 +6,13 @@
 
 #include <cstddef>
 #include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
 
 struct ARMul_State;
 typedef unsigned int (*shtop_fp_t)(ARMul_State* cpu, unsigned int sht_oper);
 
 enum class TransExtData {
+    // Conditional direct branch, whose not taken path continues the translated block
     COND = (1 << 0),
     NON_BRANCH = (1 << 1),
     DIRECT_BRANCH = (1 << 2),
@@ -83,11 +85,12 @@ struct eor_inst {
     shtop_fp_t shtop_func;
 };
 
+// Branches marked with TransExtData::COND start with the link to their not taken successor
 struct bbl_inst {
+    BlockLink not_taken;
+    BlockLink taken;
     unsigned int L;
     int signed_immed_24;
-    unsigned int next_addr;
-    unsigned int jmp_addr;
 };
 
 struct bx_inst {
@@ -450,9 +453,12 @@ struct setend_inst {
 };
 
 struct b_2_thumb {
+    BlockLink taken;
     unsigned int imm;
 };
 struct b_cond_thumb {
+    BlockLink not_taken;
+    BlockLink taken;
     unsigned int imm;
     unsigned int cond;
 };
@@ -494,5 +500,10 @@ extern const transop_fp_t arm_instruction_trans[];
 extern const std::size_t arm_instruction_trans_len;
 
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
+// Space left for the translation of a whole page when the cache is reset
+#define TRANS_CACHE_RESERVE (1024 * 1024)
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
 extern std::size_t trans_cache_buf_top;
+
+/// Drops the translations of all the cores, which share trans_cache_buf, and starts it over
+void ClearTransCache();
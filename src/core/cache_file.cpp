@@ -1,4 +1,5 @@
 
+#include <mutex>
 #include <android/log.h>
 #include <minilzo.h>
 
@@ -20,19 +21,19 @@
 #define HEAP_ALLOC(var, size)                                                                      \
     lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
 
-static bool s_lzo_init = false;
+/// The shader caches are read and written from several threads
+static std::once_flag s_lzo_init;
 
 namespace Core {
 
 class CacheFile::CacheFileImpl {
 public:
     CacheFileImpl(FileUtil::IOFile& file) : file(file) {
-        if (!s_lzo_init) {
+        std::call_once(s_lzo_init, [] {
             if (lzo_init() != LZO_E_OK) {
                 ASSERT_MSG(false, "Internal LZO Error - lzo_init() failed");
             }
-            s_lzo_init = true;
-        }
+        });
         buffer.reserve(OUT_LEN);
     }
 
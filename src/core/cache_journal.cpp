@@ -0,0 +1,176 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <utility>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/cache_journal.h"
+
+namespace Core {
+
+namespace {
+
+constexpr u32 JOURNAL_MAGIC = 0x4C4E4A43; // "CJNL"
+
+/// The journal is compacted once a quarter of it is made of replaced records
+constexpr u64 COMPACTION_RATIO = 4;
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct RecordHeader {
+    u32 type;
+    u32 size;
+    u64 key;
+    /// Hash of the fields above and of the data
+    u64 checksum;
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader has padding");
+
+u64 ComputeChecksum(const RecordHeader& header, const void* data, std::size_t size) {
+    return Common::ComputeHash64(&header, offsetof(RecordHeader, checksum)) ^
+           Common::ComputeHash64(data, static_cast<u32>(size));
+}
+
+void WriteRecord(FileUtil::IOFile& file, u32 type, u64 key, const void* data, std::size_t size) {
+    RecordHeader header{type, static_cast<u32>(size), key, 0};
+    header.checksum = ComputeChecksum(header, data, size);
+    file.WriteObject(header);
+    file.WriteBytes(static_cast<const u8*>(data), size);
+}
+
+} // Anonymous namespace
+
+CacheJournal::CacheJournal(std::string filename, u32 version)
+    : filename(std::move(filename)), version(version) {}
+
+CacheJournal::~CacheJournal() = default;
+
+std::vector<CacheJournal::Record> CacheJournal::Load() {
+    std::vector<Record> records;
+    FileUtil::IOFile input(filename, "rb");
+    const u64 file_size = input.IsOpen() ? input.GetSize() : 0;
+
+    FileHeader file_header{};
+    if (file_size >= sizeof(file_header)) {
+        input.ReadBytes(&file_header, sizeof(file_header));
+    }
+    if (!input.IsGood() || file_header.magic != JOURNAL_MAGIC || file_header.version != version) {
+        if (file_size > 0) {
+            LOG_INFO(Core, "Clearing cache journal {} of another version", filename);
+        }
+        input.Close();
+        if (!Compact(records)) {
+            Recover(0);
+        }
+        return records;
+    }
+
+    // Index of the records by type and key, to replace them
+    std::map<std::pair<u32, u64>, std::size_t> index;
+    u64 replaced_size = 0;
+    u64 offset = sizeof(file_header);
+    while (file_size - offset >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        input.ReadBytes(&header, sizeof(header));
+        if (!input.IsGood() || header.size > file_size - offset - sizeof(header)) {
+            break;
+        }
+        std::vector<u8> data(header.size);
+        input.ReadBytes(data.data(), data.size());
+        if (!input.IsGood() ||
+            header.checksum != ComputeChecksum(header, data.data(), data.size())) {
+            // A torn or corrupted record, nothing after it can be trusted
+            break;
+        }
+
+        auto [iter, inserted] = index.emplace(std::make_pair(header.type, header.key),
+                                              records.size());
+        if (inserted) {
+            records.push_back({header.type, header.key, std::move(data)});
+        } else {
+            replaced_size += sizeof(RecordHeader) + records[iter->second].data.size();
+            records[iter->second].data = std::move(data);
+        }
+        offset += sizeof(header) + header.size;
+    }
+    input.Close();
+    size = file_size;
+
+    if (offset != file_size) {
+        // The records appended after the corrupted ones would be lost
+        LOG_WARNING(Core, "Dropping {} corrupted bytes at the end of cache journal {}",
+                    file_size - offset, filename);
+        if (!Compact(records)) {
+            Recover(offset);
+        }
+    } else if (replaced_size * COMPACTION_RATIO < size || !Compact(records)) {
+        file.Open(filename, "ab");
+    }
+    return records;
+}
+
+void CacheJournal::Append(u32 type, u64 key, const void* data, std::size_t data_size) {
+    if (!file.IsGood()) {
+        return;
+    }
+    WriteRecord(file, type, key, data, data_size);
+    file.Flush();
+    if (!file.IsGood()) {
+        LOG_ERROR(Core, "Failed to append to cache journal {}", filename);
+        return;
+    }
+    size += sizeof(RecordHeader) + data_size;
+}
+
+bool CacheJournal::Compact(const std::vector<Record>& records) {
+    file.Close();
+
+    const std::string temp_filename = filename + ".tmp";
+    u64 new_size = sizeof(FileHeader);
+    bool written;
+    {
+        FileUtil::IOFile output(temp_filename, "wb");
+        output.WriteObject(FileHeader{JOURNAL_MAGIC, version});
+        for (const Record& record : records) {
+            WriteRecord(output, record.type, record.key, record.data.data(), record.data.size());
+            new_size += sizeof(RecordHeader) + record.data.size();
+        }
+        output.Flush();
+        written = output.IsGood();
+    }
+
+    if (!written || !FileUtil::Rename(temp_filename, filename)) {
+        LOG_ERROR(Core, "Failed to compact cache journal {}", filename);
+        FileUtil::Delete(temp_filename);
+        return false;
+    }
+    size = new_size;
+    file.Open(filename, "ab");
+    return true;
+}
+
+void CacheJournal::Recover(u64 valid_size) {
+    bool truncated = false;
+    if (valid_size >= sizeof(FileHeader)) {
+        FileUtil::IOFile output(filename, "r+b");
+        truncated = output.IsOpen() && output.Resize(valid_size);
+    }
+    if (!truncated) {
+        // Start over in place
+        FileUtil::IOFile output(filename, "wb");
+        output.WriteObject(FileHeader{JOURNAL_MAGIC, version});
+        output.Flush();
+        valid_size = sizeof(FileHeader);
+    }
+    size = valid_size;
+    file.Open(filename, "ab");
+}
+
+} // namespace Core
@@ -0,0 +1,68 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace Core {
+
+/**
+ * Append-only cache file of checksummed records, each with a type and a key. A record replaces the
+ * earlier one of the same type and key. The records are flushed to the file as they are appended,
+ * so a crash only loses the one being written, whose checksum doesn't match on the next load.
+ * The journal is rewritten without the replaced and corrupted records once they make up a good
+ * part of it.
+ */
+class CacheJournal {
+public:
+    struct Record {
+        u32 type;
+        u64 key;
+        std::vector<u8> data;
+    };
+
+    CacheJournal(std::string filename, u32 version);
+    ~CacheJournal();
+
+    /**
+     * Reads the records of the journal and opens it to append. A journal of another version is
+     * cleared.
+     * @returns The records left after the replacements, in the order they were first appended
+     */
+    std::vector<Record> Load();
+
+    /// Appends a record to the loaded journal
+    void Append(u32 type, u64 key, const void* data, std::size_t size);
+
+    /// Gets the size of the journal file
+    u64 GetSize() const {
+        return size;
+    }
+
+private:
+    /**
+     * Rewrites the journal with the records. The new file replaces the old one once complete, so
+     * a crash meanwhile keeps the old one.
+     * @returns Whether the journal was rewritten
+     */
+    bool Compact(const std::vector<Record>& records);
+
+    /**
+     * Keeps appending to the journal in place when it couldn't be compacted, after truncating the
+     * records that can't be trusted. The journal is started over if it can't be truncated.
+     * @param valid_size Size of the trusted part of the file, 0 if none of it is
+     */
+    void Recover(u64 valid_size);
+
+    std::string filename;
+    u32 version;
+    FileUtil::IOFile file;
+    u64 size = 0;
+};
+
+} // namespace Core
@@ -7,6 +7,8 @@
 #include "audio_core/dsp_interface.h"
 #include "audio_core/hle/hle.h"
 #include "audio_core/lle/lle.h"
+#include "common/file_util.h"
+#include "common/host_memory.h"
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
@@ -15,6 +17,7 @@
 #include "core/arm/dyncom/arm_dyncom.h"
 #include "core/cheats/cheats.h"
 #include "core/core.h"
+#include "core/core_threads.h"
 #include "core/core_timing.h"
 #include "core/custom_tex_cache.h"
 #include "core/file_sys/archive_source_sd_savedata.h"
@@ -23,6 +26,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/latency_stats.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/sm/sm.h"
@@ -71,8 +75,15 @@ System::ResultStatus System::RunLoopMultiCores() {
             kernel->Advance(cpu_core.get(), max_slice);
         }
         timing->AddToGlobalTicks(max_slice);
-        for (auto& cpu_core : cpu_cores) {
-            kernel->Run(cpu_core.get());
+        // The order in which the cores access shared memory depends on the host when they run in
+        // parallel, so movies and the debugger keep running them one after the other
+        if (core_threads && !Movie::GetInstance().IsPlayingInput() &&
+            !Movie::GetInstance().IsRecordingInput() && !GDBStub::IsServerEnabled()) {
+            core_threads->RunSlice();
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                kernel->Run(cpu_core.get());
+            }
         }
     }
 
@@ -132,23 +143,8 @@ static void LoadOverrides(u64 title_id) {
     } else if (title_id == 0x00040000001ACB00) {
         // Dragon Quest Monsters Joker 3 Professional
         Settings::values.skip_slow_draw = true;
-    } else if (title_id == 0x000400000019E700 || title_id == 0x00040000001A5600) {
-        // Armed Blue Gunvolt
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x000400000019B200 || title_id == 0x0004000000196A00 ||
-               title_id == 0x00040000001A6E00) {
-        // Armed Blue Gunvolt 2
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x0004000000149100) {
-        // Gravity Falls - Legend of the Gnome Gemulets
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x0004000000196900 || title_id == 0x0004000000119A00 ||
-               title_id == 0x000400000017C900 || title_id == 0x000400000017E100) {
-        // Shovel Knight
-        Settings::values.stream_buffer_hack = false;
     } else if (title_id == 0x000400000008FE00) {
         // 1001 Spikes
-        Settings::values.stream_buffer_hack = false;
         Settings::values.core_downcount_hack = true;
     } else if (title_id == 0x0004000000049100 || title_id == 0x0004000000030400 ||
                title_id == 0x0004000000049000) {
@@ -400,19 +396,61 @@ PerfStats::Results System::GetAndResetPerfStats() {
     return perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
 }
 
+void System::StopCoreThreads() {
+    if (core_threads && core_threads->IsRunningSlice()) {
+        core_threads->StopCores();
+    }
+}
+
+void System::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    if (core_threads && core_threads->IsRunningSlice()) {
+        core_threads->InvalidateCacheRange(start_address, length);
+        return;
+    }
+    for (const auto& cpu : cpu_cores) {
+        cpu->InvalidateCacheRange(start_address, length);
+    }
+}
+
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mode, u8 n3ds_mode) {
     LOG_DEBUG(HW_Memory, "initialized OK");
 
-    memory = std::make_unique<Memory::MemorySystem>();
+    // The 4 GiB arenas are only reserved when the CPU backend can use them
+    bool use_fastmem = false;
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+    if (Settings::values.use_cpu_jit && Settings::values.use_fastmem) {
+        if (!ARM_Dynarmic::SupportsFastmem()) {
+            LOG_WARNING(Core, "Fastmem is not supported by this version of dynarmic");
+        } else if (!Common::HostMemory::IsSupported()) {
+            LOG_WARNING(Core, "Fastmem is not supported on this host");
+        } else {
+            use_fastmem = true;
+        }
+    }
+#endif
+    LOG_INFO(Core, "Fastmem {}", use_fastmem ? "enabled" : "disabled");
+    memory = std::make_unique<Memory::MemorySystem>(use_fastmem);
     timing = std::make_unique<Timing>();
     kernel = std::make_unique<Kernel::KernelSystem>(*memory, *timing, system_mode, n3ds_mode);
 
     if (Settings::values.use_cpu_jit) {
 #if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+        if (Settings::values.use_cpu_threads) {
+            exclusive_monitor = ARM_Dynarmic::MakeExclusiveMonitor();
+            if (!exclusive_monitor) {
+                LOG_WARNING(Core, "CPU threads requested, but dynarmic has no global exclusive "
+                                  "monitor");
+            }
+        }
         for (u32 i = 0; i < 4; ++i) {
             cpu_cores[i] = std::make_shared<ARM_Dynarmic>(this, i, timing->GetTimer(i));
             kernel->GetThreadManager(i).SetCPU(cpu_cores[i].get());
         }
+        if (exclusive_monitor) {
+            LOG_INFO(Core, "Running the CPU cores on threads");
+            core_threads = std::make_unique<CoreThreads>(*this);
+            memory->SetHostPointerRemovalCallback([this] { StopCoreThreads(); });
+        }
 #else
         for (u32 i = 0; i < 4; ++i) {
             cpu_cores[i] = std::make_shared<ARM_DynCom>(this, i, timing->GetTimer(i));
@@ -445,6 +483,9 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
+    if (Settings::values.record_latency_stats) {
+        latency_stats = std::make_unique<HLE::LatencyStats>();
+    }
     rpc_server = std::make_unique<RPC::RPCServer>();
 
     service_manager = std::make_unique<Service::SM::ServiceManager>(*this);
@@ -561,7 +602,15 @@ void System::Shutdown() {
     cheat_engine.reset();
     archive_manager.reset();
     service_manager.reset();
+    core_threads.reset();
     cpu_cores = {};
+    exclusive_monitor.reset();
+    if (latency_stats) {
+        const std::string path =
+            FileUtil::GetUserPath(FileUtil::UserPath::LogDir) + "latency_stats.json";
+        FileUtil::WriteStringToFile(true, path, latency_stats->ToJson());
+        latency_stats.reset();
+    }
     dsp_core.reset();
     kernel.reset();
     timing.reset();
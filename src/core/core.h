@@ -51,9 +51,18 @@ namespace Cheats {
 class CheatEngine;
 }
 
+namespace HLE {
+class LatencyStats;
+}
+
+namespace Dynarmic {
+class ExclusiveMonitor;
+}
+
 namespace Core {
 
 class Timing;
+class CoreThreads;
 
 class System {
 public:
@@ -164,11 +173,11 @@ public:
         return static_cast<u32>(cpu_cores.size());
     }
 
-    void InvalidateCacheRange(u32 start_address, std::size_t length) {
-        for (const auto& cpu : cpu_cores) {
-            cpu->InvalidateCacheRange(start_address, length);
-        }
-    }
+    void InvalidateCacheRange(u32 start_address, std::size_t length);
+
+    /// Stops the cores running guest code on their threads until the end of the slice, for the
+    /// emulation thread to change how they access the memory while none of them is accessing it
+    void StopCoreThreads();
 
     /**
      * Gets a reference to the emulated DSP.
@@ -202,6 +211,11 @@ public:
     /// Gets a const reference to the kernel
     const Kernel::KernelSystem& Kernel() const;
 
+    /// Gets the exclusive monitor the JITs of the cores share when they run on threads, or null
+    Dynarmic::ExclusiveMonitor* GetExclusiveMonitor() const {
+        return exclusive_monitor.get();
+    }
+
     /// Gets a reference to the timing system
     Timing& CoreTiming();
 
@@ -220,6 +234,16 @@ public:
     /// Gets a const reference to the cheat engine
     const Cheats::CheatEngine& CheatEngine() const;
 
+    /// Gets the SVC and service command latency stats, or nullptr if they aren't recorded. They
+    /// are only kept while a title is running with Settings::values.record_latency_stats set.
+    HLE::LatencyStats* GetLatencyStats() {
+        return latency_stats.get();
+    }
+
+    const HLE::LatencyStats* GetLatencyStats() const {
+        return latency_stats.get();
+    }
+
     /// Gets a reference to the custom texture cache system
     Core::CustomTexCache& CustomTexCache();
 
@@ -290,6 +314,12 @@ private:
     /// ARM11 CPU core
     std::array<std::shared_ptr<ARM_Interface>, 4> cpu_cores;
 
+    /// Host threads running the cores in parallel, if enabled
+    std::unique_ptr<CoreThreads> core_threads;
+    /// Exclusive monitor of the cores running in parallel. Shared, so that it can be destroyed
+    /// without the dynarmic headers.
+    std::shared_ptr<Dynarmic::ExclusiveMonitor> exclusive_monitor;
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -312,6 +342,9 @@ private:
     /// Image interface
     std::shared_ptr<Frontend::ImageInterface> registered_image_interface;
 
+    /// Latency stats of the SVCs and service commands, dumped at shutdown
+    std::unique_ptr<HLE::LatencyStats> latency_stats;
+
     /// RPC Server for scripting support
     std::unique_ptr<RPC::RPCServer> rpc_server;
 
@@ -0,0 +1,202 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <fmt/format.h>
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_threads.h"
+#include "core/hle/kernel/kernel.h"
+
+namespace Core {
+
+/// Number of times a waiting thread checks for its condition before sleeping. Most SVCs are served
+/// quicker than the host takes to wake up a thread.
+constexpr u32 SPIN_ITERATIONS = 256;
+
+thread_local CoreThreads::Worker* CoreThreads::current_worker = nullptr;
+
+CoreThreads::CoreThreads(System& system) : system(system) {
+    for (u32 i = 0; i < system.GetNumCores(); ++i) {
+        auto& worker = workers.emplace_back(std::make_unique<Worker>());
+        worker->owner = this;
+        worker->core = &system.GetCore(i);
+        worker->thread = std::thread([this, &worker = *worker] { WorkerLoop(worker); });
+    }
+}
+
+CoreThreads::~CoreThreads() {
+    stop = true;
+    Notify(worker_condition);
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+bool CoreThreads::IsCoreThread() {
+    return current_worker != nullptr;
+}
+
+template <typename Predicate>
+void CoreThreads::Wait(std::condition_variable& condition, Predicate&& predicate) {
+    for (u32 i = 0; i < SPIN_ITERATIONS; ++i) {
+        if (predicate()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    std::unique_lock lock{mutex};
+    condition.wait(lock, predicate);
+}
+
+void CoreThreads::Notify(std::condition_variable& condition) {
+    // Taking the mutex orders the change of the condition before a waiter that checked it goes to
+    // sleep, so that it can't miss the notification
+    { std::lock_guard lock{mutex}; }
+    condition.notify_all();
+}
+
+void CoreThreads::Request(void (*function)(void*), void* argument) {
+    Worker& worker = *current_worker;
+    CoreThreads& core_threads = *worker.owner;
+
+    worker.request = function;
+    worker.request_argument = argument;
+    worker.request_done.store(false, std::memory_order_relaxed);
+    // The emulation thread sets it back before serving the request is done, so that StopCores
+    // sees the core running again as soon as it can be
+    worker.in_guest.store(false);
+    {
+        std::lock_guard lock{core_threads.mutex};
+        core_threads.requests.push_back(&worker);
+        core_threads.num_requests.fetch_add(1, std::memory_order_release);
+    }
+    core_threads.emu_condition.notify_one();
+
+    core_threads.Wait(core_threads.worker_condition, [&worker] {
+        return worker.request_done.load(std::memory_order_acquire);
+    });
+
+    // The core was stopped while waiting, and halts its JIT to end the slice once back in it
+    if (core_threads.stopping.load()) {
+        worker.core->PrepareReschedule();
+    }
+}
+
+void CoreThreads::WorkerLoop(Worker& worker) {
+    const std::string name = fmt::format("CpuCore{}", worker.core->GetID());
+    Common::SetCurrentThreadName(name.c_str());
+    MicroProfileOnThreadCreate(name.c_str());
+    current_worker = &worker;
+
+    u64 seen_slice = 0;
+    while (true) {
+        Wait(worker_condition, [this, &worker, seen_slice] {
+            return stop.load(std::memory_order_acquire) ||
+                   worker.slice.load(std::memory_order_acquire) != seen_slice;
+        });
+        if (stop) {
+            break;
+        }
+        seen_slice = worker.slice.load(std::memory_order_acquire);
+
+        // Either StopCores sees the core running, or the core sees it was stopped
+        worker.in_guest.store(true);
+        if (!stopping.load()) {
+            worker.core->Run();
+        }
+        worker.in_guest.store(false);
+
+        num_running.fetch_sub(1, std::memory_order_acq_rel);
+        Notify(emu_condition);
+    }
+}
+
+void CoreThreads::RunSlice() {
+    auto& kernel = system.Kernel();
+
+    // The kernel switches to each core like when running them one after the other, but only the
+    // cores with a thread to run are started
+    std::vector<Worker*> started;
+    for (auto& worker : workers) {
+        if (kernel.PrepareRun(worker->core)) {
+            started.push_back(worker.get());
+        }
+    }
+    if (started.empty()) {
+        return;
+    }
+
+    running_slice = true;
+    stopping.store(false);
+    num_running.store(static_cast<u32>(started.size()), std::memory_order_release);
+    for (Worker* worker : started) {
+        worker->slice.fetch_add(1, std::memory_order_release);
+    }
+    Notify(worker_condition);
+
+    // Serve the requests of the cores until they all stopped. A core that is waiting on a request
+    // can't stop, so there is none left once they did.
+    while (true) {
+        Wait(emu_condition, [this] {
+            return num_requests.load(std::memory_order_acquire) != 0 ||
+                   num_running.load(std::memory_order_acquire) == 0;
+        });
+
+        Worker* worker = nullptr;
+        {
+            std::lock_guard lock{mutex};
+            if (!requests.empty()) {
+                worker = requests.front();
+                requests.pop_front();
+                num_requests.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        if (worker == nullptr) {
+            break;
+        }
+
+        kernel.SetRunningCore(worker->core);
+        worker->request(worker->request_argument);
+        worker->in_guest.store(true);
+        worker->request_done.store(true, std::memory_order_release);
+        Notify(worker_condition);
+    }
+    running_slice = false;
+
+    // Leave the kernel on the last core, like running the cores one after the other does
+    kernel.SetRunningCore(workers.back()->core);
+
+    for (const auto& [start_address, length] : pending_invalidations) {
+        for (auto& worker : workers) {
+            worker->core->InvalidateCacheRange(start_address, length);
+        }
+    }
+    pending_invalidations.clear();
+}
+
+void CoreThreads::StopCores() {
+    ASSERT(running_slice);
+    stopping.store(true);
+
+    // Each core halts its own JIT, as it can't be halted safely from another thread. A core
+    // running guest code is stopped once it sends its next request or ends its slice.
+    Wait(emu_condition, [this] {
+        return std::none_of(workers.begin(), workers.end(),
+                            [](const auto& worker) { return worker->in_guest.load(); });
+    });
+}
+
+void CoreThreads::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    ASSERT(running_slice);
+    system.Kernel().GetRunningCore().InvalidateCacheRange(start_address, length);
+    pending_invalidations.emplace_back(start_address, length);
+}
+
+} // namespace Core
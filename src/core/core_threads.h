@@ -0,0 +1,132 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+class ARM_Interface;
+
+namespace Core {
+
+class System;
+
+/**
+ * Runs the CPU cores of a slice on host threads of their own. The guest code of the cores runs in
+ * parallel, while everything else they reach (SVCs, accesses to memory without a host pointer and
+ * reads of code to translate) is sent to the emulation thread, which serves one request at a time
+ * with the kernel switched to the core of the request. The rest of the emulator thus still only
+ * runs on the emulation thread.
+ */
+class CoreThreads {
+public:
+    explicit CoreThreads(System& system);
+    ~CoreThreads();
+
+    /// Runs the cores that have a thread to run until the end of the current slice, serving their
+    /// requests in the meantime
+    void RunSlice();
+
+    /// Whether the cores are running a slice on their threads
+    bool IsRunningSlice() const {
+        return running_slice;
+    }
+
+    /**
+     * Stops the cores that are running guest code and waits until they did, while serving a
+     * request. A core stops at its next request or at the end of its slice, and once its request
+     * is served it halts its own JIT to end the slice early, like when rescheduled.
+     */
+    void StopCores();
+
+    /// Invalidates the range in the JIT of the requesting core now, and in the ones of the other
+    /// cores once they stopped, as they can't be invalidated while running
+    void InvalidateCacheRange(u32 start_address, std::size_t length);
+
+    /// Whether the calling thread is a core thread
+    static bool IsCoreThread();
+
+    /// Runs the function on the emulation thread if called from a core thread, or right away
+    /// otherwise, and returns its result
+    template <typename Function>
+    static auto RunOnEmuThread(Function&& function) -> decltype(function()) {
+        if (!IsCoreThread()) {
+            return function();
+        }
+
+        using Result = decltype(function());
+        if constexpr (std::is_void_v<Result>) {
+            Request(&Call<Function>, &function);
+        } else {
+            Result result{};
+            auto call = [&function, &result] { result = function(); };
+            Request(&Call<decltype(call)>, &call);
+            return result;
+        }
+    }
+
+private:
+    struct Worker {
+        CoreThreads* owner = nullptr;
+        ARM_Interface* core = nullptr;
+        std::thread thread;
+        /// Incremented by the emulation thread to have the core run a slice
+        std::atomic<u64> slice{0};
+
+        /// Whether the core is running guest code, rather than waiting on a slice or a request
+        std::atomic<bool> in_guest{false};
+
+        void (*request)(void*) = nullptr;
+        void* request_argument = nullptr;
+        std::atomic<bool> request_done{false};
+    };
+
+    template <typename Function>
+    static void Call(void* function) {
+        (*static_cast<Function*>(function))();
+    }
+
+    /// Sends a request from the core thread to the emulation thread and waits until it is served
+    static void Request(void (*function)(void*), void* argument);
+
+    void WorkerLoop(Worker& worker);
+
+    /// Worker of the calling thread, if it is a core thread
+    static thread_local Worker* current_worker;
+
+    /// Spins for a bit until the predicate holds, then sleeps on the condition variable
+    template <typename Predicate>
+    void Wait(std::condition_variable& condition, Predicate&& predicate);
+    void Notify(std::condition_variable& condition);
+
+    System& system;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    bool running_slice = false;
+    std::atomic<u32> num_running{0};
+    std::atomic<bool> stop{false};
+    /// Set by StopCores to keep the cores that didn't start the slice yet from running it
+    std::atomic<bool> stopping{false};
+
+    std::mutex mutex;
+    std::condition_variable emu_condition;
+    std::condition_variable worker_condition;
+    std::deque<Worker*> requests;
+    std::atomic<std::size_t> num_requests{0};
+
+    /// Ranges to invalidate in all the cores once the slice ended
+    std::vector<std::pair<u32, std::size_t>> pending_invalidations;
+};
+
+} // namespace Core
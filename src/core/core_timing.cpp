@@ -4,22 +4,12 @@
 
 #include <algorithm>
 #include <cinttypes>
-#include <tuple>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core_timing.h"
 
 namespace Core {
 
-// Sort by time, unless the times are the same, in which case sort by the order added to the queue
-bool Timing::Event::operator>(const Timing::Event& right) const {
-    return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
-}
-
-bool Timing::Event::operator<(const Timing::Event& right) const {
-    return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
-}
-
 Timing::Timing() {
     for (u32 i = 0; i < timers.size(); ++i) {
         timers[i] = std::make_shared<Timer>();
@@ -53,9 +43,7 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
         if (!timer->is_timer_sane)
             timer->ForceExceptionCheck(cycles_into_future);
 
-        timer->event_queue.emplace_back(
-            Event{timeout, timer->event_fifo_id++, userdata, event_type});
-        std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+        timer->event_queue.Schedule(Event{timeout, timer->event_fifo_id++, userdata, event_type});
     } else {
         timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
                                    userdata, event_type});
@@ -64,29 +52,14 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.userdata == userdata; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->event_queue.Unschedule(event_type, userdata);
     }
     // TODO:remove events from ts_queue
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->event_queue.Remove(event_type);
     }
     // TODO:remove events from ts_queue
 }
@@ -152,15 +125,13 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 void Timing::Timer::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Schedule(ev);
     }
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
-        return next_event->time - executed_ticks;
+    if (!event_queue.IsEmpty()) {
+        return event_queue.NextTime() - executed_ticks;
     }
     return MAX_SLICE_LENGTH;
 }
@@ -175,19 +146,16 @@ void Timing::Timer::Advance(s64 max_slice_length) {
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    for (Event evt; event_queue.PopDue(executed_ticks, evt);) {
         evt.type->callback(evt.userdata, executed_ticks - evt.time);
     }
 
     is_timer_sane = false;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (!event_queue.IsEmpty()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+            std::min<s64>(event_queue.NextTime() - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length >> downcount_hack;
@@ -27,6 +27,7 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/threadsafe_queue.h"
+#include "core/timing_wheel.h"
 
 // The timing we get from the assembly is 268,111,855.956 Hz
 // It is possible that this number isn't just an integer because the compiler could have
@@ -127,15 +128,7 @@ struct TimingEventType {
 
 class Timing {
 public:
-    struct Event {
-        s64 time;
-        u64 fifo_order;
-        u64 userdata;
-        const TimingEventType* type;
-
-        bool operator>(const Event& right) const;
-        bool operator<(const Event& right) const;
-    };
+    using Event = TimingEvent;
 
     static constexpr int MAX_SLICE_LENGTH = 20000;
 
@@ -165,11 +158,9 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accomodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+        // The queue is a timing wheel, so that events can be scheduled and erased (RemoveEvent())
+        // in constant time, regardless of the number of events in the queue.
+        TimingWheel event_queue;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
         // to the event_queue by the emu thread
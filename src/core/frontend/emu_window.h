@@ -12,6 +12,18 @@
 
 namespace Frontend {
 
+/// A graphics context that can be made current on a thread
+class GraphicsContext {
+public:
+    virtual ~GraphicsContext();
+
+    /// Makes the graphics context current for the caller thread
+    virtual void MakeCurrent() = 0;
+
+    /// Releases the context from the caller thread
+    virtual void DoneCurrent() = 0;
+};
+
 /**
  * Abstraction class used to provide an interface between emulation code and the frontend
  * (e.g. SDL, QGLWidget, GLFW, etc...).
@@ -30,20 +42,23 @@ namespace Frontend {
  * - DO NOT TREAT THIS CLASS AS A GUI TOOLKIT ABSTRACTION LAYER. That's not what it is. Please
  *   re-read the upper points again and think about it if you don't see this.
  */
-class EmuWindow {
+class EmuWindow : public GraphicsContext {
 public:
     /// Polls window events
     virtual void PollEvents() = 0;
 
-    /// Makes the graphics context current for the caller thread
-    virtual void MakeCurrent() = 0;
-
-    /// Releases (dunno if this is the "right" word) the context from the caller thread
-    virtual void DoneCurrent() = 0;
-
     /// Swap buffers to display the next frame
     virtual void SwapBuffers() = 0;
 
+    /**
+     * Creates a graphics context that shares its objects with the one of the window, for the
+     * worker threads of the video core.
+     * @returns The context, or nullptr if the frontend can't create one
+     */
+    virtual std::unique_ptr<GraphicsContext> CreateSharedContext() const {
+        return nullptr;
+    }
+
     /**
      * Signal that a touch pressed event has occurred (e.g. mouse click pressed)
      * @param framebuffer_x Framebuffer x-coordinate that was pressed
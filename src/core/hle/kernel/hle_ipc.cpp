@@ -41,6 +41,13 @@ public:
         // Copy the translated command buffer back into the thread's command buffer area.
         memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
                           cmd_buff.size() * sizeof(u32));
+
+        // The request is done unless the callback put the thread to sleep again, its session and
+        // objects are released and the thread gets the context back for its next request
+        if (thread->status != ThreadStatus::WaitHleEvent && context.use_count() == 1) {
+            context->Reset(nullptr);
+            thread->hle_request_context = std::move(context);
+        }
     }
 
 private:
@@ -91,6 +98,16 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(std::shared_ptr<ServerSession> session) {
+    this->session = std::move(session);
+    cmd_buf[0] = 0;
+    request_handles.clear();
+    request_mapped_buffers.clear();
+    for (auto& buffer : static_buffers) {
+        buffer.clear();
+    }
+}
+
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
     return request_handles[id_from_cmdbuf];
@@ -163,11 +180,11 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into our own vector, reusing its memory from earlier requests.
+            std::vector<u8>& data = static_buffers[buffer_info.buffer_id];
+            data.resize(buffer_info.size);
             kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
 
-            AddStaticBuffer(buffer_info.buffer_id, std::move(data));
             cmd_buf[i++] = source_address;
             break;
         }
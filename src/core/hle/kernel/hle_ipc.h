@@ -161,6 +161,13 @@ public:
     HLERequestContext(KernelSystem& kernel, std::shared_ptr<ServerSession> session, Thread* thread);
     ~HLERequestContext();
 
+    /**
+     * Releases the objects of the previous request and sets the session of the next one. The
+     * memory of the static buffers is kept, so that a thread can reuse its context for each of its
+     * requests without allocating.
+     */
+    void Reset(std::shared_ptr<ServerSession> session);
+
     /// Returns a pointer to the IPC command buffer for this request.
     u32* CommandBuffer() {
         return cmd_buf.data();
@@ -86,7 +86,7 @@ void KernelSystem::Advance(ARM_Interface* cpu, s64 max_slice_length) {
     current_cpu = previous_cpu;
 }
 
-void KernelSystem::Run(ARM_Interface* cpu) {
+void KernelSystem::SetRunningCore(ARM_Interface* cpu) {
     const u32 new_cpu_id = cpu->GetID();
     const u32 old_cpu_id = current_cpu->GetID();
     current_cpu = cpu;
@@ -99,14 +99,25 @@ void KernelSystem::Run(ARM_Interface* cpu) {
     }
 
     timing.SetCurrentTimer(new_cpu_id);
+}
+
+bool KernelSystem::PrepareRun(ARM_Interface* cpu) {
+    SetRunningCore(cpu);
 
     // If we don't have a currently active thread then don't execute instructions,
     // instead advance to the next event and try to yield to the next thread
-    if (thread_managers[new_cpu_id]->GetCurrentThread() == nullptr) {
-        LOG_TRACE(Core_ARM11, "Core {} idling", new_cpu_id);
+    const u32 cpu_id = cpu->GetID();
+    if (thread_managers[cpu_id]->GetCurrentThread() == nullptr) {
+        LOG_TRACE(Core_ARM11, "Core {} idling", cpu_id);
         current_cpu->GetTimer().Idle();
-        thread_managers[new_cpu_id]->PrepareReschedule();
-    } else {
+        thread_managers[cpu_id]->PrepareReschedule();
+        return false;
+    }
+    return true;
+}
+
+void KernelSystem::Run(ARM_Interface* cpu) {
+    if (PrepareRun(cpu)) {
         current_cpu->Run();
     }
 }
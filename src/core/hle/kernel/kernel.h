@@ -215,6 +215,16 @@ public:
     void SetCurrentProcessForCPU(const std::shared_ptr<Process>& process, u32 core_id);
 
     void Advance(ARM_Interface* cpu, s64 max_slice_length);
+
+    /// Switches the kernel to the core, making its process and timer the current ones
+    void SetRunningCore(ARM_Interface* cpu);
+
+    /**
+     * Switches the kernel to the core to run it.
+     * @returns Whether the core has a thread to run, the core idles until the next event otherwise
+     */
+    bool PrepareRun(ARM_Interface* cpu);
+
     void Run(ARM_Interface* cpu);
 
     ThreadManager& GetThreadManager(u32 core_id);
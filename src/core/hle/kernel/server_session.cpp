@@ -72,8 +72,15 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
         kernel.memory.ReadBlock(*current_process, thread->GetCommandBufferAddress(), cmd_buf.data(),
                                 cmd_buf.size() * sizeof(u32));
 
-        auto context =
-            std::make_shared<Kernel::HLERequestContext>(kernel, SharedFrom(this), thread.get());
+        // The context of the previous request of the thread is reused, unless something else
+        // still holds it.
+        auto& context = thread->hle_request_context;
+        if (context != nullptr && context.use_count() == 1) {
+            context->Reset(SharedFrom(this));
+        } else {
+            context =
+                std::make_shared<Kernel::HLERequestContext>(kernel, SharedFrom(this), thread.get());
+        }
         context->PopulateFromIncomingCommandBuffer(cmd_buf.data(), *current_process);
 
         hle_handler->HandleSyncRequest(*context);
@@ -88,6 +95,14 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
             kernel.memory.WriteBlock(*current_process, thread->GetCommandBufferAddress(),
                                      cmd_buf.data(), cmd_buf.size() * sizeof(u32));
         }
+
+        if (thread->status == Kernel::ThreadStatus::WaitHleEvent) {
+            // The wakeup callback owns the context while the request sleeps, and releases it
+            context.reset();
+        } else if (context.use_count() == 1) {
+            // Don't keep the session and the objects of the request alive until the next request
+            context->Reset(nullptr);
+        }
     }
 
     if (thread->status == ThreadStatus::Running) {
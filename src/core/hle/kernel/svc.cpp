@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <map>
 #include <fmt/format.h>
@@ -35,6 +36,7 @@
 #include "core/hle/kernel/timer.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/hle/kernel/wait_object.h"
+#include "core/hle/latency_stats.h"
 #include "core/hle/lock.h"
 #include "core/hle/result.h"
 #include "core/hle/service/service.h"
@@ -183,6 +185,8 @@ private:
     };
 
     static const FunctionDef SVC_Table[];
+
+    friend const char* GetSVCName(u32 immediate);
 };
 
 /// Map application or GSP heap memory
@@ -525,9 +529,13 @@ ResultCode SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle
             std::all_of(objects.begin(), objects.end(),
                         [thread](const ObjectPtr& object) { return !object->ShouldWait(thread); });
         if (all_available) {
-            // We can acquire all objects right now, do so.
-            for (auto& object : objects)
-                object->Acquire(thread);
+            // We can acquire all objects right now, do so. An object passed more than once is
+            // only acquired once.
+            for (auto itr = objects.begin(); itr != objects.end(); ++itr) {
+                if (std::find(objects.begin(), itr, *itr) == itr) {
+                    (*itr)->Acquire(thread);
+                }
+            }
             // Note: In this case, the `out` parameter is not set,
             // and retains whatever value it had before.
             return RESULT_SUCCESS;
@@ -633,6 +641,7 @@ static ResultCode ReceiveIPCRequest(Kernel::KernelSystem& kernel, Memory::Memory
 
         server_session->currently_handling->ResumeFromWait();
         server_session->currently_handling = nullptr;
+        server_session->NotifyAvailable();
 
         // TODO(Subv): This path should try to wait again on the same objects.
         ASSERT_MSG(false, "ReplyAndReceive translation error behavior unimplemented");
@@ -676,8 +685,10 @@ ResultCode SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_co
 
         auto request_thread = std::move(session->currently_handling);
 
-        // Mark the request as "handled".
+        // Mark the request as "handled". The session is available again if more requests are
+        // pending.
         session->currently_handling = nullptr;
+        session->NotifyAvailable();
 
         // Error out if there's no request thread or the session was closed.
         // TODO(Subv): Is the same error code (ClosedByRemote) returned for both of these cases?
@@ -1598,12 +1609,25 @@ const SVC::FunctionDef SVC::SVC_Table[] = {
     {0x7D, &SVC::Wrap<&SVC::QueryProcessMemory>, "QueryProcessMemory"},
 };
 
+const char* GetSVCName(u32 immediate) {
+    if (immediate >= ARRAY_SIZE(SVC::SVC_Table)) {
+        return nullptr;
+    }
+    return SVC::SVC_Table[immediate].name;
+}
+
 MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
 
 void SVC::CallSVC(u32 immediate) {
     // Lock the global kernel mutex when we enter the kernel HLE.
     std::lock_guard lock{HLE::g_hle_lock};
 
+    HLE::LatencyStats* const latency_stats = system.GetLatencyStats();
+    std::chrono::steady_clock::time_point start;
+    if (latency_stats) {
+        start = std::chrono::steady_clock::now();
+    }
+
     DEBUG_ASSERT_MSG(kernel.GetCurrentProcess()->status == ProcessStatus::Running,
                      "Running threads from exiting processes is unimplemented");
 
@@ -1617,6 +1641,10 @@ void SVC::CallSVC(u32 immediate) {
     } else {
         LOG_ERROR(Kernel_SVC, "unknown svc=0x{:02X}", immediate);
     }
+
+    if (latency_stats) {
+        latency_stats->RecordSVC(immediate, std::chrono::steady_clock::now() - start);
+    }
 }
 
 SVC::SVC(Core::System& system) : system(system), kernel(system.Kernel()), memory(system.Memory()) {}
@@ -15,6 +15,9 @@ namespace Kernel {
 
 class SVC;
 
+/// Gets the name of the SVC with the given immediate, or nullptr if there is none
+const char* GetSVCName(u32 immediate);
+
 class SVCContext {
 public:
     SVCContext(Core::System& system);
@@ -280,7 +280,6 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(std::string name,
     auto thread{std::make_shared<Thread>(*this, processor_id)};
 
     thread_managers[processor_id]->thread_list.push_back(thread);
-    thread_managers[processor_id]->ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = ThreadStatus::Dormant;
@@ -346,10 +345,11 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
 
+    const bool changed = current_priority != priority;
     nominal_priority = current_priority = priority;
+    if (changed)
+        UpdateWaitListPlaces();
 }
 
 void Thread::UpdatePriority() {
@@ -365,9 +365,17 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
+    const bool changed = current_priority != priority;
     current_priority = priority;
+    if (changed)
+        UpdateWaitListPlaces();
+}
+
+void Thread::UpdateWaitListPlaces() {
+    for (std::size_t i = 0; i < num_wait_list_nodes; ++i) {
+        WaitListNode& node = *wait_list_nodes[i];
+        node.object->UpdateWaitingThreadPriority(node);
+    }
 }
 
 void SetupMainThread(KernelSystem& kernel, u32 entry_point, u32 priority, Process& owner_process) {
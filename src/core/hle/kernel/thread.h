@@ -19,6 +19,7 @@
 
 namespace Kernel {
 
+class HLERequestContext;
 class Mutex;
 class Process;
 
@@ -285,6 +286,14 @@ public:
     // passed to WaitSynchronization1/N.
     std::vector<std::shared_ptr<WaitObject>> wait_objects;
 
+    /// Entries of the thread in the waiting lists of its wait objects. The first
+    /// num_wait_list_nodes are in use, the others are kept to be reused by the next waits.
+    std::vector<std::unique_ptr<WaitListNode>> wait_list_nodes;
+    std::size_t num_wait_list_nodes = 0;
+
+    /// Number of the objects of a WaitSynchAll wait that haven't been available since it started
+    u32 remaining_wait_objects = 0;
+
     VAddr wait_address; ///< If waiting on an AddressArbiter, this is the arbitration address
 
     std::string name;
@@ -294,7 +303,16 @@ public:
     // available. In case of a timeout, the object will be nullptr.
     std::shared_ptr<WakeupCallback> wakeup_callback;
 
+    /// Context of the last request of the thread to an HLE service, reused by the next one
+    std::shared_ptr<HLERequestContext> hle_request_context;
+
+    /// Links of the thread in the ready queue of its ThreadManager
+    Common::ThreadQueueLinks<Thread*> queue_links;
+
 private:
+    /// Moves the thread in the waiting lists it is in after its priority changed
+    void UpdateWaitListPlaces();
+
     ThreadManager& thread_manager;
 };
 
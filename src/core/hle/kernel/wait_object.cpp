@@ -17,64 +17,123 @@
 namespace Kernel {
 
 void WaitObject::AddWaitingThread(const std::shared_ptr<Thread>& thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(thread);
+    auto& nodes = thread->wait_list_nodes;
+    const auto used_end = nodes.begin() + thread->num_wait_list_nodes;
+    if (std::any_of(nodes.begin(), used_end,
+                    [this](const auto& node) { return node->object == this; })) {
+        return;
+    }
+
+    if (thread->num_wait_list_nodes == nodes.size()) {
+        nodes.push_back(std::make_unique<WaitListNode>());
+    }
+    WaitListNode& node = *nodes[thread->num_wait_list_nodes++];
+    node.thread = thread;
+    node.object = this;
+    Link(node);
+
+    if (thread->status == ThreadStatus::WaitSynchAll && ShouldWait(thread.get())) {
+        node.pending = true;
+        node.pending_prev = nullptr;
+        node.pending_next = pending_head;
+        if (pending_head != nullptr) {
+            pending_head->pending_prev = &node;
+        }
+        pending_head = &node;
+        ++thread->remaining_wait_objects;
+    }
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
-    auto itr = std::find_if(waiting_threads.begin(), waiting_threads.end(),
-                            [thread](const auto& p) { return p.get() == thread; });
+    auto& nodes = thread->wait_list_nodes;
+    const auto used_end = nodes.begin() + thread->num_wait_list_nodes;
+    const auto itr = std::find_if(nodes.begin(), used_end,
+                                  [this](const auto& node) { return node->object == this; });
     // If a thread passed multiple handles to the same object,
     // the kernel might attempt to remove the thread from the object's
     // waiting threads list multiple times.
-    if (itr != waiting_threads.end())
-        waiting_threads.erase(itr);
+    if (itr == used_end)
+        return;
+
+    WaitListNode& node = **itr;
+    // The node can hold the last reference to the thread, so it is released last
+    const std::shared_ptr<Thread> reference = std::move(node.thread);
+
+    Unlink(node);
+    if (node.pending) {
+        (node.pending_prev != nullptr ? node.pending_prev->pending_next : pending_head) =
+            node.pending_next;
+        if (node.pending_next != nullptr) {
+            node.pending_next->pending_prev = node.pending_prev;
+        }
+        node.pending = false;
+        --thread->remaining_wait_objects;
+    }
+    node.object = nullptr;
+
+    // Keep the nodes in use at the front, to be reused by the next waits
+    std::iter_swap(itr, used_end - 1);
+    --thread->num_wait_list_nodes;
+}
+
+void WaitObject::NotifyAvailable() {
+    for (WaitListNode* node = pending_head; node != nullptr; node = node->pending_next) {
+        node->pending = false;
+        --node->thread->remaining_wait_objects;
+    }
+    pending_head = nullptr;
 }
 
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
-    Thread* candidate = nullptr;
-    u32 candidate_priority = ThreadPrioLowest + 1;
+    for (const WaitListNode* node = waiting_head; node != nullptr; node = node->next) {
+        Thread* thread = node->thread.get();
 
-    for (const auto& thread : waiting_threads) {
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
                        thread->status == ThreadStatus::WaitSynchAll ||
                        thread->status == ThreadStatus::WaitHleEvent,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->current_priority >= candidate_priority)
-            continue;
-
-        if (ShouldWait(thread.get()))
-            continue;
+        // Whether the object is available doesn't depend on the waiting thread: only a mutex
+        // tells its holder apart, and it is only signaled once nobody holds it.
+        if (ShouldWait(thread))
+            break;
 
         // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
         // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
-        bool ready_to_run = true;
+        // The objects that weren't available since it started to wait can't be ready yet.
         if (thread->status == ThreadStatus::WaitSynchAll) {
-            ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const std::shared_ptr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
-                                        });
+            if (thread->remaining_wait_objects != 0)
+                continue;
+
+            const bool ready_to_run =
+                std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
+                             [thread](const std::shared_ptr<WaitObject>& object) {
+                                 return object->ShouldWait(thread);
+                             });
+            if (!ready_to_run)
+                continue;
         }
 
-        if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->current_priority;
-        }
+        return node->thread;
     }
 
-    return SharedFrom(candidate);
+    return nullptr;
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
+    NotifyAvailable();
+
     while (auto thread = GetHighestPriorityReadyThread()) {
         if (!thread->IsSleepingOnWaitAll()) {
             Acquire(thread.get());
         } else {
-            for (auto& object : thread->wait_objects) {
-                object->Acquire(thread.get());
+            // An object passed more than once is only acquired once
+            const auto& objects = thread->wait_objects;
+            for (auto itr = objects.begin(); itr != objects.end(); ++itr) {
+                if (std::find(objects.begin(), itr, *itr) == itr) {
+                    (*itr)->Acquire(thread.get());
+                }
             }
         }
 
@@ -93,8 +152,45 @@ void WaitObject::WakeupAllWaitingThreads() {
         hle_notifier();
 }
 
-const std::vector<std::shared_ptr<Thread>>& WaitObject::GetWaitingThreads() const {
-    return waiting_threads;
+u32 WaitObject::GetHighestWaitingPriority() const {
+    if (waiting_head == nullptr) {
+        return ThreadPrioLowest;
+    }
+    return std::min<u32>(waiting_head->thread->current_priority, ThreadPrioLowest);
+}
+
+void WaitObject::UpdateWaitingThreadPriority(WaitListNode& node) {
+    Unlink(node);
+    Link(node);
+}
+
+std::vector<std::shared_ptr<Thread>> WaitObject::GetWaitingThreads() const {
+    std::vector<std::shared_ptr<Thread>> threads;
+    for (const WaitListNode* node = waiting_head; node != nullptr; node = node->next) {
+        threads.push_back(node->thread);
+    }
+    return threads;
+}
+
+void WaitObject::Link(WaitListNode& node) {
+    // Threads mostly wait with the same priority, so the place is looked for from the end
+    const u32 priority = node.thread->current_priority;
+    WaitListNode* prev = waiting_tail;
+    while (prev != nullptr && prev->thread->current_priority > priority) {
+        prev = prev->prev;
+    }
+
+    node.prev = prev;
+    node.next = prev != nullptr ? prev->next : waiting_head;
+    (prev != nullptr ? prev->next : waiting_head) = &node;
+    (node.next != nullptr ? node.next->prev : waiting_tail) = &node;
+}
+
+void WaitObject::Unlink(WaitListNode& node) {
+    (node.prev != nullptr ? node.prev->next : waiting_head) = node.next;
+    (node.next != nullptr ? node.next->prev : waiting_tail) = node.prev;
+    node.prev = nullptr;
+    node.next = nullptr;
 }
 
 void WaitObject::SetHLENotifier(std::function<void()> callback) {
@@ -13,8 +13,27 @@
 namespace Kernel {
 
 class Thread;
+class WaitObject;
+
+/// Entry of a thread in the waiting list of one of the objects it waits for
+struct WaitListNode {
+    std::shared_ptr<Thread> thread;
+    WaitObject* object = nullptr;
+    WaitListNode* prev = nullptr;
+    WaitListNode* next = nullptr;
+
+    /// Whether the thread waits for all its objects and this one hasn't been available since
+    bool pending = false;
+    WaitListNode* pending_prev = nullptr;
+    WaitListNode* pending_next = nullptr;
+};
 
-/// Class that represents a Kernel object that a thread can be waiting on
+/**
+ * Class that represents a Kernel object that a thread can be waiting on. The waiting threads are
+ * linked in priority order, and a thread waiting for all its objects counts the ones that haven't
+ * been available since it started to wait, so waking threads up only looks at the threads it can
+ * wake up.
+ */
 class WaitObject : public Object {
 public:
     using Object::Object;
@@ -47,18 +66,39 @@ public:
      */
     virtual void WakeupAllWaitingThreads();
 
+    /**
+     * Records that the object may have become available for the threads waiting for all their
+     * objects, without waking any up. WakeupAllWaitingThreads does it too, objects that become
+     * available without calling it have to call this instead.
+     */
+    void NotifyAvailable();
+
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     std::shared_ptr<Thread> GetHighestPriorityReadyThread() const;
 
-    /// Get a const reference to the waiting threads list for debug use
-    const std::vector<std::shared_ptr<Thread>>& GetWaitingThreads() const;
+    /// Gets the priority of the best waiting thread, or ThreadPrioLowest if there is none
+    u32 GetHighestWaitingPriority() const;
+
+    /// Moves a waiting thread to the place of its new priority in the waiting list
+    void UpdateWaitingThreadPriority(WaitListNode& node);
+
+    /// Get the waiting threads in priority order for debug use
+    std::vector<std::shared_ptr<Thread>> GetWaitingThreads() const;
 
     /// Sets a callback which is called when the object becomes available
     void SetHLENotifier(std::function<void()> callback);
 
 private:
-    /// Threads waiting for this object to become available
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    void Link(WaitListNode& node);
+    void Unlink(WaitListNode& node);
+
+    /// Threads waiting for this object to become available, by priority then in waiting order
+    WaitListNode* waiting_head = nullptr;
+    WaitListNode* waiting_tail = nullptr;
+
+    /// Nodes of the threads waiting for all their objects that this object hasn't been available
+    /// for since they started to wait
+    WaitListNode* pending_head = nullptr;
 
     /// Function to call when this object becomes available
     std::function<void()> hle_notifier;
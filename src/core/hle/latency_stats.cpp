@@ -0,0 +1,153 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "common/string_util.h"
+#include "core/hle/kernel/svc.h"
+#include "core/hle/latency_stats.h"
+
+namespace HLE {
+
+static std::atomic<u64> next_id{1};
+
+namespace {
+/// Slots last used by the thread, valid while the instance with the id is alive
+struct CachedSlots {
+    u64 owner_id = 0;
+    void* slots = nullptr;
+};
+thread_local CachedSlots cached_slots;
+} // namespace
+
+static std::size_t BucketIndex(u64 ns) {
+    std::size_t bucket = 0;
+    while (ns > 1 && bucket < LatencyStats::NUM_BUCKETS - 1) {
+        ns >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Only the owning thread writes an entry, so plain loads and stores are enough to not lose counts
+static void Increment(std::atomic<u64>& value, u64 amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void LatencyStats::Entry::Record(std::chrono::nanoseconds duration) {
+    const u64 ns = static_cast<u64>(std::max<s64>(duration.count(), 0));
+    Increment(count, 1);
+    Increment(total_ns, ns);
+    if (ns > max_ns.load(std::memory_order_relaxed)) {
+        max_ns.store(ns, std::memory_order_relaxed);
+    }
+    Increment(buckets[BucketIndex(ns)], 1);
+}
+
+void LatencyStats::Entry::AddTo(Histogram& histogram) const {
+    histogram.count += count.load(std::memory_order_relaxed);
+    histogram.total_ns += total_ns.load(std::memory_order_relaxed);
+    histogram.max_ns = std::max(histogram.max_ns, max_ns.load(std::memory_order_relaxed));
+    for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+        histogram.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+}
+
+LatencyStats::LatencyStats() : id(next_id++) {}
+LatencyStats::~LatencyStats() = default;
+
+LatencyStats::Slots& LatencyStats::ThreadSlots() {
+    if (cached_slots.owner_id == id) {
+        return *static_cast<Slots*>(cached_slots.slots);
+    }
+
+    std::lock_guard lock{mutex};
+    auto& slots = thread_slots.emplace_back(std::make_unique<Slots>());
+    cached_slots = {id, slots.get()};
+    return *slots;
+}
+
+void LatencyStats::RecordSVC(u32 immediate, std::chrono::nanoseconds duration) {
+    if (immediate < MAX_SVCS) {
+        ThreadSlots().svcs[immediate].Record(duration);
+    }
+}
+
+u32 LatencyStats::RegisterCommand(const std::string& service_name, u32 header, const char* name) {
+    std::lock_guard lock{mutex};
+    if (commands.size() >= MAX_COMMANDS) {
+        return NO_COMMAND;
+    }
+    commands.push_back({service_name, header, name != nullptr ? name : ""});
+    return static_cast<u32>(commands.size() - 1);
+}
+
+void LatencyStats::RecordCommand(u32 index, std::chrono::nanoseconds duration) {
+    if (index < MAX_COMMANDS) {
+        ThreadSlots().commands[index].Record(duration);
+    }
+}
+
+LatencyStats::Histogram LatencyStats::GetSVC(u32 immediate) const {
+    Histogram histogram;
+    std::lock_guard lock{mutex};
+    for (const auto& slots : thread_slots) {
+        slots->svcs[immediate].AddTo(histogram);
+    }
+    return histogram;
+}
+
+LatencyStats::Histogram LatencyStats::GetCommand(u32 index) const {
+    Histogram histogram;
+    std::lock_guard lock{mutex};
+    for (const auto& slots : thread_slots) {
+        slots->commands[index].AddTo(histogram);
+    }
+    return histogram;
+}
+
+static std::string HistogramToJson(const LatencyStats::Histogram& histogram) {
+    return fmt::format("\"count\": {}, \"total_ns\": {}, \"max_ns\": {}, \"buckets\": [{}]",
+                       histogram.count, histogram.total_ns, histogram.max_ns,
+                       fmt::join(histogram.buckets.begin(), histogram.buckets.end(), ", "));
+}
+
+std::string LatencyStats::ToJson() const {
+    std::string svcs;
+    for (u32 immediate = 0; immediate < MAX_SVCS; ++immediate) {
+        const Histogram histogram = GetSVC(immediate);
+        if (histogram.count == 0) {
+            continue;
+        }
+        const char* name = Kernel::GetSVCName(immediate);
+        svcs += fmt::format("{}\n    {{\"id\": {}, \"name\": \"{}\", {}}}",
+                            svcs.empty() ? "" : ",", immediate, name != nullptr ? name : "",
+                            HistogramToJson(histogram));
+    }
+
+    std::vector<Command> registered_commands;
+    {
+        std::lock_guard lock{mutex};
+        registered_commands = commands;
+    }
+
+    std::string service_commands;
+    for (u32 index = 0; index < registered_commands.size(); ++index) {
+        const Histogram histogram = GetCommand(index);
+        if (histogram.count == 0) {
+            continue;
+        }
+        const Command& command = registered_commands[index];
+        service_commands += fmt::format(
+            "{}\n    {{\"service\": \"{}\", \"header\": {}, \"name\": \"{}\", {}}}",
+            service_commands.empty() ? "" : ",", Common::EscapeJson(command.service_name), command.header,
+            Common::EscapeJson(command.name), HistogramToJson(histogram));
+    }
+
+    return fmt::format("{{\n  \"bucket_bounds_ns\": \"[2^i, 2^(i+1))\",\n  \"svcs\": [{}\n  ],\n"
+                       "  \"service_commands\": [{}\n  ]\n}}\n",
+                       svcs, service_commands);
+}
+
+} // namespace HLE
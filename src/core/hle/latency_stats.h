@@ -0,0 +1,98 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace HLE {
+
+/**
+ * Counts the calls of each SVC and of each HLE service command, with a histogram of how long they
+ * took. Each host thread records into slots of its own, so recording takes no lock and no atomic
+ * read-modify-write, and the slots of all the threads are only summed up when the stats are read.
+ */
+class LatencyStats {
+public:
+    /// Bucket i counts the calls that took [2^i, 2^(i+1)) ns, the first one also 0 ns and the last
+    /// one all the longer calls
+    static constexpr std::size_t NUM_BUCKETS = 32;
+    static constexpr u32 MAX_SVCS = 0x80;
+    /// Service commands get an index when they are first called, the later ones aren't counted
+    static constexpr u32 MAX_COMMANDS = 1024;
+    static constexpr u32 NO_COMMAND = 0xFFFFFFFF;
+
+    struct Histogram {
+        u64 count = 0;
+        u64 total_ns = 0;
+        u64 max_ns = 0;
+        std::array<u64, NUM_BUCKETS> buckets{};
+    };
+
+    LatencyStats();
+    ~LatencyStats();
+
+    /// Records a call of the SVC with the given immediate
+    void RecordSVC(u32 immediate, std::chrono::nanoseconds duration);
+
+    /**
+     * Gives an index to a service command, to record its calls with.
+     * @returns The index, or NO_COMMAND if there are already MAX_COMMANDS commands
+     */
+    u32 RegisterCommand(const std::string& service_name, u32 header, const char* name);
+
+    /// Records a call of the service command with the given index, if it has one
+    void RecordCommand(u32 index, std::chrono::nanoseconds duration);
+
+    /// Gets the calls of an SVC summed up over all the threads
+    Histogram GetSVC(u32 immediate) const;
+
+    /// Gets the calls of a service command summed up over all the threads
+    Histogram GetCommand(u32 index) const;
+
+    /// Serializes the SVCs and the service commands that were called to JSON
+    std::string ToJson() const;
+
+private:
+    /// Histogram written by a single thread, that other threads can read at any time
+    struct Entry {
+        std::atomic<u64> count{};
+        std::atomic<u64> total_ns{};
+        std::atomic<u64> max_ns{};
+        std::array<std::atomic<u64>, NUM_BUCKETS> buckets{};
+
+        void Record(std::chrono::nanoseconds duration);
+        void AddTo(Histogram& histogram) const;
+    };
+
+    struct Slots {
+        std::array<Entry, MAX_SVCS> svcs;
+        std::array<Entry, MAX_COMMANDS> commands;
+    };
+
+    struct Command {
+        std::string service_name;
+        u32 header;
+        std::string name;
+    };
+
+    /// Gets the slots of the calling thread, creating them on its first call
+    Slots& ThreadSlots();
+
+    /// Identifies the instance in the slots cached by the threads, as its address can be reused
+    const u64 id;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Slots>> thread_slots;
+    std::vector<Command> commands;
+};
+
+} // namespace HLE
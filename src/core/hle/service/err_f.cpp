@@ -244,7 +244,7 @@ ERR_F::ERR_F(Core::System& system) : ServiceFramework("err:f", 1), system(system
 ERR_F::~ERR_F() = default;
 
 void InstallInterfaces(Core::System& system) {
-    std::make_shared<ERR_F>(system)->InstallAsNamedPort(system.Kernel());
+    std::make_shared<ERR_F>(system)->InstallAsNamedPort(system.Kernel(), system.GetLatencyStats());
 }
 
 } // namespace Service::ERR
@@ -20,7 +20,7 @@ HBLDR::HBLDR() : ServiceFramework("hb:ldr") {
 }
 
 void InstallInterfaces(Core::System& system) {
-    std::make_shared<HBLDR>()->InstallAsNamedPort(system.Kernel());
+    std::make_shared<HBLDR>()->InstallAsNamedPort(system.Kernel(), system.GetLatencyStats());
 }
 
 } // namespace Service::NDM
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -13,6 +14,7 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/latency_stats.h"
 #include "core/hle/service/ac/ac.h"
 #include "core/hle/service/act/act.h"
 #include "core/hle/service/am/am.h"
@@ -132,9 +134,12 @@ ServiceFrameworkBase::~ServiceFrameworkBase() = default;
 void ServiceFrameworkBase::InstallAsService(SM::ServiceManager& service_manager) {
     auto port = service_manager.RegisterService(service_name, max_sessions).Unwrap();
     port->SetHleHandler(shared_from_this());
+    latency_stats = service_manager.GetLatencyStats();
 }
 
-void ServiceFrameworkBase::InstallAsNamedPort(Kernel::KernelSystem& kernel) {
+void ServiceFrameworkBase::InstallAsNamedPort(Kernel::KernelSystem& kernel,
+                                              HLE::LatencyStats* latency_stats) {
+    this->latency_stats = latency_stats;
     auto [server_port, client_port] = kernel.CreatePortPair(max_sessions, service_name);
     server_port->SetHleHandler(shared_from_this());
     kernel.AddNamedPort(service_name, std::move(client_port));
@@ -172,7 +177,7 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
 void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
     u32 header_code = context.CommandBuffer()[0];
     auto itr = handlers.find(header_code);
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
     if (info == nullptr || info->handler_callback == nullptr) {
         context.ReportUnimplemented();
         return ReportUnimplementedFunction(context.CommandBuffer(), info);
@@ -180,7 +185,21 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+
+    if (!latency_stats) {
+        handler_invoker(this, info->handler_callback, context);
+        return;
+    }
+
+    if (!info->latency_stats_index) {
+        info->latency_stats_index =
+            latency_stats->RegisterCommand(service_name, info->expected_header, info->name);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
     handler_invoker(this, info->handler_callback, context);
+    latency_stats->RecordCommand(*info->latency_stats_index,
+                                 std::chrono::steady_clock::now() - start);
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(u32 header) const {
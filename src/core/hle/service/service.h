@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
@@ -19,6 +20,10 @@ namespace Core {
 class System;
 }
 
+namespace HLE {
+class LatencyStats;
+}
+
 namespace Kernel {
 class KernelSystem;
 class ClientPort;
@@ -59,8 +64,11 @@ public:
 
     /// Creates a port pair and registers this service with the given ServiceManager.
     void InstallAsService(SM::ServiceManager& service_manager);
-    /// Creates a port pair and registers it on the kernel's global port registry.
-    void InstallAsNamedPort(Kernel::KernelSystem& kernel);
+    /**
+     * Creates a port pair and registers it on the kernel's global port registry.
+     * @param latency_stats Latency stats the commands are recorded in, or nullptr
+     */
+    void InstallAsNamedPort(Kernel::KernelSystem& kernel, HLE::LatencyStats* latency_stats);
 
     void HandleSyncRequest(Kernel::HLERequestContext& context) override;
 
@@ -80,6 +88,8 @@ private:
         u32 expected_header;
         HandlerFnP<ServiceFrameworkBase> handler_callback;
         const char* name;
+        /// Index of the function in the latency stats, given on its first call
+        std::optional<u32> latency_stats_index;
     };
 
     using InvokerFn = void(ServiceFrameworkBase* object, HandlerFnP<ServiceFrameworkBase> member,
@@ -99,6 +109,9 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+
+    /// Latency stats of the commands, set when the service is installed if they are recorded
+    HLE::LatencyStats* latency_stats = nullptr;
 };
 
 /**
@@ -28,7 +28,7 @@ void ServiceManager::InstallInterfaces(Core::System& system) {
     ASSERT(system.ServiceManager().srv_interface.expired());
 
     auto srv = std::make_shared<SRV>(system);
-    srv->InstallAsNamedPort(system.Kernel());
+    srv->InstallAsNamedPort(system.Kernel(), system.GetLatencyStats());
     system.ServiceManager().srv_interface = srv;
 }
 
@@ -74,4 +74,8 @@ std::string ServiceManager::GetServiceNameByPortId(u32 port) const {
     return "";
 }
 
+HLE::LatencyStats* ServiceManager::GetLatencyStats() const {
+    return system.GetLatencyStats();
+}
+
 } // namespace Service::SM
@@ -18,6 +18,10 @@ namespace Core {
 class System;
 }
 
+namespace HLE {
+class LatencyStats;
+}
+
 namespace Kernel {
 class ClientSession;
 class SessionRequestHandler;
@@ -54,6 +58,9 @@ public:
     // For IPC Recorder
     std::string GetServiceNameByPortId(u32 port) const;
 
+    /// Gets the latency stats the registered services record their commands in, or nullptr
+    HLE::LatencyStats* GetLatencyStats() const;
+
     template <typename T>
     std::shared_ptr<T> GetService(const std::string& service_name) const {
         static_assert(std::is_base_of_v<Kernel::SessionRequestHandler, T>,
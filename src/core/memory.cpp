@@ -2,11 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <utility>
 #include "audio_core/dsp_interface.h"
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/host_memory.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
@@ -15,63 +20,223 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Memory {
 
+/// Virtual regions that map 1:1 to the physical memory the rasterizer can cache
+struct RasterizerRegion {
+    VAddr vaddr;
+    VAddr vaddr_end;
+    PAddr paddr;
+};
+
+constexpr std::array<RasterizerRegion, 3> RASTERIZER_REGIONS{{
+    {LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END, FCRAM_PADDR},
+    {NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR_END, FCRAM_PADDR},
+    {VRAM_VADDR, VRAM_VADDR_END, VRAM_PADDR},
+}};
+
+/// Tracks which physical pages are rasterizer-cached, for the pages mapped after they were marked
 class RasterizerCacheMarker {
 public:
-    void Mark(VAddr addr, bool cached) {
-        bool* p = At(addr);
-        if (p)
-            *p = cached;
+    /// Marks the physical pages in [first_page, end_page)
+    void Mark(u32 first_page, u32 end_page, bool cached) {
+        Fill(vram, VRAM_PADDR, first_page, end_page, cached);
+        Fill(fcram, FCRAM_PADDR, first_page, end_page, cached);
     }
 
-    bool IsCached(VAddr addr) {
-        bool* p = At(addr);
-        if (p)
-            return *p;
+    bool IsCached(VAddr addr) const {
+        for (const RasterizerRegion& region : RASTERIZER_REGIONS) {
+            if (addr >= region.vaddr && addr < region.vaddr_end) {
+                const PAddr paddr = region.paddr + (addr - region.vaddr);
+                if (paddr >= VRAM_PADDR && paddr < VRAM_PADDR_END) {
+                    return vram[(paddr - VRAM_PADDR) / PAGE_SIZE];
+                }
+                return fcram[(paddr - FCRAM_PADDR) / PAGE_SIZE];
+            }
+        }
         return false;
     }
 
 private:
-    bool* At(VAddr addr) {
-        if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
-            return &vram[(addr - VRAM_VADDR) / PAGE_SIZE];
+    template <std::size_t N>
+    static void Fill(std::array<bool, N>& pages, PAddr region_paddr, u32 first_page, u32 end_page,
+                     bool cached) {
+        const u32 region_first_page = region_paddr >> PAGE_BITS;
+        const u32 begin = std::max(first_page, region_first_page);
+        const u32 end = std::min<u32>(end_page, region_first_page + N);
+        if (begin < end) {
+            std::fill(pages.begin() + (begin - region_first_page),
+                      pages.begin() + (end - region_first_page), cached);
         }
-        if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
-            return &linear_heap[(addr - LINEAR_HEAP_VADDR) / PAGE_SIZE];
-        }
-        if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
-            return &new_linear_heap[(addr - NEW_LINEAR_HEAP_VADDR) / PAGE_SIZE];
-        }
-        return nullptr;
     }
 
     std::array<bool, VRAM_SIZE / PAGE_SIZE> vram{};
-    std::array<bool, LINEAR_HEAP_SIZE / PAGE_SIZE> linear_heap{};
-    std::array<bool, NEW_LINEAR_HEAP_SIZE / PAGE_SIZE> new_linear_heap{};
+    std::array<bool, FCRAM_N3DS_SIZE / PAGE_SIZE> fcram{};
 };
 
+/// Calls function(virtual_page, physical_page) for the pages in [first_page, end_page) that are in
+/// a rasterizer region
+template <typename Function>
+static void ForEachRasterizerPage(u32 first_page, u32 end_page, Function&& function) {
+    for (const RasterizerRegion& region : RASTERIZER_REGIONS) {
+        const u32 region_first_page = region.vaddr >> PAGE_BITS;
+        const u32 begin = std::max(first_page, region_first_page);
+        const u32 end = std::min(end_page, region.vaddr_end >> PAGE_BITS);
+        for (u32 page = begin; page < end; ++page) {
+            function(page, (region.paddr >> PAGE_BITS) + (page - region_first_page));
+        }
+    }
+}
+
+/// Page of a page table that maps a rasterizer-cacheable physical page
+struct RasterizerMapping {
+    PageTable* page_table;
+    u32 virtual_page;
+};
+
+/// Size of FCRAM, VRAM and the N3DS extra RAM, which are allocated together in this order
+constexpr std::size_t PHYSICAL_MEMORY_SIZE = FCRAM_N3DS_SIZE + VRAM_SIZE + N3DS_EXTRA_RAM_SIZE;
+
+/// Size of the host mirror of a guest address space
+constexpr std::size_t FASTMEM_ARENA_SIZE = std::size_t{PAGE_TABLE_NUM_ENTRIES} * PAGE_SIZE;
+
 class MemorySystem::Impl {
 public:
+    explicit Impl(bool use_fastmem);
+
+    /// Adds the mapped pages of the rasterizer regions in the pages [first_page, end_page)
+    void AddRasterizerMappings(PageTable& page_table, u32 first_page, u32 end_page);
+
+    /// Removes the mappings of the page table in the pages [first_page, end_page)
+    void RemoveRasterizerMappings(PageTable& page_table, u32 first_page, u32 end_page);
+
     // Visual Studio would try to allocate these on compile time if they are std::array, which would
     // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    std::unique_ptr<u8[]> physical_memory;
+    /// Replaces physical_memory when fastmem is enabled, so that it can be mapped into the arenas
+    std::unique_ptr<Common::HostMemory> host_memory;
+
+    u8* fcram;
+    u8* vram;
+    u8* n3ds_extra_ram;
 
     PageTable* current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
     std::vector<PageTable*> page_table_list;
+    /// Reverse map of the rasterizer-cacheable memory of the registered page tables, by physical
+    /// page
+    std::unordered_multimap<u32, RasterizerMapping> rasterizer_mappings;
+    std::unordered_map<PageTable*, std::unique_ptr<Common::AddressSpace>> fastmem_arenas;
+    std::function<void()> host_pointer_removal_callback;
 
     AudioCore::DspInterface* dsp = nullptr;
 };
 
-MemorySystem::MemorySystem() : impl(std::make_unique<Impl>()) {}
+MemorySystem::Impl::Impl(bool use_fastmem) {
+    u8* base = nullptr;
+    if (use_fastmem) {
+        host_memory = std::make_unique<Common::HostMemory>(PHYSICAL_MEMORY_SIZE);
+        if (host_memory->IsValid()) {
+            base = host_memory->BasePointer();
+        } else {
+            LOG_WARNING(HW_Memory, "Allocating the fastmem memory failed, disabling fastmem");
+            host_memory.reset();
+        }
+    }
+    if (base == nullptr) {
+        physical_memory = std::make_unique<u8[]>(PHYSICAL_MEMORY_SIZE);
+        base = physical_memory.get();
+    }
+
+    fcram = base;
+    vram = fcram + FCRAM_N3DS_SIZE;
+    n3ds_extra_ram = vram + VRAM_SIZE;
+}
+
+void MemorySystem::Impl::AddRasterizerMappings(PageTable& page_table, u32 first_page,
+                                               u32 end_page) {
+    ForEachRasterizerPage(first_page, end_page, [&](u32 virtual_page, u32 physical_page) {
+        const PageType type = page_table.attributes[virtual_page];
+        if (type == PageType::Memory || type == PageType::RasterizerCachedMemory) {
+            rasterizer_mappings.emplace(physical_page, RasterizerMapping{&page_table, virtual_page});
+        }
+    });
+}
+
+void MemorySystem::Impl::RemoveRasterizerMappings(PageTable& page_table, u32 first_page,
+                                                  u32 end_page) {
+    ForEachRasterizerPage(first_page, end_page, [&](u32 virtual_page, u32 physical_page) {
+        const auto [begin, end] = rasterizer_mappings.equal_range(physical_page);
+        const auto mapping = std::find_if(begin, end, [&](const auto& entry) {
+            return entry.second.page_table == &page_table &&
+                   entry.second.virtual_page == virtual_page;
+        });
+        if (mapping != end) {
+            rasterizer_mappings.erase(mapping);
+        }
+    });
+}
+
+MemorySystem::MemorySystem(bool use_fastmem) : impl(std::make_unique<Impl>(use_fastmem)) {}
 MemorySystem::~MemorySystem() = default;
 
+void MemorySystem::UpdateFastmem(PageTable& page_table, u32 base, u32 size) {
+    const auto arena = impl->fastmem_arenas.find(&page_table);
+    if (arena == impl->fastmem_arenas.end()) {
+        return;
+    }
+    const Common::HostMemory& host_memory = *impl->host_memory;
+
+    // Consecutive pages with consecutive backing are mapped at once
+    enum class Kind { Unmapped, Mapped, Cached };
+    const auto classify = [&](u32 page, std::size_t& offset) {
+        const u8* pointer = page_table.pointers[page];
+        Kind kind = Kind::Mapped;
+        if (page_table.attributes[page] == PageType::RasterizerCachedMemory) {
+            pointer = GetPointerForRasterizerCache(page << PAGE_BITS);
+            kind = Kind::Cached;
+        }
+        if (pointer == nullptr || !host_memory.Contains(pointer)) {
+            return Kind::Unmapped;
+        }
+        offset = pointer - host_memory.BasePointer();
+        return kind;
+    };
+
+    Common::AddressSpace& address_space = *arena->second;
+    const u32 end = base + size;
+    while (base != end) {
+        std::size_t offset = 0;
+        const Kind kind = classify(base, offset);
+
+        u32 run_end = base + 1;
+        std::size_t next_offset = 0;
+        while (run_end != end && classify(run_end, next_offset) == kind &&
+               (kind == Kind::Unmapped || next_offset == offset + (run_end - base) * PAGE_SIZE)) {
+            ++run_end;
+        }
+
+        const std::size_t virtual_offset = std::size_t{base} << PAGE_BITS;
+        const std::size_t length = std::size_t{run_end - base} << PAGE_BITS;
+        bool success;
+        if (kind == Kind::Unmapped) {
+            success = address_space.Unmap(virtual_offset, length);
+        } else {
+            success = address_space.Map(virtual_offset, host_memory, offset, length) &&
+                      (kind != Kind::Cached || address_space.Protect(virtual_offset, length, false));
+        }
+        if (!success) {
+            DropFastmem(page_table);
+            return;
+        }
+        base = run_end;
+    }
+}
+
 void MemorySystem::SetCurrentPageTable(PageTable* page_table) {
     impl->current_page_table = page_table;
 }
@@ -87,6 +252,14 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
     RasterizerFlushVirtualRegion(base << PAGE_BITS, size * PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
+    // Whatever could still be accessing the pages through their host pointers is stopped first
+    const auto pointers = page_table.pointers.begin() + base;
+    if (impl->host_pointer_removal_callback &&
+        std::any_of(pointers, pointers + size, [](const u8* pointer) { return pointer != nullptr; })) {
+        impl->host_pointer_removal_callback();
+    }
+
+    const u32 first_page = base;
     u32 end = base + size;
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
@@ -104,6 +277,14 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
         if (memory != nullptr)
             memory += PAGE_SIZE;
     }
+
+    const auto& page_tables = impl->page_table_list;
+    if (std::find(page_tables.begin(), page_tables.end(), &page_table) != page_tables.end()) {
+        impl->RemoveRasterizerMappings(page_table, first_page, end);
+        impl->AddRasterizerMappings(page_table, first_page, end);
+    }
+
+    UpdateFastmem(page_table, first_page, size);
 }
 
 void MemorySystem::MapMemoryRegion(PageTable& page_table, VAddr base, u32 size, u8* target) {
@@ -120,24 +301,38 @@ void MemorySystem::UnmapRegion(PageTable& page_table, VAddr base, u32 size) {
 
 u8* MemorySystem::GetPointerForRasterizerCache(VAddr addr) {
     if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
-        return impl->fcram.get() + (addr - LINEAR_HEAP_VADDR);
+        return impl->fcram + (addr - LINEAR_HEAP_VADDR);
     }
     if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
-        return impl->fcram.get() + (addr - NEW_LINEAR_HEAP_VADDR);
+        return impl->fcram + (addr - NEW_LINEAR_HEAP_VADDR);
     }
     if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
-        return impl->vram.get() + (addr - VRAM_VADDR);
+        return impl->vram + (addr - VRAM_VADDR);
     }
     UNREACHABLE();
 }
 
 void MemorySystem::RegisterPageTable(PageTable* page_table) {
     impl->page_table_list.push_back(page_table);
+    // The page table can already have mappings
+    impl->AddRasterizerMappings(*page_table, 0, PAGE_TABLE_NUM_ENTRIES);
+
+    if (impl->host_memory) {
+        auto arena = std::make_unique<Common::AddressSpace>(FASTMEM_ARENA_SIZE);
+        if (arena->IsValid()) {
+            page_table->fastmem_base = arena->BasePointer();
+            impl->fastmem_arenas.emplace(page_table, std::move(arena));
+            UpdateFastmem(*page_table, 0, PAGE_TABLE_NUM_ENTRIES);
+        }
+    }
 }
 
 void MemorySystem::UnregisterPageTable(PageTable* page_table) {
     impl->page_table_list.erase(
         std::find(impl->page_table_list.begin(), impl->page_table_list.end(), page_table));
+    impl->RemoveRasterizerMappings(*page_table, 0, PAGE_TABLE_NUM_ENTRIES);
+    impl->fastmem_arenas.erase(page_table);
+    page_table->fastmem_base = nullptr;
 }
 
 template <typename T>
@@ -250,89 +445,127 @@ std::string MemorySystem::ReadCString(VAddr vaddr, u32 max_length) {
 
 u8* MemorySystem::GetPhysicalPointer(PAddr address) {
     if (address >= VRAM_PADDR && address <= VRAM_PADDR_END) {
-        return impl->vram.get() + (address - VRAM_PADDR);
+        return impl->vram + (address - VRAM_PADDR);
     }
     if (address >= DSP_RAM_PADDR && address <= DSP_RAM_PADDR_END) {
         return impl->dsp->GetDspMemory().data() + (address - DSP_RAM_PADDR);
     }
     if (address >= FCRAM_PADDR && address <= FCRAM_N3DS_PADDR_END) {
-        return impl->fcram.get() + (address - FCRAM_PADDR);
+        return impl->fcram + (address - FCRAM_PADDR);
     }
     if (address >= N3DS_EXTRA_RAM_PADDR && address <= N3DS_EXTRA_RAM_PADDR_END) {
-        return impl->n3ds_extra_ram.get() + (address - N3DS_EXTRA_RAM_PADDR);
+        return impl->n3ds_extra_ram + (address - N3DS_EXTRA_RAM_PADDR);
     }
     LOG_ERROR(HW_Memory, "unknown GetPhysicalPointer @ 0x{:08X}", address);
     return nullptr;
 }
 
-/// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
-static std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr) {
-    if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
-        return {addr - VRAM_PADDR + VRAM_VADDR};
-    }
-    if (addr >= FCRAM_PADDR && addr < FCRAM_PADDR_END) {
-        return {addr - FCRAM_PADDR + LINEAR_HEAP_VADDR, addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
-    }
-    if (addr >= FCRAM_PADDR_END && addr < FCRAM_N3DS_PADDR_END) {
-        return {addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
+void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
+    if (start < VRAM_PADDR) {
+        LOG_ERROR(HW_Memory, "Using invalid physical address for rasterizer: {:08X}", start);
+        return;
     }
+
+    const u32 first_page = start >> PAGE_BITS;
+    const u32 end_page = ((start + size - 1) >> PAGE_BITS) + 1;
+
     // While the physical <-> virtual mapping is 1:1 for the regions supported by the cache,
     // some games (like Pokemon Super Mystery Dungeon) will try to use textures that go beyond
     // the end address of VRAM, causing the Virtual->Physical translation to fail when flushing
     // parts of the texture.
-    LOG_ERROR(HW_Memory, "Trying to use invalid physical address for rasterizer: {:08X}", addr);
-    return {};
-}
-
-void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
-    if (start < VRAM_PADDR) {
-        LOG_ERROR(HW_Memory, "Using invalid physical address for rasterizer: {:08X}", start);
-        return;
+    const bool in_vram = first_page >= (VRAM_PADDR >> PAGE_BITS) &&
+                         end_page <= (VRAM_PADDR_END >> PAGE_BITS);
+    const bool in_fcram = first_page >= (FCRAM_PADDR >> PAGE_BITS) &&
+                          end_page <= (FCRAM_N3DS_PADDR_END >> PAGE_BITS);
+    if (!in_vram && !in_fcram) {
+        LOG_ERROR(HW_Memory, "Trying to use invalid physical address for rasterizer: {:08X}-{:08X}",
+                  start, start + size);
     }
 
-    u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
-    PAddr paddr = start;
-
-    for (unsigned i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
-        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
-            impl->cache_marker.Mark(vaddr, cached);
-            for (auto page_table : impl->page_table_list) {
-                PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
-
-                if (cached) {
-                    // Switch page type to cached if now cached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::Memory:
-                        page_type = PageType::RasterizerCachedMemory;
-                        page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
-                        break;
-                    default:
-                        UNREACHABLE();
-                    }
-                } else {
-                    // Switch page type to uncached if now uncached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::RasterizerCachedMemory: {
-                        page_type = PageType::Memory;
-                        page_table->pointers[vaddr >> PAGE_BITS] =
-                            GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
-                        break;
-                    }
-                    default:
-                        UNREACHABLE();
+    impl->cache_marker.Mark(first_page, end_page, cached);
+
+    // Whatever read the host pointer of a page before it is removed could write to the page after
+    // the rasterizer loaded it, so it is stopped before the first one is removed
+    bool removal_notified = false;
+    // Consecutive pages of a page table change their fastmem access at once
+    std::vector<std::pair<PageTable*, std::pair<u32, u32>>> fastmem_runs;
+
+    for (u32 physical_page = first_page; physical_page < end_page; ++physical_page) {
+        const auto [begin, end] = impl->rasterizer_mappings.equal_range(physical_page);
+        for (auto entry = begin; entry != end; ++entry) {
+            PageTable& page_table = *entry->second.page_table;
+            const u32 page = entry->second.virtual_page;
+            PageType& page_type = page_table.attributes[page];
+            if (cached) {
+                // Switch page type to cached if now cached
+                switch (page_type) {
+                case PageType::Unmapped:
+                    // It is not necessary for a process to have this region mapped into its
+                    // address space, for example, a system module need not have a VRAM mapping.
+                    break;
+                case PageType::Memory:
+                    if (!std::exchange(removal_notified, true) &&
+                        impl->host_pointer_removal_callback) {
+                        impl->host_pointer_removal_callback();
                     }
+                    page_type = PageType::RasterizerCachedMemory;
+                    page_table.pointers[page] = nullptr;
+                    break;
+                default:
+                    UNREACHABLE();
                 }
+            } else {
+                // Switch page type to uncached if now uncached
+                switch (page_type) {
+                case PageType::Unmapped:
+                    // It is not necessary for a process to have this region mapped into its
+                    // address space, for example, a system module need not have a VRAM mapping.
+                    break;
+                case PageType::RasterizerCachedMemory:
+                    page_type = PageType::Memory;
+                    page_table.pointers[page] = GetPointerForRasterizerCache(page << PAGE_BITS);
+                    break;
+                default:
+                    UNREACHABLE();
+                }
+            }
+
+            const auto run = std::find_if(fastmem_runs.begin(), fastmem_runs.end(),
+                                          [&](const auto& run) {
+                                              return run.first == &page_table &&
+                                                     run.second.second == page;
+                                          });
+            if (run != fastmem_runs.end()) {
+                ++run->second.second;
+            } else {
+                fastmem_runs.push_back({&page_table, {page, page + 1}});
             }
         }
     }
+
+    for (const auto& [page_table, run] : fastmem_runs) {
+        ProtectFastmemPages(*page_table, run.first, run.second - run.first, !cached);
+    }
+}
+
+void MemorySystem::SetHostPointerRemovalCallback(std::function<void()> callback) {
+    impl->host_pointer_removal_callback = std::move(callback);
+}
+
+void MemorySystem::ProtectFastmemPages(PageTable& page_table, u32 base, u32 size,
+                                       bool accessible) {
+    const auto arena = impl->fastmem_arenas.find(&page_table);
+    if (arena != impl->fastmem_arenas.end() &&
+        !arena->second->Protect(std::size_t{base} << PAGE_BITS, std::size_t{size} << PAGE_BITS,
+                                accessible)) {
+        DropFastmem(page_table);
+    }
+}
+
+void MemorySystem::DropFastmem(PageTable& page_table) {
+    LOG_ERROR(HW_Memory, "The fastmem arena could not be updated, disabling fastmem for it");
+    impl->fastmem_arenas.erase(&page_table);
+    page_table.fastmem_base = nullptr;
 }
 
 void RasterizerFlushRegion(PAddr start, u32 size) {
@@ -583,14 +816,13 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) {
-    DEBUG_ASSERT(pointer >= impl->fcram.get() &&
-                 pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return static_cast<u32>(pointer - impl->fcram.get());
+    DEBUG_ASSERT(pointer >= impl->fcram && pointer <= impl->fcram + Memory::FCRAM_N3DS_SIZE);
+    return static_cast<u32>(pointer - impl->fcram);
 }
 
 u8* MemorySystem::GetFCRAMPointer(u32 offset) {
     DEBUG_ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 void MemorySystem::SetDSP(AudioCore::DspInterface& dsp) {
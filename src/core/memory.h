@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -63,6 +64,12 @@ struct PageTable {
      * the corresponding entry in `pointers` MUST be set to null.
      */
     std::array<PageType, PAGE_TABLE_NUM_ENTRIES> attributes;
+
+    /**
+     * Host mirror of the address space when fastmem is enabled, or null. Pages that can't be
+     * accessed through `pointers` are inaccessible in it as well.
+     */
+    u8* fastmem_base = nullptr;
 };
 
 /// Physical memory regions as seen from the ARM11
@@ -202,7 +209,11 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
 class MemorySystem {
 public:
-    MemorySystem();
+    /**
+     * @param use_fastmem Whether to mirror the address space of each page table in a fastmem
+     * arena, for a CPU backend that can access the guest memory through it
+     */
+    explicit MemorySystem(bool use_fastmem = false);
     ~MemorySystem();
 
     /**
@@ -263,6 +274,13 @@ public:
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Sets the function called before the host pointer of a page is removed or replaced, by a
+     * mapping or by RasterizerMarkRegionCached. It has to stop whatever could still be accessing
+     * the page through it.
+     */
+    void SetHostPointerRemovalCallback(std::function<void()> callback);
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(PageTable* page_table);
 
@@ -288,6 +306,19 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    /**
+     * Mirrors the pages in the fastmem arena of the page table, if it has one. Pages backed by the
+     * physical memory are mapped to it, and inaccessible while they are rasterizer-cached. All the
+     * other pages are left unmapped, their accesses fault and take the slow path of the JIT.
+     */
+    void UpdateFastmem(PageTable& page_table, u32 base, u32 size);
+
+    /// Changes whether the pages can be accessed in the fastmem arena of the page table
+    void ProtectFastmemPages(PageTable& page_table, u32 base, u32 size, bool accessible);
+
+    /// Releases the fastmem arena of the page table, the JIT then only uses the page table
+    void DropFastmem(PageTable& page_table);
+
     class Impl;
 
     std::unique_ptr<Impl> impl;
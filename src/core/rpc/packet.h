@@ -14,6 +14,7 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    ReadLatencyStats,
 };
 
 struct PacketHeader {
@@ -1,7 +1,10 @@
+#include <algorithm>
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/latency_stats.h"
 #include "core/memory.h"
 #include "core/rpc/packet.h"
 #include "core/rpc/rpc_server.h"
@@ -54,11 +57,29 @@ void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u
     packet.SendReply();
 }
 
+void RPCServer::HandleReadLatencyStats(Packet& packet, u32 offset, u32 data_size) {
+    if (offset == 0) {
+        // The stats are released on shutdown, a read meanwhile gets an empty result
+        const auto* latency_stats = Core::System::GetInstance().GetLatencyStats();
+        latency_stats_json = latency_stats ? latency_stats->ToJson() : std::string{};
+    }
+
+    // A read past the end gets an empty reply, which tells the client it has the whole JSON
+    const std::size_t size =
+        offset < latency_stats_json.size()
+            ? std::min<std::size_t>(data_size, latency_stats_json.size() - offset)
+            : 0;
+    std::memcpy(packet.GetPacketData().data(), latency_stats_json.data() + offset, size);
+    packet.SetPacketDataSize(static_cast<u32>(size));
+    packet.SendReply();
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
         case PacketType::ReadMemory:
         case PacketType::WriteMemory:
+        case PacketType::ReadLatencyStats:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
@@ -95,6 +116,12 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ReadLatencyStats:
+            if (data_size > 0 && data_size <= MAX_READ_SIZE) {
+                HandleReadLatencyStats(*request_packet, address, data_size);
+                success = true;
+            }
+            break;
         default:
             break;
         }
@@ -56,12 +56,17 @@ void LogSetting(const std::string& name, const T& value) {
 void LogSettings() {
     LOG_INFO(Config, "Citra Configuration:");
     LogSetting("Core_UseCpuJit", Settings::values.use_cpu_jit);
+    LogSetting("Core_UseCpuJitCache", Settings::values.use_cpu_jit_cache);
+    LogSetting("Core_UseFastmem", Settings::values.use_fastmem);
+    LogSetting("Core_UseCpuThreads", Settings::values.use_cpu_threads);
     LogSetting("Renderer_UseGLES", Settings::values.use_gles);
     LogSetting("Renderer_UseHwRenderer", Settings::values.use_hw_renderer);
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
     LogSetting("Renderer_ShadersAccurateMul",
                static_cast<int>(Settings::values.shaders_accurate_mul));
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_AsyncShaderCompile", Settings::values.async_shader_compile);
+    LogSetting("Renderer_SwRasterizerThreads", Settings::values.sw_rasterizer_threads);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
     LogSetting("Renderer_FrameLimit", Settings::values.frame_limit);
@@ -90,6 +95,7 @@ void LogSettings() {
     LogSetting("DataStorage_UseVirtualSd", Settings::values.use_virtual_sd);
     LogSetting("System_IsNew3ds", Settings::values.is_new_3ds);
     LogSetting("System_RegionValue", Settings::values.region_value);
+    LogSetting("Debugging_RecordLatencyStats", Settings::values.record_latency_stats);
     LogSetting("Debugging_UseGdbstub", Settings::values.use_gdbstub);
     LogSetting("Debugging_GdbstubPort", Settings::values.gdbstub_port);
 }
@@ -147,6 +147,9 @@ struct Values {
 
     // Core
     bool use_cpu_jit;
+    bool use_cpu_jit_cache;
+    bool use_fastmem;
+    bool use_cpu_threads;
 
     // Data Storage
     bool use_virtual_sd;
@@ -162,6 +165,7 @@ struct Values {
     bool use_hw_renderer;
     bool use_hw_shader;
     bool use_shader_jit;
+    u8 sw_rasterizer_threads; ///< 0: one per host core, 1: no tile binning
     u16 resolution_factor;
     bool vsync_enabled;
     bool use_frame_limit;
@@ -201,6 +205,7 @@ struct Values {
     std::array<int, Service::CAM::NumCameras> camera_flip;
 
     // Debugging
+    bool record_latency_stats;
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string log_filter;
@@ -218,7 +223,6 @@ struct Values {
     bool skip_load_buffer;
     bool merge_framebuffer;
     bool disable_clip_coef;
-    bool stream_buffer_hack;
     bool y2r_event_delay;
     bool use_present_thread;
     bool use_direct_display;
@@ -0,0 +1,247 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <tuple>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "core/timing_wheel.h"
+
+namespace Core {
+
+// Sort by time, unless the times are the same, in which case sort by the order added to the queue
+bool TimingEvent::operator>(const TimingEvent& right) const {
+    return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
+}
+
+bool TimingEvent::operator<(const TimingEvent& right) const {
+    return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
+}
+
+TimingWheel::TimingWheel() = default;
+TimingWheel::~TimingWheel() = default;
+
+void TimingWheel::Schedule(const TimingEvent& event) {
+    u32 index = free_nodes;
+    if (index != NONE) {
+        free_nodes = nodes[index].next;
+    } else {
+        index = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    node.event = event;
+
+    u32& type_head = type_heads.try_emplace(event.type, NONE).first->second;
+    node.type_prev = NONE;
+    node.type_next = type_head;
+    if (type_head != NONE) {
+        nodes[type_head].type_prev = index;
+    }
+    type_head = index;
+
+    ++num_events;
+    Insert(index);
+}
+
+void TimingWheel::Unschedule(const TimingEventType* type, u64 userdata) {
+    const auto type_head = type_heads.find(type);
+    if (type_head == type_heads.end()) {
+        return;
+    }
+
+    for (u32 index = type_head->second; index != NONE;) {
+        const u32 next = nodes[index].type_next;
+        if (nodes[index].event.userdata == userdata) {
+            Release(index);
+        }
+        index = next;
+    }
+}
+
+void TimingWheel::Remove(const TimingEventType* type) {
+    const auto type_head = type_heads.find(type);
+    if (type_head == type_heads.end()) {
+        return;
+    }
+
+    for (u32 index = type_head->second; index != NONE;) {
+        const u32 next = nodes[index].type_next;
+        Release(index);
+        index = next;
+    }
+}
+
+s64 TimingWheel::NextTime() const {
+    ASSERT(!IsEmpty());
+    if (occupied[0] != 0) {
+        return nodes[lists[Common::LeastSignificantSetBit(occupied[0])].head].event.time;
+    }
+
+    // Only the bottom level is sorted, the earliest event of the slot has to be looked for
+    u32 list = OVERFLOW_LIST;
+    for (u32 level = 1; level < NUM_LEVELS; ++level) {
+        if (occupied[level] != 0) {
+            list = level * NUM_SLOTS + Common::LeastSignificantSetBit(occupied[level]);
+            break;
+        }
+    }
+
+    s64 time = nodes[lists[list].head].event.time;
+    for (u32 index = lists[list].head; index != NONE; index = nodes[index].next) {
+        time = std::min(time, nodes[index].event.time);
+    }
+    return time;
+}
+
+bool TimingWheel::PopDue(s64 time, TimingEvent& event) {
+    while (num_events != 0) {
+        if (occupied[0] != 0) {
+            const u32 index = lists[Common::LeastSignificantSetBit(occupied[0])].head;
+            if (nodes[index].event.time > time) {
+                break;
+            }
+            event = nodes[index].event;
+            Release(index);
+            return true;
+        }
+
+        // Move the current time to the start of the earliest slot above, to move it down
+        s64 slot_start = NextTime();
+        u32 list = OVERFLOW_LIST;
+        u32 shift = GRANULARITY_BITS + SLOT_BITS * NUM_LEVELS;
+        for (u32 level = 1; level < NUM_LEVELS; ++level) {
+            if (occupied[level] != 0) {
+                list = level * NUM_SLOTS + Common::LeastSignificantSetBit(occupied[level]);
+                shift = GRANULARITY_BITS + SLOT_BITS * level;
+                break;
+            }
+        }
+        slot_start = static_cast<s64>((static_cast<u64>(slot_start) >> shift) << shift);
+        if (slot_start > time) {
+            break;
+        }
+        current_time = slot_start;
+        Reinsert(list);
+    }
+
+    MoveTo(time);
+    return false;
+}
+
+void TimingWheel::Insert(u32 index) {
+    const s64 time = std::max(nodes[index].event.time, current_time);
+
+    u32 level = 0;
+    u64 differing_slots = (static_cast<u64>(time) ^ static_cast<u64>(current_time)) >>
+                          GRANULARITY_BITS;
+    while (differing_slots >= NUM_SLOTS) {
+        differing_slots >>= SLOT_BITS;
+        ++level;
+    }
+
+    if (level >= NUM_LEVELS) {
+        Link(index, OVERFLOW_LIST);
+        return;
+    }
+
+    const u32 slot = static_cast<u32>(static_cast<u64>(time) >>
+                                      (GRANULARITY_BITS + SLOT_BITS * level)) &
+                     (NUM_SLOTS - 1);
+    Link(index, level * NUM_SLOTS + slot);
+}
+
+void TimingWheel::Link(u32 index, u32 list) {
+    Node& node = nodes[index];
+    List& slot = lists[list];
+    node.list = list;
+
+    // Events are mostly scheduled in order, so the bottom slots are searched from their end
+    u32 prev = slot.tail;
+    if (list < NUM_SLOTS) {
+        while (prev != NONE && nodes[prev].event > node.event) {
+            prev = nodes[prev].prev;
+        }
+    }
+
+    node.prev = prev;
+    node.next = prev != NONE ? nodes[prev].next : slot.head;
+    (prev != NONE ? nodes[prev].next : slot.head) = index;
+    (node.next != NONE ? nodes[node.next].prev : slot.tail) = index;
+
+    if (list != OVERFLOW_LIST) {
+        occupied[list / NUM_SLOTS] |= u64{1} << (list % NUM_SLOTS);
+    }
+}
+
+void TimingWheel::Unlink(u32 index) {
+    const Node& node = nodes[index];
+    List& slot = lists[node.list];
+    (node.prev != NONE ? nodes[node.prev].next : slot.head) = node.next;
+    (node.next != NONE ? nodes[node.next].prev : slot.tail) = node.prev;
+
+    if (slot.head == NONE && node.list != OVERFLOW_LIST) {
+        occupied[node.list / NUM_SLOTS] &= ~(u64{1} << (node.list % NUM_SLOTS));
+    }
+}
+
+void TimingWheel::Release(u32 index) {
+    Unlink(index);
+
+    Node& node = nodes[index];
+    if (node.type_prev != NONE) {
+        nodes[node.type_prev].type_next = node.type_next;
+    } else {
+        type_heads[node.event.type] = node.type_next;
+    }
+    if (node.type_next != NONE) {
+        nodes[node.type_next].type_prev = node.type_prev;
+    }
+
+    node.next = free_nodes;
+    free_nodes = index;
+    --num_events;
+}
+
+void TimingWheel::Reinsert(u32 list) {
+    u32 index = lists[list].head;
+    lists[list] = {};
+    if (list != OVERFLOW_LIST) {
+        occupied[list / NUM_SLOTS] &= ~(u64{1} << (list % NUM_SLOTS));
+    }
+
+    while (index != NONE) {
+        const u32 next = nodes[index].next;
+        Insert(index);
+        index = next;
+    }
+}
+
+void TimingWheel::MoveTo(s64 time) {
+    if (time <= current_time) {
+        return;
+    }
+
+    constexpr u32 wheel_bits = GRANULARITY_BITS + SLOT_BITS * NUM_LEVELS;
+    const bool overflow_reached = (static_cast<u64>(time) >> wheel_bits) !=
+                                  (static_cast<u64>(current_time) >> wheel_bits);
+    current_time = time;
+    if (overflow_reached && lists[OVERFLOW_LIST].head != NONE) {
+        Reinsert(OVERFLOW_LIST);
+    }
+
+    // The events in the slot of the current time on a level belong to the levels below. As no
+    // event is due, this is the only slot whose events can have to move down.
+    for (u32 level = NUM_LEVELS - 1; level > 0; --level) {
+        const u32 slot = static_cast<u32>(static_cast<u64>(time) >>
+                                          (GRANULARITY_BITS + SLOT_BITS * level)) &
+                         (NUM_SLOTS - 1);
+        if ((occupied[level] >> slot) & 1) {
+            Reinsert(level * NUM_SLOTS + slot);
+        }
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,112 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+struct TimingEventType;
+
+struct TimingEvent {
+    s64 time;
+    u64 fifo_order;
+    u64 userdata;
+    const TimingEventType* type;
+
+    bool operator>(const TimingEvent& right) const;
+    bool operator<(const TimingEvent& right) const;
+};
+
+/**
+ * Hierarchical timing wheel holding the events of a timer. Each level has 64 slots, and the slots
+ * of a level span 64 times the cycles of the slots of the level below. An event is placed on the
+ * lowest level where its time and the current time of the wheel fall in the same slot of the level
+ * above, so that the events of a level all come before those of the levels above. The slots of the
+ * bottom level are kept sorted, and the slots above are moved down a level when the current time
+ * reaches them.
+ *
+ * Events are popped in order of time, and of scheduling for the same time. Scheduling and popping
+ * are O(1) amortized, and removing the events of a type takes O(1) per event of the type.
+ */
+class TimingWheel {
+public:
+    TimingWheel();
+    ~TimingWheel();
+
+    void Schedule(const TimingEvent& event);
+
+    /// Removes the events of the type with the userdata
+    void Unschedule(const TimingEventType* type, u64 userdata);
+
+    /// Removes all the events of the type
+    void Remove(const TimingEventType* type);
+
+    bool IsEmpty() const {
+        return num_events == 0;
+    }
+
+    /// Returns the time of the earliest event, the wheel must not be empty
+    s64 NextTime() const;
+
+    /**
+     * Pops the earliest event if it is due at the time. Once no event is due, the current time of
+     * the wheel is moved to the time, which must not go backwards between calls.
+     */
+    bool PopDue(s64 time, TimingEvent& event);
+
+private:
+    static constexpr u32 NONE = 0xFFFFFFFF;
+    /// The slots of the bottom level span 16 cycles
+    static constexpr u32 GRANULARITY_BITS = 4;
+    static constexpr u32 SLOT_BITS = 6;
+    static constexpr u32 NUM_SLOTS = 1 << SLOT_BITS;
+    static constexpr u32 NUM_LEVELS = 6;
+    /// Events too far in the future for the top level are kept unsorted in an extra list
+    static constexpr u32 OVERFLOW_LIST = NUM_LEVELS * NUM_SLOTS;
+
+    struct Node {
+        TimingEvent event;
+        u32 prev;
+        u32 next;
+        /// Links of the nodes of the same event type
+        u32 type_prev;
+        u32 type_next;
+        u32 list;
+    };
+
+    struct List {
+        u32 head = NONE;
+        u32 tail = NONE;
+    };
+
+    void Insert(u32 index);
+    void Link(u32 index, u32 list);
+    void Unlink(u32 index);
+    void Release(u32 index);
+
+    /// Moves the events of the list to the levels they belong to at the current time
+    void Reinsert(u32 list);
+
+    /// Moves the current time forward, no event must be due before it
+    void MoveTo(s64 time);
+
+    std::vector<Node> nodes;
+    u32 free_nodes = NONE;
+    std::size_t num_events = 0;
+
+    std::array<List, OVERFLOW_LIST + 1> lists;
+    /// Bit mask of the non-empty slots of each level
+    std::array<u64, NUM_LEVELS> occupied{};
+    /// First node of each event type, in no particular order
+    std::unordered_map<const TimingEventType*, u32> type_heads;
+
+    s64 current_time = 0;
+};
+
+} // namespace Core
@@ -0,0 +1,64 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+
+namespace ArmTests {
+
+TEST_CASE("ARM_Dynarmic: warm-up leaves the state unchanged", "[arm_dynarmic]") {
+    constexpr std::array<u32, 5> code{
+        0xE3A00055, // mov r0, #0x55
+        0xEE0D0F50, // mcr p15, 0, r0, c13, c0, 2 (TPIDRURW)
+        0xE5810000, // str r0, [r1]
+        0xEE000A10, // vmov s0, r0
+        0xEF000000, // svc #0
+    };
+    alignas(Memory::PAGE_SIZE) static std::array<u8, Memory::PAGE_SIZE> page{};
+    std::memcpy(page.data(), code.data(), sizeof(code));
+
+    auto page_table = std::make_unique<Memory::PageTable>();
+    page_table->pointers.fill(nullptr);
+    page_table->attributes.fill(Memory::PageType::Unmapped);
+    page_table->pointers[0] = page.data();
+    page_table->attributes[0] = Memory::PageType::Memory;
+
+    // The blocks run on a JIT of their own, whose callbacks drop everything
+    Core::Timing timing;
+    ARM_Dynarmic cpu(&Core::System::GetInstance(), 0, timing.GetTimer(0));
+    cpu.SetPageTable(page_table.get());
+
+    for (int i = 0; i < 15; ++i) {
+        cpu.SetReg(i, 0x1000 + i);
+    }
+    cpu.SetPC(0);
+    cpu.SetCPSR(0x10);
+    cpu.SetVFPReg(0, 0x3F800000);
+    cpu.SetCP15Register(CP15_THREAD_UPRW, 0x12345678);
+    cpu.SetCP15Register(CP15_THREAD_URO, 0x9ABCDEF0);
+    const auto pointers = page_table->pointers;
+
+    cpu.WarmUp({{0, 0, 0}}, *page_table);
+
+    for (int i = 0; i < 15; ++i) {
+        REQUIRE(cpu.GetReg(i) == 0x1000u + i);
+    }
+    REQUIRE(cpu.GetPC() == 0);
+    REQUIRE(cpu.GetCPSR() == 0x10);
+    REQUIRE(cpu.GetVFPReg(0) == 0x3F800000);
+    REQUIRE(cpu.GetCP15Register(CP15_THREAD_UPRW) == 0x12345678);
+    REQUIRE(cpu.GetCP15Register(CP15_THREAD_URO) == 0x9ABCDEF0);
+    REQUIRE(page_table->pointers == pointers);
+    // The store of the block was dropped
+    REQUIRE(std::memcmp(page.data(), code.data(), sizeof(code)) == 0);
+}
+
+} // namespace ArmTests
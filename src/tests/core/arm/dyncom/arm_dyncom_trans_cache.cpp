@@ -0,0 +1,65 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstring>
+#include "core/arm/dyncom/arm_dyncom_interpreter.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+
+namespace ArmTests {
+
+/// Translates and runs the instruction at the address
+static void RunInstruction(ARMul_State& state, Core::Timing::Timer& timer, u32 address) {
+    state.Reg[15] = address;
+    state.NumInstrsToExecute = 1;
+    InterpreterMainLoop(&state, &timer);
+}
+
+TEST_CASE("ARM_DynCom: reset of the translation cache shared by the cores", "[arm_dyncom]") {
+    constexpr std::array<u32, 3> code{
+        0xE3A00001, // mov r0, #1
+        0xE3A00002, // mov r0, #2
+        0xE3A00003, // mov r0, #3
+    };
+    alignas(Memory::PAGE_SIZE) static std::array<u8, Memory::PAGE_SIZE> page{};
+    std::memcpy(page.data(), code.data(), sizeof(code));
+
+    Memory::MemorySystem memory;
+    Memory::PageTable page_table{};
+    memory.MapMemoryRegion(page_table, 0, Memory::PAGE_SIZE, page.data());
+    memory.SetCurrentPageTable(&page_table);
+
+    Core::Timing timing;
+    auto& timer = *timing.GetTimer(0);
+    ARMul_State core_a(Core::System::GetInstance(), memory, USER32MODE);
+    ARMul_State core_b(Core::System::GetInstance(), memory, USER32MODE);
+    ClearTransCache();
+
+    // The first translation of each core is at the start of the buffer
+    RunInstruction(core_a, timer, 0);
+    REQUIRE(core_a.Reg[0] == 1);
+    RunInstruction(core_b, timer, 4);
+    REQUIRE(core_b.Reg[0] == 2);
+
+    // The next translation of core B resets the buffer, and overwrites the one of core A
+    trans_cache_buf_top = TRANS_CACHE_SIZE - TRANS_CACHE_RESERVE + 1;
+    RunInstruction(core_b, timer, 8);
+    REQUIRE(core_b.Reg[0] == 3);
+    REQUIRE(trans_cache_buf_top < TRANS_CACHE_RESERVE);
+
+    // Both cores translate their instructions again
+    core_a.Reg[0] = 0;
+    RunInstruction(core_a, timer, 0);
+    REQUIRE(core_a.Reg[0] == 1);
+    RunInstruction(core_b, timer, 4);
+    REQUIRE(core_b.Reg[0] == 2);
+}
+
+} // namespace ArmTests
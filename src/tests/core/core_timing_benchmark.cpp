@@ -0,0 +1,135 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+#include <fmt/format.h>
+#include "core/core_timing.h"
+#include "core/timing_wheel.h"
+
+namespace CoreTimingBenchmark {
+
+using Event = Core::TimingEvent;
+
+/// The min-heap CoreTiming used before the timing wheel, as a reference
+class EventHeap {
+public:
+    void Schedule(const Event& event) {
+        events.push_back(event);
+        std::push_heap(events.begin(), events.end(), std::greater<>());
+    }
+
+    void Unschedule(const Core::TimingEventType* type, u64 userdata) {
+        auto itr = std::remove_if(events.begin(), events.end(), [&](const Event& e) {
+            return e.type == type && e.userdata == userdata;
+        });
+        if (itr != events.end()) {
+            events.erase(itr, events.end());
+            std::make_heap(events.begin(), events.end(), std::greater<>());
+        }
+    }
+
+    bool IsEmpty() const {
+        return events.empty();
+    }
+
+    s64 NextTime() const {
+        return events.front().time;
+    }
+
+    bool PopDue(s64 time, Event& event) {
+        if (events.empty() || events.front().time > time) {
+            return false;
+        }
+        event = events.front();
+        std::pop_heap(events.begin(), events.end(), std::greater<>());
+        events.pop_back();
+        return true;
+    }
+
+private:
+    std::vector<Event> events;
+};
+
+// Event types of the mix, only their addresses are used
+static std::array<Core::TimingEventType, 4> event_types;
+static const Core::TimingEventType* const audio_tick = &event_types[0];
+static const Core::TimingEventType* const vblank = &event_types[1];
+static const Core::TimingEventType* const thread_wakeup = &event_types[2];
+static const Core::TimingEventType* const service_delay = &event_types[3];
+
+constexpr int NUM_THREADS = 32;
+constexpr int NUM_SLICES = 200000;
+
+struct Result {
+    u64 checksum = 0;
+    std::chrono::nanoseconds duration{};
+};
+
+/**
+ * Replays slices of a typical frame: periodic audio and VBlank events, threads waiting with
+ * timeouts that are mostly cancelled by their wakeup, and short service reply delays.
+ */
+template <typename Queue>
+static Result RunMix() {
+    Queue queue;
+    std::mt19937 rng(0x3D5);
+    std::uniform_int_distribution<s64> timeout(usToCycles(100), msToCycles(50));
+    std::uniform_int_distribution<s64> delay(usToCycles(20), usToCycles(2000));
+    std::uniform_int_distribution<int> thread(0, NUM_THREADS - 1);
+
+    s64 ticks = 0;
+    u64 fifo = 0;
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+
+    queue.Schedule({msToCycles(5), fifo++, 0, audio_tick});
+    queue.Schedule({msToCycles(16), fifo++, 0, vblank});
+    for (int slice = 0; slice < NUM_SLICES; ++slice) {
+        // Threads start waiting, and others are woken up before their timeout
+        const u64 waiting = static_cast<u64>(thread(rng));
+        queue.Schedule({ticks + timeout(rng), fifo++, waiting, thread_wakeup});
+        queue.Unschedule(thread_wakeup, static_cast<u64>(thread(rng)));
+        if (slice % 4 == 0) {
+            queue.Schedule({ticks + delay(rng), fifo++, waiting, service_delay});
+        }
+
+        ticks += std::min<s64>(queue.NextTime() - ticks, Core::Timing::MAX_SLICE_LENGTH);
+        for (Event event; queue.PopDue(ticks, event);) {
+            result.checksum = result.checksum * 31 + event.fifo_order;
+            if (event.type == audio_tick) {
+                queue.Schedule({event.time + msToCycles(5), fifo++, 0, audio_tick});
+            } else if (event.type == vblank) {
+                queue.Schedule({event.time + msToCycles(16), fifo++, 0, vblank});
+            }
+        }
+    }
+
+    result.duration = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+} // namespace CoreTimingBenchmark
+
+TEST_CASE("CoreTiming[Benchmark]", "[core][.benchmark]") {
+    using namespace CoreTimingBenchmark;
+
+    const Result heap = RunMix<EventHeap>();
+    const Result wheel = RunMix<Core::TimingWheel>();
+
+    // Both queues have to run the events in the same order
+    REQUIRE(heap.checksum == wheel.checksum);
+
+    const auto per_slice = [](const Result& result) {
+        return static_cast<double>(result.duration.count()) / NUM_SLICES;
+    };
+    WARN(fmt::format("binary heap: {:.1f} ns per slice, timing wheel: {:.1f} ns per slice",
+                     per_slice(heap), per_slice(wheel)));
+}
@@ -0,0 +1,187 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <fmt/format.h>
+#include "common/thread_queue_list.h"
+#include "core/hle/kernel/thread.h"
+
+namespace SchedulerBenchmark {
+
+struct BenchThread {
+    Common::ThreadQueueLinks<BenchThread*> queue_links;
+    u32 id;
+    u32 priority;
+    bool ready;
+};
+
+constexpr unsigned int NUM_PRIORITIES = Kernel::ThreadPrioLowest + 1;
+
+/// The deque-based ready queue the kernel used before the bit mask one, as a reference
+struct DequeQueueList {
+    struct Queue {
+        Queue* next_nonempty = UnlinkedTag();
+        std::deque<BenchThread*> data;
+    };
+
+    static Queue* UnlinkedTag() {
+        return reinterpret_cast<Queue*>(1);
+    }
+
+    BenchThread* pop_first() {
+        for (Queue* cur = first; cur != nullptr; cur = cur->next_nonempty) {
+            if (!cur->data.empty()) {
+                BenchThread* tmp = cur->data.front();
+                cur->data.pop_front();
+                return tmp;
+            }
+        }
+        return nullptr;
+    }
+
+    BenchThread* pop_first_better(unsigned int priority) {
+        Queue* stop = &queues[priority];
+        for (Queue* cur = first; cur < stop; cur = cur->next_nonempty) {
+            if (!cur->data.empty()) {
+                BenchThread* tmp = cur->data.front();
+                cur->data.pop_front();
+                return tmp;
+            }
+        }
+        return nullptr;
+    }
+
+    // The kernel prepared the priority of each thread when creating it
+    void push_front(unsigned int priority, BenchThread* thread) {
+        prepare(priority);
+        queues[priority].data.push_front(thread);
+    }
+
+    void push_back(unsigned int priority, BenchThread* thread) {
+        prepare(priority);
+        queues[priority].data.push_back(thread);
+    }
+
+    void move(BenchThread* thread, unsigned int old_priority, unsigned int new_priority) {
+        remove(old_priority, thread);
+        push_back(new_priority, thread);
+    }
+
+    void remove(unsigned int priority, BenchThread* thread) {
+        auto& data = queues[priority].data;
+        data.erase(std::remove(data.begin(), data.end(), thread), data.end());
+    }
+
+    void prepare(unsigned int priority) {
+        Queue* cur = &queues[priority];
+        if (cur->next_nonempty != UnlinkedTag()) {
+            return;
+        }
+        for (int i = priority - 1; i >= 0; --i) {
+            if (queues[i].next_nonempty != UnlinkedTag()) {
+                cur->next_nonempty = queues[i].next_nonempty;
+                queues[i].next_nonempty = cur;
+                return;
+            }
+        }
+        cur->next_nonempty = first;
+        first = cur;
+    }
+
+    Queue* first = nullptr;
+    std::array<Queue, NUM_PRIORITIES> queues;
+};
+
+constexpr u32 NUM_THREADS = 48;
+constexpr int NUM_RESCHEDULES = 1000000;
+
+struct Result {
+    u64 checksum = 0;
+    std::chrono::nanoseconds duration{};
+};
+
+/**
+ * Replays the scheduling of a title with many worker threads: the running thread blocks on an SVC
+ * and the best ready thread is picked, blocked threads are woken up, a woken thread of a better
+ * priority preempts the running one, and ready threads get their priority changed.
+ */
+template <typename Queue>
+static Result RunScheduling() {
+    Queue queue;
+    std::array<BenchThread, NUM_THREADS> threads{};
+    std::mt19937 rng(0x5CED);
+    std::uniform_int_distribution<u32> thread_index(0, NUM_THREADS - 1);
+    std::uniform_int_distribution<u32> priority(Kernel::ThreadPrioUserlandMax,
+                                                Kernel::ThreadPrioLowest);
+
+    for (u32 i = 0; i < NUM_THREADS; ++i) {
+        threads[i].id = i;
+        threads[i].priority = priority(rng);
+    }
+    BenchThread* current = &threads[0];
+
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < NUM_RESCHEDULES; ++i) {
+        // Wake up a blocked thread
+        BenchThread& woken = threads[thread_index(rng)];
+        if (!woken.ready && &woken != current) {
+            woken.ready = true;
+            queue.push_back(woken.priority, &woken);
+        }
+
+        // Change the priority of a ready thread
+        BenchThread& changed = threads[thread_index(rng)];
+        const u32 new_priority = priority(rng);
+        if (changed.ready) {
+            queue.move(&changed, changed.priority, new_priority);
+        }
+        changed.priority = new_priority;
+
+        BenchThread* next;
+        if (i % 4 != 0) {
+            // The running thread blocks
+            next = queue.pop_first();
+        } else if ((next = queue.pop_first_better(current->priority)) != nullptr) {
+            // The running thread is preempted
+            current->ready = true;
+            queue.push_front(current->priority, current);
+        }
+
+        if (next != nullptr) {
+            next->ready = false;
+            current = next;
+        }
+        result.checksum = result.checksum * 31 + current->id;
+    }
+
+    result.duration = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+} // namespace SchedulerBenchmark
+
+TEST_CASE("ThreadQueueList[Benchmark]", "[core][kernel][.benchmark]") {
+    using namespace SchedulerBenchmark;
+
+    const Result deque = RunScheduling<DequeQueueList>();
+    const Result bit_mask =
+        RunScheduling<Common::ThreadQueueList<BenchThread*, NUM_PRIORITIES>>();
+
+    // Both queues have to schedule the threads in the same order
+    REQUIRE(deque.checksum == bit_mask.checksum);
+
+    const auto per_reschedule = [](const Result& result) {
+        return static_cast<double>(result.duration.count()) / NUM_RESCHEDULES;
+    };
+    WARN(fmt::format("deque queues: {:.1f} ns per reschedule, bit mask: {:.1f} ns per reschedule",
+                     per_reschedule(deque), per_reschedule(bit_mask)));
+}
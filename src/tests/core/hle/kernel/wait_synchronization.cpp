@@ -0,0 +1,310 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "core/arm/arm_interface.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+
+namespace WaitSynchronizationTest {
+
+using namespace Kernel;
+
+/// CPU that never runs, the threads are only put to sleep and woken up
+class TestCPU final : public ARM_Interface {
+public:
+    class Context final : public ThreadContext {
+    public:
+        void Reset() override {}
+        u32 GetCpuRegister(std::size_t index) const override {
+            return 0;
+        }
+        void SetCpuRegister(std::size_t index, u32 value) override {}
+        u32 GetCpsr() const override {
+            return 0;
+        }
+        void SetCpsr(u32 value) override {}
+        u32 GetFpuRegister(std::size_t index) const override {
+            return 0;
+        }
+        void SetFpuRegister(std::size_t index, u32 value) override {}
+        u32 GetFpscr() const override {
+            return 0;
+        }
+        void SetFpscr(u32 value) override {}
+        u32 GetFpexc() const override {
+            return 0;
+        }
+        void SetFpexc(u32 value) override {}
+    };
+
+    explicit TestCPU(std::shared_ptr<Core::Timing::Timer> timer) : ARM_Interface(0, timer) {}
+
+    void Run() override {}
+    void Step() override {}
+    void ClearInstructionCache() override {}
+    void InvalidateCacheRange(u32 start_address, std::size_t length) override {}
+    void SetPageTable(Memory::PageTable* page_table) override {}
+    void SetPC(u32 addr) override {}
+    u32 GetPC() const override {
+        return 0;
+    }
+    u32 GetReg(int index) const override {
+        return 0;
+    }
+    void SetReg(int index, u32 value) override {}
+    u32 GetVFPReg(int index) const override {
+        return 0;
+    }
+    void SetVFPReg(int index, u32 value) override {}
+    u32 GetVFPSystemReg(VFPSystemRegister reg) const override {
+        return 0;
+    }
+    void SetVFPSystemReg(VFPSystemRegister reg, u32 value) override {}
+    u32 GetCPSR() const override {
+        return 0;
+    }
+    void SetCPSR(u32 cpsr) override {}
+    u32 GetCP15Register(CP15Register reg) const override {
+        return 0;
+    }
+    void SetCP15Register(CP15Register reg, u32 value) override {}
+    std::unique_ptr<ThreadContext> NewContext() const override {
+        return std::make_unique<Context>();
+    }
+    void SaveContext(const std::unique_ptr<ThreadContext>& ctx) override {}
+    void LoadContext(const std::unique_ptr<ThreadContext>& ctx) override {}
+    void PrepareReschedule() override {}
+    void PurgeState() override {}
+
+protected:
+    Memory::PageTable* GetPageTable() const override {
+        return nullptr;
+    }
+};
+
+/// Wake-up of a thread, with the index of the object that woke it up, or -1 for a wait for all
+struct WakeUpRecord {
+    Thread* thread;
+    s32 index;
+
+    bool operator==(const WakeUpRecord& other) const {
+        return thread == other.thread && index == other.index;
+    }
+};
+
+class RecordingCallback final : public WakeupCallback {
+public:
+    explicit RecordingCallback(std::vector<WakeUpRecord>& wake_ups) : wake_ups(wake_ups) {}
+
+    void WakeUp(ThreadWakeupReason reason, std::shared_ptr<Thread> thread,
+                std::shared_ptr<WaitObject> object) override {
+        REQUIRE(reason == ThreadWakeupReason::Signal);
+        const s32 index =
+            thread->IsSleepingOnWaitAll() ? -1 : thread->GetWaitObjectIndex(object.get());
+        wake_ups.push_back({thread.get(), index});
+    }
+
+private:
+    std::vector<WakeUpRecord>& wake_ups;
+};
+
+struct TestKernel {
+    TestKernel() : cpu(timing.GetTimer(0)), kernel(memory, timing, 0, 0) {
+        for (u32 i = 0; i < 4; ++i) {
+            kernel.GetThreadManager(i).SetCPU(&cpu);
+        }
+        kernel.Initialize(kernel.CreateProcess(kernel.CreateCodeSet("", 0)), &cpu);
+    }
+
+    std::shared_ptr<Thread> MakeThread(u32 priority) {
+        auto thread = std::make_shared<Thread>(kernel, 0);
+        thread->nominal_priority = thread->current_priority = priority;
+        thread->status = ThreadStatus::Running;
+        threads.push_back(thread);
+        return thread;
+    }
+
+    /// Puts the thread to sleep on the objects, like WaitSynchronizationN does when they aren't
+    /// available
+    void Wait(const std::shared_ptr<Thread>& thread,
+              std::vector<std::shared_ptr<WaitObject>> objects, bool wait_all) {
+        thread->status = wait_all ? ThreadStatus::WaitSynchAll : ThreadStatus::WaitSynchAny;
+        for (auto& object : objects) {
+            object->AddWaitingThread(thread);
+        }
+        thread->wait_objects = std::move(objects);
+        thread->wakeup_callback = std::make_shared<RecordingCallback>(wake_ups);
+    }
+
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    TestCPU cpu;
+    KernelSystem kernel;
+    std::vector<std::shared_ptr<Thread>> threads;
+    std::vector<WakeUpRecord> wake_ups;
+};
+
+} // namespace WaitSynchronizationTest
+
+TEST_CASE("WaitSynchronizationN[WaitAnyPriority]", "[core][kernel]") {
+    using namespace WaitSynchronizationTest;
+
+    TestKernel test;
+    auto event = test.kernel.CreateEvent(ResetType::Sticky);
+    const auto low = test.MakeThread(40);
+    const auto high = test.MakeThread(20);
+    const auto middle_first = test.MakeThread(30);
+    const auto middle_second = test.MakeThread(30);
+    for (const auto& thread : {low, high, middle_first, middle_second}) {
+        test.Wait(thread, {event}, false);
+    }
+    const std::vector<std::shared_ptr<Thread>> waiting{high, middle_first, middle_second, low};
+    REQUIRE(event->GetWaitingThreads() == waiting);
+
+    // The threads of the same priority wake up in the order they started to wait
+    event->Signal();
+    const std::vector<WakeUpRecord> wake_ups{
+        {high.get(), 0}, {middle_first.get(), 0}, {middle_second.get(), 0}, {low.get(), 0}};
+    REQUIRE(test.wake_ups == wake_ups);
+    REQUIRE(event->GetWaitingThreads().empty());
+    for (const auto& thread : {low, high, middle_first, middle_second}) {
+        REQUIRE(thread->status == ThreadStatus::Ready);
+        REQUIRE(thread->wait_objects.empty());
+    }
+}
+
+TEST_CASE("WaitSynchronizationN[WaitAnyAcquire]", "[core][kernel]") {
+    using namespace WaitSynchronizationTest;
+
+    TestKernel test;
+    auto event = test.kernel.CreateEvent(ResetType::OneShot);
+    auto semaphore = test.kernel.CreateSemaphore(0, 2).Unwrap();
+    const auto low = test.MakeThread(40);
+    const auto high = test.MakeThread(20);
+    const auto middle = test.MakeThread(30);
+    test.Wait(low, {event, semaphore}, false);
+    test.Wait(high, {event, semaphore}, false);
+    test.Wait(middle, {semaphore}, false);
+
+    // Only the best threads acquire the slots, the other one keeps waiting on both objects
+    semaphore->Release(2);
+    const std::vector<WakeUpRecord> wake_ups{{high.get(), 1}, {middle.get(), 0}};
+    REQUIRE(test.wake_ups == wake_ups);
+    REQUIRE(semaphore->available_count == 0);
+    REQUIRE(low->status == ThreadStatus::WaitSynchAny);
+    const std::vector<std::shared_ptr<Thread>> waiting{low};
+    REQUIRE(event->GetWaitingThreads() == waiting);
+    REQUIRE(semaphore->GetWaitingThreads() == waiting);
+
+    // The one-shot event is acquired by the waking thread
+    event->Signal();
+    REQUIRE(test.wake_ups.size() == 3);
+    REQUIRE(test.wake_ups.back().thread == low.get());
+    REQUIRE(test.wake_ups.back().index == 0);
+    REQUIRE(event->ShouldWait(low.get()));
+    REQUIRE(semaphore->GetWaitingThreads().empty());
+}
+
+TEST_CASE("WaitSynchronizationN[WaitAll]", "[core][kernel]") {
+    using namespace WaitSynchronizationTest;
+
+    TestKernel test;
+    auto first = test.kernel.CreateEvent(ResetType::OneShot);
+    auto second = test.kernel.CreateEvent(ResetType::OneShot);
+    const auto thread = test.MakeThread(30);
+    test.Wait(thread, {first, second}, true);
+    REQUIRE(thread->remaining_wait_objects == 2);
+
+    // An object isn't acquired until all of them are available
+    first->Signal();
+    REQUIRE(test.wake_ups.empty());
+    REQUIRE(!first->ShouldWait(thread.get()));
+    REQUIRE(thread->remaining_wait_objects == 1);
+
+    // An object that was available but isn't anymore still has to be waited for
+    first->Clear();
+    second->Signal();
+    REQUIRE(test.wake_ups.empty());
+    REQUIRE(thread->status == ThreadStatus::WaitSynchAll);
+
+    first->Signal();
+    REQUIRE(test.wake_ups.size() == 1);
+    REQUIRE(test.wake_ups[0].thread == thread.get());
+    REQUIRE(test.wake_ups[0].index == -1);
+    REQUIRE(thread->status == ThreadStatus::Ready);
+    REQUIRE(thread->remaining_wait_objects == 0);
+    REQUIRE(first->ShouldWait(thread.get()));
+    REQUIRE(second->ShouldWait(thread.get()));
+    REQUIRE(first->GetWaitingThreads().empty());
+    REQUIRE(second->GetWaitingThreads().empty());
+}
+
+TEST_CASE("WaitSynchronizationN[WaitAllPriority]", "[core][kernel]") {
+    using namespace WaitSynchronizationTest;
+
+    TestKernel test;
+    auto event = test.kernel.CreateEvent(ResetType::Sticky);
+    auto semaphore = test.kernel.CreateSemaphore(0, 1).Unwrap();
+    const auto low = test.MakeThread(40);
+    const auto high = test.MakeThread(20);
+    const auto any = test.MakeThread(30);
+    test.Wait(low, {event, semaphore}, true);
+    test.Wait(high, {semaphore, event}, true);
+    test.Wait(any, {semaphore}, false);
+
+    event->Signal();
+    REQUIRE(test.wake_ups.empty());
+
+    // The slot goes to the best thread, whether it waits for all its objects or any
+    semaphore->Release(1);
+    semaphore->Release(1);
+    semaphore->Release(1);
+    const std::vector<WakeUpRecord> wake_ups{{high.get(), -1}, {any.get(), 0}, {low.get(), -1}};
+    REQUIRE(test.wake_ups == wake_ups);
+    REQUIRE(event->GetWaitingThreads().empty());
+}
+
+TEST_CASE("WaitSynchronizationN[SameObjectTwice]", "[core][kernel]") {
+    using namespace WaitSynchronizationTest;
+
+    TestKernel test;
+    auto event = test.kernel.CreateEvent(ResetType::OneShot);
+    auto other = test.kernel.CreateEvent(ResetType::OneShot);
+    const auto any = test.MakeThread(30);
+    const auto all = test.MakeThread(20);
+    test.Wait(any, {event, event}, false);
+    test.Wait(all, {event, other, event}, true);
+
+    // The threads are only linked once to the object
+    const std::vector<std::shared_ptr<Thread>> waiting{all, any};
+    REQUIRE(event->GetWaitingThreads() == waiting);
+    REQUIRE(all->remaining_wait_objects == 2);
+
+    // The thread waiting for all its objects counts the object once
+    other->Signal();
+    REQUIRE(all->remaining_wait_objects == 1);
+    event->Signal();
+    REQUIRE(all->remaining_wait_objects == 0);
+    REQUIRE(test.wake_ups.size() == 1);
+    REQUIRE(test.wake_ups[0].thread == all.get());
+    REQUIRE(event->GetWaitingThreads().size() == 1);
+    REQUIRE(event->GetWaitingThreads()[0] == any);
+
+    // The thread waiting for any of its objects wakes up once
+    event->Signal();
+    REQUIRE(test.wake_ups.size() == 2);
+    REQUIRE(test.wake_ups.back().thread == any.get());
+    REQUIRE(any->status == ThreadStatus::Ready);
+    REQUIRE(event->GetWaitingThreads().empty());
+}
@@ -0,0 +1,64 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <thread>
+#include "core/hle/latency_stats.h"
+
+namespace HLE {
+
+using namespace std::chrono_literals;
+
+TEST_CASE("LatencyStats::RecordSVC", "[core][hle]") {
+    LatencyStats stats;
+    stats.RecordSVC(0x24, 0ns);
+    stats.RecordSVC(0x24, 1ns);
+    stats.RecordSVC(0x24, 3ns);
+    stats.RecordSVC(0x24, 1500ns);
+    stats.RecordSVC(0x24, 10s);
+
+    const LatencyStats::Histogram histogram = stats.GetSVC(0x24);
+    REQUIRE(histogram.count == 5);
+    REQUIRE(histogram.total_ns == 10'000'001'504);
+    REQUIRE(histogram.max_ns == 10'000'000'000);
+    REQUIRE(histogram.buckets[0] == 2);
+    REQUIRE(histogram.buckets[1] == 1);
+    REQUIRE(histogram.buckets[10] == 1);
+    REQUIRE(histogram.buckets[LatencyStats::NUM_BUCKETS - 1] == 1);
+
+    REQUIRE(stats.GetSVC(0x25).count == 0);
+}
+
+TEST_CASE("LatencyStats::RecordCommand", "[core][hle]") {
+    LatencyStats stats;
+    const u32 read = stats.RegisterCommand("fs:USER", 0x080200C2, "OpenFile");
+    const u32 write = stats.RegisterCommand("fs:USER", 0x08030102, "OpenFileDirectly");
+    REQUIRE(read != write);
+
+    // Each thread records into its own slots, which are summed up when read
+    std::thread other([&] {
+        for (int i = 0; i < 1000; ++i) {
+            stats.RecordCommand(read, 100ns);
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        stats.RecordCommand(read, 100ns);
+    }
+    other.join();
+
+    REQUIRE(stats.GetCommand(read).count == 2000);
+    REQUIRE(stats.GetCommand(read).total_ns == 200000);
+    REQUIRE(stats.GetCommand(write).count == 0);
+
+    // Commands beyond the limit aren't recorded
+    for (u32 i = 2; i < LatencyStats::MAX_COMMANDS; ++i) {
+        stats.RegisterCommand("srv:", i, "");
+    }
+    REQUIRE(stats.RegisterCommand("srv:", 0, "") == LatencyStats::NO_COMMAND);
+    stats.RecordCommand(LatencyStats::NO_COMMAND, 100ns);
+}
+
+} // namespace HLE
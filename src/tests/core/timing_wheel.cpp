@@ -0,0 +1,148 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "core/core_timing.h"
+#include "core/timing_wheel.h"
+
+namespace TimingWheelTest {
+
+using Event = Core::TimingEvent;
+
+// Only the addresses of the types are used by the wheel
+static const Core::TimingEventType type_a{};
+static const Core::TimingEventType type_b{};
+
+static std::vector<Event> PopAllDue(Core::TimingWheel& wheel, s64 time) {
+    std::vector<Event> events;
+    Event event;
+    while (wheel.PopDue(time, event)) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+} // namespace TimingWheelTest
+
+TEST_CASE("TimingWheel[Order]", "[core]") {
+    using namespace TimingWheelTest;
+
+    Core::TimingWheel wheel;
+    REQUIRE(wheel.IsEmpty());
+
+    // Times on the bottom level, on the levels above, and past the top level
+    const std::vector<s64> times{5, 1000, 17, 1 << 20, 5, 1LL << 40, 64 * 16, 3};
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        wheel.Schedule({times[i], i, i, &type_a});
+    }
+    REQUIRE(wheel.NextTime() == 3);
+
+    const auto events = PopAllDue(wheel, 1LL << 40);
+    REQUIRE(wheel.IsEmpty());
+    REQUIRE(events.size() == times.size());
+    REQUIRE(std::is_sorted(events.begin(), events.end()));
+    // The events scheduled for the same time come out in the order they were scheduled
+    REQUIRE(events[1].userdata == 0);
+    REQUIRE(events[2].userdata == 4);
+}
+
+TEST_CASE("TimingWheel[NotDue]", "[core]") {
+    using namespace TimingWheelTest;
+
+    Core::TimingWheel wheel;
+    wheel.Schedule({100, 0, 0, &type_a});
+    wheel.Schedule({100000, 1, 1, &type_a});
+
+    REQUIRE(PopAllDue(wheel, 99).empty());
+    REQUIRE(wheel.NextTime() == 100);
+    REQUIRE(PopAllDue(wheel, 100).size() == 1);
+    REQUIRE(PopAllDue(wheel, 99999).empty());
+    REQUIRE(wheel.NextTime() == 100000);
+
+    // An event scheduled in the past is due at once
+    wheel.Schedule({50, 2, 2, &type_b});
+    const auto events = PopAllDue(wheel, 99999);
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].userdata == 2);
+}
+
+TEST_CASE("TimingWheel[Unschedule]", "[core]") {
+    using namespace TimingWheelTest;
+
+    Core::TimingWheel wheel;
+    wheel.Schedule({10, 0, 1, &type_a});
+    wheel.Schedule({20, 1, 2, &type_a});
+    wheel.Schedule({30, 2, 1, &type_a});
+    wheel.Schedule({40, 3, 1, &type_b});
+    wheel.Schedule({1 << 24, 4, 2, &type_b});
+
+    wheel.Unschedule(&type_a, 1);
+    auto events = PopAllDue(wheel, 30);
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].time == 20);
+
+    wheel.Remove(&type_b);
+    REQUIRE(wheel.IsEmpty());
+    REQUIRE(PopAllDue(wheel, 1 << 25).empty());
+
+    // The released nodes are reused
+    wheel.Schedule({1 << 26, 5, 3, &type_b});
+    events = PopAllDue(wheel, 1 << 26);
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].userdata == 3);
+}
+
+TEST_CASE("TimingWheel[Random]", "[core]") {
+    using namespace TimingWheelTest;
+
+    std::mt19937_64 rng(0x5eed);
+    Core::TimingWheel wheel;
+    std::vector<Event> reference;
+    s64 now = 0;
+    u64 fifo_order = 0;
+
+    for (int step = 0; step < 2000; ++step) {
+        // Mostly near events, some far ones to go through all the levels
+        const int num_scheduled = static_cast<int>(rng() % 4);
+        for (int i = 0; i < num_scheduled; ++i) {
+            const u32 range_bits = rng() % 8 == 0 ? 40 : 16;
+            const s64 time = now + static_cast<s64>(rng() & ((u64{1} << range_bits) - 1));
+            const Event event{time, fifo_order++, rng() % 8, rng() % 2 ? &type_a : &type_b};
+            wheel.Schedule(event);
+            reference.push_back(event);
+        }
+
+        if (rng() % 16 == 0) {
+            const auto* type = rng() % 2 ? &type_a : &type_b;
+            const u64 userdata = rng() % 8;
+            wheel.Unschedule(type, userdata);
+            reference.erase(std::remove_if(reference.begin(), reference.end(),
+                                           [&](const Event& e) {
+                                               return e.type == type && e.userdata == userdata;
+                                           }),
+                            reference.end());
+        }
+
+        REQUIRE(wheel.IsEmpty() == reference.empty());
+        if (!reference.empty()) {
+            REQUIRE(wheel.NextTime() ==
+                    std::min_element(reference.begin(), reference.end())->time);
+        }
+
+        now += static_cast<s64>(rng() % 20000);
+        std::sort(reference.begin(), reference.end());
+        const auto due_end = std::find_if(reference.begin(), reference.end(),
+                                          [&](const Event& e) { return e.time > now; });
+        const auto events = PopAllDue(wheel, now);
+        REQUIRE(events.size() == static_cast<std::size_t>(due_end - reference.begin()));
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            REQUIRE(events[i].fifo_order == reference[i].fifo_order);
+        }
+        reference.erase(reference.begin(), due_end);
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "common/file_util.h"
+#include "core/hw/gpu.h"
+#include "core/memory.h"
+#include "core/tracer/citrace.h"
+#include "trace_replay/trace_player.h"
+#include "video_core/command_processor.h"
+#include "video_core/regs.h"
+
+namespace TracePlayerTest {
+
+/// Builds a trace with the data appended after the header, followed by the stream
+class TraceBuilder {
+public:
+    TraceBuilder() {
+        std::memcpy(header.magic, CiTrace::CTHeader::ExpectedMagicWord(), 4);
+        header.version = CiTrace::CTHeader::ExpectedVersion();
+        header.header_size = sizeof(header);
+        data.resize(sizeof(header));
+    }
+
+    /// Appends the words to the trace, and loads them at the physical address during the replay
+    void LoadMemory(PAddr address, const std::vector<u32>& words) {
+        CiTrace::CTStreamElement element{};
+        element.type = CiTrace::MemoryLoad;
+        element.memory_load.file_offset = static_cast<u32>(data.size());
+        element.memory_load.size = static_cast<u32>(words.size() * sizeof(u32));
+        element.memory_load.physical_address = address;
+        stream.push_back(element);
+
+        data.resize(data.size() + words.size() * sizeof(u32));
+        std::memcpy(data.data() + element.memory_load.file_offset, words.data(),
+                    words.size() * sizeof(u32));
+    }
+
+    void WriteGPURegister(u32 index, u32 value) {
+        CiTrace::CTStreamElement element{};
+        element.type = CiTrace::RegisterWrite;
+        element.register_write.physical_address =
+            TraceReplay::GPU_REGS_PADDR + index * static_cast<u32>(sizeof(u32));
+        element.register_write.size = CiTrace::CTRegisterWrite::SIZE_32;
+        element.register_write.value = value;
+        stream.push_back(element);
+    }
+
+    void EndFrame() {
+        CiTrace::CTStreamElement element{};
+        element.type = CiTrace::FrameMarker;
+        stream.push_back(element);
+    }
+
+    void Write(const std::string& filename) {
+        header.stream_offset = static_cast<u32>(data.size());
+        header.stream_size = static_cast<u32>(stream.size());
+        std::memcpy(data.data(), &header, sizeof(header));
+
+        FileUtil::IOFile file(filename, "wb");
+        REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+        REQUIRE(file.WriteArray(stream.data(), stream.size()) == stream.size());
+    }
+
+private:
+    CiTrace::CTHeader header{};
+    std::vector<u8> data;
+    std::vector<CiTrace::CTStreamElement> stream;
+};
+
+} // namespace TracePlayerTest
+
+TEST_CASE("TracePlayer[InterruptRequest]", "[trace_replay]") {
+    using namespace TracePlayerTest;
+
+    // A command list that only requests the P3D interrupt, as the lists of games end
+    const Pica::CommandProcessor::CommandHeader irq_header{
+        PICA_REG_INDEX(trigger_irq) | (0xF << 16)};
+    const std::vector<u32> command_list{0x12345678, irq_header.hex};
+
+    TraceBuilder builder;
+    builder.LoadMemory(Memory::FCRAM_PADDR, command_list);
+    builder.WriteGPURegister(GPU_REG_INDEX(command_processor_config.size),
+                             static_cast<u32>(command_list.size() * sizeof(u32)));
+    builder.WriteGPURegister(GPU_REG_INDEX(command_processor_config.address),
+                             Memory::FCRAM_PADDR >> 3);
+    builder.WriteGPURegister(GPU_REG_INDEX(command_processor_config.trigger), 1);
+    builder.EndFrame();
+
+    const std::string filename = "trace_player_interrupt_request.ctf";
+    builder.Write(filename);
+
+    Memory::MemorySystem memory;
+    TraceReplay::TracePlayer player(memory);
+    REQUIRE(player.Load(filename));
+
+    const auto stats = player.Replay();
+    FileUtil::Delete(filename);
+
+    REQUIRE(stats.frames.size() == 1);
+    REQUIRE(stats.frames[0].command_lists == 1);
+    REQUIRE(stats.skipped_interrupts == 1);
+}
+
+TEST_CASE("TracePlayer[MemoryLoadOutOfRegion]", "[trace_replay]") {
+    using namespace TracePlayerTest;
+
+    // The load starts at the end of VRAM and would overflow into the memory that follows it
+    TraceBuilder builder;
+    builder.LoadMemory(Memory::VRAM_PADDR_END - sizeof(u32), {0xFFFFFFFF, 0xFFFFFFFF});
+    builder.LoadMemory(Memory::FCRAM_PADDR, {0xFFFFFFFF});
+    builder.EndFrame();
+
+    const std::string filename = "trace_player_memory_load_out_of_region.ctf";
+    builder.Write(filename);
+
+    Memory::MemorySystem memory;
+    TraceReplay::TracePlayer player(memory);
+    REQUIRE(player.Load(filename));
+
+    player.Replay();
+    FileUtil::Delete(filename);
+
+    u32 vram_end = 0;
+    std::memcpy(&vram_end, memory.GetPhysicalPointer(Memory::VRAM_PADDR_END - sizeof(u32)),
+                sizeof(u32));
+    REQUIRE(vram_end == 0);
+    u32 fcram = 0;
+    std::memcpy(&fcram, memory.GetPhysicalPointer(Memory::FCRAM_PADDR), sizeof(u32));
+    REQUIRE(fcram == 0xFFFFFFFF);
+}
@@ -0,0 +1,130 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader_interpreter.h"
+
+using float24 = Pica::float24;
+using InterpreterEngine = Pica::Shader::InterpreterEngine;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+static void AssembleShader(std::initializer_list<nihstro::InlineAsm> code,
+                           Pica::Shader::ShaderSetup& setup) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    std::transform(shbin.program.begin(), shbin.program.end(), setup.program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   setup.swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    setup.MarkProgramCodeDirty();
+    setup.MarkSwizzleDataDirty();
+}
+
+static float RunShader(InterpreterEngine& engine, Pica::Shader::ShaderSetup& setup, float input) {
+    Pica::Shader::UnitState shader_unit;
+    shader_unit.registers.input[0].x = float24::FromFloat32(input);
+
+    engine.SetupBatch(setup, 0);
+    engine.Run(setup, shader_unit);
+    return shader_unit.registers.output[0].x.ToFloat32();
+}
+
+TEST_CASE("Pre-decoded interpreter runs the program", "[video_core][shader][shader_interpreter]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_temp_dest = DestRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    InterpreterEngine engine;
+    Pica::Shader::ShaderSetup setup;
+    AssembleShader(
+        {
+            // clang-format off
+            {OpCode::Id::LG2, sh_temp_dest, sh_input},
+            {OpCode::Id::MUL, sh_temp_dest, sh_temp, sh_input},
+            {OpCode::Id::EX2, sh_output, sh_temp},
+            {OpCode::Id::END},
+            // clang-format on
+        },
+        setup);
+
+    REQUIRE(RunShader(engine, setup, 2.f) == Approx(4.f));
+    REQUIRE(RunShader(engine, setup, 3.f) == Approx(27.f));
+}
+
+TEST_CASE("Pre-decoded interpreter follows program changes",
+          "[video_core][shader][shader_interpreter]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    InterpreterEngine engine;
+    Pica::Shader::ShaderSetup setup;
+    AssembleShader(
+        {
+            // clang-format off
+            {OpCode::Id::EX2, sh_output, sh_input},
+            {OpCode::Id::END},
+            // clang-format on
+        },
+        setup);
+    REQUIRE(RunShader(engine, setup, 3.f) == Approx(8.f));
+
+    AssembleShader(
+        {
+            // clang-format off
+            {OpCode::Id::MOV, sh_output, sh_input},
+            {OpCode::Id::END},
+            // clang-format on
+        },
+        setup);
+    REQUIRE(RunShader(engine, setup, 3.f) == Approx(3.f));
+}
+
+TEST_CASE("Batches carry the registers between vertices",
+          "[video_core][shader][shader_interpreter]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_temp_dest = DestRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    InterpreterEngine engine;
+    Pica::Shader::ShaderSetup setup;
+    // The temporary isn't written before it is read, so it accumulates the inputs
+    AssembleShader(
+        {
+            // clang-format off
+            {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input},
+            {OpCode::Id::MOV, sh_output, sh_temp},
+            {OpCode::Id::END},
+            // clang-format on
+        },
+        setup);
+    engine.SetupBatch(setup, 0);
+
+    constexpr std::array<float, 5> inputs{1.f, 2.f, 4.f, 8.f, 16.f};
+    Pica::Shader::UnitState unit;
+    unit.registers.temporary[0].x = float24::FromFloat32(0.f);
+    std::array<Pica::Shader::UnitState, inputs.size()> units;
+    units[0] = unit;
+
+    std::array<float, inputs.size()> expected;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        unit.registers.input[0].x = float24::FromFloat32(inputs[i]);
+        engine.Run(setup, unit);
+        expected[i] = unit.registers.output[0].x.ToFloat32();
+        units[i].registers.input[0].x = float24::FromFloat32(inputs[i]);
+    }
+
+    engine.RunBatch(setup, units.data(), units.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        REQUIRE(units[i].registers.output[0].x.ToFloat32() == expected[i]);
+    }
+    REQUIRE(expected.back() == Approx(31.f));
+}
@@ -7,28 +7,34 @@
 #include <memory>
 #include <catch2/catch.hpp>
 #include <nihstro/inline_assembly.h>
+#include "common/x64/cpu_detect.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 
 using float24 = Pica::float24;
+using JitBatchShader = Pica::Shader::JitBatchShader;
 using JitShader = Pica::Shader::JitShader;
 
 using DestRegister = nihstro::DestRegister;
 using OpCode = nihstro::OpCode;
 using SourceRegister = nihstro::SourceRegister;
 
-static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
+static void AssembleShader(std::initializer_list<nihstro::InlineAsm> code,
+                           Pica::Shader::ShaderSetup& setup) {
     const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
 
-    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
-    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
-
-    std::transform(shbin.program.begin(), shbin.program.end(), program_code.begin(),
-                   [](const auto& x) { return x.hex; });
-    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+    std::transform(shbin.program.begin(), shbin.program.end(), setup.program_code.begin(),
                    [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   setup.swizzle_data.begin(), [](const auto& x) { return x.hex; });
+}
+
+static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
+    Pica::Shader::ShaderSetup setup;
+    AssembleShader(code, setup);
 
     auto shader = std::make_unique<JitShader>();
-    shader->Compile(&program_code, &swizzle_data);
+    shader->Compile(&setup.program_code, &setup.swizzle_data);
 
     return shader;
 }
@@ -89,3 +95,113 @@ TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
     REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
     REQUIRE(std::isinf(shader.Run(800.f)));
 }
+
+TEST_CASE("Deserialized shader matches the compiled one", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::LG2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+    const float expected = shader.Run(64.f);
+
+    // Load the image in a shader at another address
+    const Pica::Shader::JitShaderImage image = shader.shader->Serialize();
+    shader.shader = std::make_unique<JitShader>();
+    REQUIRE(shader.shader->Deserialize(image));
+    REQUIRE(shader.Run(64.f) == expected);
+
+    Pica::Shader::JitShaderImage truncated = image;
+    truncated.code.resize(8);
+    REQUIRE_FALSE(shader.shader->Deserialize(truncated));
+}
+
+TEST_CASE("Batch shader matches the per-vertex JIT", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_temp_dest = DestRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+    const std::initializer_list<nihstro::InlineAsm> code = {
+        // clang-format off
+        {OpCode::Id::LG2, sh_temp_dest, sh_input},
+        {OpCode::Id::MUL, sh_temp_dest, sh_temp, sh_input},
+        {OpCode::Id::EX2, sh_output, sh_temp},
+        {OpCode::Id::END},
+        // clang-format on
+    };
+
+    Pica::Shader::ShaderSetup setup;
+    AssembleShader(code, setup);
+
+    const auto batch_shader = JitBatchShader::Compile(setup.program_code, setup.swizzle_data, 0);
+    if (!batch_shader) {
+        // The host has no AVX, vertices always run one by one
+        return;
+    }
+
+    const auto shader = CompileShader(code);
+    const std::array<float, 7> inputs{NAN, -1.f, 0.f, 0.5f, 4.f, 64.f, 1.e24f};
+    std::array<Pica::Shader::UnitState, 7> units;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        units[i].registers.input[0].x = float24::FromFloat32(inputs[i]);
+    }
+
+    // Seven vertices leave a partial batch with both 4 and 8 lanes
+    const std::size_t lanes = batch_shader->GetLaneCount();
+    for (std::size_t first = 0; first < inputs.size(); first += lanes) {
+        const std::size_t count = std::min(lanes, inputs.size() - first);
+        batch_shader->Run(setup, &units[first], count);
+    }
+
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        Pica::Shader::UnitState unit;
+        unit.registers.input[0].x = float24::FromFloat32(inputs[i]);
+        shader->Run(setup, unit, 0);
+
+        const float expected = unit.registers.output[0].x.ToFloat32();
+        const float result = units[i].registers.output[0].x.ToFloat32();
+        if (std::isnan(expected)) {
+            REQUIRE(std::isnan(result));
+        } else {
+            REQUIRE(result == expected);
+        }
+    }
+}
+
+TEST_CASE("Batch shader is not compiled for programs reading the previous vertex",
+          "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_temp_dest = DestRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    Pica::Shader::ShaderSetup setup;
+    AssembleShader(
+        {
+            // clang-format off
+            {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input},
+            {OpCode::Id::MOV, sh_output, sh_temp},
+            {OpCode::Id::END},
+            // clang-format on
+        },
+        setup);
+    REQUIRE(JitBatchShader::Compile(setup.program_code, setup.swizzle_data, 0) == nullptr);
+
+    // Writing the temporary first makes the vertices independent
+    AssembleShader(
+        {
+            // clang-format off
+            {OpCode::Id::MOV, sh_temp_dest, sh_input},
+            {OpCode::Id::ADD, sh_temp_dest, sh_temp, sh_input},
+            {OpCode::Id::MOV, sh_output, sh_temp},
+            {OpCode::Id::END},
+            // clang-format on
+        },
+        setup);
+    const auto batch_shader = JitBatchShader::Compile(setup.program_code, setup.swizzle_data, 0);
+    const auto& caps = Common::GetCPUCaps();
+    REQUIRE((batch_shader != nullptr) == (caps.avx || caps.avx2));
+}
@@ -0,0 +1,98 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <catch2/catch.hpp>
+#include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/swrasterizer/span.h"
+#include "video_core/swrasterizer/texturing.h"
+
+using namespace Pica;
+using namespace Pica::Rasterizer;
+
+using Operation = TexturingRegs::TevStageConfig::Operation;
+using BlendEquation = FramebufferRegs::BlendEquation;
+
+namespace {
+
+/// Fills a span with a fixed first input and a run of consecutive values for the others
+struct SpanInputs {
+    explicit SpanInputs(unsigned row, unsigned first) {
+        for (unsigned i = 0; i < SPAN_SIZE; ++i) {
+            a[i] = static_cast<u8>(row);
+            b[i] = static_cast<u8>(first + i);
+            c[i] = static_cast<u8>((first + i) * 7 + row);
+        }
+    }
+
+    SpanChannel a;
+    SpanChannel b;
+    SpanChannel c;
+};
+
+void CheckCombine(const SpanKernels& kernels) {
+    for (unsigned op_index = 0; op_index <= static_cast<unsigned>(Operation::AddThenMultiply);
+         ++op_index) {
+        const auto op = static_cast<Operation>(op_index);
+        if (!IsSpanOperation(op))
+            continue;
+
+        for (unsigned shift = 0; shift < 3; ++shift) {
+            for (unsigned row = 0; row < 256; row += 3) {
+                for (unsigned first = 0; first < 256; first += SPAN_SIZE) {
+                    const SpanInputs in(row, first);
+                    SpanChannel out;
+                    kernels.combine(op, in.a.data(), in.b.data(), in.c.data(), out.data(), shift);
+
+                    for (std::size_t i = 0; i < SPAN_SIZE; ++i) {
+                        const std::array<u8, 3> alpha_input{{in.a[i], in.b[i], in.c[i]}};
+                        const unsigned expected =
+                            std::min(255u, AlphaCombine(op, alpha_input) * (1u << shift));
+                        REQUIRE(out[i] == expected);
+
+                        const Common::Vec3<u8> color_input[3] = {
+                            {in.a[i], 0, 0}, {in.b[i], 0, 0}, {in.c[i], 0, 0}};
+                        REQUIRE(ColorCombine(op, color_input).r() == AlphaCombine(op, alpha_input));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CheckBlend(const SpanKernels& kernels) {
+    for (unsigned eq_index = 0; eq_index <= static_cast<unsigned>(BlendEquation::Max);
+         ++eq_index) {
+        const auto equation = static_cast<BlendEquation>(eq_index);
+
+        for (unsigned row = 0; row < 256; row += 3) {
+            for (unsigned first = 0; first < 256; first += SPAN_SIZE) {
+                const SpanInputs src(row, first);
+                const SpanInputs dest(255 - row, 255 - first - SPAN_SIZE + 1);
+                SpanChannel out;
+                kernels.blend(equation, src.a.data(), src.b.data(), dest.c.data(), dest.b.data(),
+                              out.data());
+
+                for (std::size_t i = 0; i < SPAN_SIZE; ++i) {
+                    const auto expected = EvaluateBlendEquation(
+                        {src.a[i], 0, 0, 0}, {src.b[i], 0, 0, 0}, {dest.c[i], 0, 0, 0},
+                        {dest.b[i], 0, 0, 0}, equation);
+                    REQUIRE(out[i] == expected.r());
+                }
+            }
+        }
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Span combine matches the scalar combiner", "[video_core][swrasterizer]") {
+    CheckCombine(GetGenericSpanKernels());
+    CheckCombine(GetSpanKernels());
+}
+
+TEST_CASE("Span blend matches the scalar blend equation", "[video_core][swrasterizer]") {
+    CheckBlend(GetGenericSpanKernels());
+    CheckBlend(GetSpanKernels());
+}
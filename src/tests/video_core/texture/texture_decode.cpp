@@ -0,0 +1,47 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/texture/texture_decode.h"
+
+using Pica::TexturingRegs;
+using Pica::Texture::TextureInfo;
+
+TEST_CASE("DecodeTexture matches LookupTexture", "[video_core][texture]") {
+    constexpr unsigned int width = 16;
+    constexpr unsigned int height = 8;
+
+    // Every known format except the unused values 14 and 15
+    for (u32 format = 0; format <= static_cast<u32>(TexturingRegs::TextureFormat::ETC1A4);
+         ++format) {
+        TextureInfo info{};
+        info.width = width;
+        info.height = height;
+        info.format = static_cast<TexturingRegs::TextureFormat>(format);
+        info.SetDefaultStride();
+
+        std::vector<u8> data(info.stride * (height / 8));
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<u8>(i * 97 + format * 13 + (i >> 3));
+        }
+
+        for (bool disable_alpha : {false, true}) {
+            std::vector<Common::Vec4<u8>> decoded(width * height);
+            Pica::Texture::DecodeTexture(data.data(), info, decoded.data(), disable_alpha);
+
+            for (unsigned int y = 0; y < height; ++y) {
+                for (unsigned int x = 0; x < width; ++x) {
+                    const auto expected =
+                        Pica::Texture::LookupTexture(data.data(), x, y, info, disable_alpha);
+                    const auto& texel = decoded[y * width + x];
+                    REQUIRE(texel.r() == expected.r());
+                    REQUIRE(texel.g() == expected.g());
+                    REQUIRE(texel.b() == expected.b());
+                    REQUIRE(texel.a() == expected.a());
+                }
+            }
+        }
+    }
+}
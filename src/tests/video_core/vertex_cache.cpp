@@ -0,0 +1,37 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "video_core/vertex_cache.h"
+
+using Pica::VertexCache;
+
+TEST_CASE("VertexCache looks up inserted vertices", "[video_core][vertex_cache]") {
+    VertexCache<int, 8> cache;
+
+    REQUIRE(cache.Lookup(0) == nullptr);
+
+    cache.Insert(3) = 30;
+    cache.Insert(4) = 40;
+    REQUIRE(cache.Lookup(3) != nullptr);
+    REQUIRE(*cache.Lookup(3) == 30);
+    REQUIRE(*cache.Lookup(4) == 40);
+    REQUIRE(cache.Lookup(5) == nullptr);
+
+    // 11 maps to the same slot as 3 and replaces it
+    cache.Insert(11) = 110;
+    REQUIRE(cache.Lookup(3) == nullptr);
+    REQUIRE(*cache.Lookup(11) == 110);
+}
+
+TEST_CASE("VertexCache::Clear invalidates all entries", "[video_core][vertex_cache]") {
+    VertexCache<int, 8> cache;
+
+    cache.Insert(1) = 10;
+    cache.Clear();
+    REQUIRE(cache.Lookup(1) == nullptr);
+
+    cache.Insert(1) = 20;
+    REQUIRE(*cache.Lookup(1) == 20);
+}
@@ -0,0 +1,94 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <catch2/catch.hpp>
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+using Pica::PipelineRegs;
+using Pica::VertexLoader;
+using Pica::VertexLoaderJit;
+using Format = PipelineRegs::VertexAttributeFormat;
+
+TEST_CASE("VertexLoaderJit converts every format", "[video_core][vertex_loader]") {
+    const std::array<s8, 2 * 3> bytes{-128, 0, 127, 1, -1, 2};
+    const std::array<u8, 2 * 4> ubytes{0, 1, 2, 255, 10, 20, 30, 40};
+    const std::array<s16, 2 * 2> shorts{-32768, 32767, 1234, -4321};
+    const std::array<float, 2 * 1> floats{0.5f, -3.25f};
+
+    VertexLoader::Layout layout{};
+    layout.num_total_attributes = 5;
+    layout.formats = {Format::BYTE, Format::UBYTE, Format::SHORT, Format::FLOAT};
+    layout.elements = {3, 4, 2, 1};
+    layout.strides = {3, 4, 4, 4};
+    layout.is_default[4] = true;
+
+    Pica::g_state.input_default_attributes.attr[4] = {
+        Pica::float24::FromFloat32(7.0f), Pica::float24::FromFloat32(8.0f),
+        Pica::float24::FromFloat32(9.0f), Pica::float24::FromFloat32(10.0f)};
+
+    const std::array<const u8*, 16> sources{
+        reinterpret_cast<const u8*>(bytes.data()), ubytes.data(),
+        reinterpret_cast<const u8*>(shorts.data()), reinterpret_cast<const u8*>(floats.data())};
+
+    // Load the vertices in reverse order to check that the indices are honored
+    const std::array<u32, 2> vertices{1, 0};
+    std::array<Pica::Shader::AttributeBuffer, 2> output{};
+
+    const VertexLoaderJit jit(layout);
+    jit.Load(sources.data(), vertices.data(), vertices.size(), output.data());
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const u32 v = vertices[i];
+        const auto& attr = output[i].attr;
+
+        REQUIRE(attr[0].x.ToFloat32() == bytes[v * 3 + 0]);
+        REQUIRE(attr[0].y.ToFloat32() == bytes[v * 3 + 1]);
+        REQUIRE(attr[0].z.ToFloat32() == bytes[v * 3 + 2]);
+        REQUIRE(attr[0].w.ToFloat32() == 1.0f);
+
+        REQUIRE(attr[1].x.ToFloat32() == ubytes[v * 4 + 0]);
+        REQUIRE(attr[1].y.ToFloat32() == ubytes[v * 4 + 1]);
+        REQUIRE(attr[1].z.ToFloat32() == ubytes[v * 4 + 2]);
+        REQUIRE(attr[1].w.ToFloat32() == ubytes[v * 4 + 3]);
+
+        REQUIRE(attr[2].x.ToFloat32() == shorts[v * 2 + 0]);
+        REQUIRE(attr[2].y.ToFloat32() == shorts[v * 2 + 1]);
+        REQUIRE(attr[2].z.ToFloat32() == 0.0f);
+        REQUIRE(attr[2].w.ToFloat32() == 1.0f);
+
+        REQUIRE(attr[3].x.ToFloat32() == floats[v]);
+        REQUIRE(attr[3].y.ToFloat32() == 0.0f);
+        REQUIRE(attr[3].z.ToFloat32() == 0.0f);
+        REQUIRE(attr[3].w.ToFloat32() == 1.0f);
+
+        REQUIRE(attr[4].x.ToFloat32() == 7.0f);
+        REQUIRE(attr[4].w.ToFloat32() == 10.0f);
+    }
+}
+
+TEST_CASE("VertexLoaderJit is cached by layout", "[video_core][vertex_loader]") {
+    VertexLoader::Layout layout{};
+    layout.num_total_attributes = 1;
+    layout.formats[0] = Format::FLOAT;
+    layout.elements[0] = 4;
+    layout.strides[0] = 16;
+
+    const VertexLoaderJit& first = Pica::GetVertexLoaderJit(layout);
+    REQUIRE(&Pica::GetVertexLoaderJit(layout) == &first);
+
+    // The offsets of the attributes are not compiled in
+    layout.sources[0] = 64;
+    REQUIRE(&Pica::GetVertexLoaderJit(layout) == &first);
+
+    layout.strides[0] = 20;
+    REQUIRE(&Pica::GetVertexLoaderJit(layout) != &first);
+
+    layout.strides[0] = 16;
+    layout.is_default[1] = true;
+    layout.num_total_attributes = 2;
+    REQUIRE(&Pica::GetVertexLoaderJit(layout) != &first);
+}
@@ -0,0 +1,187 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/scm_rev.h"
+#include "common/string_util.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "trace_replay/trace_player.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <trace.ctf>\n"
+                 "Replays a CiTrace recording with the software rasterizer and prints the\n"
+                 "time, draw count and microprofile stage totals of each frame as JSON.\n"
+                 "Stage totals are only measured in builds with MICROPROFILE_ENABLED.\n\n"
+                 "-n, --loops    Number of times the trace is replayed (default 1)\n"
+                 "-o, --output   File to write the JSON report to instead of stdout\n"
+                 "-h, --help     Display this help and exit\n"
+                 "-v, --version  Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra trace replay " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+using StageTimes = std::array<double, TraceReplay::PROFILED_STAGES.size()>;
+
+static std::string StagesToJson(const StageTimes& ms) {
+    std::string json = "{";
+    for (std::size_t i = 0; i < ms.size(); ++i) {
+        json += fmt::format("{}\"{}\": {:.3f}", i == 0 ? "" : ", ",
+                            TraceReplay::PROFILED_STAGES[i], ms[i]);
+    }
+    return json + "}";
+}
+
+static std::string ReportToJson(const std::string& filename,
+                                const std::vector<TraceReplay::ReplayStats>& runs) {
+    TraceReplay::FrameStats total;
+    std::size_t num_frames = 0;
+    std::string frames;
+    for (std::size_t loop = 0; loop < runs.size(); ++loop) {
+        const auto& run_frames = runs[loop].frames;
+        for (std::size_t index = 0; index < run_frames.size(); ++index) {
+            const auto& frame = run_frames[index];
+            frames += fmt::format(
+                "{}    {{\"loop\": {}, \"frame\": {}, \"time_ms\": {:.3f}, \"command_lists\": {}, "
+                "\"draws\": {}, \"triangles\": {}, \"stages_ms\": {}}}",
+                num_frames == 0 ? "" : ",\n", loop, index, frame.time_ms, frame.command_lists,
+                frame.draws, frame.triangles, StagesToJson(frame.stage_ms));
+
+            total.time_ms += frame.time_ms;
+            total.command_lists += frame.command_lists;
+            total.draws += frame.draws;
+            total.triangles += frame.triangles;
+            for (std::size_t i = 0; i < total.stage_ms.size(); ++i) {
+                total.stage_ms[i] += frame.stage_ms[i];
+            }
+            ++num_frames;
+        }
+    }
+
+    const double average_ms = num_frames != 0 ? total.time_ms / num_frames : 0.0;
+    const auto& last_run = runs.back();
+    return fmt::format(
+        "{{\n"
+        "  \"trace\": \"{}\",\n"
+        "  \"microprofile\": {},\n"
+        "  \"loops\": {},\n"
+        "  \"skipped\": {{\"memory_fills\": {}, \"display_transfers\": {}, "
+        "\"interrupts\": {}}},\n"
+        "  \"total\": {{\"frames\": {}, \"time_ms\": {:.3f}, \"average_frame_ms\": {:.3f}, "
+        "\"command_lists\": {}, \"draws\": {}, \"triangles\": {}, \"stages_ms\": {}}},\n"
+        "  \"frames\": [\n{}\n  ]\n"
+        "}}\n",
+        Common::EscapeJson(filename), MICROPROFILE_ENABLED ? "true" : "false", runs.size(),
+        last_run.skipped_memory_fills, last_run.skipped_display_transfers,
+        last_run.skipped_interrupts, num_frames, total.time_ms, average_ms, total.command_lists,
+        total.draws, total.triangles, StagesToJson(total.stage_ms), frames);
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+    char* endarg;
+
+    std::string output_file;
+    u32 loops = 1;
+
+    static struct option long_options[] = {
+        {"loops", required_argument, 0, 'n'},
+        {"output", required_argument, 0, 'o'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "n:o:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'n':
+                loops = strtoul(optarg, &endarg, 0);
+                break;
+            case 'o':
+                output_file.assign(optarg);
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            }
+        } else {
+            break;
+        }
+    }
+
+    if (optind >= argc) {
+        std::cout << "No trace file given!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    if (loops == 0) {
+        std::cout << "loops needs to be at least 1!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    const std::string filename = argv[optind];
+
+    // Messages go to stderr, so that the report can be piped
+    Log::Filter log_filter(Log::Level::Warning);
+    Log::SetGlobalFilter(log_filter);
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    // Replays only use the software rasterizer. The shader cache needs a loaded title.
+    Settings::values.use_hw_renderer = false;
+    Settings::values.use_shader_cache = false;
+
+    MicroProfileOnThreadCreate("TraceReplay");
+
+    Memory::MemorySystem memory;
+    std::vector<TraceReplay::ReplayStats> runs;
+    {
+        TraceReplay::TracePlayer player(memory);
+        if (!player.Load(filename)) {
+            return -1;
+        }
+
+        for (u32 loop = 0; loop < loops; ++loop) {
+            runs.push_back(player.Replay());
+        }
+    }
+
+    const std::string report = ReportToJson(filename, runs);
+    if (output_file.empty()) {
+        std::cout << report;
+    } else if (FileUtil::WriteStringToFile(true, output_file, report) != report.size()) {
+        LOG_CRITICAL(Frontend, "Failed to write {}", output_file);
+        return -1;
+    }
+
+    MicroProfileShutdown();
+    return 0;
+}
@@ -0,0 +1,302 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+#include "trace_replay/trace_player.h"
+#include "video_core/command_processor.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/video_core.h"
+
+namespace TraceReplay {
+
+/// Software rasterizer that counts the draws and triangles of the replay
+class CountingRasterizer final : public VideoCore::SWRasterizer {
+public:
+    void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
+                     const Pica::Shader::OutputVertex& v2) override {
+        ++triangles;
+        SWRasterizer::AddTriangle(v0, v1, v2);
+    }
+
+    void DrawTriangles() override {
+        ++draws;
+        SWRasterizer::DrawTriangles();
+    }
+
+    u32 draws = 0;
+    u64 triangles = 0;
+};
+
+TracePlayer::TracePlayer(Memory::MemorySystem& memory) : memory(memory) {
+    auto counting_rasterizer = std::make_unique<CountingRasterizer>();
+    rasterizer = counting_rasterizer.get();
+    VideoCore::InitHeadless(memory, std::move(counting_rasterizer));
+
+    // There is no GSP service to signal the P3D interrupt to
+    Pica::CommandProcessor::SetInterruptHandler([] {});
+
+    MicroProfileSetEnableAllGroups(true);
+}
+
+TracePlayer::~TracePlayer() {
+    Pica::CommandProcessor::SetInterruptHandler(nullptr);
+    VideoCore::Shutdown();
+}
+
+bool TracePlayer::Load(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Could not open {}", filename);
+        return false;
+    }
+
+    data.resize(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size() || data.size() < sizeof(header)) {
+        LOG_ERROR(HW_GPU, "Could not read {}", filename);
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, CiTrace::CTHeader::ExpectedMagicWord(), 4) != 0 ||
+        header.version != CiTrace::CTHeader::ExpectedVersion()) {
+        LOG_ERROR(HW_GPU, "{} is not a CiTrace file of version {}", filename,
+                  CiTrace::CTHeader::ExpectedVersion());
+        return false;
+    }
+
+    const u64 stream_end =
+        header.stream_offset + u64{header.stream_size} * sizeof(CiTrace::CTStreamElement);
+    if (stream_end > data.size()) {
+        LOG_ERROR(HW_GPU, "The command stream of {} is truncated", filename);
+        return false;
+    }
+
+    stream.resize(header.stream_size);
+    std::memcpy(stream.data(), data.data() + header.stream_offset,
+                stream.size() * sizeof(CiTrace::CTStreamElement));
+    return true;
+}
+
+std::vector<u32> TracePlayer::ReadWords(u32 offset, u32 count) const {
+    if (u64{offset} + u64{count} * sizeof(u32) > data.size()) {
+        LOG_WARNING(HW_GPU, "Ignoring initial state out of the file at {:#X}", offset);
+        return {};
+    }
+
+    std::vector<u32> words(count);
+    std::memcpy(words.data(), data.data() + offset, count * sizeof(u32));
+    return words;
+}
+
+static void LoadFloat24(const std::vector<u32>& words, Pica::float24* dest, std::size_t count) {
+    for (std::size_t i = 0; i < std::min(words.size(), count); ++i) {
+        dest[i] = Pica::float24::FromRaw(words[i]);
+    }
+}
+
+static void LoadShaderSetup(const std::vector<u32>& program, const std::vector<u32>& swizzle,
+                            const std::vector<u32>& uniforms, Pica::Shader::ShaderSetup& setup) {
+    std::copy_n(program.begin(), std::min(program.size(), setup.program_code.size()),
+                setup.program_code.begin());
+    std::copy_n(swizzle.begin(), std::min(swizzle.size(), setup.swizzle_data.size()),
+                setup.swizzle_data.begin());
+    setup.MarkProgramCodeDirty();
+    setup.MarkSwizzleDataDirty();
+
+    // Uniforms are stored as four float24 values each
+    LoadFloat24(uniforms, &setup.uniforms.f[0].x, 4 * std::size(setup.uniforms.f));
+}
+
+void TracePlayer::LoadInitialState() {
+    const auto& initial = header.initial_state_offsets;
+    Pica::g_state.Reset();
+
+    std::memset(&gpu_regs, 0, sizeof(gpu_regs));
+    const auto gpu_registers = ReadWords(initial.gpu_registers, initial.gpu_registers_size);
+    std::memcpy(&gpu_regs, gpu_registers.data(),
+                std::min(gpu_registers.size() * sizeof(u32), sizeof(gpu_regs)));
+
+    const auto pica_registers = ReadWords(initial.pica_registers, initial.pica_registers_size);
+    std::copy_n(pica_registers.begin(),
+                std::min(pica_registers.size(), Pica::g_state.regs.reg_array.size()),
+                Pica::g_state.regs.reg_array.begin());
+
+    // Default attributes are stored as four float24 values each
+    LoadFloat24(ReadWords(initial.default_attributes, initial.default_attributes_size),
+                &Pica::g_state.input_default_attributes.attr[0].x,
+                4 * std::size(Pica::g_state.input_default_attributes.attr));
+
+    LoadShaderSetup(ReadWords(initial.vs_program_binary, initial.vs_program_binary_size),
+                    ReadWords(initial.vs_swizzle_data, initial.vs_swizzle_data_size),
+                    ReadWords(initial.vs_float_uniforms, initial.vs_float_uniforms_size),
+                    Pica::g_state.vs);
+    LoadShaderSetup(ReadWords(initial.gs_program_binary, initial.gs_program_binary_size),
+                    ReadWords(initial.gs_swizzle_data, initial.gs_swizzle_data_size),
+                    ReadWords(initial.gs_float_uniforms, initial.gs_float_uniforms_size),
+                    Pica::g_state.gs);
+}
+
+/// Returns whether the physical range lies within one of the memory regions a trace can load
+static bool IsLoadableRange(PAddr address, u32 size) {
+    constexpr std::array<std::pair<PAddr, PAddr>, 3> regions{{
+        {Memory::VRAM_PADDR, Memory::VRAM_PADDR_END},
+        {Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_PADDR_END},
+        {Memory::N3DS_EXTRA_RAM_PADDR, Memory::N3DS_EXTRA_RAM_PADDR_END},
+    }};
+    return std::any_of(regions.begin(), regions.end(), [&](const auto& region) {
+        return address >= region.first && u64{address} + size <= region.second;
+    });
+}
+
+void TracePlayer::LoadMemory(const CiTrace::CTMemoryLoad& load) {
+    if (u64{load.file_offset} + load.size > data.size()) {
+        LOG_WARNING(HW_GPU, "Ignoring memory load out of the file at {:#X}", load.file_offset);
+        return;
+    }
+
+    // The DSP memory is not emulated by the replay
+    if (load.physical_address >= Memory::DSP_RAM_PADDR &&
+        load.physical_address <= Memory::DSP_RAM_PADDR_END) {
+        return;
+    }
+
+    if (!IsLoadableRange(load.physical_address, load.size)) {
+        LOG_WARNING(HW_GPU, "Ignoring memory load of {:#X} bytes out of memory at {:#010X}",
+                    load.size, load.physical_address);
+        return;
+    }
+
+    u8* dest = memory.GetPhysicalPointer(load.physical_address);
+
+    std::memcpy(dest, data.data() + load.file_offset, load.size);
+    VideoCore::Rasterizer()->InvalidateRegion(load.physical_address, load.size);
+}
+
+void TracePlayer::WriteRegister(const CiTrace::CTRegisterWrite& write, FrameStats& frame,
+                                ReplayStats& stats) {
+    // Only the GPU registers drive rendering, the LCD ones are ignored
+    const u32 index = (write.physical_address - GPU_REGS_PADDR) / sizeof(u32);
+    if (write.physical_address < GPU_REGS_PADDR || index >= GPU::Regs::NumIds()) {
+        return;
+    }
+
+    // Like GPU::Write, only 32-bit writes are supported
+    if (write.size != CiTrace::CTRegisterWrite::SIZE_32) {
+        LOG_ERROR(HW_GPU, "Ignoring write of unsupported size to {:#010X}",
+                  write.physical_address);
+        return;
+    }
+
+    gpu_regs[index] = static_cast<u32>(write.value);
+
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+    case GPU_REG_INDEX(memory_fill_config[1].trigger): {
+        const bool is_second_filler = (index != GPU_REG_INDEX(memory_fill_config[0].trigger));
+        auto& config = gpu_regs.memory_fill_config[is_second_filler];
+        if (config.trigger) {
+            ++stats.skipped_memory_fills;
+            config.trigger.Assign(0);
+            config.finished.Assign(1);
+        }
+        break;
+    }
+
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+        if (gpu_regs.display_transfer_config.trigger & 1) {
+            ++stats.skipped_display_transfers;
+            gpu_regs.display_transfer_config.trigger = 0;
+        }
+        break;
+
+    case GPU_REG_INDEX(command_processor_config.trigger): {
+        const auto& config = gpu_regs.command_processor_config;
+        if (config.trigger & 1) {
+            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
+            ++frame.command_lists;
+            gpu_regs.command_processor_config.trigger = 0;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+ReplayStats TracePlayer::Replay() {
+    using Clock = std::chrono::steady_clock;
+
+    ReplayStats stats;
+    LoadInitialState();
+    Pica::CommandProcessor::SetInterruptHandler([&stats] { ++stats.skipped_interrupts; });
+
+    FrameStats frame;
+    auto frame_start = Clock::now();
+    rasterizer->draws = 0;
+    rasterizer->triangles = 0;
+
+    auto finish_frame = [&] {
+        // Wait for the binned triangles, so that the frame time includes all the rasterization
+        VideoCore::Rasterizer()->FlushAll();
+
+        const std::chrono::duration<double, std::milli> frame_time = Clock::now() - frame_start;
+        frame.time_ms = frame_time.count();
+        frame.draws = rasterizer->draws;
+        frame.triangles = rasterizer->triangles;
+
+        MicroProfileFlip();
+        for (std::size_t i = 0; i < PROFILED_STAGES.size(); ++i) {
+            frame.stage_ms[i] = MicroProfileGetTime("GPU", PROFILED_STAGES[i]);
+        }
+
+        stats.frames.push_back(frame);
+        frame = {};
+        rasterizer->draws = 0;
+        rasterizer->triangles = 0;
+        frame_start = Clock::now();
+    };
+
+    for (const auto& element : stream) {
+        switch (element.type) {
+        case CiTrace::FrameMarker:
+            finish_frame();
+            break;
+
+        case CiTrace::MemoryLoad:
+            LoadMemory(element.memory_load);
+            break;
+
+        case CiTrace::RegisterWrite:
+            WriteRegister(element.register_write, frame, stats);
+            break;
+
+        default:
+            LOG_WARNING(HW_GPU, "Ignoring unknown stream element {:#X}",
+                        static_cast<u32>(element.type));
+            break;
+        }
+    }
+
+    // Commands after the last frame marker make up an incomplete frame
+    if (frame.command_lists != 0) {
+        finish_frame();
+    }
+
+    Pica::CommandProcessor::SetInterruptHandler([] {});
+    return stats;
+}
+
+} // namespace TraceReplay
@@ -0,0 +1,84 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/tracer/citrace.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace TraceReplay {
+
+class CountingRasterizer;
+
+/// Physical address of the GPU registers, as stored in traces
+constexpr u32 GPU_REGS_PADDR = HW::VADDR_GPU - 0x1EC00000 + 0x10100000;
+
+/// Names of the microprofile timers of the GPU group that are reported per frame
+constexpr std::array<const char*, 5> PROFILED_STAGES = {
+    "Drawing", "Shader", "Rasterization", "Tile Flush", "Vertex Loader Compilation",
+};
+
+struct FrameStats {
+    double time_ms = 0.0;
+    u32 command_lists = 0;
+    u32 draws = 0;
+    u64 triangles = 0;
+    /// Time spent in each of PROFILED_STAGES, zero if microprofile is disabled
+    std::array<double, PROFILED_STAGES.size()> stage_ms{};
+};
+
+struct ReplayStats {
+    std::vector<FrameStats> frames;
+    /// GPU operations that are not emulated by the replay
+    u32 skipped_memory_fills = 0;
+    u32 skipped_display_transfers = 0;
+    u32 skipped_interrupts = 0;
+};
+
+/**
+ * Plays back a CiTrace recording with the software rasterizer. The initial state is loaded into
+ * Pica::g_state and the GPU registers, and each command list the recorded register writes trigger
+ * is run through the command processor, without any renderer or window.
+ */
+class TracePlayer {
+public:
+    /// Initializes the video core with a software rasterizer drawing to the memory
+    explicit TracePlayer(Memory::MemorySystem& memory);
+    ~TracePlayer();
+
+    /// Reads the trace file, returns false if it is not a valid trace
+    bool Load(const std::string& filename);
+
+    /// Replays the whole trace from its initial state and returns the statistics of each frame
+    ReplayStats Replay();
+
+private:
+    /// Returns count u32 values of the trace at the offset, or nothing if they are out of bounds
+    std::vector<u32> ReadWords(u32 offset, u32 count) const;
+
+    void LoadInitialState();
+    void LoadMemory(const CiTrace::CTMemoryLoad& load);
+    void WriteRegister(const CiTrace::CTRegisterWrite& write, FrameStats& frame, ReplayStats& stats);
+
+    Memory::MemorySystem& memory;
+    CountingRasterizer* rasterizer;
+
+    std::vector<u8> data;
+    CiTrace::CTHeader header{};
+    std::vector<CiTrace::CTStreamElement> stream;
+
+    /// Shadow of the GPU registers, written by the trace instead of GPU::g_regs
+    GPU::Regs gpu_regs{};
+};
+
+} // namespace TraceReplay
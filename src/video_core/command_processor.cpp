@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <utility>
 #include "common/assert.h"
@@ -26,6 +28,7 @@
 #include "video_core/regs_texturing.h"
 #include "video_core/renderer_base.h"
 #include "video_core/shader/shader.h"
+#include "video_core/vertex_cache.h"
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
@@ -33,6 +36,43 @@ namespace Pica::CommandProcessor {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+/// Number of vertices cached by index during indexed draws
+constexpr std::size_t VERTEX_CACHE_SIZE = 256;
+
+// Processed vertices of the current indexed draw. These are kept around between draws, which
+// avoids constructing them every time, and are cleared at the start of each draw.
+static VertexCache<Shader::OutputVertex, VERTEX_CACHE_SIZE> output_vertex_cache;
+static VertexCache<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vs_output_cache;
+
+static std::function<void()> interrupt_handler;
+
+/// Number of vertices loaded and run through the vertex shader together
+constexpr u32 VERTEX_BATCH_SIZE = 32;
+
+/**
+ * Runs the vertex shader on a batch of vertices, in order on the shader unit state. Each vertex
+ * starts from the registers left by the previous one, and the state of the last one is kept for
+ * the next batch.
+ */
+static void RunVertexShaderBatch(Shader::ShaderEngine* engine, Shader::UnitState& unit,
+                                 const Shader::AttributeBuffer* inputs,
+                                 Shader::AttributeBuffer* outputs, std::size_t count) {
+    static std::array<Shader::UnitState, VERTEX_BATCH_SIZE> units;
+    ASSERT(count > 0 && count <= units.size());
+
+    const auto& regs = g_state.regs;
+    // The engine carries the registers over to the other units
+    units[0] = unit;
+    for (std::size_t i = 0; i < count; ++i) {
+        units[i].LoadInput(regs.vs, inputs[i]);
+    }
+    engine->RunBatch(g_state.vs, units.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        units[i].WriteOutput(regs.vs, outputs[i]);
+    }
+    unit = units[count - 1];
+}
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -128,7 +168,11 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        if (interrupt_handler) {
+            interrupt_handler();
+        } else {
+            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        }
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -302,7 +346,6 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         bool index_u16 = index_info.format != 0;
 
         DebugUtils::MemoryAccessTracker memory_accesses;
-        Shader::AttributeBuffer vs_output;
         auto* shader_engine = Shader::GetEngine();
         Shader::UnitState shader_unit;
 
@@ -312,64 +355,129 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         g_state.geometry_pipeline.Setup(shader_engine);
 
         if (is_indexed) {
-            // Simple circular-replacement vertex cache
-            // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-            const u32 VERTEX_CACHE_SIZE = 32;
-            std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-            std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-            std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-            u32 vertex_cache_pos = 0;
-            u32 cache_lookup_limit = std::min(VERTEX_CACHE_SIZE, regs.pipeline.num_vertices - 1);
-
-            for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
+            // Indices repeat a lot within a draw, so the processed vertices are cached by index.
+            // Without a geometry shader the cache holds the final OutputVertex and hits skip the
+            // vertex shader, the output mapping and the vertex handler. With a geometry shader it
+            // holds the vertex shader output, since that is what the geometry shader consumes.
+            // The PICA has no restart index: primitive restart is a register write between draws
+            // and only resets the primitive assembler, so cached vertices stay valid across it.
+            const bool use_gs = regs.pipeline.use_gs == PipelineRegs::UseGS::Yes;
+            if (use_gs) {
+                vs_output_cache.Clear();
+            } else {
+                output_vertex_cache.Clear();
+            }
+
+            const auto AddTriangle = [](const Shader::OutputVertex& v0,
+                                        const Shader::OutputVertex& v1,
+                                        const Shader::OutputVertex& v2) {
+                VideoCore::Rasterizer()->AddTriangle(v0, v1, v2);
+            };
+
+            const auto GetIndex = [&](u32 index) -> u32 {
                 // Indexed rendering doesn't use the start offset
-                u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
+                return index_u16 ? index_address_16[index] : index_address_8[index];
+            };
+
+            if (!use_gs) {
+                // The vertices missing from the cache are deduplicated and shaded together, then
+                // all of them are submitted in order
+                std::array<const Shader::OutputVertex*, VERTEX_BATCH_SIZE> chunk_outputs;
+                std::array<u32, VERTEX_BATCH_SIZE> batch_vertices;
+                std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> batch_inputs;
+                std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> batch_vs_outputs;
+                std::array<Shader::OutputVertex, VERTEX_BATCH_SIZE> batch_outputs;
+
+                for (u32 first = 0; first < regs.pipeline.num_vertices;
+                     first += VERTEX_BATCH_SIZE) {
+                    const u32 chunk_size =
+                        std::min(VERTEX_BATCH_SIZE, regs.pipeline.num_vertices - first);
+
+                    std::size_t batch_size = 0;
+                    for (u32 i = 0; i < chunk_size; ++i) {
+                        const u32 vertex = GetIndex(first + i);
+                        if (const auto* cached = output_vertex_cache.Lookup(vertex)) {
+                            chunk_outputs[i] = cached;
+                            continue;
+                        }
+
+                        const auto batch_end = batch_vertices.begin() + batch_size;
+                        const auto it = std::find(batch_vertices.begin(), batch_end, vertex);
+                        if (it == batch_end) {
+                            batch_vertices[batch_size++] = vertex;
+                        }
+                        chunk_outputs[i] = &batch_outputs[it - batch_vertices.begin()];
+                    }
 
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
-                }
+                    if (batch_size > 0) {
+                        loader.LoadVertices(base_address, batch_vertices.data(), batch_size,
+                                            batch_inputs.data(), memory_accesses);
+                        RunVertexShaderBatch(shader_engine, shader_unit, batch_inputs.data(),
+                                             batch_vs_outputs.data(), batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            batch_outputs[i] = Shader::OutputVertex::FromAttributeBuffer(
+                                regs.rasterizer, batch_vs_outputs[i]);
+                        }
+                    }
+
+                    for (u32 i = 0; i < chunk_size; ++i) {
+                        primitive_assembler.SubmitVertex(*chunk_outputs[i], AddTriangle);
+                    }
 
-                bool vertex_cache_hit = false;
-                for (u32 i = 0; i < cache_lookup_limit; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
+                    // Inserting may evict vertices the chunk points to, so it happens last
+                    for (std::size_t i = 0; i < batch_size; ++i) {
+                        output_vertex_cache.Insert(batch_vertices[i]) = batch_outputs[i];
                     }
                 }
+            } else {
+                for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
+                    const u32 vertex = GetIndex(index);
+
+                    if (g_state.geometry_pipeline.NeedIndexInput()) {
+                        g_state.geometry_pipeline.SubmitIndex(vertex);
+                        continue;
+                    }
+
+                    if (const auto* cached = vs_output_cache.Lookup(vertex)) {
+                        g_state.geometry_pipeline.SubmitVertex(*cached);
+                        continue;
+                    }
 
-                if (!vertex_cache_hit) {
                     // Initialize data for the current vertex
                     Shader::AttributeBuffer input;
                     loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
                     shader_unit.LoadInput(regs.vs, input);
                     shader_engine->Run(g_state.vs, shader_unit);
-                    shader_unit.WriteOutput(regs.vs, vs_output);
 
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
-                }
+                    auto& output = vs_output_cache.Insert(vertex);
+                    shader_unit.WriteOutput(regs.vs, output);
 
-                // Send to geometry pipeline
-                g_state.geometry_pipeline.SubmitVertex(vs_output);
+                    // Send to geometry pipeline
+                    g_state.geometry_pipeline.SubmitVertex(output);
+                }
             }
         } else {
-            for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
-                // Indexed rendering doesn't use the start offset
-                u32 vertex = index + regs.pipeline.vertex_offset;
-
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
+            // Vertices are loaded and shaded in batches, so that the loader and the shader run
+            // over several of them at once
+            std::array<u32, VERTEX_BATCH_SIZE> batch_vertices;
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> batch_inputs;
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> batch_outputs;
+
+            for (u32 first = 0; first < regs.pipeline.num_vertices; first += VERTEX_BATCH_SIZE) {
+                const u32 batch_size =
+                    std::min(VERTEX_BATCH_SIZE, regs.pipeline.num_vertices - first);
+                for (u32 i = 0; i < batch_size; ++i) {
+                    batch_vertices[i] = first + i + regs.pipeline.vertex_offset;
+                }
+                loader.LoadVertices(base_address, batch_vertices.data(), batch_size,
+                                    batch_inputs.data(), memory_accesses);
+                RunVertexShaderBatch(shader_engine, shader_unit, batch_inputs.data(),
+                                     batch_outputs.data(), batch_size);
 
-                // Send to geometry pipeline
-                g_state.geometry_pipeline.SubmitVertex(vs_output);
+                for (u32 i = 0; i < batch_size; ++i) {
+                    // Send to geometry pipeline
+                    g_state.geometry_pipeline.SubmitVertex(batch_outputs[i]);
+                }
             }
         }
 
@@ -611,4 +719,8 @@ void ProcessCommandList(PAddr list, u32 size) {
     }
 }
 
+void SetInterruptHandler(std::function<void()> handler) {
+    interrupt_handler = std::move(handler);
+}
+
 } // namespace Pica::CommandProcessor
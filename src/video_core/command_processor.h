@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <type_traits>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -34,4 +35,10 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 
 void ProcessCommandList(PAddr list, u32 size);
 
+/**
+ * Sets the function called when a command list requests the P3D interrupt. The interrupt is
+ * signalled to GSP when no handler is set.
+ */
+void SetInterruptHandler(std::function<void()> handler);
+
 } // namespace Pica::CommandProcessor
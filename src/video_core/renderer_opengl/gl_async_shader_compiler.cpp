@@ -0,0 +1,138 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
+
+namespace OpenGL {
+
+/// Compiling keeps a core busy, so some are left for the emulation and the render threads
+static std::size_t NumWorkers() {
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
+std::unique_ptr<AsyncShaderCompiler> AsyncShaderCompiler::Create(
+    const Frontend::EmuWindow& window) {
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts;
+    for (std::size_t i = 0; i < NumWorkers(); ++i) {
+        auto context = window.CreateSharedContext();
+        if (context == nullptr) {
+            break;
+        }
+        contexts.push_back(std::move(context));
+    }
+    if (contexts.empty()) {
+        LOG_WARNING(Render_OpenGL, "No shared contexts, shaders are compiled in the draws");
+        return nullptr;
+    }
+    return std::make_unique<AsyncShaderCompiler>(std::move(contexts));
+}
+
+AsyncShaderCompiler::AsyncShaderCompiler(
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts_)
+    : contexts(std::move(contexts_)) {
+    for (auto& context : contexts) {
+        workers.emplace_back([this, &context = *context] { WorkerLoop(context); });
+    }
+}
+
+AsyncShaderCompiler::~AsyncShaderCompiler() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    job_condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // The programs nobody took are deleted in the context of the caller, which shares them
+    TakeCompiled();
+}
+
+void AsyncShaderCompiler::Compile(Job job) {
+    {
+        std::lock_guard lock{mutex};
+        jobs.push_back(std::move(job));
+    }
+    job_condition.notify_one();
+}
+
+std::vector<std::unique_ptr<AsyncShaderCompiler::Result>> AsyncShaderCompiler::TakeCompiled() {
+    std::vector<std::unique_ptr<Result>> results;
+    Result* result = compiled.exchange(nullptr, std::memory_order_acquire);
+    while (result != nullptr) {
+        results.emplace_back(result);
+        result = std::exchange(result->next, nullptr);
+    }
+    return results;
+}
+
+void AsyncShaderCompiler::WorkerLoop(Frontend::GraphicsContext& context) {
+    Common::SetCurrentThreadName("ShaderCompiler");
+    context.MakeCurrent();
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock{mutex};
+            job_condition.wait(lock, [this] { return stop || !jobs.empty(); });
+            if (stop) {
+                break;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        auto result = std::make_unique<Result>();
+        result->hash = job.hash;
+        result->separable = job.separable;
+
+        if (!job.binary.empty()) {
+            result->from_binary = true;
+            result->program.Create(job.binary_format, job.binary);
+            glFinish();
+            Push(std::move(result));
+            continue;
+        }
+
+        std::vector<OGLShader> shaders(job.sources.size());
+        std::vector<GLuint> handles;
+        bool compiled_all = true;
+        for (std::size_t i = 0; i < job.sources.size(); ++i) {
+            shaders[i].Create(job.sources[i].code->c_str(), job.sources[i].type);
+            compiled_all &= shaders[i].handle != 0;
+            handles.push_back(shaders[i].handle);
+        }
+        if (compiled_all) {
+            result->program.Create(job.separable, handles);
+            if (job.get_binary) {
+                result->program.GetProgramBinary(result->binary_format, result->binary);
+            }
+        }
+        shaders.clear();
+
+        // The render thread only uses the program once the driver is done with it in this context
+        glFinish();
+
+        Push(std::move(result));
+    }
+
+    context.DoneCurrent();
+}
+
+void AsyncShaderCompiler::Push(std::unique_ptr<Result> result) {
+    Result* head = compiled.load(std::memory_order_relaxed);
+    do {
+        result->next = head;
+    } while (!compiled.compare_exchange_weak(head, result.get(), std::memory_order_release,
+                                             std::memory_order_relaxed));
+    result.release();
+}
+
+} // namespace OpenGL
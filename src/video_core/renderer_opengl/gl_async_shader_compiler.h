@@ -0,0 +1,93 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Frontend {
+class EmuWindow;
+class GraphicsContext;
+} // namespace Frontend
+
+namespace OpenGL {
+
+/**
+ * Compiles and links shader programs on worker threads, each with a graphics context shared with
+ * the one of the renderer, so that a draw needing a new program doesn't wait for the driver. The
+ * programs are handed back to the render thread through a lock-free list it polls.
+ */
+class AsyncShaderCompiler {
+public:
+    struct Source {
+        GLenum type;
+        std::shared_ptr<const std::string> code;
+    };
+
+    struct Job {
+        u64 hash;
+        bool separable;
+        /// Whether to get the binary of the linked program, for the program cache
+        bool get_binary;
+        std::vector<Source> sources;
+        /// Program binary to load instead of compiling the sources, if not empty
+        GLenum binary_format = 0;
+        std::vector<GLbyte> binary;
+    };
+
+    struct Result {
+        u64 hash;
+        bool separable;
+        /// Whether the program was loaded from the binary of the job
+        bool from_binary = false;
+        /// Empty if the program failed to compile or link
+        OGLProgram program;
+        GLenum binary_format = 0;
+        std::vector<GLbyte> binary;
+
+        Result* next = nullptr;
+    };
+
+    /**
+     * Creates a compiler with workers for the graphics contexts the window can share.
+     * @returns The compiler, or nullptr if the window can't share its context
+     */
+    static std::unique_ptr<AsyncShaderCompiler> Create(const Frontend::EmuWindow& window);
+
+    explicit AsyncShaderCompiler(std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts);
+    ~AsyncShaderCompiler();
+
+    /// Queues a program to compile
+    void Compile(Job job);
+
+    /// Takes the programs compiled since the last call, without taking a lock
+    std::vector<std::unique_ptr<Result>> TakeCompiled();
+
+private:
+    void WorkerLoop(Frontend::GraphicsContext& context);
+    void Push(std::unique_ptr<Result> result);
+
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable job_condition;
+    std::deque<Job> jobs;
+    bool stop = false;
+
+    /// Stack of the compiled programs, pushed by the workers and emptied by the render thread
+    std::atomic<Result*> compiled{nullptr};
+};
+
+} // namespace OpenGL
@@ -43,7 +43,7 @@ static bool IsVendorMali() {
     return gpu_vendor.find("ARM") != std::string::npos;
 }
 
-RasterizerOpenGL::RasterizerOpenGL()
+RasterizerOpenGL::RasterizerOpenGL(Frontend::EmuWindow& window)
     : is_mali_gpu(IsVendorMali()), shader_dirty(true),
       vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE),
       uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE),
@@ -93,6 +93,7 @@ RasterizerOpenGL::RasterizerOpenGL()
     uniform_block_data.lighting_lut_dirty.fill(true);
     uniform_block_data.lighting_lut_dirty_any = true;
     uniform_block_data.light_dirty = true;
+    uniform_block_data.uber_fs_dirty = true;
 
     uniform_block_data.fog_lut_dirty = true;
 
@@ -109,6 +110,8 @@ RasterizerOpenGL::RasterizerOpenGL()
         Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
     uniform_size_aligned_light =
         Common::AlignUp<std::size_t>(sizeof(UniformLightData), uniform_buffer_alignment);
+    uniform_size_aligned_uber_fs =
+        Common::AlignUp<std::size_t>(sizeof(UberFSUniformData), uniform_buffer_alignment);
 
     // Set vertex attributes for software shader path
     state.draw.vertex_array = sw_vao.handle;
@@ -169,7 +172,8 @@ RasterizerOpenGL::RasterizerOpenGL()
 
     // 845需要开启分离着色器，但开启后Mali GPU会挂掉，究极日也有显示问题！
     const bool use_separable_shader = Settings::values.use_separable_shader;
-    shader_program_manager = std::make_unique<ShaderProgramManager>(use_separable_shader);
+    shader_program_manager =
+        std::make_unique<ShaderProgramManager>(window, use_separable_shader);
 
     // init opengl state
     glEnable(GL_CULL_FACE);
@@ -468,7 +472,13 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
 
     state.draw.vertex_array = hw_vao.handle;
     state.draw.vertex_buffer = vertex_buffer.GetHandle();
-    shader_program_manager->ApplyTo(state);
+    if (!shader_program_manager->ApplyTo(state)) {
+        // The program is still being compiled, the software shader path draws with the uber shader
+        // if it can, otherwise the draw is skipped. A program that failed is drawn by the software
+        // shader path.
+        return !shader_program_manager->HasUberShaderFallback() &&
+               !shader_program_manager->HasProgramFailed();
+    }
     state.Apply();
 
     u8* buffer_ptr;
@@ -852,11 +862,12 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         state.draw.vertex_buffer = vertex_buffer.GetHandle();
         shader_program_manager->UseTrivialVertexShader();
         shader_program_manager->UseTrivialGeometryShader();
-        shader_program_manager->ApplyTo(state);
+        // Nothing is drawn while the program is still being compiled
+        const bool program_ready = shader_program_manager->ApplyTo(state);
         state.Apply();
 
         std::size_t max_vertices = 3 * (VERTEX_BUFFER_SIZE / (3 * sizeof(HardwareVertex)));
-        for (std::size_t base_vertex = 0; base_vertex < vertex_batch.size();
+        for (std::size_t base_vertex = 0; program_ready && base_vertex < vertex_batch.size();
              base_vertex += max_vertices) {
             const std::size_t vertices = std::min(max_vertices, vertex_batch.size() - base_vertex);
             const std::size_t vertex_size = vertices * sizeof(HardwareVertex);
@@ -1578,6 +1589,14 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const TextureConfig& config)
 
 void RasterizerOpenGL::SetShader() {
     shader_program_manager->UseFragmentShader(Pica::g_state.regs);
+
+    const UberFSUniformData* uber_fs_data = shader_program_manager->GetUberShaderConfig();
+    auto& uber_fs_uniforms = uniform_block_data.uber_fs_data;
+    if (uber_fs_data != nullptr &&
+        std::memcmp(uber_fs_data, &uber_fs_uniforms, sizeof(UberFSUniformData)) != 0) {
+        uber_fs_uniforms = *uber_fs_data;
+        uniform_block_data.uber_fs_dirty = true;
+    }
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
@@ -2152,6 +2171,8 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     const bool sync_vs = accelerate_draw;
     const bool sync_fs = uniform_block_data.dirty;
     const bool sync_light = uniform_block_data.light_dirty;
+    const bool sync_uber_fs = uniform_block_data.uber_fs_dirty;
+    const bool has_uber_fs = shader_program_manager->GetUberShaderConfig() != nullptr;
 
     std::size_t uniform_size = 0;
     if (sync_vs) {
@@ -2163,16 +2184,31 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     if (sync_light) {
         uniform_size += uniform_size_aligned_light;
     }
+    if (sync_uber_fs) {
+        uniform_size += uniform_size_aligned_uber_fs;
+    }
     if (uniform_size == 0) {
         return;
     }
 
+    // An invalidation uploads all the fragment blocks again, the chunk has room for them
+    std::size_t map_size = uniform_size;
+    if (!sync_fs) {
+        map_size += uniform_size_aligned_fs;
+    }
+    if (!sync_light) {
+        map_size += uniform_size_aligned_light;
+    }
+    if (!sync_uber_fs && has_uber_fs) {
+        map_size += uniform_size_aligned_uber_fs;
+    }
+
     std::size_t used_bytes = 0;
     u8* uniforms;
     GLintptr offset;
     bool invalidate;
     std::tie(uniforms, offset, invalidate) =
-        uniform_buffer.Map(uniform_size, uniform_buffer_alignment);
+        uniform_buffer.Map(map_size, uniform_buffer_alignment);
 
     if (sync_vs) {
         VSUniformData vs_uniforms;
@@ -2199,6 +2235,16 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
         used_bytes += uniform_size_aligned_light;
     }
 
+    if (sync_uber_fs || (invalidate && has_uber_fs)) {
+        std::memcpy(uniforms + used_bytes, &uniform_block_data.uber_fs_data,
+                    sizeof(UberFSUniformData));
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::FSConfig),
+                          uniform_buffer.GetHandle(), offset + used_bytes,
+                          sizeof(UberFSUniformData));
+        uniform_block_data.uber_fs_dirty = false;
+        used_bytes += uniform_size_aligned_uber_fs;
+    }
+
     uniform_buffer.Unmap(used_bytes);
 }
 
@@ -29,11 +29,15 @@
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/shader/shader.h"
 
+namespace Frontend {
+class EmuWindow;
+}
+
 namespace OpenGL {
 
 class RasterizerOpenGL : public VideoCore::RasterizerInterface {
 public:
-    RasterizerOpenGL();
+    explicit RasterizerOpenGL(Frontend::EmuWindow& window);
     ~RasterizerOpenGL() override;
 
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
@@ -285,6 +289,9 @@ private:
         UniformLightData light_data;
         bool light_dirty;
 
+        UberFSUniformData uber_fs_data;
+        bool uber_fs_dirty;
+
         std::array<bool, Pica::LightingRegs::NumLightingSampler> lighting_lut_dirty;
         bool lighting_lut_dirty_any;
         bool fog_lut_dirty;
@@ -331,6 +338,7 @@ private:
     std::size_t uniform_size_aligned_vs;
     std::size_t uniform_size_aligned_fs;
     std::size_t uniform_size_aligned_light;
+    std::size_t uniform_size_aligned_uber_fs;
 
     SamplerInfo texture_cube_sampler;
 
@@ -37,6 +37,7 @@
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_vars.h"
+#include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
@@ -552,12 +553,28 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+            // Decode whole tiles at once and copy the rows that lie inside the rect. The rows are
+            // flipped since textures are laid out from bottom to top.
+            const std::size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+            Pica::Texture::DecodedTile tile;
+            for (u32 tile_y = (height - rect.top) / 8; tile_y * 8 < height - rect.bottom;
+                 ++tile_y) {
+                for (u32 tile_x = rect.left / 8; tile_x * 8 < rect.right; ++tile_x) {
+                    Pica::Texture::DecodeTile(texture_src_data + tile_y * tex_info.stride +
+                                                  tile_x * tile_size,
+                                              tex_info, tile);
+
+                    const u32 x_begin = std::max<u32>(rect.left, tile_x * 8);
+                    const u32 x_end = std::min<u32>(rect.right, tile_x * 8 + 8);
+                    for (u32 fine_y = 0; fine_y < 8; ++fine_y) {
+                        const u32 y = height - 1 - (tile_y * 8 + fine_y);
+                        if (y < rect.bottom || y >= rect.top)
+                            continue;
+
+                        const std::size_t offset = (x_begin + (width * y)) * 4;
+                        std::memcpy(&gl_buffer[offset], &tile[fine_y * 8 + x_begin - tile_x * 8],
+                                    (x_end - x_begin) * 4);
+                    }
                 }
             }
         } else {
@@ -89,6 +89,68 @@ layout (std140) uniform shader_light_data {
 };
 )";
 
+/// Functions shared by the generated fragment shaders and the uber shader
+constexpr std::string_view FragmentHelperFunctions = R"(
+// Rotate the vector v by the quaternion q
+vec3 quaternion_rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+float LookupLightingLUT(int lut_index, int index, float delta) {
+    vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
+    return entry.r + entry.g * delta;
+}
+
+float LookupLightingLUTUnsigned(int lut_index, float pos) {
+    int index = clamp(int(pos * 256.0), 0, 255);
+    float delta = pos * 256.0 - float(index);
+    return LookupLightingLUT(lut_index, index, delta);
+}
+
+float LookupLightingLUTSigned(int lut_index, float pos) {
+    int index = clamp(int(pos * 128.0), -128, 127);
+    float delta = pos * 128.0 - float(index);
+    if (index < 0) index += 256;
+    return LookupLightingLUT(lut_index, index, delta);
+}
+
+float byteround(float x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec2 byteround(vec2 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec3 byteround(vec3 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec4 byteround(vec4 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+// PICA's LOD formula for 2D textures.
+// This LOD formula is the same as the LOD lower limit defined in OpenGL.
+// f(x, y) >= max{m_u, m_v, m_w}
+// (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
+float getLod(vec2 coord) {
+    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
+    return log2(max(d.x, d.y));
+}
+)";
+
+/// Shadow texture lookups for the fragment shaders that don't do shadow rendering
+constexpr std::string_view ShadowTextureStubs = R"(
+vec4 shadowTexture(vec2 uv, float w) {
+    return vec4(1.0);
+}
+
+vec4 shadowTextureCube(vec2 uv, float w) {
+    return vec4(1.0);
+}
+)";
+
 static bool s_use_fragment_color;
 static bool s_use_texcolor0;
 static bool s_use_texcolor1;
@@ -1503,68 +1565,12 @@ layout(r32ui) uniform uimage2D shadow_buffer;
 
     out += UniformBlockDef;
 
-    out += R"(
-// Rotate the vector v by the quaternion q
-vec3 quaternion_rotate(vec4 q, vec3 v) {
-    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
-}
-
-float LookupLightingLUT(int lut_index, int index, float delta) {
-    vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
-    return entry.r + entry.g * delta;
-}
-
-float LookupLightingLUTUnsigned(int lut_index, float pos) {
-    int index = clamp(int(pos * 256.0), 0, 255);
-    float delta = pos * 256.0 - float(index);
-    return LookupLightingLUT(lut_index, index, delta);
-}
-
-float LookupLightingLUTSigned(int lut_index, float pos) {
-    int index = clamp(int(pos * 128.0), -128, 127);
-    float delta = pos * 128.0 - float(index);
-    if (index < 0) index += 256;
-    return LookupLightingLUT(lut_index, index, delta);
-}
-
-float byteround(float x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec2 byteround(vec2 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec3 byteround(vec3 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec4 byteround(vec4 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-// PICA's LOD formula for 2D textures.
-// This LOD formula is the same as the LOD lower limit defined in OpenGL.
-// f(x, y) >= max{m_u, m_v, m_w}
-// (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
-float getLod(vec2 coord) {
-    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
-    return log2(max(d.x, d.y));
-}
-)";
+    out += FragmentHelperFunctions;
 
     if (shadow_rendering) {
         AppendShadowRendering(out, config);
     } else {
-        out += R"(
-vec4 shadowTexture(vec2 uv, float w) {
-    return vec4(1.0);
-}
-
-vec4 shadowTextureCube(vec2 uv, float w) {
-    return vec4(1.0);
-}
-)";
+        out += ShadowTextureStubs;
     }
 
     if (config.state.proctex.enable)
@@ -1737,6 +1743,505 @@ do {
     return out;
 }
 
+bool CanUseFragmentUberShader(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    // The procedural texture and the shadow rendering only have generated code
+    if (state.proctex.enable) {
+        return false;
+    }
+    if (GLES && AllowShadow && state.shadow_rendering) {
+        return false;
+    }
+    return true;
+}
+
+std::string GenerateFragmentUberShader(bool separable_shader) {
+    std::string out;
+    if (separable_shader) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n";
+    }
+    if (GLES) {
+        out += fragment_shader_precision_OES;
+    }
+
+    out += GetVertexInterfaceDeclaration(false, separable_shader);
+    out += R"(
+#ifndef CITRA_GLES
+in vec4 gl_FragCoord;
+#endif // CITRA_GLES
+
+out vec4 color;
+
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform samplerCube tex_cube;
+uniform samplerBuffer texture_buffer_lut_lf;
+uniform samplerBuffer texture_buffer_lut_rg;
+uniform samplerBuffer texture_buffer_lut_rgba;
+)";
+
+    out += UniformBlockDef;
+
+    // The state PicaFSConfig bakes into the generated shaders, see UberFSUniformData
+    out += R"(
+#define LUT_D0 0
+#define LUT_D1 1
+#define LUT_SP 2
+#define LUT_FR 3
+#define LUT_RR 4
+#define LUT_RG 5
+#define LUT_RB 6
+
+layout (std140) uniform fs_config {
+    int combiner_buffer_input;
+    int alpha_test_func;
+    int scissor_test_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int depthmap_enable;
+    int fog_mode;
+    int fog_flip;
+    int logic_op;
+    int lighting_enable;
+    int lighting_src_num;
+    int lighting_bump_mode;
+    int lighting_bump_selector;
+    int lighting_bump_renorm;
+    int lighting_clamp_highlights;
+    int lighting_cp_input;
+    int lighting_primary_alpha;
+    int lighting_secondary_alpha;
+    int lighting_shadow_enable;
+    int lighting_shadow_primary;
+    int lighting_shadow_secondary;
+    int lighting_shadow_invert;
+    int lighting_shadow_alpha;
+    int lighting_shadow_selector;
+    // sources, modifiers, ops and scales of each stage
+    ivec4 tev_stages[NUM_TEV_STAGES];
+    // num, directional, two_sided_diffuse and shadow_enable of each light
+    ivec4 light_config[NUM_LIGHTS];
+    // dist_atten_enable, spot_atten_enable, geometric_factor_0 and geometric_factor_1
+    ivec4 light_atten[NUM_LIGHTS];
+    // enable, abs_input and input of each LUT
+    ivec4 lighting_luts[7];
+};
+)";
+
+    out += FragmentHelperFunctions;
+    out += ShadowTextureStubs;
+
+    out += R"(
+vec4 rounded_primary_color;
+vec4 primary_fragment_color = vec4(0.0);
+vec4 secondary_fragment_color = vec4(0.0);
+vec4 texcolor[4];
+vec4 combiner_buffer = vec4(0.0);
+vec4 last_tex_env_out = vec4(0.0);
+
+vec4 SampleTexture0() {
+    switch (texture0_type) {
+    case 0: // Texture2D
+        return textureLod(tex0, texcoord0, getLod(texcoord0 * vec2(textureSize(tex0, 0))));
+    case 1: // TextureCube
+        return texture(tex_cube, vec3(texcoord0, texcoord0_w));
+    case 2: // Shadow2D
+        return shadowTexture(texcoord0, texcoord0_w);
+    case 3: // Projection2D
+        return textureProj(tex0, vec3(texcoord0, texcoord0_w));
+    case 4: // ShadowCube
+        return shadowTextureCube(texcoord0, texcoord0_w);
+    case 5: // Disabled
+        return vec4(0.0);
+    default:
+        return texture(tex0, texcoord0);
+    }
+}
+
+vec4 GetSource(int source, int stage) {
+    switch (source) {
+    case 0: return rounded_primary_color;
+    case 1: return primary_fragment_color;
+    case 2: return secondary_fragment_color;
+    case 3: return texcolor[0];
+    case 4: return texcolor[1];
+    case 5: return texcolor[2];
+    case 6: return texcolor[3];
+    case 13: return combiner_buffer;
+    case 14: return const_color[stage];
+    case 15: return last_tex_env_out;
+    default: return vec4(0.0);
+    }
+}
+
+vec3 ColorModifier(int modifier, vec4 value) {
+    switch (modifier) {
+    case 0: return value.rgb;
+    case 1: return vec3(1.0) - value.rgb;
+    case 2: return value.aaa;
+    case 3: return vec3(1.0) - value.aaa;
+    case 4: return value.rrr;
+    case 5: return vec3(1.0) - value.rrr;
+    case 8: return value.ggg;
+    case 9: return vec3(1.0) - value.ggg;
+    case 12: return value.bbb;
+    case 13: return vec3(1.0) - value.bbb;
+    default: return vec3(0.0);
+    }
+}
+
+float AlphaModifier(int modifier, vec4 value) {
+    switch (modifier) {
+    case 0: return value.a;
+    case 1: return 1.0 - value.a;
+    case 2: return value.r;
+    case 3: return 1.0 - value.r;
+    case 4: return value.g;
+    case 5: return 1.0 - value.g;
+    case 6: return value.b;
+    case 7: return 1.0 - value.b;
+    default: return 0.0;
+    }
+}
+
+vec3 ColorCombiner(int op, vec3 a, vec3 b, vec3 c) {
+    vec3 result;
+    switch (op) {
+    case 0: result = a; break;
+    case 1: result = a * b; break;
+    case 2: result = a + b; break;
+    case 3: result = a + b - vec3(0.5); break;
+    case 4: result = a * c + b * (vec3(1.0) - c); break;
+    case 5: result = a - b; break;
+    case 6:
+    case 7: result = vec3(dot(a - vec3(0.5), b - vec3(0.5)) * 4.0); break;
+    case 8: result = a * b + c; break;
+    case 9: result = min(a + b, vec3(1.0)) * c; break;
+    default: result = vec3(0.0); break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float AlphaCombiner(int op, float a, float b, float c) {
+    float result;
+    switch (op) {
+    case 0: result = a; break;
+    case 1: result = a * b; break;
+    case 2: result = a + b; break;
+    case 3: result = a + b - 0.5; break;
+    case 4: result = a * c + b * (1.0 - c); break;
+    case 5: result = a - b; break;
+    case 8: result = a * b + c; break;
+    case 9: result = min(a + b, 1.0) * c; break;
+    default: result = 0.0; break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+float Multiplier(int scale) {
+    return scale < 3 ? float(1 << scale) : 1.0;
+}
+
+bool AlphaTestFails(int alpha) {
+    switch (alpha_test_func) {
+    case 0: return true;
+    case 2: return alpha != alphatest_ref;
+    case 3: return alpha == alphatest_ref;
+    case 4: return alpha >= alphatest_ref;
+    case 5: return alpha > alphatest_ref;
+    case 6: return alpha <= alphatest_ref;
+    case 7: return alpha < alphatest_ref;
+    default: return false;
+    }
+}
+
+vec3 normal;
+vec3 tangent;
+vec3 light_vector;
+vec3 spot_dir;
+vec3 half_vector;
+
+float LookupLUT(int lut, int lut_index, int light_num) {
+    float index;
+    switch (lighting_luts[lut].z) {
+    case 0: // NH
+        index = dot(normal, normalize(half_vector));
+        break;
+    case 1: // VH
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case 2: // NV
+        index = dot(normal, normalize(view));
+        break;
+    case 3: // LN
+        index = dot(light_vector, normal);
+        break;
+    case 4: // SP
+        index = dot(light_vector, spot_dir);
+        break;
+    case 5: // CP, only available with configuration 7
+        if (lighting_cp_input != 0) {
+            index = dot(normalize(half_vector) - normal * dot(normal, normalize(half_vector)),
+                        tangent);
+        } else {
+            index = 0.0;
+        }
+        break;
+    default:
+        index = 0.0;
+        break;
+    }
+
+    if (lighting_luts[lut].y != 0) {
+        index = light_config[light_num].z != 0 ? abs(index) : max(index, 0.0);
+        return LookupLightingLUTUnsigned(lut_index, index);
+    }
+    return LookupLightingLUTSigned(lut_index, index);
+}
+
+void ComputeLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (lighting_bump_mode == 1) {
+        surface_normal = 2.0 * texcolor[lighting_bump_selector].rgb - 1.0;
+        if (lighting_bump_renorm != 0) {
+            surface_normal.z = sqrt(max(1.0 - (surface_normal.x * surface_normal.x +
+                                               surface_normal.y * surface_normal.y), 0.0));
+        }
+    } else if (lighting_bump_mode == 2) {
+        surface_tangent = 2.0 * texcolor[lighting_bump_selector].rgb - 1.0;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    normal = quaternion_rotate(normalized_normquat, surface_normal);
+    tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if (lighting_shadow_enable != 0) {
+        shadow = texcolor[lighting_shadow_selector];
+        if (lighting_shadow_invert != 0) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    for (int i = 0; i < NUM_LIGHTS; ++i) {
+        if (i >= lighting_src_num) {
+            break;
+        }
+        int num = light_config[i].x;
+
+        if (light_config[i].y != 0) {
+            light_vector = normalize(light_src[num].position);
+        } else {
+            light_vector = normalize(light_src[num].position + view);
+        }
+        spot_dir = light_src[num].spot_direction;
+        half_vector = normalize(view) + light_vector;
+
+        float dot_product = light_config[i].z != 0 ? abs(dot(light_vector, normal))
+                                                   : max(dot(light_vector, normal), 0.0);
+        float clamp_highlights = lighting_clamp_highlights != 0 ? sign(dot_product) : 1.0;
+
+        float spot_atten = 1.0;
+        if (light_atten[i].y != 0 && lighting_luts[LUT_SP].x != 0) {
+            spot_atten = lut_scale_sp * LookupLUT(LUT_SP, 8 + num, num);
+        }
+
+        float dist_atten = 1.0;
+        if (light_atten[i].x != 0) {
+            float index = clamp(light_src[num].dist_atten_scale *
+                                length(-view - light_src[num].position) +
+                                light_src[num].dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(16 + num, index);
+        }
+
+        float geo_factor = 1.0;
+        if (light_atten[i].z != 0 || light_atten[i].w != 0) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        vec3 specular_0 = light_src[num].specular_0;
+        if (lighting_luts[LUT_D0].x != 0) {
+            specular_0 *= lut_scale_d0 * LookupLUT(LUT_D0, 0, num);
+        }
+        if (light_atten[i].z != 0) {
+            specular_0 *= geo_factor;
+        }
+
+        vec3 refl_value = vec3(1.0);
+        if (lighting_luts[LUT_RR].x != 0) {
+            refl_value.r = lut_scale_rr * LookupLUT(LUT_RR, 6, num);
+        }
+        refl_value.g = refl_value.r;
+        if (lighting_luts[LUT_RG].x != 0) {
+            refl_value.g = lut_scale_rg * LookupLUT(LUT_RG, 5, num);
+        }
+        refl_value.b = refl_value.r;
+        if (lighting_luts[LUT_RB].x != 0) {
+            refl_value.b = lut_scale_rb * LookupLUT(LUT_RB, 4, num);
+        }
+
+        vec3 specular_1 = refl_value * light_src[num].specular_1;
+        if (lighting_luts[LUT_D1].x != 0) {
+            specular_1 *= lut_scale_d1 * LookupLUT(LUT_D1, 1, num);
+        }
+        if (light_atten[i].w != 0) {
+            specular_1 *= geo_factor;
+        }
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (i == lighting_src_num - 1 && lighting_luts[LUT_FR].x != 0) {
+            float fresnel = lut_scale_fr * LookupLUT(LUT_FR, 3, num);
+            if (lighting_primary_alpha != 0) {
+                diffuse_sum.a = fresnel;
+            }
+            if (lighting_secondary_alpha != 0) {
+                specular_sum.a = fresnel;
+            }
+        }
+
+        bool light_shadow = light_config[i].w != 0;
+        vec3 shadow_primary = lighting_shadow_primary != 0 && light_shadow ? shadow.rgb : vec3(1.0);
+        vec3 shadow_secondary =
+            lighting_shadow_secondary != 0 && light_shadow ? shadow.rgb : vec3(1.0);
+
+        diffuse_sum.rgb += ((light_src[num].diffuse * dot_product) + light_src[num].ambient) *
+                           dist_atten * spot_atten * shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary;
+    }
+
+    if (lighting_shadow_alpha != 0) {
+        if (lighting_primary_alpha != 0) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if (lighting_secondary_alpha != 0) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+void main() {
+    rounded_primary_color = byteround(primary_color);
+
+    if (alpha_test_func == 0) {
+        discard;
+    }
+
+    if (scissor_test_mode != 0) {
+        bool inside = gl_FragCoord.x >= float(scissor_x1) &&
+                      gl_FragCoord.y >= float(scissor_y1) &&
+                      gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+        // Include keeps the pixels inside the scissor box, Exclude the ones outside of it
+        if (inside != (scissor_test_mode == 3)) {
+            discard;
+        }
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (depthmap_enable == 0) {
+        depth /= gl_FragCoord.w;
+    }
+
+    // The textures are sampled up front, where the derivatives of the coordinates are defined
+    texcolor[0] = SampleTexture0();
+    texcolor[1] = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))));
+    vec2 texcoord2_used = texture2_use_coord1 != 0 ? texcoord1 : texcoord2;
+    texcolor[2] = textureLod(tex2, texcoord2_used,
+                             getLod(texcoord2_used * vec2(textureSize(tex2, 0))));
+    texcolor[3] = vec4(0.0);
+
+    if (lighting_enable != 0) {
+        ComputeLighting();
+    }
+
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    for (int i = 0; i < NUM_TEV_STAGES; ++i) {
+        ivec4 stage = tev_stages[i];
+        int color_op = stage.z & 15;
+        int alpha_op = (stage.z >> 16) & 15;
+
+        vec3 color_output = byteround(ColorCombiner(color_op,
+            ColorModifier(stage.y & 15, GetSource(stage.x & 15, i)),
+            ColorModifier((stage.y >> 4) & 15, GetSource((stage.x >> 4) & 15, i)),
+            ColorModifier((stage.y >> 8) & 15, GetSource((stage.x >> 8) & 15, i))));
+
+        float alpha_output;
+        if (color_op == 7) {
+            // The result of Dot3_RGBA is also placed to the alpha component
+            alpha_output = color_output[0];
+        } else {
+            alpha_output = byteround(AlphaCombiner(alpha_op,
+                AlphaModifier((stage.y >> 12) & 7, GetSource((stage.x >> 16) & 15, i)),
+                AlphaModifier((stage.y >> 16) & 7, GetSource((stage.x >> 20) & 15, i)),
+                AlphaModifier((stage.y >> 20) & 7, GetSource((stage.x >> 24) & 15, i))));
+        }
+
+        last_tex_env_out = clamp(vec4(color_output * Multiplier(stage.w & 3),
+                                      alpha_output * Multiplier((stage.w >> 16) & 3)),
+                                 vec4(0.0), vec4(1.0));
+
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4) {
+            if ((combiner_buffer_input & (1 << i)) != 0) {
+                next_combiner_buffer.rgb = last_tex_env_out.rgb;
+            }
+            if ((combiner_buffer_input & (16 << i)) != 0) {
+                next_combiner_buffer.a = last_tex_env_out.a;
+            }
+        }
+    }
+
+    if (AlphaTestFails(int(last_tex_env_out.a * 255.0))) {
+        discard;
+    }
+
+    gl_FragDepth = depth;
+
+    if (fog_mode == 5) {
+        float fog_index = (fog_flip != 0 ? 1.0 - depth : depth) * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_lf, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    } else if (fog_mode == 7) {
+        // The gas mode is unimplemented
+        color = vec4(0.0);
+        return;
+    }
+
+    switch (logic_op) {
+    case 0: // Clear
+        color = vec4(0.0);
+        break;
+    case 4: // Set
+        color = vec4(1.0);
+        break;
+    case 5: // CopyInverted
+        color = vec4(1.0) - byteround(last_tex_env_out);
+        break;
+    default:
+        // Round the final fragment color to maintain the PICA's 8 bits of precision
+        color = byteround(last_tex_env_out);
+        break;
+    }
+}
+)";
+
+    return out;
+}
+
 std::string GenerateTrivialVertexShader(bool separable_shader) {
     std::string out;
     if (separable_shader) {
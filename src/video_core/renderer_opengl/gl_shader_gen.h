@@ -224,4 +224,19 @@ std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config, bool se
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader);
 
+/**
+ * Whether the fragment uber shader can draw the given Pica state, it has no procedural texture and
+ * no shadow rendering
+ */
+bool CanUseFragmentUberShader(const PicaFSConfig& config);
+
+/**
+ * Generates the GLSL fragment shader program source code that reads the Pica state from the
+ * fs_config uniform block instead of having it baked in, so that one program draws any state
+ * CanUseFragmentUberShader accepts
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+std::string GenerateFragmentUberShader(bool separable_shader);
+
 } // namespace OpenGL
@@ -3,9 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <future>
 #include <unordered_map>
-#include "core/cache_file.h"
+#include "core/cache_journal.h"
 #include "core/settings.h"
+#include "video_core/renderer_opengl/gl_async_shader_compiler.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/renderer_opengl/on_screen_display.h"
 
@@ -29,6 +32,8 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
     SetShaderUniformBlockBinding(shader, "shader_light_data", UniformBindings::Light,
                                  sizeof(UniformLightData));
     SetShaderUniformBlockBinding(shader, "vs_config", UniformBindings::VS, sizeof(VSUniformData));
+    SetShaderUniformBlockBinding(shader, "fs_config", UniformBindings::FSConfig,
+                                 sizeof(UberFSUniformData));
 }
 
 static void SetShaderSamplerBinding(GLuint shader, const char* name,
@@ -86,6 +91,67 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs,
                    });
 }
 
+void UberFSUniformData::SetFromConfig(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    combiner_buffer_input = state.combiner_buffer_input;
+    alpha_test_func = static_cast<GLint>(state.alpha_test_func);
+    scissor_test_mode = static_cast<GLint>(state.scissor_test_mode);
+    texture0_type = static_cast<GLint>(state.texture0_type);
+    texture2_use_coord1 = state.texture2_use_coord1;
+    depthmap_enable = static_cast<GLint>(state.depthmap_enable);
+    fog_mode = static_cast<GLint>(state.fog_mode);
+    fog_flip = state.fog_flip;
+    logic_op = static_cast<GLint>(state.logic_op);
+    for (std::size_t i = 0; i < tev_stages.size(); ++i) {
+        const auto& stage = state.tev_stages[i];
+        tev_stages[i] = {static_cast<GLint>(stage.sources_raw),
+                         static_cast<GLint>(stage.modifiers_raw), static_cast<GLint>(stage.ops_raw),
+                         static_cast<GLint>(stage.scales_raw)};
+    }
+
+    const auto& lighting = state.lighting;
+    lighting_enable = lighting.enable;
+    lighting_src_num = static_cast<GLint>(lighting.src_num);
+    lighting_bump_mode = static_cast<GLint>(lighting.bump_mode);
+    lighting_bump_selector = static_cast<GLint>(lighting.bump_selector);
+    lighting_bump_renorm = lighting.bump_renorm;
+    lighting_clamp_highlights = lighting.clamp_highlights;
+    lighting_cp_input = lighting.config == Pica::LightingRegs::LightingConfig::Config7;
+    lighting_primary_alpha = lighting.enable_primary_alpha;
+    lighting_secondary_alpha = lighting.enable_secondary_alpha;
+    lighting_shadow_enable = lighting.enable_shadow;
+    lighting_shadow_primary = lighting.shadow_primary;
+    lighting_shadow_secondary = lighting.shadow_secondary;
+    lighting_shadow_invert = lighting.shadow_invert;
+    lighting_shadow_alpha = lighting.shadow_alpha;
+    lighting_shadow_selector = static_cast<GLint>(lighting.shadow_selector);
+    for (std::size_t i = 0; i < light_config.size(); ++i) {
+        const auto& light = lighting.light[i];
+        light_config[i] = {static_cast<GLint>(light.num), light.directional,
+                           light.two_sided_diffuse, light.shadow_enable};
+        light_atten[i] = {light.dist_atten_enable, light.spot_atten_enable,
+                          light.geometric_factor_0, light.geometric_factor_1};
+    }
+
+    // The LUTs the lighting config doesn't support are disabled here
+    using Sampler = Pica::LightingRegs::LightingSampler;
+    const auto lut = [&lighting](const auto& lut_config, Sampler sampler) -> GLivec4 {
+        const bool enable = lut_config.enable && Pica::LightingRegs::IsLightingSamplerSupported(
+                                                     lighting.config, sampler);
+        return {enable, lut_config.abs_input, static_cast<GLint>(lut_config.type), 0};
+    };
+    // In the order of the LUT_* defines of the shader
+    lighting_luts = {
+        lut(lighting.lut_d0, Sampler::Distribution0),
+        lut(lighting.lut_d1, Sampler::Distribution1),
+        lut(lighting.lut_sp, Sampler::SpotlightAttenuation),
+        lut(lighting.lut_fr, Sampler::Fresnel),
+        lut(lighting.lut_rr, Sampler::ReflectRed),
+        lut(lighting.lut_rg, Sampler::ReflectGreen),
+        lut(lighting.lut_rb, Sampler::ReflectBlue),
+    };
+}
+
 /**
  * An object representing a shader program staging. It can be either a shader object or a program
  * object, depending on whether separable program is used.
@@ -109,6 +175,29 @@ public:
         }
     }
 
+    /// Keeps the code to compile it on the async compiler instead
+    void Defer(const std::string& shader_code, GLenum type, u64 hash) {
+        this->hash = hash;
+        this->type = type;
+        code = std::make_shared<const std::string>(shader_code);
+    }
+
+    /// Compiles the deferred code in this context
+    void CreateDeferred() {
+        Create(*code, type, hash);
+        code.reset();
+    }
+
+    /// Sets the separable program the async compiler made of the deferred code
+    void SetProgram(OGLProgram&& compiled) {
+        program = std::move(compiled);
+        SetShaderUniformBlockBindings(program.handle);
+        if (type == GL_FRAGMENT_SHADER) {
+            SetShaderSamplerBindings(program.handle);
+        }
+        code.reset();
+    }
+
     GLuint GetHandle() const {
         if (separable) {
             return program.handle;
@@ -121,48 +210,91 @@ public:
         return hash;
     }
 
+    bool IsDeferred() const {
+        return code != nullptr;
+    }
+
+    /// Marks the deferred code as failed to compile, so that the draws stop waiting for it
+    void SetFailed() {
+        failed = true;
+    }
+
+    bool IsFailed() const {
+        return failed;
+    }
+
+    AsyncShaderCompiler::Source GetSource() const {
+        return {type, code};
+    }
+
 private:
     OGLShader shader;
     OGLProgram program;
     bool separable;
     u64 hash = 0;
+    GLenum type = GL_NONE;
+    std::shared_ptr<const std::string> code;
+    bool failed = false;
 };
 
 class ShaderProgramManager::Impl {
 public:
-    explicit Impl(bool separable)
+    explicit Impl(Frontend::EmuWindow& window, bool separable)
         : separable(separable), trivial_vertex_shader(separable),
           trivial_geometry_shader(separable) {
+        if (Settings::values.async_shader_compile) {
+            async_compiler = AsyncShaderCompiler::Create(window);
+        }
         if (separable) {
             pipeline.Create();
         } else if (Settings::values.use_shader_cache) {
-            u64 size = LoadProgramCache();
-            if (size > 0) {
-                std::string log{"Load Shader Cache"};
-                size >>= 20;
-                if (size > 0) {
-                    log = fmt::format("{} ({}MB)", log, size);
-                }
-                OSD::AddMessage(log, OSD::MessageType::ShaderCache, OSD::Duration::NORMAL,
-                                OSD::Color::YELLOW);
-            }
+            // The game boots while the journal is read, it is only waited for once the first draw
+            // needs the shaders
+            journal =
+                std::make_unique<Core::CacheJournal>(GetCacheFile(), PROGRAM_CACHE_VERSION);
+            cache_loader = std::async(std::launch::async, &Impl::LoadProgramCache, journal.get());
+        }
+        CreateStage(trivial_vertex_shader, GenerateTrivialVertexShader(separable), GL_VERTEX_SHADER,
+                    0);
+        if (!cache_loader.valid()) {
+            CreateUberShader();
         }
-        trivial_vertex_shader.Create(GenerateTrivialVertexShader(separable), GL_VERTEX_SHADER, 0);
     }
 
     ~Impl() {
-        if (!separable && Settings::values.use_shader_cache) {
-            SaveProgramCache();
+        if (cache_loader.valid()) {
+            cache_loader.wait();
+        }
+    }
+
+    /// Queues the uber shader on the async compiler first, as the draws whose programs are being
+    /// compiled need it
+    void CreateUberShader() {
+        if (!async_compiler) {
+            return;
+        }
+        uber_fragment_shader =
+            GetShaderStageRef(GenerateFragmentUberShader(separable), GL_FRAGMENT_SHADER);
+        if (separable) {
+            PrepareStageAsync(trivial_vertex_shader);
+            PrepareStageAsync(*uber_fragment_shader);
+        } else {
+            GetProgram(trivial_vertex_shader, trivial_geometry_shader, *uber_fragment_shader);
         }
     }
 
-    OGLShaderStage* GetShaderStageRef(const std::string& shader_code, GLenum shader_type) {
+    /**
+     * Gets the stage of the code, creating it if it is new.
+     * @param lazy Whether to only compile the stage once a program that has no binary needs it
+     */
+    OGLShaderStage* GetShaderStageRef(const std::string& shader_code, GLenum shader_type,
+                                      bool lazy = false) {
         const u64 code_hash = Common::ComputeHash64(shader_code.data(), shader_code.size());
         auto [iter, new_shader] = shaders.emplace(code_hash, separable);
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(shader_code, shader_type, code_hash);
-            if (cached_shader.GetHandle() == 0) {
+            CreateStage(cached_shader, shader_code, shader_type, code_hash, lazy);
+            if (!cached_shader.IsDeferred() && cached_shader.GetHandle() == 0) {
                 LOG_WARNING(Render_OpenGL, "shader {:04X} create failed!", shader_type);
                 shaders.erase(code_hash);
                 return nullptr;
@@ -179,6 +311,7 @@ public:
     }
 
     bool UseProgrammableVertexShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
+        WaitProgramCache();
         bool result = false;
         const PicaVSConfig key(regs, setup);
         const u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
@@ -191,31 +324,40 @@ public:
             } else {
                 current_shaders.vs = GetShaderStageRef(vs_code, GL_VERTEX_SHADER);
                 if (current_shaders.vs) {
+                    const u64 code_hash = current_shaders.vs->GetHash();
                     shaders_ref[key_hash] = current_shaders.vs;
-                    vertex_cache.emplace(current_shaders.vs->GetHash(), std::move(vs_code));
-                    result = true;
+                    AppendRecord(CacheRecord::ShaderRef, key_hash, &code_hash, sizeof(code_hash));
+                    auto [code, inserted] = vertex_cache.emplace(code_hash, std::move(vs_code));
+                    if (inserted) {
+                        AppendRecord(CacheRecord::VertexShader, code_hash, code->second.data(),
+                                     code->second.size());
+                    }
+                    // The software shader path draws if the deferred code failed to compile
+                    result = !current_shaders.vs->IsFailed();
                 }
             }
         } else {
             current_shaders.vs = iter_ref->second;
-            result = true;
+            result = !current_shaders.vs->IsFailed();
         }
         return result;
     }
 
     void UseFixedGeometryShader(const Pica::Regs& regs) {
+        WaitProgramCache();
         const PicaFixedGSConfig key(regs);
         const u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
         auto [iter, new_shader] = shaders.emplace(key_hash, separable);
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
             std::string gs_code = GenerateFixedGeometryShader(key, separable);
-            cached_shader.Create(gs_code, GL_GEOMETRY_SHADER, key_hash);
+            CreateStage(cached_shader, gs_code, GL_GEOMETRY_SHADER, key_hash);
         }
         current_shaders.gs = &cached_shader;
     }
 
     void UseFragmentShader(const Pica::Regs& regs) {
+        WaitProgramCache();
         const auto key = PicaFSConfig::BuildFromRegs(regs);
         const u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
         auto iter_ref = shaders_ref.find(key_hash);
@@ -223,12 +365,23 @@ public:
             std::string fs_code = GenerateFragmentShader(key, separable);
             current_shaders.fs = GetShaderStageRef(fs_code, GL_FRAGMENT_SHADER);
             if (current_shaders.fs) {
+                const u64 code_hash = current_shaders.fs->GetHash();
                 shaders_ref[key_hash] = current_shaders.fs;
-                fragment_cache.emplace(current_shaders.fs->GetHash(), std::move(fs_code));
+                AppendRecord(CacheRecord::ShaderRef, key_hash, &code_hash, sizeof(code_hash));
+                auto [code, inserted] = fragment_cache.emplace(code_hash, std::move(fs_code));
+                if (inserted) {
+                    AppendRecord(CacheRecord::FragmentShader, code_hash, code->second.data(),
+                                 code->second.size());
+                }
             }
         } else {
             current_shaders.fs = iter_ref->second;
         }
+
+        if (uber_fragment_shader) {
+            uber_usable = CanUseFragmentUberShader(key);
+            uber_config.SetFromConfig(key);
+        }
     }
 
     void UseTrivialVertexShader() {
@@ -239,59 +392,301 @@ public:
         current_shaders.gs = &trivial_geometry_shader;
     }
 
-    void ApplyTo(OpenGLState& state) {
-        GLuint vs = current_shaders.vs->GetHandle();
-        GLuint gs = current_shaders.gs->GetHandle();
-        GLuint fs = current_shaders.fs->GetHandle();
+    bool ApplyTo(OpenGLState& state) {
+        OGLShaderStage* vs = current_shaders.vs;
+        OGLShaderStage* gs = current_shaders.gs;
+        OGLShaderStage* fs = current_shaders.fs;
+        program_failed = false;
+        if (async_compiler) {
+            TakeCompiledPrograms();
+        }
 
         if (separable) {
-            glUseProgramStages(pipeline.handle, GL_VERTEX_SHADER_BIT, vs);
-            glUseProgramStages(pipeline.handle, GL_GEOMETRY_SHADER_BIT, gs);
-            glUseProgramStages(pipeline.handle, GL_FRAGMENT_SHADER_BIT, fs);
+            if (async_compiler) {
+                // All the missing stages are queued at once
+                const bool vs_ready = PrepareStageAsync(*vs);
+                const bool gs_ready = PrepareStageAsync(*gs);
+                bool fs_ready = PrepareStageAsync(*fs);
+                if (!fs_ready && uber_usable && PrepareStageAsync(*uber_fragment_shader)) {
+                    fs = uber_fragment_shader;
+                    fs_ready = true;
+                }
+                if (!vs_ready || !gs_ready || !fs_ready) {
+                    return false;
+                }
+            }
+            glUseProgramStages(pipeline.handle, GL_VERTEX_SHADER_BIT, vs->GetHandle());
+            glUseProgramStages(pipeline.handle, GL_GEOMETRY_SHADER_BIT, gs->GetHandle());
+            glUseProgramStages(pipeline.handle, GL_FRAGMENT_SHADER_BIT, fs->GetHandle());
             state.draw.shader_program = 0;
             state.draw.program_pipeline = pipeline.handle;
+            return true;
+        }
+
+        GLuint program = GetProgram(*vs, *gs, *fs);
+        if (program == 0 && !async_compiler) {
+            program_failed = true;
+            return false;
+        }
+        if (program == 0 && async_compiler) {
+            // Only the program of the software shader path has an uber shader variant, as linking
+            // one for each vertex shader would take as long as compiling the missing program
+            const bool software_path =
+                vs == &trivial_vertex_shader && gs == &trivial_geometry_shader;
+            if (!uber_usable || !software_path) {
+                return false;
+            }
+            program = GetProgram(*vs, *gs, *uber_fragment_shader);
+            if (program == 0) {
+                return false;
+            }
+        }
+        state.draw.shader_program = program;
+        state.draw.program_pipeline = 0;
+        return true;
+    }
+
+    /**
+     * Gets the program linking the stages, creating it if it isn't cached.
+     * @returns The program, or 0 while the async compiler compiles it or if it failed to link
+     */
+    GLuint GetProgram(OGLShaderStage& vs, OGLShaderStage& gs, OGLShaderStage& fs) {
+        const std::array<u64, 3> bundle{vs.GetHash(), gs.GetHash(), fs.GetHash()};
+        u64 hash = Common::ComputeHash64(bundle.data(), bundle.size() * sizeof(u64));
+        if (failed_programs.count(hash) != 0) {
+            return 0;
+        }
+        auto& cached_program = program_cache[hash];
+        if (cached_program.handle == 0) {
+            if (async_compiler) {
+                if (!CreateProgramAsync(cached_program, hash, {&vs, &gs, &fs})) {
+                    return 0;
+                }
+            } else if (!CreateProgram(cached_program, hash, {&vs, &gs, &fs})) {
+                // Not linked again by the next draws
+                program_cache.erase(hash);
+                failed_programs.insert(hash);
+                return 0;
+            }
+            SetShaderUniformBlockBindings(cached_program.handle);
+            SetShaderSamplerBindings(cached_program.handle);
+        }
+        return cached_program.handle;
+    }
+
+    /// Compiles the stage now, or defers it to the async compiler, or to the first program that
+    /// needs it if lazy
+    void CreateStage(OGLShaderStage& stage, const std::string& shader_code, GLenum type, u64 hash,
+                     bool lazy = false) {
+        if (async_compiler || lazy) {
+            stage.Defer(shader_code, type, hash);
         } else {
-            const std::array<u64, 3> bundle{
-                current_shaders.vs->GetHash(),
-                current_shaders.gs->GetHash(),
-                current_shaders.fs->GetHash(),
-            };
-            u64 hash = Common::ComputeHash64(bundle.data(), bundle.size() * sizeof(u64));
-            auto& cached_program = program_cache[hash];
-            if (cached_program.handle == 0) {
-                CreateProgram(cached_program, hash, vs, gs, fs);
-                SetShaderUniformBlockBindings(cached_program.handle);
-                SetShaderSamplerBindings(cached_program.handle);
+            stage.Create(shader_code, type, hash);
+        }
+    }
+
+    /**
+     * Queues the separable program of a deferred stage on the async compiler.
+     * @returns Whether the stage is ready to use
+     */
+    bool PrepareStageAsync(const OGLShaderStage& stage) {
+        if (!stage.IsDeferred()) {
+            return true;
+        }
+        if (pending_programs.insert(stage.GetHash()).second) {
+            async_compiler->Compile({stage.GetHash(), true, false, {stage.GetSource()}});
+            ++num_compiling;
+        }
+        return false;
+    }
+
+    /**
+     * Creates the program from its binary in the cache, or queues it on the async compiler.
+     * @returns Whether the program was created
+     */
+    bool CreateProgramAsync(OGLProgram& program, u64 hash,
+                            const std::array<const OGLShaderStage*, 3>& stages) {
+        auto iter = binary_cache.find(hash);
+        if (iter != binary_cache.end()) {
+            MarkUsed(*iter);
+            auto warmed = warmed_programs.find(hash);
+            if (warmed != warmed_programs.end()) {
+                program = std::move(warmed->second);
+                warmed_programs.erase(warmed);
+                return true;
+            }
+            program.Create(iter->second.format, iter->second.binary);
+            if (program.handle != 0) {
+                return true;
+            }
+            // The driver rejected the binary, the program is compiled again and replaces it
+            binary_cache.erase(iter);
+        }
+
+        if (pending_programs.insert(hash).second) {
+            AsyncShaderCompiler::Job job{hash, false, true, {}};
+            for (const OGLShaderStage* stage : stages) {
+                // The trivial geometry shader has no code, no geometry shader is used then
+                if (stage->IsDeferred()) {
+                    job.sources.push_back(stage->GetSource());
+                }
+            }
+            async_compiler->Compile(std::move(job));
+            ++num_compiling;
+            if (stages[0] != &trivial_vertex_shader) {
+                program_vertex_shaders.emplace(hash, stages[0]->GetHash());
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Puts the programs the async compiler made to use. The ones that failed stay pending, so that
+     * the draws needing them are skipped like with a program that failed to link. Their vertex
+     * shader is marked as failed, the software shader path draws it from then on like when it
+     * fails to compile in the draw.
+     */
+    void TakeCompiledPrograms() {
+        for (auto& result : async_compiler->TakeCompiled()) {
+            if (result->from_binary) {
+                TakeWarmedProgram(*result);
+                continue;
+            }
+            --num_compiling;
+
+            // A separable program is the stage itself
+            u64 vertex_shader_hash = result->separable ? result->hash : 0;
+            auto iter = program_vertex_shaders.find(result->hash);
+            if (!result->separable && iter != program_vertex_shaders.end()) {
+                vertex_shader_hash = iter->second;
+                program_vertex_shaders.erase(iter);
+            }
+            if (result->program.handle == 0) {
+                LOG_WARNING(Render_OpenGL, "program {:016X} create failed!", result->hash);
+                auto stage = shaders.find(vertex_shader_hash);
+                if (vertex_shader_hash != trivial_vertex_shader.GetHash() &&
+                    stage != shaders.end()) {
+                    stage->second.SetFailed();
+                }
+                continue;
+            }
+            pending_programs.erase(result->hash);
+
+            if (result->separable) {
+                // The trivial vertex shader isn't in the shaders, it has the hash 0
+                OGLShaderStage& stage = result->hash == trivial_vertex_shader.GetHash()
+                                            ? trivial_vertex_shader
+                                            : shaders.at(result->hash);
+                stage.SetProgram(std::move(result->program));
+                continue;
+            }
+            SetShaderUniformBlockBindings(result->program.handle);
+            SetShaderSamplerBindings(result->program.handle);
+            if (!result->binary.empty()) {
+                AddProgramBinary(result->hash, result->binary_format, std::move(result->binary));
+            }
+            program_cache[result->hash] = std::move(result->program);
+        }
+        WarmProgramCache();
+    }
+
+    void TakeWarmedProgram(AsyncShaderCompiler::Result& result) {
+        --num_warming;
+        pending_programs.erase(result.hash);
+        if (result.program.handle == 0) {
+            // The binary doesn't fit the driver anymore, the program is compiled again when used
+            binary_cache.erase(result.hash);
+            return;
+        }
+        // Dropped if a draw already loaded the binary itself
+        auto iter = program_cache.find(result.hash);
+        if (iter == program_cache.end() || iter->second.handle == 0) {
+            warmed_programs.emplace(result.hash, std::move(result.program));
+        }
+    }
+
+    /**
+     * Loads the binaries of the cached programs on the async compiler while it has nothing else to
+     * do, the ones the earlier sessions used the most first. Only a few are queued at a time, so
+     * that the new programs of the game don't wait behind them and the binaries aren't copied all
+     * at once.
+     */
+    void WarmProgramCache() {
+        while (next_warm < warm_order.size() && num_warming < MAX_WARMING_PROGRAMS &&
+               num_compiling == 0) {
+            const u64 hash = warm_order[next_warm++];
+            auto iter = binary_cache.find(hash);
+            if (iter == binary_cache.end() || program_cache.count(hash) != 0 ||
+                !pending_programs.insert(hash).second) {
+                continue;
             }
-            state.draw.shader_program = cached_program.handle;
-            state.draw.program_pipeline = 0;
+            AsyncShaderCompiler::Job job{hash, false, false, {}};
+            job.binary_format = iter->second.format;
+            job.binary = iter->second.binary;
+            async_compiler->Compile(std::move(job));
+            ++num_warming;
         }
     }
 
-    void CreateProgram(OGLProgram& program, u64 hash, GLuint vs, GLuint gs, GLuint fs) {
+    /**
+     * Creates the program from its binary in the cache, or compiles its deferred stages and links
+     * it.
+     * @returns Whether the program was created
+     */
+    bool CreateProgram(OGLProgram& program, u64 hash,
+                       const std::array<OGLShaderStage*, 3>& stages) {
         auto iter = binary_cache.find(hash);
         // load opengl program binary cache
         if (iter != binary_cache.end()) {
+            MarkUsed(*iter);
             program.Create(iter->second.format, iter->second.binary);
             if (program.handle == 0) {
-                // cache data corrupted
-                binary_cache.clear();
+                // The driver rejected the binary, the program is compiled again and replaces it
+                binary_cache.erase(iter);
             }
         }
         if (program.handle == 0) {
+            std::vector<GLuint> handles;
+            bool stages_failed = false;
+            for (OGLShaderStage* stage : stages) {
+                if (stage->IsDeferred()) {
+                    stage->CreateDeferred();
+                    if (stage->GetHandle() == 0) {
+                        stage->SetFailed();
+                    }
+                }
+                stages_failed |= stage->IsFailed();
+                handles.push_back(stage->GetHandle());
+            }
+            if (stages_failed) {
+                LOG_WARNING(Render_OpenGL, "program {:016X} has a stage that failed to compile",
+                            hash);
+                return false;
+            }
+
             GLenum format;
             std::vector<GLbyte> binary;
-            program.Create(false, {vs, gs, fs});
+            program.Create(false, handles);
+            GLint linked = GL_FALSE;
+            if (program.handle != 0) {
+                glGetProgramiv(program.handle, GL_LINK_STATUS, &linked);
+            }
+            if (linked != GL_TRUE) {
+                LOG_WARNING(Render_OpenGL, "program {:016X} create failed!", hash);
+                program.Release();
+                return false;
+            }
             program.GetProgramBinary(format, binary);
             if (!binary.empty()) {
-                binary_cache.emplace(hash, ProgramCacheEntity{format, std::move(binary)});
+                AddProgramBinary(hash, format, std::move(binary));
             } else {
                 LOG_DEBUG(Render_OpenGL, "failed to get program binary!");
             }
         }
+        return true;
     }
 
-    static constexpr u32 PROGRAM_CACHE_VERSION = 0x9;
+    static constexpr u32 PROGRAM_CACHE_VERSION = 0xB;
 
     static std::string GetCacheFile() {
         u64 program_id = 0;
@@ -300,149 +695,58 @@ public:
         return fmt::format("{}{:016X}.cache", dir, program_id);
     }
 
-    void SaveProgramCache() {
-        Core::CacheFile file(GetCacheFile(), Core::CacheFile::MODE_SAVE);
-
-        u32 verion = PROGRAM_CACHE_VERSION;
-        file.DoHeader(verion);
-
-        s32 count = static_cast<s32>(binary_cache.size());
-        file.Do(count);
-
-        u64 hash;
-        GLenum format;
-        std::vector<GLbyte> binary;
-        for (auto& pair : binary_cache) {
-            hash = pair.first;
-            format = pair.second.format;
-            file.Do(hash);
-            file.Do(format);
-            file.Do(pair.second.binary);
-        }
-
-        if (!file.IsGood()) {
+    /// Takes what the loader thread read from the cache journal
+    void WaitProgramCache() {
+        if (!cache_loader.valid()) {
             return;
         }
+        LoadedCache cache = cache_loader.get();
+        binary_cache.merge(cache.binary_cache);
+        reference_cache.merge(cache.reference_cache);
+        vertex_cache.merge(cache.vertex_cache);
+        fragment_cache.merge(cache.fragment_cache);
 
-        file.DoMarker("ShadersRef");
-        SaveShadersRef(file);
-        if (!file.IsGood()) {
-            return;
-        }
-
-        file.DoMarker("VertexCache");
-        file.Do(vertex_cache);
-
-        file.DoMarker("FragmentCache");
-        file.Do(fragment_cache);
-    }
-
-    u64 LoadProgramCache() {
-        Core::CacheFile file(GetCacheFile(), Core::CacheFile::MODE_LOAD);
-
-        u32 verion = 0;
-        file.DoHeader(verion);
-        if (verion != PROGRAM_CACHE_VERSION) {
-            FileUtil::Delete(GetCacheFile());
-            return 0;
-        }
-
-        s32 count = 0;
-        file.Do(count);
-
-        u64 hash;
-        GLenum format;
-        std::vector<GLbyte> binary;
-        for (s32 i = 0; i < count; ++i) {
-            file.Do(hash);
-            file.Do(format);
-            file.Do(binary);
-            binary_cache.emplace(hash, ProgramCacheEntity{format, std::move(binary)});
-        }
-
-        if (!file.IsGood()) {
-            binary_cache.clear();
-            return 0;
-        }
-
-        file.DoMarker("ShadersRef");
-        LoadShadersRef(file);
-        if (!file.IsGood()) {
-            reference_cache.clear();
-            return 0;
-        }
-
-        file.DoMarker("VertexCache");
-        file.Do(vertex_cache);
-        if (!file.IsGood()) {
-            vertex_cache.clear();
-            return 0;
-        }
-
-        file.DoMarker("FragmentCache");
-        file.Do(fragment_cache);
-        if (!file.IsGood()) {
-            fragment_cache.clear();
-            return 0;
-        }
-
-        // load vertex shader cache
-        std::vector<u64> error_caches;
+        // The stages are only compiled once a program that has no binary needs them
         for (const auto& entity : vertex_cache) {
-            if (!GetShaderStageRef(entity.second, GL_VERTEX_SHADER)) {
-                error_caches.push_back(entity.first);
-            }
+            GetShaderStageRef(entity.second, GL_VERTEX_SHADER, true);
         }
-        for (auto key : error_caches) {
-            vertex_cache.erase(key);
+        for (const auto& entity : fragment_cache) {
+            GetShaderStageRef(entity.second, GL_FRAGMENT_SHADER, true);
         }
 
-        // load fragment shader cache
-        error_caches.clear();
-        for (const auto& entity : fragment_cache) {
-            if (!GetShaderStageRef(entity.second, GL_FRAGMENT_SHADER)) {
-                error_caches.push_back(entity.first);
+        if (cache.size > 0) {
+            std::string log{"Load Shader Cache"};
+            const u64 size = cache.size >> 20;
+            if (size > 0) {
+                log = fmt::format("{} ({}MB)", log, size);
             }
-        }
-        for (auto key : error_caches) {
-            fragment_cache.erase(key);
+            OSD::AddMessage(log, OSD::MessageType::ShaderCache, OSD::Duration::NORMAL,
+                            OSD::Color::YELLOW);
         }
 
-        return file.GetSize();
-    }
-
-    void SaveShadersRef(Core::CacheFile& file) {
-        for (const auto& ref : shaders_ref) {
-            u64 key_hash = ref.first;
-            u64 code_hash = ref.second->GetHash();
-            auto iter = reference_cache.find(code_hash);
-            if (iter != reference_cache.end()) {
-                iter->second.insert(key_hash);
-            } else {
-                reference_cache[code_hash] = {key_hash};
+        CreateUberShader();
+        if (async_compiler) {
+            warm_order.reserve(binary_cache.size());
+            for (const auto& entity : binary_cache) {
+                warm_order.push_back(entity.first);
             }
+            std::stable_sort(warm_order.begin(), warm_order.end(), [this](u64 a, u64 b) {
+                return binary_cache.at(a).uses > binary_cache.at(b).uses;
+            });
+            WarmProgramCache();
         }
+    }
 
-        u32 count = reference_cache.size();
-        file.Do(count);
-
-        for (auto& ref : reference_cache) {
-            file.Do(ref.first);
-            file.Do(ref.second);
-        }
+    const UberFSUniformData* GetUberShaderConfig() const {
+        return uber_fragment_shader != nullptr ? &uber_config : nullptr;
     }
 
-    void LoadShadersRef(Core::CacheFile& file) {
-        s32 count = 0;
-        file.Do(count);
+    bool HasUberShaderFallback() const {
+        return uber_usable;
+    }
 
-        for (s32 i = 0; i < count; ++i) {
-            u64 code_hash = 0;
-            std::unordered_set<u64> hash_set;
-            file.Do(code_hash);
-            file.Do(hash_set);
-            reference_cache[code_hash] = std::move(hash_set);
-        }
+    bool HasProgramFailed() const {
+        return program_failed;
     }
 
 private:
@@ -455,11 +759,117 @@ private:
     } current_shaders{};
 
     struct ProgramCacheEntity {
-        explicit ProgramCacheEntity(GLenum format, std::vector<GLbyte>&& binary)
-            : format(format), binary(binary) {}
+        explicit ProgramCacheEntity(GLenum format, std::vector<GLbyte>&& binary, u32 uses = 0)
+            : format(format), binary(binary), uses(uses) {}
         GLenum format;
         std::vector<GLbyte> binary;
+        /// Number of the earlier sessions that used the program
+        u32 uses;
+        /// Whether this session used it
+        bool used = false;
+    };
+
+    /// Types of the records of the cache journal
+    enum class CacheRecord : u32 {
+        /// Key: program hash, data: binary format and binary
+        ProgramBinary,
+        /// Key: program hash, data: number of the sessions that used the program
+        ProgramUses,
+        /// Key: code hash, data: code
+        VertexShader,
+        FragmentShader,
+        /// Key: config hash, data: code hash of the shader generated for it
+        ShaderRef,
+    };
+
+    void AppendRecord(CacheRecord type, u64 key, const void* data, std::size_t size) {
+        if (journal) {
+            journal->Append(static_cast<u32>(type), key, data, size);
+        }
+    }
+
+    void AddProgramBinary(u64 hash, GLenum format, std::vector<GLbyte>&& binary) {
+        std::vector<u8> data(sizeof(format) + binary.size());
+        std::memcpy(data.data(), &format, sizeof(format));
+        std::memcpy(data.data() + sizeof(format), binary.data(), binary.size());
+        AppendRecord(CacheRecord::ProgramBinary, hash, data.data(), data.size());
+
+        auto [entity, inserted] =
+            binary_cache.insert_or_assign(hash, ProgramCacheEntity{format, std::move(binary)});
+        MarkUsed(*entity);
+    }
+
+    /// Counts the session in the uses of the program the first time it uses it
+    void MarkUsed(std::pair<const u64, ProgramCacheEntity>& entity) {
+        if (entity.second.used) {
+            return;
+        }
+        entity.second.used = true;
+        const u32 uses = entity.second.uses + 1;
+        AppendRecord(CacheRecord::ProgramUses, entity.first, &uses, sizeof(uses));
+    }
+
+    /// What the loader thread read from the cache journal
+    struct LoadedCache {
+        std::unordered_map<u64, ProgramCacheEntity> binary_cache;
+        std::unordered_map<u64, std::unordered_set<u64>> reference_cache;
+        std::unordered_map<u64, std::string> vertex_cache;
+        std::unordered_map<u64, std::string> fragment_cache;
+        /// Size of the journal
+        u64 size = 0;
     };
+
+    /// Rebuilds the caches from the records of the journal, on the loader thread
+    static LoadedCache LoadProgramCache(Core::CacheJournal* journal) {
+        LoadedCache cache;
+        std::unordered_map<u64, u32> uses;
+        for (auto& record : journal->Load()) {
+            const auto& data = record.data;
+            switch (static_cast<CacheRecord>(record.type)) {
+            case CacheRecord::ProgramBinary: {
+                GLenum format;
+                if (data.size() <= sizeof(format)) {
+                    break;
+                }
+                std::memcpy(&format, data.data(), sizeof(format));
+                std::vector<GLbyte> binary(data.size() - sizeof(format));
+                std::memcpy(binary.data(), data.data() + sizeof(format), binary.size());
+                cache.binary_cache.emplace(record.key,
+                                           ProgramCacheEntity{format, std::move(binary)});
+                break;
+            }
+            case CacheRecord::ProgramUses:
+                if (data.size() == sizeof(u32)) {
+                    std::memcpy(&uses[record.key], data.data(), sizeof(u32));
+                }
+                break;
+            case CacheRecord::VertexShader:
+                cache.vertex_cache.emplace(record.key, std::string(data.begin(), data.end()));
+                break;
+            case CacheRecord::FragmentShader:
+                cache.fragment_cache.emplace(record.key, std::string(data.begin(), data.end()));
+                break;
+            case CacheRecord::ShaderRef:
+                if (data.size() == sizeof(u64)) {
+                    u64 code_hash;
+                    std::memcpy(&code_hash, data.data(), sizeof(code_hash));
+                    cache.reference_cache[code_hash].insert(record.key);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        for (const auto& [hash, count] : uses) {
+            auto iter = cache.binary_cache.find(hash);
+            if (iter != cache.binary_cache.end()) {
+                iter->second.uses = count;
+            }
+        }
+        cache.size = journal->GetSize();
+        return cache;
+    }
+
     std::unordered_map<u64, ProgramCacheEntity> binary_cache;
     std::unordered_map<u64, std::unordered_set<u64>> reference_cache;
     std::unordered_map<u64, std::string> vertex_cache;
@@ -472,10 +882,41 @@ private:
 
     OGLPipeline pipeline;
     std::unordered_map<u64, OGLProgram> program_cache;
+    /// Programs that failed to compile or link without the async compiler
+    std::unordered_set<u64> failed_programs;
+    /// Whether the program of the last ApplyTo is one of them
+    bool program_failed = false;
+
+    std::unique_ptr<AsyncShaderCompiler> async_compiler;
+    /// Programs queued on the async compiler, the draws needing them use the uber shader or are
+    /// skipped until they're compiled
+    std::unordered_set<u64> pending_programs;
+    /// Vertex shaders of the pending programs that have a programmable one
+    std::unordered_map<u64, u64> program_vertex_shaders;
+
+    /// Only with the async compiler
+    OGLShaderStage* uber_fragment_shader = nullptr;
+    UberFSUniformData uber_config{};
+    /// Whether the uber shader can draw the current fragment state
+    bool uber_usable = false;
+
+    /// The program cache, appended as the programs are made so that a crash doesn't lose them
+    std::unique_ptr<Core::CacheJournal> journal;
+    std::future<LoadedCache> cache_loader;
+
+    /// Cached programs to load on the async compiler, by decreasing uses
+    std::vector<u64> warm_order;
+    std::size_t next_warm = 0;
+    std::size_t num_warming = 0;
+    /// Programs of the game the async compiler is compiling
+    std::size_t num_compiling = 0;
+    static constexpr std::size_t MAX_WARMING_PROGRAMS = 4;
+    /// Programs the async compiler loaded that no draw used yet
+    std::unordered_map<u64, OGLProgram> warmed_programs;
 };
 
-ShaderProgramManager::ShaderProgramManager(bool separable)
-    : impl(std::make_unique<Impl>(separable)) {}
+ShaderProgramManager::ShaderProgramManager(Frontend::EmuWindow& window, bool separable)
+    : impl(std::make_unique<Impl>(window, separable)) {}
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
@@ -500,8 +941,20 @@ void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
     impl->UseFragmentShader(regs);
 }
 
-void ShaderProgramManager::ApplyTo(OpenGLState& state) {
-    impl->ApplyTo(state);
+bool ShaderProgramManager::ApplyTo(OpenGLState& state) {
+    return impl->ApplyTo(state);
+}
+
+const UberFSUniformData* ShaderProgramManager::GetUberShaderConfig() const {
+    return impl->GetUberShaderConfig();
+}
+
+bool ShaderProgramManager::HasUberShaderFallback() const {
+    return impl->HasUberShaderFallback();
+}
+
+bool ShaderProgramManager::HasProgramFailed() const {
+    return impl->HasProgramFailed();
 }
 
 } // namespace OpenGL
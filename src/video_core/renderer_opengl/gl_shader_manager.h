@@ -12,9 +12,13 @@
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 
+namespace Frontend {
+class EmuWindow;
+}
+
 namespace OpenGL {
 
-enum class UniformBindings : GLuint { Common, Light, VS, GS };
+enum class UniformBindings : GLuint { Common, Light, VS, GS, FSConfig };
 
 struct LightSrc {
     alignas(16) GLvec3 specular_0;
@@ -97,10 +101,54 @@ static_assert(
 static_assert(sizeof(VSUniformData) < 0x4000,
               "VSUniformData structure must be less than 16kb as per the OpenGL spec");
 
-/// A class that manage different shader stages and configures them with given config data.
+/// Uniform struct for the Uniform Buffer Object of the fragment uber shader, that contains the Pica
+/// state the generated fragment shaders have baked in.
+// NOTE: the same rule from UniformData also applies here.
+struct UberFSUniformData {
+    void SetFromConfig(const PicaFSConfig& config);
+
+    GLint combiner_buffer_input;
+    GLint alpha_test_func;
+    GLint scissor_test_mode;
+    GLint texture0_type;
+    GLint texture2_use_coord1;
+    GLint depthmap_enable;
+    GLint fog_mode;
+    GLint fog_flip;
+    GLint logic_op;
+    GLint lighting_enable;
+    GLint lighting_src_num;
+    GLint lighting_bump_mode;
+    GLint lighting_bump_selector;
+    GLint lighting_bump_renorm;
+    GLint lighting_clamp_highlights;
+    GLint lighting_cp_input;
+    GLint lighting_primary_alpha;
+    GLint lighting_secondary_alpha;
+    GLint lighting_shadow_enable;
+    GLint lighting_shadow_primary;
+    GLint lighting_shadow_secondary;
+    GLint lighting_shadow_invert;
+    GLint lighting_shadow_alpha;
+    GLint lighting_shadow_selector;
+    alignas(16) std::array<GLivec4, 6> tev_stages;
+    alignas(16) std::array<GLivec4, 8> light_config;
+    alignas(16) std::array<GLivec4, 8> light_atten;
+    alignas(16) std::array<GLivec4, 7> lighting_luts;
+};
+static_assert(
+    sizeof(UberFSUniformData) == 0x230,
+    "The size of the UberFSUniformData structure has changed, update the structure in the shader");
+
+/**
+ * A class that manage different shader stages and configures them with given config data.
+ * With async_shader_compile, new programs are compiled on the shader compiler threads of the
+ * window's shared contexts instead of in the draws, and the fragment uber shader draws in the
+ * meantime.
+ */
 class ShaderProgramManager {
 public:
-    ShaderProgramManager(bool separable);
+    ShaderProgramManager(Frontend::EmuWindow& window, bool separable);
     ~ShaderProgramManager();
 
     bool UseProgrammableVertexShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup);
@@ -113,7 +161,24 @@ public:
 
     void UseFragmentShader(const Pica::Regs& regs);
 
-    void ApplyTo(OpenGLState& state);
+    /**
+     * Sets the program of the current shaders in the state. While it is being compiled, the uber
+     * shader draws the fragments instead if it can.
+     * @returns false if the program is still being compiled or failed, the draw has to be skipped
+     * then
+     */
+    bool ApplyTo(OpenGLState& state);
+
+    /// Gets the uniforms the uber shader needs to draw the current fragment state, or nullptr if
+    /// there is no uber shader
+    const UberFSUniformData* GetUberShaderConfig() const;
+
+    /// Whether the software shader path can draw the current fragment state with the uber shader
+    bool HasUberShaderFallback() const;
+
+    /// Whether the program of the last ApplyTo failed to compile or link, the software shader path
+    /// draws with its own program then
+    bool HasProgramFailed() const;
 
 private:
     class Impl;
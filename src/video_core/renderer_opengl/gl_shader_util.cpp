@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <glad/glad.h>
@@ -68,8 +69,8 @@ GLuint LoadShader(const char* source, GLenum type) {
             LOG_ERROR(Render_OpenGL, "Error compiling {} shader:\n{}", debug_type,
                       &shader_error[0]);
             LOG_ERROR(Render_OpenGL, "Shader source code:\n{}{}", src_arr[0], src_arr[1]);
-            // dump shader source code to file
-            static u32 file_id = 0;
+            // dump shader source code to file, shaders can be compiled on several threads
+            static std::atomic<u32> file_id{0};
             const std::string& log_dir = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
             const std::string filepath = fmt::format("{}{}_{}.txt", log_dir, debug_type, file_id++);
             std::string shader(src_arr[0]);
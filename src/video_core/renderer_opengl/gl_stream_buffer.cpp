@@ -2,25 +2,52 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <deque>
-#include <vector>
+#include <algorithm>
 #include "common/alignment.h"
-#include "common/microprofile.h"
-#include "core/settings.h"
-#include "video_core/renderer_opengl/gl_state.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
 #include "video_core/renderer_opengl/gl_stream_buffer.h"
+#include "video_core/renderer_opengl/gl_vars.h"
 
 namespace OpenGL {
 
-OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size) : gl_target(target), buffer_size(size) {
+/// Timeout of each wait for a fence, the wait goes on until it is signaled
+constexpr GLuint64 FENCE_WAIT_TIMEOUT = 1'000'000'000;
+
+OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size)
+    : gl_target(target), buffer_size(size),
+      region_size((size + NUM_REGIONS - 1) / NUM_REGIONS) {
     gl_buffer.Create();
     glBindBuffer(gl_target, gl_buffer.handle);
-    // prefer `glBufferData` than `glBufferStorage` on mobile device
+
+    const bool buffer_storage = GLES ? GLAD_GL_EXT_buffer_storage : GLAD_GL_ARB_buffer_storage;
+    if (buffer_storage) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        if (GLES) {
+            glBufferStorageEXT(gl_target, buffer_size, nullptr, flags);
+        } else {
+            glBufferStorage(gl_target, buffer_size, nullptr, flags);
+        }
+        persistent_ptr = static_cast<u8*>(glMapBufferRange(gl_target, 0, buffer_size, flags));
+        if (persistent_ptr != nullptr) {
+            return;
+        }
+        // The storage is immutable, the fallback needs a new buffer
+        LOG_WARNING(Render_OpenGL, "Failed to map stream buffer {:04X} persistently", target);
+        gl_buffer.Release();
+        gl_buffer.Create();
+        glBindBuffer(gl_target, gl_buffer.handle);
+    }
     glBufferData(gl_target, buffer_size, nullptr, GL_STREAM_DRAW);
-    gl_target_invalidate_hack = Settings::values.stream_buffer_hack ? GL_TEXTURE_BUFFER : 0;
 }
 
 OGLStreamBuffer::~OGLStreamBuffer() {
+    for (GLsync fence : fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
+    // Deleting the buffer unmaps it
     gl_buffer.Release();
 }
 
@@ -33,33 +60,83 @@ GLsizeiptr OGLStreamBuffer::GetSize() const {
 }
 
 std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr alignment) {
+    DEBUG_ASSERT(size <= buffer_size);
     bool invalidate = false;
 
     buffer_pos = Common::AlignUp<std::size_t>(buffer_pos, alignment);
     if (buffer_pos + size > buffer_size) {
+        FenceRegions(NUM_REGIONS);
+        fenced_region = 0;
         buffer_pos = 0;
-        if (gl_target_invalidate_hack == 0 || gl_target == gl_target_invalidate_hack) {
-            invalidate = true;
-        }
+        invalidate = true;
     }
 
-    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT |
-                       (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
-    u8* mapped_ptr = static_cast<u8*>(glMapBufferRange(gl_target, buffer_pos, size, flags));
+    // The chunks the draws keep bound are uploaded again in each region, so that a region is only
+    // read by the draws issued before its fence
+    const std::size_t begin = GetRegion(buffer_pos);
+    if (begin != fenced_region) {
+        FenceRegions(begin);
+        invalidate = true;
+    }
+    WaitRegions(begin, GetRegion(buffer_pos + std::max<GLsizeiptr>(size, 1) - 1) + 1);
+
+    u8* mapped_ptr;
+    if (persistent_ptr != nullptr) {
+        mapped_ptr = persistent_ptr + buffer_pos;
+    } else {
+        // The fences already keep the chunk from being written while the GPU reads it
+        constexpr GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        mapped_ptr = static_cast<u8*>(glMapBufferRange(gl_target, buffer_pos, size, flags));
+    }
     return std::make_tuple(mapped_ptr, buffer_pos, invalidate);
 }
 
 void OGLStreamBuffer::Unmap(GLsizeiptr size) {
-    if (size > 0) {
-        // flush is relative to the start of the currently mapped range of buffer
-        glFlushMappedBufferRange(gl_target, 0, size);
-        GLenum error = glGetError();
-        if (error != GL_NO_ERROR) {
-            LOG_DEBUG(Render_OpenGL, "flush mapped buffer range error: {:04X}, target: {:04X}, offset: {}, size: {}, total: {}", error, gl_target, buffer_pos, size, buffer_size);
+    if (persistent_ptr == nullptr) {
+        if (size > 0) {
+            // flush is relative to the start of the currently mapped range of buffer
+            glFlushMappedBufferRange(gl_target, 0, size);
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR) {
+                LOG_DEBUG(Render_OpenGL,
+                          "flush mapped buffer range error: {:04X}, target: {:04X}, offset: {}, "
+                          "size: {}, total: {}",
+                          error, gl_target, buffer_pos, size, buffer_size);
+            }
         }
+        glUnmapBuffer(gl_target);
     }
-    glUnmapBuffer(gl_target);
     buffer_pos += size;
 }
 
+std::size_t OGLStreamBuffer::GetRegion(GLintptr offset) const {
+    return static_cast<std::size_t>(offset / region_size);
+}
+
+void OGLStreamBuffer::FenceRegions(std::size_t end) {
+    for (; fenced_region < end; ++fenced_region) {
+        // The regions a lap skipped at the end still have the fence of the previous lap
+        GLsync& fence = fences[fenced_region];
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void OGLStreamBuffer::WaitRegions(std::size_t begin, std::size_t end) {
+    for (std::size_t region = begin; region < end; ++region) {
+        GLsync& fence = fences[region];
+        if (fence == nullptr) {
+            continue;
+        }
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT) ==
+               GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
 } // namespace OpenGL
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
 #include <glad/glad.h>
 #include "common/common_types.h"
@@ -11,6 +12,14 @@
 
 namespace OpenGL {
 
+/**
+ * Ring buffer for the data the draws upload. With buffer storage, the buffer stays mapped
+ * persistently and coherently, otherwise the chunks are mapped unsynchronized. Either way, the
+ * buffer is never orphaned and the driver never waits for the GPU: the buffer is split in regions
+ * and a fence is put after the draws of each region once the writes leave it, so that it is only
+ * waited for if the ring comes back to a region the GPU still reads. Leaving a region invalidates
+ * its chunks, so that no draw after the fence reads them.
+ */
 class OGLStreamBuffer : private NonCopyable {
 public:
     explicit OGLStreamBuffer(GLenum target, GLsizeiptr size);
@@ -22,9 +31,11 @@ public:
     /*
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
-     * If the buffer is full, the whole buffer is reallocated which invalidates old chunks.
+     * If the buffer is full, the chunks wrap around to its start.
      * The return values are the pointer to the new chunk, the offset within the buffer,
-     * and the invalidation flag for previous chunks.
+     * and the invalidation flag for previous chunks. The flag is set whenever the chunk starts in
+     * another region than the previous one: the data the draws keep bound must then be uploaded
+     * again in the new chunk, as the GPU is only waited for up to the last use of the region.
      * The actual used size must be specified on unmapping the chunk.
      */
     std::tuple<u8*, GLintptr, bool> Map(GLsizeiptr size, GLintptr alignment);
@@ -32,12 +43,29 @@ public:
     void Unmap(GLsizeiptr size);
 
 private:
+    static constexpr std::size_t NUM_REGIONS = 8;
+
+    std::size_t GetRegion(GLintptr offset) const;
+
+    /// Puts a fence after the draws of the regions written since the last fence, up to the end one
+    void FenceRegions(std::size_t end);
+
+    /// Waits for the GPU to be done with the regions
+    void WaitRegions(std::size_t begin, std::size_t end);
+
     OGLBuffer gl_buffer;
     GLenum gl_target;
-    GLenum gl_target_invalidate_hack;
 
     GLintptr buffer_pos = 0;
     GLsizeiptr buffer_size = 0;
+
+    /// The persistent mapping of the whole buffer, nullptr without buffer storage
+    u8* persistent_ptr = nullptr;
+
+    GLsizeiptr region_size;
+    std::array<GLsync, NUM_REGIONS> fences{};
+    /// First region written since the last fence
+    std::size_t fenced_region = 0;
 };
 
 } // namespace OpenGL
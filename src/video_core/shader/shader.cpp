@@ -97,6 +97,13 @@ void UnitState::WriteOutput(const ShaderRegs& config, AttributeBuffer& output) {
     CopyRegistersToOutput(registers.output, config.output_mask, output);
 }
 
+void UnitState::CarryOver(const UnitState& previous) {
+    std::memcpy(registers.temporary, previous.registers.temporary, sizeof(registers.temporary));
+    std::memcpy(registers.output, previous.registers.output, sizeof(registers.output));
+    std::memcpy(conditional_code, previous.conditional_code, sizeof(conditional_code));
+    std::memcpy(address_registers, previous.address_registers, sizeof(address_registers));
+}
+
 UnitState::UnitState(GSEmitter* emitter) : emitter_ptr(emitter) {}
 
 GSEmitter::GSEmitter() {
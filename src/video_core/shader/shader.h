@@ -159,6 +159,12 @@ struct UnitState {
     void LoadInput(const ShaderRegs& config, const AttributeBuffer& input);
 
     void WriteOutput(const ShaderRegs& config, AttributeBuffer& output);
+
+    /**
+     * Takes over the registers other than the inputs from the unit state of the previous vertex,
+     * which the shader unit keeps between vertices.
+     */
+    void CarryOver(const UnitState& previous);
 };
 
 /**
@@ -206,6 +212,10 @@ struct ShaderSetup {
         unsigned int entry_point;
         /// Used by the JIT, points to a compiled shader object.
         const void* cached_shader = nullptr;
+        /// Used by the JIT, points to a shader compiled for batches of vertices if supported.
+        const void* cached_batch_shader = nullptr;
+        /// Used by the interpreter, points to the pre-decoded program.
+        const void* decoded_program = nullptr;
     } engine_data;
 
     void MarkProgramCodeDirty() {
@@ -256,6 +266,26 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader on several vertices, with the same results as running it on
+     * a single shader unit loaded with each input in turn. Only the first state needs the registers
+     * left by the previous vertex, the others only need their inputs: each state takes over the
+     * other registers from the previous one before running. Engines that can process several
+     * vertices at once override this.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param states Shader unit states, must be setup with input data before each invocation.
+     * @param count Number of shader units in states.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, UnitState* states, std::size_t count) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                states[i].CarryOver(states[i - 1]);
+            }
+            Run(setup, states[i]);
+        }
+    }
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <memory>
 #include <numeric>
 #include <boost/container/static_vector.hpp>
 #include <boost/range/algorithm/fill.hpp>
@@ -36,6 +37,9 @@ struct CallStackElement {
     u32 loop_address;   // The address where we'll return to after each loop iteration
 };
 
+// Placeholder for invalid inputs
+static float24 dummy_vec4_float24[4];
+
 template <bool Debug>
 static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData<Debug>& debug_data,
                            unsigned offset) {
@@ -80,9 +84,6 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     const auto& swizzle_data = setup.swizzle_data;
     const auto& program_code = setup.program_code;
 
-    // Placeholder for invalid inputs
-    static float24 dummy_vec4_float24[4];
-
     unsigned iteration = 0;
     bool exit_loop = false;
     while (!exit_loop) {
@@ -666,9 +667,651 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     }
 }
 
+/// Register banks that source operands are read from
+enum class SourceBank : u8 { Input, Temporary, FloatUniform, Invalid };
+
+/// Register banks that results are written to
+enum class DestBank : u8 { Output, Temporary, Invalid };
+
+/// Source operand with its register and swizzle resolved
+struct DecodedSource {
+    SourceBank bank;
+    u8 index;
+    /// Register as encoded in the instruction, used when the operand is relatively addressed
+    u8 raw_register;
+    /// Address register added to the register index, or -1 if there is none
+    s8 address_register;
+    std::array<u8, 4> selector;
+    bool negate;
+};
+
+struct DecodedInstruction;
+struct DecodedContext;
+
+using DecodedHandler = void (*)(const DecodedInstruction& instr, DecodedContext& context);
+
+struct DecodedInstruction {
+    DecodedHandler handler;
+    /// The raw instruction, for the fields of flow control instructions
+    Instruction instr;
+    std::array<DecodedSource, 3> src;
+    DestBank dest_bank;
+    u8 dest_index;
+    /// Bit i is set if component i of the destination is written
+    u8 dest_mask;
+};
+
+/// State of one run of a decoded program
+struct DecodedContext {
+    UnitState& state;
+    const Uniforms& uniforms;
+    u32 program_counter;
+    boost::container::static_vector<CallStackElement, 16> call_stack{};
+    bool exit_loop = false;
+};
+
+static void ResolveSourceRegister(u32 reg, SourceBank& bank, u8& index) {
+    // Same mapping as SourceRegister::GetRegisterType, except that out of range uniforms are
+    // redirected to the placeholder
+    if (reg < 0x10) {
+        bank = SourceBank::Input;
+        index = static_cast<u8>(reg);
+    } else if (reg < 0x20) {
+        bank = SourceBank::Temporary;
+        index = static_cast<u8>(reg - 0x10);
+    } else if (reg < 0x20 + 96) {
+        bank = SourceBank::FloatUniform;
+        index = static_cast<u8>(reg - 0x20);
+    } else {
+        bank = SourceBank::Invalid;
+        index = 0;
+    }
+}
+
+static DecodedSource DecodeSource(u32 reg, int address_register_index, bool relative,
+                                  SwizzlePattern::Selector s0, SwizzlePattern::Selector s1,
+                                  SwizzlePattern::Selector s2, SwizzlePattern::Selector s3,
+                                  bool negate) {
+    DecodedSource src{};
+    ResolveSourceRegister(reg, src.bank, src.index);
+    src.raw_register = static_cast<u8>(reg);
+    src.address_register =
+        (relative && address_register_index != 0) ? static_cast<s8>(address_register_index - 1)
+                                                   : -1;
+    src.selector = {static_cast<u8>(s0), static_cast<u8>(s1), static_cast<u8>(s2),
+                    static_cast<u8>(s3)};
+    src.negate = negate;
+    return src;
+}
+
+static const float24* LookupDecodedSource(const DecodedSource& src,
+                                          const DecodedContext& context) {
+    SourceBank bank = src.bank;
+    u8 index = src.index;
+    if (src.address_register >= 0) {
+        // Relative addressing can move the operand to another bank, as it does in the interpreter
+        const u32 reg = src.raw_register + context.state.address_registers[src.address_register];
+        ResolveSourceRegister(reg, bank, index);
+    }
+
+    switch (bank) {
+    case SourceBank::Input:
+        return &context.state.registers.input[index].x;
+    case SourceBank::Temporary:
+        return &context.state.registers.temporary[index].x;
+    case SourceBank::FloatUniform:
+        return &context.uniforms.f[index].x;
+    default:
+        return dummy_vec4_float24;
+    }
+}
+
+static void FetchSource(const DecodedInstruction& instr, unsigned src_num,
+                        const DecodedContext& context, float24 (&value)[4]) {
+    const DecodedSource& src = instr.src[src_num];
+    const float24* reg = LookupDecodedSource(src, context);
+    for (int i = 0; i < 4; ++i) {
+        value[i] = src.negate ? -reg[src.selector[i]] : reg[src.selector[i]];
+    }
+}
+
+static float24* GetDest(const DecodedInstruction& instr, DecodedContext& context) {
+    switch (instr.dest_bank) {
+    case DestBank::Output:
+        return &context.state.registers.output[instr.dest_index][0];
+    case DestBank::Temporary:
+        return &context.state.registers.temporary[instr.dest_index][0];
+    default:
+        return dummy_vec4_float24;
+    }
+}
+
+/// Writes op(i) to each enabled component i of the destination
+template <typename Op>
+static void WriteDest(const DecodedInstruction& instr, DecodedContext& context, Op op) {
+    float24* dest = GetDest(instr, context);
+    for (int i = 0; i < 4; ++i) {
+        if (instr.dest_mask & (1 << i)) {
+            dest[i] = op(i);
+        }
+    }
+}
+
+template <typename Op>
+static void UnaryOp(const DecodedInstruction& instr, DecodedContext& context, Op op) {
+    float24 src1[4];
+    FetchSource(instr, 0, context, src1);
+    WriteDest(instr, context, [&](int i) { return op(src1[i]); });
+}
+
+template <typename Op>
+static void BinaryOp(const DecodedInstruction& instr, DecodedContext& context, Op op) {
+    float24 src1[4];
+    float24 src2[4];
+    FetchSource(instr, 0, context, src1);
+    FetchSource(instr, 1, context, src2);
+    WriteDest(instr, context, [&](int i) { return op(src1[i], src2[i]); });
+}
+
+/// Computes op on the first component of src1 and writes the result to all enabled components
+template <typename Op>
+static void ScalarOp(const DecodedInstruction& instr, DecodedContext& context, Op op) {
+    float24 src1[4];
+    FetchSource(instr, 0, context, src1);
+    const float24 result = float24::FromFloat32(op(src1[0].ToFloat32()));
+    WriteDest(instr, context, [&](int) { return result; });
+}
+
+static void HandleADD(const DecodedInstruction& instr, DecodedContext& context) {
+    BinaryOp(instr, context, [](float24 a, float24 b) { return a + b; });
+}
+
+static void HandleMUL(const DecodedInstruction& instr, DecodedContext& context) {
+    BinaryOp(instr, context, [](float24 a, float24 b) { return a * b; });
+}
+
+static void HandleFLR(const DecodedInstruction& instr, DecodedContext& context) {
+    UnaryOp(instr, context,
+            [](float24 a) { return float24::FromFloat32(std::floor(a.ToFloat32())); });
+}
+
+static void HandleMAX(const DecodedInstruction& instr, DecodedContext& context) {
+    // NOTE: Exact form required to match NaN semantics to hardware, see RunInterpreter
+    BinaryOp(instr, context, [](float24 a, float24 b) { return (a > b) ? a : b; });
+}
+
+static void HandleMIN(const DecodedInstruction& instr, DecodedContext& context) {
+    BinaryOp(instr, context, [](float24 a, float24 b) { return (a < b) ? a : b; });
+}
+
+template <int NumComponents, bool Homogeneous>
+static void HandleDP(const DecodedInstruction& instr, DecodedContext& context) {
+    float24 src1[4];
+    float24 src2[4];
+    FetchSource(instr, 0, context, src1);
+    FetchSource(instr, 1, context, src2);
+    if (Homogeneous)
+        src1[3] = float24::FromFloat32(1.0f);
+
+    const float24 dot =
+        std::inner_product(src1, src1 + NumComponents, src2, float24::FromFloat32(0.f));
+    WriteDest(instr, context, [&](int) { return dot; });
+}
+
+static void HandleRCP(const DecodedInstruction& instr, DecodedContext& context) {
+    ScalarOp(instr, context, [](float x) { return 1.0f / x; });
+}
+
+static void HandleRSQ(const DecodedInstruction& instr, DecodedContext& context) {
+    ScalarOp(instr, context, [](float x) { return 1.0f / std::sqrt(x); });
+}
+
+static void HandleEX2(const DecodedInstruction& instr, DecodedContext& context) {
+    ScalarOp(instr, context, [](float x) { return std::exp2(x); });
+}
+
+static void HandleLG2(const DecodedInstruction& instr, DecodedContext& context) {
+    ScalarOp(instr, context, [](float x) { return std::log2(x); });
+}
+
+static void HandleMOVA(const DecodedInstruction& instr, DecodedContext& context) {
+    float24 src1[4];
+    FetchSource(instr, 0, context, src1);
+    for (int i = 0; i < 2; ++i) {
+        if (instr.dest_mask & (1 << i)) {
+            // TODO: Figure out how the rounding is done on hardware
+            context.state.address_registers[i] = static_cast<s32>(src1[i].ToFloat32());
+        }
+    }
+}
+
+static void HandleMOV(const DecodedInstruction& instr, DecodedContext& context) {
+    UnaryOp(instr, context, [](float24 a) { return a; });
+}
+
+static void HandleSGE(const DecodedInstruction& instr, DecodedContext& context) {
+    BinaryOp(instr, context, [](float24 a, float24 b) {
+        return (a >= b) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+    });
+}
+
+static void HandleSLT(const DecodedInstruction& instr, DecodedContext& context) {
+    BinaryOp(instr, context, [](float24 a, float24 b) {
+        return (a < b) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+    });
+}
+
+static void HandleCMP(const DecodedInstruction& instr, DecodedContext& context) {
+    float24 src1[4];
+    float24 src2[4];
+    FetchSource(instr, 0, context, src1);
+    FetchSource(instr, 1, context, src2);
+
+    const auto compare_op = instr.instr.common.compare_op;
+    for (int i = 0; i < 2; ++i) {
+        const auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+        bool& result = context.state.conditional_code[i];
+
+        switch (op) {
+        case Instruction::Common::CompareOpType::Equal:
+            result = (src1[i] == src2[i]);
+            break;
+        case Instruction::Common::CompareOpType::NotEqual:
+            result = (src1[i] != src2[i]);
+            break;
+        case Instruction::Common::CompareOpType::LessThan:
+            result = (src1[i] < src2[i]);
+            break;
+        case Instruction::Common::CompareOpType::LessEqual:
+            result = (src1[i] <= src2[i]);
+            break;
+        case Instruction::Common::CompareOpType::GreaterThan:
+            result = (src1[i] > src2[i]);
+            break;
+        case Instruction::Common::CompareOpType::GreaterEqual:
+            result = (src1[i] >= src2[i]);
+            break;
+        default:
+            LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(op));
+            break;
+        }
+    }
+}
+
+static void HandleMAD(const DecodedInstruction& instr, DecodedContext& context) {
+    float24 src1[4];
+    float24 src2[4];
+    float24 src3[4];
+    FetchSource(instr, 0, context, src1);
+    FetchSource(instr, 1, context, src2);
+    FetchSource(instr, 2, context, src3);
+    WriteDest(instr, context, [&](int i) { return src1[i] * src2[i] + src3[i]; });
+}
+
+static void DecodedCall(DecodedContext& context, u32 offset, u32 num_instructions,
+                        u32 return_offset, u8 repeat_count, u8 loop_increment) {
+    // -1 to make sure when incrementing the PC we end up at the correct offset
+    context.program_counter = offset - 1;
+    ASSERT(context.call_stack.size() < context.call_stack.capacity());
+    context.call_stack.push_back(
+        {offset + num_instructions, return_offset, repeat_count, loop_increment, offset});
+}
+
+static bool EvaluateCondition(const UnitState& state, Instruction::FlowControlType flow_control) {
+    using Op = Instruction::FlowControlType::Op;
+
+    bool result_x = flow_control.refx.Value() == state.conditional_code[0];
+    bool result_y = flow_control.refy.Value() == state.conditional_code[1];
+
+    switch (flow_control.op) {
+    case Op::Or:
+        return result_x || result_y;
+    case Op::And:
+        return result_x && result_y;
+    case Op::JustX:
+        return result_x;
+    case Op::JustY:
+        return result_y;
+    default:
+        UNREACHABLE();
+        return false;
+    }
+}
+
+static void HandleNOP(const DecodedInstruction&, DecodedContext&) {}
+
+static void HandleEND(const DecodedInstruction&, DecodedContext& context) {
+    context.exit_loop = true;
+}
+
+static void HandleJMPC(const DecodedInstruction& instr, DecodedContext& context) {
+    if (EvaluateCondition(context.state, instr.instr.flow_control)) {
+        context.program_counter = instr.instr.flow_control.dest_offset - 1;
+    }
+}
+
+static void HandleJMPU(const DecodedInstruction& instr, DecodedContext& context) {
+    const auto& flow_control = instr.instr.flow_control;
+    if (context.uniforms.b[flow_control.bool_uniform_id] ==
+        !(flow_control.num_instructions & 1)) {
+        context.program_counter = flow_control.dest_offset - 1;
+    }
+}
+
+static void HandleCALL(const DecodedInstruction& instr, DecodedContext& context) {
+    const auto& flow_control = instr.instr.flow_control;
+    DecodedCall(context, flow_control.dest_offset, flow_control.num_instructions,
+                context.program_counter + 1, 0, 0);
+}
+
+static void HandleCALLU(const DecodedInstruction& instr, DecodedContext& context) {
+    if (context.uniforms.b[instr.instr.flow_control.bool_uniform_id]) {
+        HandleCALL(instr, context);
+    }
+}
+
+static void HandleCALLC(const DecodedInstruction& instr, DecodedContext& context) {
+    if (EvaluateCondition(context.state, instr.instr.flow_control)) {
+        HandleCALL(instr, context);
+    }
+}
+
+static void DecodedIf(const DecodedInstruction& instr, DecodedContext& context, bool condition) {
+    const auto& flow_control = instr.instr.flow_control;
+    const u32 end_offset = flow_control.dest_offset + flow_control.num_instructions;
+    if (condition) {
+        DecodedCall(context, context.program_counter + 1,
+                    flow_control.dest_offset - context.program_counter - 1, end_offset, 0, 0);
+    } else {
+        DecodedCall(context, flow_control.dest_offset, flow_control.num_instructions, end_offset,
+                    0, 0);
+    }
+}
+
+static void HandleIFU(const DecodedInstruction& instr, DecodedContext& context) {
+    DecodedIf(instr, context, context.uniforms.b[instr.instr.flow_control.bool_uniform_id]);
+}
+
+static void HandleIFC(const DecodedInstruction& instr, DecodedContext& context) {
+    DecodedIf(instr, context, EvaluateCondition(context.state, instr.instr.flow_control));
+}
+
+static void HandleLOOP(const DecodedInstruction& instr, DecodedContext& context) {
+    const auto& flow_control = instr.instr.flow_control;
+    const Common::Vec4<u8>& loop_param = context.uniforms.i[flow_control.int_uniform_id];
+    context.state.address_registers[2] = loop_param.y;
+
+    DecodedCall(context, context.program_counter + 1,
+                flow_control.dest_offset - context.program_counter, flow_control.dest_offset + 1,
+                loop_param.x, loop_param.z);
+}
+
+static void HandleEMIT(const DecodedInstruction&, DecodedContext& context) {
+    GSEmitter* emitter = context.state.emitter_ptr;
+    ASSERT_MSG(emitter, "Execute EMIT on VS");
+    emitter->Emit(context.state.registers.output);
+}
+
+static void HandleSETEMIT(const DecodedInstruction& instr, DecodedContext& context) {
+    GSEmitter* emitter = context.state.emitter_ptr;
+    ASSERT_MSG(emitter, "Execute SETEMIT on VS");
+    emitter->vertex_id = instr.instr.setemit.vertex_id;
+    emitter->prim_emit = instr.instr.setemit.prim_emit != 0;
+    emitter->winding = instr.instr.setemit.winding != 0;
+}
+
+static void HandleUnknownArithmetic(const DecodedInstruction& instr, DecodedContext&) {
+    LOG_ERROR(HW_GPU, "Unhandled arithmetic instruction: 0x{:02x} ({}): 0x{:08x}",
+              (int)instr.instr.opcode.Value().EffectiveOpCode(),
+              instr.instr.opcode.Value().GetInfo().name, instr.instr.hex);
+    DEBUG_ASSERT(false);
+}
+
+static void HandleUnknownMultiplyAdd(const DecodedInstruction& instr, DecodedContext&) {
+    LOG_ERROR(HW_GPU, "Unhandled multiply-add instruction: 0x{:02x} ({}): 0x{:08x}",
+              (int)instr.instr.opcode.Value().EffectiveOpCode(),
+              instr.instr.opcode.Value().GetInfo().name, instr.instr.hex);
+}
+
+static void HandleUnknown(const DecodedInstruction& instr, DecodedContext&) {
+    LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
+              (int)instr.instr.opcode.Value().EffectiveOpCode(),
+              instr.instr.opcode.Value().GetInfo().name, instr.instr.hex);
+}
+
+static DecodedHandler GetArithmeticHandler(OpCode::Id opcode) {
+    switch (opcode) {
+    case OpCode::Id::ADD:
+        return HandleADD;
+    case OpCode::Id::MUL:
+        return HandleMUL;
+    case OpCode::Id::FLR:
+        return HandleFLR;
+    case OpCode::Id::MAX:
+        return HandleMAX;
+    case OpCode::Id::MIN:
+        return HandleMIN;
+    case OpCode::Id::DP3:
+        return HandleDP<3, false>;
+    case OpCode::Id::DP4:
+        return HandleDP<4, false>;
+    case OpCode::Id::DPH:
+    case OpCode::Id::DPHI:
+        return HandleDP<4, true>;
+    case OpCode::Id::RCP:
+        return HandleRCP;
+    case OpCode::Id::RSQ:
+        return HandleRSQ;
+    case OpCode::Id::MOVA:
+        return HandleMOVA;
+    case OpCode::Id::MOV:
+        return HandleMOV;
+    case OpCode::Id::SGE:
+    case OpCode::Id::SGEI:
+        return HandleSGE;
+    case OpCode::Id::SLT:
+    case OpCode::Id::SLTI:
+        return HandleSLT;
+    case OpCode::Id::CMP:
+        return HandleCMP;
+    case OpCode::Id::EX2:
+        return HandleEX2;
+    case OpCode::Id::LG2:
+        return HandleLG2;
+    default:
+        return HandleUnknownArithmetic;
+    }
+}
+
+static DecodedHandler GetFlowControlHandler(OpCode::Id opcode) {
+    switch (opcode) {
+    case OpCode::Id::END:
+        return HandleEND;
+    case OpCode::Id::JMPC:
+        return HandleJMPC;
+    case OpCode::Id::JMPU:
+        return HandleJMPU;
+    case OpCode::Id::CALL:
+        return HandleCALL;
+    case OpCode::Id::CALLU:
+        return HandleCALLU;
+    case OpCode::Id::CALLC:
+        return HandleCALLC;
+    case OpCode::Id::NOP:
+        return HandleNOP;
+    case OpCode::Id::IFU:
+        return HandleIFU;
+    case OpCode::Id::IFC:
+        return HandleIFC;
+    case OpCode::Id::LOOP:
+        return HandleLOOP;
+    case OpCode::Id::EMIT:
+        return HandleEMIT;
+    case OpCode::Id::SETEMIT:
+        return HandleSETEMIT;
+    default:
+        return HandleUnknown;
+    }
+}
+
+static void DecodeDest(u32 reg, const SwizzlePattern& swizzle, DecodedInstruction& decoded) {
+    if (reg < 0x10) {
+        decoded.dest_bank = DestBank::Output;
+        decoded.dest_index = static_cast<u8>(reg);
+    } else if (reg < 0x20) {
+        decoded.dest_bank = DestBank::Temporary;
+        decoded.dest_index = static_cast<u8>(reg - 0x10);
+    } else {
+        decoded.dest_bank = DestBank::Invalid;
+        decoded.dest_index = 0;
+    }
+
+    decoded.dest_mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (swizzle.DestComponentEnabled(i))
+            decoded.dest_mask |= 1 << i;
+    }
+}
+
+static DecodedInstruction DecodeInstruction(Instruction instr, const SwizzleData& swizzle_data) {
+    DecodedInstruction decoded{};
+    decoded.instr = instr;
+
+    const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+    switch (instr.opcode.Value().GetInfo().type) {
+    case OpCode::Type::Arithmetic: {
+        const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        const int address_register = instr.common.address_register_index;
+
+        decoded.handler = GetArithmeticHandler(opcode);
+        decoded.src[0] = DecodeSource(
+            instr.common.GetSrc1(is_inverted), address_register, !is_inverted,
+            swizzle.src1_selector_0, swizzle.src1_selector_1, swizzle.src1_selector_2,
+            swizzle.src1_selector_3, swizzle.negate_src1 != 0);
+        decoded.src[1] = DecodeSource(
+            instr.common.GetSrc2(is_inverted), address_register, is_inverted,
+            swizzle.src2_selector_0, swizzle.src2_selector_1, swizzle.src2_selector_2,
+            swizzle.src2_selector_3, swizzle.negate_src2 != 0);
+        DecodeDest(instr.common.dest.Value(), swizzle, decoded);
+        break;
+    }
+
+    case OpCode::Type::MultiplyAdd: {
+        if (opcode != OpCode::Id::MAD && opcode != OpCode::Id::MADI) {
+            decoded.handler = HandleUnknownMultiplyAdd;
+            break;
+        }
+
+        const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+        const bool is_inverted = (opcode == OpCode::Id::MADI);
+        const int address_register = instr.mad.address_register_index;
+
+        decoded.handler = HandleMAD;
+        decoded.src[0] = DecodeSource(instr.mad.GetSrc1(is_inverted), address_register, false,
+                                      swizzle.src1_selector_0, swizzle.src1_selector_1,
+                                      swizzle.src1_selector_2, swizzle.src1_selector_3,
+                                      swizzle.negate_src1 != 0);
+        decoded.src[1] = DecodeSource(instr.mad.GetSrc2(is_inverted), address_register,
+                                      !is_inverted, swizzle.src2_selector_0,
+                                      swizzle.src2_selector_1, swizzle.src2_selector_2,
+                                      swizzle.src2_selector_3, swizzle.negate_src2 != 0);
+        decoded.src[2] = DecodeSource(instr.mad.GetSrc3(is_inverted), address_register,
+                                      is_inverted, swizzle.src3_selector_0,
+                                      swizzle.src3_selector_1, swizzle.src3_selector_2,
+                                      swizzle.src3_selector_3, swizzle.negate_src3 != 0);
+        DecodeDest(instr.mad.dest.Value(), swizzle, decoded);
+        break;
+    }
+
+    default:
+        decoded.handler = GetFlowControlHandler(instr.opcode.Value());
+        break;
+    }
+
+    return decoded;
+}
+
+/**
+ * A shader program lowered into pre-decoded instructions. The operand descriptors and the
+ * register operands of each instruction are resolved once, and each instruction points to the
+ * function that executes it, so running a vertex does not decode anything.
+ */
+class DecodedProgram {
+public:
+    DecodedProgram(const ProgramCode& program_code, const SwizzleData& swizzle_data) {
+        for (std::size_t i = 0; i < MAX_PROGRAM_CODE_LENGTH; ++i) {
+            instructions[i] = DecodeInstruction({program_code[i]}, swizzle_data);
+        }
+    }
+
+    /// Runs the program with the same results as RunInterpreter
+    void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
+        DecodedContext context{state, setup.uniforms, offset};
+
+        state.conditional_code[0] = false;
+        state.conditional_code[1] = false;
+
+        while (!context.exit_loop) {
+            if (!context.call_stack.empty()) {
+                auto& top = context.call_stack.back();
+                if (context.program_counter == top.final_address) {
+                    state.address_registers[2] += top.loop_increment;
+
+                    if (top.repeat_counter-- == 0) {
+                        context.program_counter = top.return_address;
+                        context.call_stack.pop_back();
+                    } else {
+                        context.program_counter = top.loop_address;
+                    }
+
+                    continue;
+                }
+            }
+
+            const DecodedInstruction& instr = instructions[context.program_counter];
+            instr.handler(instr, context);
+            ++context.program_counter;
+        }
+    }
+
+private:
+    std::array<DecodedInstruction, MAX_PROGRAM_CODE_LENGTH> instructions;
+};
+
+/// Maximum number of decoded programs kept in memory
+constexpr std::size_t MAX_DECODED_PROGRAMS = 64;
+
+InterpreterEngine::InterpreterEngine() = default;
+
+InterpreterEngine::~InterpreterEngine() = default;
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
+
+    // Same key as the shader JIT
+    const u64 cache_key = setup.GetProgramCodeHash() ^ setup.GetSwizzleDataHash();
+    auto iter = cache.find(cache_key);
+    if (iter != cache.end()) {
+        lru.splice(lru.begin(), lru, iter->second.lru_position);
+    } else {
+        // The vertex and geometry shaders are set up before each draw, so the ones evicted here
+        // are not in use as long as there is room for more than these two
+        if (cache.size() >= MAX_DECODED_PROGRAMS) {
+            cache.erase(lru.back());
+            lru.pop_back();
+        }
+
+        lru.push_front(cache_key);
+        iter = cache.emplace(cache_key, CacheEntry{}).first;
+        iter->second.program =
+            std::make_unique<DecodedProgram>(setup.program_code, setup.swizzle_data);
+        iter->second.lru_position = lru.begin();
+    }
+
+    setup.engine_data.decoded_program = iter->second.program.get();
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
@@ -677,6 +1320,12 @@ void InterpreterEngine::Run(const ShaderSetup& setup, UnitState& state) const {
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
+    const auto* program = static_cast<const DecodedProgram*>(setup.engine_data.decoded_program);
+    if (program != nullptr) {
+        program->Run(setup, state, setup.engine_data.entry_point);
+        return;
+    }
+
     DebugData<false> dummy_debug_data;
     RunInterpreter(setup, state, dummy_debug_data, setup.engine_data.entry_point);
 }
@@ -4,13 +4,22 @@
 
 #pragma once
 
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "common/common_types.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
 
+class DecodedProgram;
+
 class InterpreterEngine final : public ShaderEngine {
 public:
+    InterpreterEngine();
+    ~InterpreterEngine() override;
+
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
@@ -23,6 +32,17 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const AttributeBuffer& input,
                                      const ShaderRegs& config) const;
+
+private:
+    struct CacheEntry {
+        std::unique_ptr<DecodedProgram> program;
+        std::list<u64>::iterator lru_position;
+    };
+
+    /// Decoded programs, limited to MAX_DECODED_PROGRAMS by evicting the least recently used ones
+    std::unordered_map<u64, CacheEntry> cache;
+    /// Keys of the decoded programs, from the most to the least recently used
+    std::list<u64> lru;
 };
 
 } // namespace Pica::Shader
@@ -2,14 +2,94 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/scm_rev.h"
+#include "common/x64/cpu_detect.h"
+#include "core/cache_journal.h"
+#include "core/core.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/loader/loader.h"
+#include "core/settings.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 
 namespace Pica::Shader {
 
-JitX64Engine::JitX64Engine() = default;
+/// Maximum number of compiled shaders kept in memory. Each of them reserves MAX_SHADER_SIZE bytes
+/// of executable memory.
+constexpr std::size_t MAX_CACHED_SHADERS = 64;
+
+/// Version of the disk cache, to be increased whenever the generated code changes
+constexpr u32 JIT_CACHE_VERSION = 0x1;
+
+/// The compiled code is only valid for the build and the CPU features it was generated with
+struct JitCacheHeader {
+    u32 version;
+    u32 sse4_1;
+    u64 build_hash;
+
+    static JitCacheHeader Current() {
+        return {JIT_CACHE_VERSION, Common::GetCPUCaps().sse4_1 ? 1u : 0u,
+                Common::ComputeHash64(Common::g_scm_rev, std::strlen(Common::g_scm_rev))};
+    }
+
+    /// Version of the journal, a journal made with another header is cleared
+    u32 JournalVersion() const {
+        return static_cast<u32>(Common::ComputeHash64(this, sizeof(*this)));
+    }
+};
+
+/// Type of the journal records, keyed by the cache key of the shader
+enum class JitCacheRecord : u32 {
+    ShaderImage,
+};
+
+/// Lays out the image as its program offset, its instruction offsets and its code
+static std::vector<u8> SerializeImage(const JitShaderImage& image) {
+    const u32 num_offsets = static_cast<u32>(image.instruction_offsets.size());
+    const std::size_t offsets_size = num_offsets * sizeof(u32);
+    std::vector<u8> data(2 * sizeof(u32) + offsets_size + image.code.size());
+    u8* out = data.data();
+    std::memcpy(out, &image.program_offset, sizeof(u32));
+    std::memcpy(out + sizeof(u32), &num_offsets, sizeof(u32));
+    std::memcpy(out + 2 * sizeof(u32), image.instruction_offsets.data(), offsets_size);
+    std::memcpy(out + 2 * sizeof(u32) + offsets_size, image.code.data(), image.code.size());
+    return data;
+}
+
+static bool DeserializeImage(const std::vector<u8>& data, JitShaderImage& image) {
+    u32 num_offsets;
+    if (data.size() < 2 * sizeof(u32)) {
+        return false;
+    }
+    std::memcpy(&image.program_offset, data.data(), sizeof(u32));
+    std::memcpy(&num_offsets, data.data() + sizeof(u32), sizeof(u32));
+    const std::size_t offsets_size = std::size_t{num_offsets} * sizeof(u32);
+    if (data.size() - 2 * sizeof(u32) < offsets_size) {
+        return false;
+    }
+    const u8* offsets = data.data() + 2 * sizeof(u32);
+    image.instruction_offsets.resize(num_offsets);
+    std::memcpy(image.instruction_offsets.data(), offsets, offsets_size);
+    image.code.assign(offsets + offsets_size, data.data() + data.size());
+    return true;
+}
+
+JitX64Engine::JitX64Engine() {
+    if (Settings::values.use_shader_cache) {
+        LoadDiskCache();
+    }
+}
+
 JitX64Engine::~JitX64Engine() = default;
 
 void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
@@ -22,13 +102,95 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     u64 cache_key = code_hash ^ swizzle_hash;
     auto iter = cache.find(cache_key);
     if (iter != cache.end()) {
-        setup.engine_data.cached_shader = iter->second.get();
+        lru.splice(lru.begin(), lru, iter->second.lru_position);
     } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.engine_data.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        // The vertex and geometry shaders are set up before each draw, so the ones evicted here
+        // are not in use as long as there is room for more than these two
+        if (cache.size() >= MAX_CACHED_SHADERS) {
+            cache.erase(lru.back());
+            lru.pop_back();
+        }
+
+        lru.push_front(cache_key);
+        iter = cache.emplace(cache_key, CacheEntry{}).first;
+        iter->second.shader = LoadOrCompile(setup, cache_key);
+        iter->second.lru_position = lru.begin();
     }
+
+    CacheEntry& entry = iter->second;
+    setup.engine_data.cached_shader = entry.shader.get();
+
+    // The batch shader is specialized to the entry point, since it only compiles the instructions
+    // reachable from it
+    auto batch_iter = entry.batch_shaders.find(entry_point);
+    if (batch_iter == entry.batch_shaders.end()) {
+        batch_iter = entry.batch_shaders
+                         .emplace(entry_point, JitBatchShader::Compile(setup.program_code,
+                                                                       setup.swizzle_data,
+                                                                       entry_point))
+                         .first;
+    }
+    setup.engine_data.cached_batch_shader = batch_iter->second.get();
+}
+
+std::unique_ptr<JitShader> JitX64Engine::LoadOrCompile(const ShaderSetup& setup, u64 cache_key) {
+    auto shader = std::make_unique<JitShader>();
+
+    auto image = disk_cache.find(cache_key);
+    if (image != disk_cache.end()) {
+        if (shader->Deserialize(image->second)) {
+            return shader;
+        }
+        LOG_WARNING(HW_GPU, "Discarding invalid cached shader {:016X}", cache_key);
+    }
+
+    shader->Compile(&setup.program_code, &setup.swizzle_data);
+    if (journal) {
+        // Appended right away, so that the shaders of a session that doesn't shut down cleanly
+        // aren't lost
+        auto [image, inserted] = disk_cache.insert_or_assign(cache_key, shader->Serialize());
+        const std::vector<u8> data = SerializeImage(image->second);
+        journal->Append(static_cast<u32>(JitCacheRecord::ShaderImage), cache_key, data.data(),
+                        data.size());
+    }
+    return shader;
+}
+
+std::string JitX64Engine::GetDiskCacheFile() {
+    Core::System& system = Core::System::GetInstance();
+    const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    u64 program_id = 0;
+    if (system.GetAppLoader().ReadProgramId(program_id) == Loader::ResultStatus::Success &&
+        program_id != 0) {
+        return fmt::format("{}{:016X}.jit", dir, program_id);
+    }
+
+    // Homebrew has no title ID, its cache is keyed by a hash of its code instead
+    const auto process = system.Kernel().GetCurrentProcess();
+    if (process != nullptr && process->codeset != nullptr) {
+        const Kernel::CodeSet& codeset = *process->codeset;
+        const auto& code = codeset.CodeSegment();
+        if (code.offset + code.size <= codeset.memory.size()) {
+            program_id = Common::ComputeHash64(codeset.memory.data() + code.offset, code.size);
+        }
+    }
+    return fmt::format("{}{:016X}.code.jit", dir, program_id);
+}
+
+void JitX64Engine::LoadDiskCache() {
+    journal = std::make_unique<Core::CacheJournal>(GetDiskCacheFile(),
+                                                   JitCacheHeader::Current().JournalVersion());
+    for (const auto& record : journal->Load()) {
+        JitShaderImage image;
+        if (static_cast<JitCacheRecord>(record.type) != JitCacheRecord::ShaderImage ||
+            !DeserializeImage(record.data, image)) {
+            LOG_WARNING(HW_GPU, "Discarding invalid cached shader {:016X}", record.key);
+            continue;
+        }
+        disk_cache.insert_or_assign(record.key, std::move(image));
+    }
+
+    LOG_INFO(HW_GPU, "Loaded {} cached JIT shaders", disk_cache.size());
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
@@ -42,4 +204,29 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunBatch(const ShaderSetup& setup, UnitState* states, std::size_t count) const {
+    const JitBatchShader* shader =
+        static_cast<const JitBatchShader*>(setup.engine_data.cached_batch_shader);
+    if (shader == nullptr) {
+        ShaderEngine::RunBatch(setup, states, count);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const std::size_t lanes = shader->GetLaneCount();
+    for (std::size_t i = 0; i < count; i += lanes) {
+        if (i > 0) {
+            states[i].CarryOver(states[i - 1]);
+        }
+        const std::size_t batch_size = std::min(lanes, count - i);
+        // A single vertex is faster to run with the per-vertex shader
+        if (batch_size > 1) {
+            shader->Run(setup, states + i, batch_size);
+        } else {
+            Run(setup, states[i]);
+        }
+    }
+}
+
 } // namespace Pica::Shader
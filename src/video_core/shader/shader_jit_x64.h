@@ -4,14 +4,22 @@
 
 #pragma once
 
+#include <list>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include "common/common_types.h"
 #include "video_core/shader/shader.h"
 
+namespace Core {
+class CacheJournal;
+}
+
 namespace Pica::Shader {
 
 class JitShader;
+class JitBatchShader;
+struct JitShaderImage;
 
 class JitX64Engine final : public ShaderEngine {
 public:
@@ -20,9 +28,32 @@ public:
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, UnitState* states, std::size_t count) const override;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    struct CacheEntry {
+        std::unique_ptr<JitShader> shader;
+        /// Batch shaders by entry point, nullptr for the programs that do not support it
+        std::unordered_map<unsigned int, std::unique_ptr<JitBatchShader>> batch_shaders;
+        std::list<u64>::iterator lru_position;
+    };
+
+    /// Loads the shader from the disk cache if it is there, compiles it otherwise
+    std::unique_ptr<JitShader> LoadOrCompile(const ShaderSetup& setup, u64 cache_key);
+
+    /// Gets the cache file of the title, or of its code for homebrew without a title ID
+    static std::string GetDiskCacheFile();
+    void LoadDiskCache();
+
+    /// Shaders in memory, limited to MAX_CACHED_SHADERS by evicting the least recently used ones
+    std::unordered_map<u64, CacheEntry> cache;
+    /// Keys of the shaders in memory, from the most to the least recently used
+    std::list<u64> lru;
+
+    /// Every shader compiled for the current title, persisted between sessions
+    std::unordered_map<u64, JitShaderImage> disk_cache;
+    /// The disk cache, each shader is appended to it once compiled
+    std::unique_ptr<Core::CacheJournal> journal;
 };
 
 } // namespace Pica::Shader
@@ -0,0 +1,1527 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/x64/cpu_detect.h"
+#include "common/x64/xbyak_abi.h"
+#include "common/x64/xbyak_util.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+namespace Pica::Shader {
+
+typedef void (JitBatchShader::*JitFunction)(Instruction instr);
+
+// The geometry shader instructions and data-dependent jumps are not supported in batches. Programs
+// using them are rejected before compilation.
+const JitFunction batch_instr_table[64] = {
+    &JitBatchShader::Compile_ADD,    // add
+    &JitBatchShader::Compile_DP3,    // dp3
+    &JitBatchShader::Compile_DP4,    // dp4
+    &JitBatchShader::Compile_DPH,    // dph
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_EX2,    // ex2
+    &JitBatchShader::Compile_LG2,    // lg2
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_MUL,    // mul
+    &JitBatchShader::Compile_SGE,    // sge
+    &JitBatchShader::Compile_SLT,    // slt
+    &JitBatchShader::Compile_FLR,    // flr
+    &JitBatchShader::Compile_MAX,    // max
+    &JitBatchShader::Compile_MIN,    // min
+    &JitBatchShader::Compile_RCP,    // rcp
+    &JitBatchShader::Compile_RSQ,    // rsq
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_MOVA,   // mova
+    &JitBatchShader::Compile_MOV,    // mov
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_DPH,    // dphi
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_SGE,    // sgei
+    &JitBatchShader::Compile_SLT,    // slti
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_NOP,    // nop
+    &JitBatchShader::Compile_END,    // end
+    &JitBatchShader::Compile_BREAKC, // breakc
+    &JitBatchShader::Compile_CALL,   // call
+    &JitBatchShader::Compile_CALLC,  // callc
+    &JitBatchShader::Compile_CALLU,  // callu
+    &JitBatchShader::Compile_IF,     // ifu
+    &JitBatchShader::Compile_IF,     // ifc
+    &JitBatchShader::Compile_LOOP,   // loop
+    nullptr,                         // emit
+    nullptr,                         // sete
+    nullptr,                         // jmpc
+    &JitBatchShader::Compile_JMP,    // jmpu
+    &JitBatchShader::Compile_CMP,    // cmp
+    &JitBatchShader::Compile_CMP,    // cmp
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+};
+
+// The general purpose registers have the same purposes as in the per-vertex JIT. RAX and RDX can
+// be used as scratch registers within a compiler function.
+
+/// Pointer to the uniform memory
+static const Reg64 UNIFORMS = r9;
+/// VS loop count register (Multiplied by 16), which is the same for all vertices
+static const Reg32 LOOPCOUNT_REG = r12d;
+/// Current VS loop iteration number
+static const Reg32 LOOPCOUNT = esi;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration (Multiplied by 16)
+static const Reg32 LOOPINC = edi;
+/// Pointer to the BatchUnitState instance
+static const Reg64 STATE = r15;
+
+// Indices of the vector registers, which are XMM or YMM registers depending on the lane count.
+// Each of them holds one component of all vertices in the batch.
+
+/// Results of the current instruction, one register per component
+constexpr int RESULT = 0;
+/// Loaded with the swizzled source components, otherwise can be used as scratch registers
+constexpr int SRC1 = 4;
+constexpr int SRC2 = 5;
+constexpr int SRC3 = 6;
+/// Scratch registers
+constexpr int SCRATCH = 7;
+constexpr int SCRATCH2 = 8;
+/// Four temporaries used by the EX2 and LG2 subroutines
+constexpr int TEMP = 9;
+/// Mask of the vertices that are being executed, only maintained for divergent programs
+constexpr int EXEC = 13;
+/// Constant vector of 1.0f
+constexpr int ONE = 14;
+/// Constant vector of -0.f, used to efficiently negate a vector with XOR
+constexpr int NEGBIT = 15;
+
+/// Code size reserved for each instruction, and additionally for those that use the address
+/// registers to read a different register for each vertex
+constexpr std::size_t INSTRUCTION_CODE_SIZE = 512;
+constexpr std::size_t GATHER_CODE_SIZE = 2048;
+/// Code size reserved for the prelude and the entry of the program
+constexpr std::size_t PRELUDE_CODE_SIZE = 4096;
+
+struct JitBatchShader::ProgramInfo {
+    std::vector<bool> reachable;
+    std::vector<unsigned> return_offsets;
+    bool divergent = false;
+    u16 input_mask = 0;
+    u16 temporary_mask = 0;
+    u16 output_mask = 0;
+    std::size_t code_size = PRELUDE_CODE_SIZE;
+};
+
+namespace {
+
+/// A range of instructions [begin, end) that is compiled with data pushed on the host stack
+struct StackRegion {
+    unsigned begin;
+    unsigned end;
+
+    bool Contains(unsigned offset) const {
+        return offset >= begin && offset < end;
+    }
+};
+
+/// Returns the sources of an instruction in the common format
+std::pair<SourceRegister, SourceRegister> GetCommonSources(Instruction instr) {
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+    if (is_inverted) {
+        return {instr.common.src1i.Value(), instr.common.src2i.Value()};
+    }
+    return {instr.common.src1.Value(), instr.common.src2.Value()};
+}
+
+/// Records the registers accessed by an arithmetic instruction
+void RecordRegisters(Instruction instr, JitBatchShader::ProgramInfo& info) {
+    const auto record_source = [&info](SourceRegister reg) {
+        if (reg.GetRegisterType() == RegisterType::Input) {
+            info.input_mask |= 1 << reg.GetIndex();
+        } else if (reg.GetRegisterType() == RegisterType::Temporary) {
+            info.temporary_mask |= 1 << reg.GetIndex();
+        }
+    };
+    const auto record_dest = [&info](DestRegister reg) {
+        if (reg.GetRegisterType() == RegisterType::Output) {
+            info.output_mask |= 1 << reg.GetIndex();
+        } else if (reg.GetRegisterType() == RegisterType::Temporary) {
+            info.temporary_mask |= 1 << reg.GetIndex();
+        }
+    };
+
+    // Unused operand fields are recorded as well, which only costs a few needless copies
+    unsigned address_register_index;
+    const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+    if (opcode == OpCode::Id::MAD || opcode == OpCode::Id::MADI) {
+        const bool is_madi = opcode == OpCode::Id::MADI;
+        record_source(instr.mad.src1);
+        record_source(is_madi ? instr.mad.src2i.Value() : instr.mad.src2.Value());
+        record_source(is_madi ? instr.mad.src3i.Value() : instr.mad.src3.Value());
+        record_dest(instr.mad.dest);
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        const auto [src1, src2] = GetCommonSources(instr);
+        record_source(src1);
+        record_source(src2);
+        record_dest(instr.common.dest);
+        address_register_index = instr.common.address_register_index;
+    }
+
+    if (address_register_index != 0) {
+        // Any register may be read through the address registers
+        info.input_mask = info.temporary_mask = info.output_mask = 0xFFFF;
+        info.code_size += GATHER_CODE_SIZE;
+    }
+}
+
+/**
+ * Finds the instructions reachable from the entry point and checks that they can be executed in
+ * batches. Conditional control flow is executed for all vertices with the vertices that do not
+ * take a branch masked off, which requires it to be properly nested.
+ */
+std::optional<JitBatchShader::ProgramInfo> AnalyzeProgram(const ProgramCode& program_code,
+                                                          unsigned entry_point) {
+    using CompareOp = Instruction::Common::CompareOpType::Op;
+
+    JitBatchShader::ProgramInfo info;
+    info.reachable.assign(MAX_PROGRAM_CODE_LENGTH, false);
+
+    std::vector<StackRegion> if_regions;
+    std::vector<StackRegion> loop_regions;
+    std::vector<std::pair<unsigned, unsigned>> subroutines; // Entry and return offsets
+    std::vector<std::pair<unsigned, unsigned>> jumps;       // Source and destination offsets
+    std::vector<unsigned> breaks;
+    std::vector<unsigned> ends;
+
+    std::vector<unsigned> pending{entry_point};
+    while (!pending.empty()) {
+        const unsigned offset = pending.back();
+        pending.pop_back();
+        if (offset >= MAX_PROGRAM_CODE_LENGTH || info.reachable[offset]) {
+            continue;
+        }
+        info.reachable[offset] = true;
+        info.code_size += INSTRUCTION_CODE_SIZE;
+
+        const Instruction instr = {program_code[offset]};
+        const OpCode::Id opcode = instr.opcode.Value();
+        if (batch_instr_table[static_cast<unsigned>(opcode)] == nullptr) {
+            return std::nullopt;
+        }
+
+        const auto& flow_control = instr.flow_control;
+        const unsigned dest_offset = flow_control.dest_offset;
+        const unsigned return_offset = dest_offset + flow_control.num_instructions;
+
+        switch (instr.opcode.Value().GetInfo().type) {
+        case OpCode::Type::Arithmetic:
+        case OpCode::Type::MultiplyAdd:
+            RecordRegisters(instr, info);
+            break;
+        default:
+            break;
+        }
+
+        switch (opcode) {
+        case OpCode::Id::END:
+            ends.push_back(offset);
+            continue;
+
+        case OpCode::Id::CMP:
+            if (instr.common.compare_op.x > CompareOp::GreaterEqual ||
+                instr.common.compare_op.y > CompareOp::GreaterEqual) {
+                return std::nullopt;
+            }
+            break;
+
+        case OpCode::Id::IFC:
+            info.divergent = true;
+            [[fallthrough]];
+        case OpCode::Id::IFU:
+            if (dest_offset <= offset) {
+                return std::nullopt;
+            }
+            if (opcode == OpCode::Id::IFC) {
+                if_regions.push_back({offset + 1, return_offset});
+            }
+            pending.push_back(dest_offset);
+            pending.push_back(return_offset);
+            break;
+
+        case OpCode::Id::LOOP:
+            if (dest_offset <= offset) {
+                return std::nullopt;
+            }
+            loop_regions.push_back({offset + 1, dest_offset + 1});
+            pending.push_back(dest_offset + 1);
+            break;
+
+        case OpCode::Id::CALLC:
+            info.divergent = true;
+            [[fallthrough]];
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLU:
+            subroutines.emplace_back(dest_offset, return_offset);
+            info.return_offsets.push_back(return_offset);
+            pending.push_back(dest_offset);
+            pending.push_back(return_offset);
+            break;
+
+        case OpCode::Id::BREAKC:
+            info.divergent = true;
+            breaks.push_back(offset);
+            break;
+
+        case OpCode::Id::JMPU:
+            jumps.emplace_back(offset, dest_offset);
+            pending.push_back(dest_offset);
+            break;
+
+        default:
+            break;
+        }
+
+        pending.push_back(offset + 1);
+    }
+
+    std::sort(info.return_offsets.begin(), info.return_offsets.end());
+    info.return_offsets.erase(std::unique(info.return_offsets.begin(), info.return_offsets.end()),
+                              info.return_offsets.end());
+
+    const auto find_loop = [&](unsigned offset) {
+        return std::find_if(loop_regions.begin(), loop_regions.end(),
+                            [offset](const StackRegion& loop) { return loop.Contains(offset); });
+    };
+
+    for (const auto& loop : loop_regions) {
+        // Nested loops are not supported, like in the per-vertex JIT
+        if (find_loop(loop.begin - 1) != loop_regions.end()) {
+            return std::nullopt;
+        }
+    }
+
+    for (unsigned offset : breaks) {
+        // The loop restores the vertices disabled by BREAKC, so there must not be a conditional
+        // block between them that restores its own mask afterwards
+        const auto loop = find_loop(offset);
+        if (loop == loop_regions.end()) {
+            return std::nullopt;
+        }
+        for (const auto& region : if_regions) {
+            if (region.Contains(offset) && region.begin > loop->begin) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    if (!info.divergent) {
+        // Nothing is pushed on the stack, so any control flow that works per vertex works here
+        return info;
+    }
+
+    std::vector<StackRegion> regions = if_regions;
+    regions.insert(regions.end(), loop_regions.begin(), loop_regions.end());
+    const auto in_region = [&regions](unsigned offset) {
+        return std::any_of(regions.begin(), regions.end(),
+                           [offset](const StackRegion& region) { return region.Contains(offset); });
+    };
+
+    // Subroutines and jumps must not enter or leave the regions, since the data pushed on the
+    // stack would not match
+    for (const auto& [entry, return_offset] : subroutines) {
+        if (in_region(entry) || in_region(return_offset)) {
+            return std::nullopt;
+        }
+    }
+    for (const auto& [source, dest] : jumps) {
+        for (const auto& region : regions) {
+            if (region.Contains(source) != region.Contains(dest)) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // END finishes all vertices, so it must not be executed when some of them are masked off
+    for (unsigned offset : ends) {
+        if (in_region(offset)) {
+            return std::nullopt;
+        }
+        for (const auto& [entry, return_offset] : subroutines) {
+            if (offset >= entry && offset < return_offset) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    return info;
+}
+
+/**
+ * Registers of a shader unit, which keeps them between vertices. The float registers have a bit
+ * per component.
+ */
+struct UnitRegisters {
+    static constexpr u8 ADDRESS_REGISTER_0 = 1 << 0;
+    static constexpr u8 LOOP_REGISTER = 1 << 2;
+    static constexpr u8 CONDITIONAL_CODE_X = 1 << 3;
+    static constexpr u8 CONDITIONAL_CODE_Y = 1 << 4;
+
+    u64 temporary = 0;
+    u64 output = 0;
+    u8 other = 0;
+
+    UnitRegisters& operator|=(const UnitRegisters& right) {
+        temporary |= right.temporary;
+        output |= right.output;
+        other |= right.other;
+        return *this;
+    }
+
+    UnitRegisters& operator&=(const UnitRegisters& right) {
+        temporary &= right.temporary;
+        output &= right.output;
+        other &= right.other;
+        return *this;
+    }
+
+    bool Contains(const UnitRegisters& right) const {
+        return (right.temporary & ~temporary) == 0 && (right.output & ~output) == 0 &&
+               (right.other & ~other) == 0;
+    }
+
+    bool operator==(const UnitRegisters& right) const {
+        return temporary == right.temporary && output == right.output && other == right.other;
+    }
+};
+
+/// Returns the registers read and written by an instruction
+std::pair<UnitRegisters, UnitRegisters> GetRegisterAccesses(Instruction instr,
+                                                            const SwizzleData& swizzle_data) {
+    using FlowControlOp = Instruction::FlowControlType::Op;
+
+    UnitRegisters read;
+    UnitRegisters written;
+
+    const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+    switch (instr.opcode.Value().GetInfo().type) {
+    case OpCode::Type::Arithmetic:
+    case OpCode::Type::MultiplyAdd: {
+        const bool is_mad = opcode == OpCode::Id::MAD || opcode == OpCode::Id::MADI;
+        const bool is_inverted =
+            (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+        const SwizzlePattern swiz = {
+            swizzle_data[is_mad ? instr.mad.operand_desc_id : instr.common.operand_desc_id]};
+        const unsigned address_register_index =
+            is_mad ? instr.mad.address_register_index : instr.common.address_register_index;
+        const unsigned offset_src = is_mad ? (is_inverted ? 3 : 2) : (is_inverted ? 2 : 1);
+
+        // Source components read for each component of the result
+        u32 positions = swiz.dest_mask;
+        switch (opcode) {
+        case OpCode::Id::DP3:
+            positions = 0b1110;
+            break;
+        case OpCode::Id::DP4:
+        case OpCode::Id::DPH:
+        case OpCode::Id::DPHI:
+            positions = 0b1111;
+            break;
+        case OpCode::Id::EX2:
+        case OpCode::Id::LG2:
+        case OpCode::Id::RCP:
+        case OpCode::Id::RSQ:
+            positions = 0b1000;
+            break;
+        case OpCode::Id::CMP:
+            positions = 0b1100;
+            break;
+        default:
+            break;
+        }
+
+        const auto read_source = [&](unsigned src_num, SourceRegister reg) {
+            const bool relative = src_num == offset_src && address_register_index != 0;
+            if (relative) {
+                read.other |= address_register_index == 3
+                                  ? UnitRegisters::LOOP_REGISTER
+                                  : UnitRegisters::ADDRESS_REGISTER_0 << (address_register_index - 1);
+                if (reg.GetRegisterType() != RegisterType::FloatUniform) {
+                    // Any temporary may be read
+                    read.temporary = ~u64{0};
+                    return;
+                }
+            }
+            if (reg.GetRegisterType() != RegisterType::Temporary) {
+                return;
+            }
+            const u8 sel = swiz.GetRawSelector(src_num);
+            for (unsigned component = 0; component < 4; ++component) {
+                if ((positions >> (3 - component)) & 1) {
+                    const unsigned selector = (sel >> (6 - 2 * component)) & 3;
+                    read.temporary |= u64{1} << (reg.GetIndex() * 4 + selector);
+                }
+            }
+        };
+
+        DestRegister dest;
+        if (is_mad) {
+            read_source(1, instr.mad.src1);
+            read_source(2, is_inverted ? instr.mad.src2i.Value() : instr.mad.src2.Value());
+            read_source(3, is_inverted ? instr.mad.src3i.Value() : instr.mad.src3.Value());
+            dest = instr.mad.dest;
+        } else {
+            const auto [src1, src2] = GetCommonSources(instr);
+            read_source(1, src1);
+            switch (opcode) {
+            case OpCode::Id::EX2:
+            case OpCode::Id::LG2:
+            case OpCode::Id::RCP:
+            case OpCode::Id::RSQ:
+            case OpCode::Id::FLR:
+            case OpCode::Id::MOV:
+            case OpCode::Id::MOVA:
+                break;
+            default:
+                read_source(2, src2);
+                break;
+            }
+            dest = instr.common.dest;
+        }
+
+        if (opcode == OpCode::Id::CMP) {
+            written.other |= UnitRegisters::CONDITIONAL_CODE_X | UnitRegisters::CONDITIONAL_CODE_Y;
+        } else if (opcode == OpCode::Id::MOVA) {
+            for (unsigned component = 0; component < 2; ++component) {
+                if (swiz.DestComponentEnabled(component)) {
+                    written.other |= UnitRegisters::ADDRESS_REGISTER_0 << component;
+                }
+            }
+        } else if (dest.GetRegisterType() != RegisterType::Unknown) {
+            u64& registers =
+                dest.GetRegisterType() == RegisterType::Output ? written.output : written.temporary;
+            for (unsigned component = 0; component < 4; ++component) {
+                if (swiz.DestComponentEnabled(component)) {
+                    registers |= u64{1} << (dest.GetIndex() * 4 + component);
+                }
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    switch (opcode) {
+    case OpCode::Id::IFC:
+    case OpCode::Id::CALLC:
+    case OpCode::Id::BREAKC:
+        if (instr.flow_control.op != FlowControlOp::JustY) {
+            read.other |= UnitRegisters::CONDITIONAL_CODE_X;
+        }
+        if (instr.flow_control.op != FlowControlOp::JustX) {
+            read.other |= UnitRegisters::CONDITIONAL_CODE_Y;
+        }
+        break;
+    case OpCode::Id::LOOP:
+        written.other |= UnitRegisters::LOOP_REGISTER;
+        break;
+    default:
+        break;
+    }
+
+    return {read, written};
+}
+
+/**
+ * Checks that the results of a vertex don't depend on the registers left by the previous vertex
+ * run on the shader unit, so that the vertices can run side by side. No register may be read
+ * before it is written, and all paths to END must write the same output components.
+ *
+ * The control flow is followed like in AnalyzeProgram. The edges it leaves out, such as those
+ * returning from subroutines or conditional blocks, only add writes to the ones it follows.
+ */
+bool IsVertexIndependent(const ProgramCode& program_code, const SwizzleData& swizzle_data,
+                         unsigned entry_point) {
+    // Registers written on all the paths to each instruction
+    std::vector<std::optional<UnitRegisters>> written(MAX_PROGRAM_CODE_LENGTH);
+    UnitRegisters any_written;
+    UnitRegisters written_at_end;
+    written_at_end.output = ~u64{0};
+
+    std::vector<unsigned> pending{entry_point};
+    written[entry_point] = UnitRegisters{};
+    const auto merge = [&](unsigned offset, const UnitRegisters& registers) {
+        if (offset >= MAX_PROGRAM_CODE_LENGTH) {
+            return;
+        }
+        if (!written[offset]) {
+            written[offset] = registers;
+        } else {
+            UnitRegisters merged = *written[offset];
+            merged &= registers;
+            if (merged == *written[offset]) {
+                return;
+            }
+            written[offset] = merged;
+        }
+        pending.push_back(offset);
+    };
+
+    while (!pending.empty()) {
+        const unsigned offset = pending.back();
+        pending.pop_back();
+
+        const Instruction instr = {program_code[offset]};
+        const auto [read, writes] = GetRegisterAccesses(instr, swizzle_data);
+        if (!written[offset]->Contains(read)) {
+            return false;
+        }
+        UnitRegisters registers = *written[offset];
+        registers |= writes;
+        any_written |= writes;
+
+        const auto& flow_control = instr.flow_control;
+        const unsigned dest_offset = flow_control.dest_offset;
+        const unsigned return_offset = dest_offset + flow_control.num_instructions;
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            written_at_end &= registers;
+            continue;
+        case OpCode::Id::IFU:
+        case OpCode::Id::IFC:
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            merge(dest_offset, registers);
+            merge(return_offset, registers);
+            break;
+        case OpCode::Id::LOOP:
+            merge(dest_offset + 1, registers);
+            break;
+        case OpCode::Id::JMPU:
+            merge(dest_offset, registers);
+            break;
+        default:
+            break;
+        }
+        merge(offset + 1, registers);
+    }
+
+    return (any_written.output & ~written_at_end.output) == 0;
+}
+
+void TransposeIn(const Common::Vec4<float24> (&source)[16], BatchUnitState::Register (&dest)[16],
+                 u16 mask, std::size_t lane) {
+    for (std::size_t reg = 0; reg < 16; ++reg) {
+        if ((mask >> reg) & 1) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                dest[reg][comp][lane] = source[reg][comp].ToFloat32();
+            }
+        }
+    }
+}
+
+void TransposeOut(const BatchUnitState::Register (&source)[16], Common::Vec4<float24> (&dest)[16],
+                  u16 mask, std::size_t lane) {
+    for (std::size_t reg = 0; reg < 16; ++reg) {
+        if ((mask >> reg) & 1) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                dest[reg][comp] = float24::FromFloat32(source[reg][comp][lane]);
+            }
+        }
+    }
+}
+
+} // Anonymous namespace
+
+Xmm JitBatchShader::Vec(int index) const {
+    return lanes == 8 ? Xbyak::Ymm(index) : Xmm(index);
+}
+
+void JitBatchShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num,
+                                        SourceRegister src_reg, unsigned component, Xmm dest) {
+    unsigned operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    unsigned offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    // The raw selector holds the source component of the x component in its highest two bits.
+    // Swizzling only selects which component is loaded here.
+    u8 sel = swiz.GetRawSelector(src_num);
+    const unsigned selector = (sel >> (6 - 2 * component)) & 3;
+    const bool relative = src_num == offset_src && address_register_index != 0;
+
+    if (src_reg.GetRegisterType() == RegisterType::FloatUniform) {
+        // Uniforms are the same for all vertices and get broadcast
+        const int offset = static_cast<int>(Uniforms::GetFloatUniformOffset(src_reg.GetIndex()) +
+                                            selector * sizeof(float24));
+        if (!relative) {
+            vbroadcastss(dest, dword[UNIFORMS + offset]);
+        } else if (address_register_index == 3) {
+            vbroadcastss(dest, dword[UNIFORMS + LOOPCOUNT_REG.cvt64() + offset]);
+        } else {
+            Compile_Gather(UNIFORMS, offset, address_register_index - 1, 4, false, dest);
+        }
+    } else {
+        const int offset =
+            static_cast<int>(BatchUnitState::InputOffset(src_reg) +
+                             selector * sizeof(BatchUnitState::Component));
+        if (!relative) {
+            vmovaps(dest, ptr[STATE + offset]);
+        } else if (address_register_index == 3) {
+            // The loop counter is kept multiplied by 16, while the registers are 128 bytes apart
+            vmovaps(dest, ptr[STATE + LOOPCOUNT_REG.cvt64() * 8 + offset]);
+        } else {
+            Compile_Gather(STATE, offset, address_register_index - 1, 7, true, dest);
+        }
+    }
+
+    // If the source register should be negated, flip the negative bit using XOR
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        vxorps(dest, dest, Vec(NEGBIT));
+    }
+}
+
+void JitBatchShader::Compile_Gather(Reg64 base, int offset, unsigned address_register, int shift,
+                                    bool per_lane, Xmm dest) {
+    const std::size_t address_offset = offsetof(BatchUnitState, address_registers) +
+                                       address_register * sizeof(std::array<s32, MAX_BATCH_LANES>);
+
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        const int lane_offset = static_cast<int>(lane * sizeof(float));
+        movsxd(rax, dword[STATE + address_offset + lane_offset]);
+        shl(rax, shift);
+        mov(edx, dword[base + rax + offset + (per_lane ? lane_offset : 0)]);
+        mov(dword[STATE + offsetof(BatchUnitState, gather) + lane_offset], edx);
+    }
+    vmovaps(dest, ptr[STATE + offsetof(BatchUnitState, gather)]);
+}
+
+void JitBatchShader::Compile_DestEnable(Instruction instr, bool scalar_result) {
+    DestRegister dest;
+    unsigned operand_desc_id;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        dest = instr.mad.dest.Value();
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        dest = instr.common.dest.Value();
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    const std::size_t dest_offset = BatchUnitState::OutputOffset(dest);
+    for (unsigned comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_MaskedStore(ptr[STATE + dest_offset + comp * sizeof(BatchUnitState::Component)],
+                                Vec(scalar_result ? RESULT : RESULT + comp));
+        }
+    }
+}
+
+void JitBatchShader::Compile_MaskedStore(const Xbyak::Address& dest, Xmm value) {
+    if (!divergent) {
+        // All vertices always execute, the unused lanes of a partial batch are simply ignored
+        vmovaps(dest, value);
+        return;
+    }
+
+    vmovaps(Vec(SCRATCH), dest);
+    vblendvps(Vec(SCRATCH), Vec(SCRATCH), value, Vec(EXEC));
+    vmovaps(dest, Vec(SCRATCH));
+}
+
+void JitBatchShader::Compile_SanitizedMul(Xmm dest, Xmm src1, Xmm src2) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. This is implemented the same
+    // way as in the per-vertex JIT: NaN results where neither source was NaN are cleared.
+    vcmpordps(Vec(SCRATCH), src1, src2);
+    vmulps(dest, src1, src2);
+    vcmpunordps(Vec(SCRATCH2), dest, dest);
+    vxorps(Vec(SCRATCH), Vec(SCRATCH), Vec(SCRATCH2));
+    vandps(dest, dest, Vec(SCRATCH));
+}
+
+void JitBatchShader::Compile_EvaluateCondition(Instruction instr, Xmm dest) {
+    const auto load_condition = [this](unsigned index, u32 ref, Xmm reg) {
+        vmovaps(reg, ptr[STATE + offsetof(BatchUnitState, conditional_code) +
+                         index * sizeof(std::array<u32, MAX_BATCH_LANES>)]);
+        if (ref == 0) {
+            vxorps(reg, reg, ptr[rip + all_ones_constant]);
+        }
+    };
+
+    switch (instr.flow_control.op) {
+    case Instruction::FlowControlType::Or:
+        load_condition(0, instr.flow_control.refx, dest);
+        load_condition(1, instr.flow_control.refy, Vec(SCRATCH));
+        vorps(dest, dest, Vec(SCRATCH));
+        break;
+
+    case Instruction::FlowControlType::And:
+        load_condition(0, instr.flow_control.refx, dest);
+        load_condition(1, instr.flow_control.refy, Vec(SCRATCH));
+        vandps(dest, dest, Vec(SCRATCH));
+        break;
+
+    case Instruction::FlowControlType::JustX:
+        load_condition(0, instr.flow_control.refx, dest);
+        break;
+
+    case Instruction::FlowControlType::JustY:
+        load_condition(1, instr.flow_control.refy, dest);
+        break;
+    }
+}
+
+void JitBatchShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+template <typename Op>
+void JitBatchShader::Compile_ComponentWise(Instruction instr, unsigned num_sources, Op op) {
+    const auto [src1, src2] = GetCommonSources(instr);
+    SwizzlePattern swiz = {(*swizzle_data)[instr.common.operand_desc_id]};
+
+    // All enabled components are computed before storing any, as the destination may also be a
+    // source
+    for (unsigned comp = 0; comp < 4; ++comp) {
+        if (!swiz.DestComponentEnabled(comp)) {
+            continue;
+        }
+        Compile_SwizzleSrc(instr, 1, src1, comp, Vec(SRC1));
+        if (num_sources > 1) {
+            Compile_SwizzleSrc(instr, 2, src2, comp, Vec(SRC2));
+        }
+        op(Vec(RESULT + comp), Vec(SRC1), Vec(SRC2));
+    }
+
+    Compile_DestEnable(instr, false);
+}
+
+void JitBatchShader::Compile_DotProduct(Instruction instr, unsigned num_components,
+                                        bool homogeneous) {
+    const auto [src1, src2] = GetCommonSources(instr);
+
+    for (unsigned comp = 0; comp < num_components; ++comp) {
+        Compile_SwizzleSrc(instr, 2, src2, comp, Vec(SRC2));
+        if (homogeneous && comp == 3) {
+            // The 4th component of the first source is replaced by 1.0
+            Compile_SanitizedMul(Vec(RESULT + comp), Vec(ONE), Vec(SRC2));
+        } else {
+            Compile_SwizzleSrc(instr, 1, src1, comp, Vec(SRC1));
+            Compile_SanitizedMul(Vec(RESULT + comp), Vec(SRC1), Vec(SRC2));
+        }
+    }
+
+    // The products are added in the same order as in the per-vertex JIT
+    if (num_components == 3) {
+        vaddps(Vec(RESULT), Vec(RESULT), Vec(RESULT + 1));
+        vaddps(Vec(RESULT), Vec(RESULT), Vec(RESULT + 2));
+    } else {
+        vaddps(Vec(RESULT), Vec(RESULT), Vec(RESULT + 1));
+        vaddps(Vec(RESULT + 2), Vec(RESULT + 2), Vec(RESULT + 3));
+        vaddps(Vec(RESULT), Vec(RESULT), Vec(RESULT + 2));
+    }
+
+    Compile_DestEnable(instr, true);
+}
+
+void JitBatchShader::Compile_ADD(Instruction instr) {
+    Compile_ComponentWise(instr, 2, [this](Xmm result, Xmm src1, Xmm src2) {
+        vaddps(result, src1, src2);
+    });
+}
+
+void JitBatchShader::Compile_DP3(Instruction instr) {
+    Compile_DotProduct(instr, 3, false);
+}
+
+void JitBatchShader::Compile_DP4(Instruction instr) {
+    Compile_DotProduct(instr, 4, false);
+}
+
+void JitBatchShader::Compile_DPH(Instruction instr) {
+    Compile_DotProduct(instr, 4, true);
+}
+
+void JitBatchShader::Compile_EX2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, Vec(SRC1));
+    call(exp2_subroutine);
+    vmovaps(Vec(RESULT), Vec(SRC1));
+    Compile_DestEnable(instr, true);
+}
+
+void JitBatchShader::Compile_LG2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, Vec(SRC1));
+    call(log2_subroutine);
+    vmovaps(Vec(RESULT), Vec(SRC1));
+    Compile_DestEnable(instr, true);
+}
+
+void JitBatchShader::Compile_MUL(Instruction instr) {
+    Compile_ComponentWise(instr, 2, [this](Xmm result, Xmm src1, Xmm src2) {
+        Compile_SanitizedMul(result, src1, src2);
+    });
+}
+
+void JitBatchShader::Compile_SGE(Instruction instr) {
+    Compile_ComponentWise(instr, 2, [this](Xmm result, Xmm src1, Xmm src2) {
+        vcmpleps(result, src2, src1);
+        vandps(result, result, Vec(ONE));
+    });
+}
+
+void JitBatchShader::Compile_SLT(Instruction instr) {
+    Compile_ComponentWise(instr, 2, [this](Xmm result, Xmm src1, Xmm src2) {
+        vcmpltps(result, src1, src2);
+        vandps(result, result, Vec(ONE));
+    });
+}
+
+void JitBatchShader::Compile_FLR(Instruction instr) {
+    Compile_ComponentWise(instr, 1, [this](Xmm result, Xmm src1, Xmm) {
+        vroundps(result, src1, _MM_FROUND_FLOOR);
+    });
+}
+
+void JitBatchShader::Compile_MAX(Instruction instr) {
+    // SSE semantics match PICA200 ones: In case of NaN, src2 is returned.
+    Compile_ComponentWise(instr, 2, [this](Xmm result, Xmm src1, Xmm src2) {
+        vmaxps(result, src1, src2);
+    });
+}
+
+void JitBatchShader::Compile_MIN(Instruction instr) {
+    // SSE semantics match PICA200 ones: In case of NaN, src2 is returned.
+    Compile_ComponentWise(instr, 2, [this](Xmm result, Xmm src1, Xmm src2) {
+        vminps(result, src1, src2);
+    });
+}
+
+void JitBatchShader::Compile_MOVA(Instruction instr) {
+    SwizzlePattern swiz = {(*swizzle_data)[instr.common.operand_desc_id]};
+
+    for (unsigned comp = 0; comp < 2; ++comp) {
+        if (!swiz.DestComponentEnabled(comp)) {
+            continue;
+        }
+
+        // Convert floats to integers using truncation
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, Vec(SRC1));
+        vcvttps2dq(Vec(SRC1), Vec(SRC1));
+        Compile_MaskedStore(ptr[STATE + offsetof(BatchUnitState, address_registers) +
+                                comp * sizeof(std::array<s32, MAX_BATCH_LANES>)],
+                            Vec(SRC1));
+    }
+}
+
+void JitBatchShader::Compile_MOV(Instruction instr) {
+    Compile_ComponentWise(instr, 1, [this](Xmm result, Xmm src1, Xmm) {
+        vmovaps(result, src1);
+    });
+}
+
+void JitBatchShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, Vec(SRC1));
+
+    // RCPPS uses the same approximation as the RCPSS of the per-vertex JIT
+    vrcpps(Vec(RESULT), Vec(SRC1));
+
+    Compile_DestEnable(instr, true);
+}
+
+void JitBatchShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, Vec(SRC1));
+
+    // RSQRTPS uses the same approximation as the RSQRTSS of the per-vertex JIT
+    vrsqrtps(Vec(RESULT), Vec(SRC1));
+
+    Compile_DestEnable(instr, true);
+}
+
+void JitBatchShader::Compile_NOP(Instruction instr) {}
+
+void JitBatchShader::Compile_END(Instruction instr) {
+    // Save the loop register, the other registers are kept in the state all the time
+    sar(LOOPCOUNT_REG, 4);
+    mov(dword[STATE + offsetof(BatchUnitState, loop_register)], LOOPCOUNT_REG);
+
+    // Avoid the penalty of the SSE code that runs next using dirty upper halves of YMM registers
+    vzeroupper();
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
+}
+
+void JitBatchShader::Compile_BREAKC(Instruction instr) {
+    // The vertices that break are masked off until the end of the loop, which is left once all of
+    // them did
+    ASSERT(loop_break_label);
+    Compile_EvaluateCondition(instr, Vec(SCRATCH2));
+    vandnps(Vec(EXEC), Vec(SCRATCH2), Vec(EXEC));
+    vmovmskps(eax, Vec(EXEC));
+    test(eax, eax);
+    jz(*loop_break_label, T_NEAR);
+}
+
+void JitBatchShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return
+    push(qword, (instr.flow_control.dest_offset + instr.flow_control.num_instructions));
+
+    // Call the subroutine
+    call(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitBatchShader::Compile_CALLC(Instruction instr) {
+    // The subroutine runs with the vertices for which the condition is false masked off, and is
+    // skipped if there are none left. The execution mask is saved on the stack meanwhile.
+    Label b;
+    Compile_EvaluateCondition(instr, Vec(SCRATCH2));
+    sub(rsp, 32);
+    vmovups(ptr[rsp], Vec(EXEC));
+    vandps(Vec(EXEC), Vec(EXEC), Vec(SCRATCH2));
+    vmovmskps(eax, Vec(EXEC));
+    test(eax, eax);
+    jz(b, T_NEAR);
+    Compile_CALL(instr);
+    L(b);
+    vmovups(Vec(EXEC), ptr[rsp]);
+    add(rsp, 32);
+}
+
+void JitBatchShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitBatchShader::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    const Op ops[] = {instr.common.compare_op.x, instr.common.compare_op.y};
+
+    // Greater-than (GT) and greater-equal (GE) are emulated by swapping the lhs and rhs, like in
+    // the per-vertex JIT
+    static const u8 cmp[] = {CMP_EQ, CMP_NEQ, CMP_LT, CMP_LE, CMP_LT, CMP_LE};
+
+    for (unsigned comp = 0; comp < 2; ++comp) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, Vec(SRC1));
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, Vec(SRC2));
+
+        const bool invert_op = (ops[comp] == Op::GreaterThan || ops[comp] == Op::GreaterEqual);
+        const Xmm lhs = Vec(invert_op ? SRC2 : SRC1);
+        const Xmm rhs = Vec(invert_op ? SRC1 : SRC2);
+        vcmpps(Vec(RESULT), lhs, rhs, cmp[ops[comp]]);
+
+        Compile_MaskedStore(ptr[STATE + offsetof(BatchUnitState, conditional_code) +
+                                comp * sizeof(std::array<u32, MAX_BATCH_LANES>)],
+                            Vec(RESULT));
+    }
+}
+
+void JitBatchShader::Compile_MAD(Instruction instr) {
+    const bool is_madi = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+    const SourceRegister src2 = is_madi ? instr.mad.src2i.Value() : instr.mad.src2.Value();
+    const SourceRegister src3 = is_madi ? instr.mad.src3i.Value() : instr.mad.src3.Value();
+    SwizzlePattern swiz = {(*swizzle_data)[instr.mad.operand_desc_id]};
+
+    for (unsigned comp = 0; comp < 4; ++comp) {
+        if (!swiz.DestComponentEnabled(comp)) {
+            continue;
+        }
+        Compile_SwizzleSrc(instr, 1, instr.mad.src1, comp, Vec(SRC1));
+        Compile_SwizzleSrc(instr, 2, src2, comp, Vec(SRC2));
+        Compile_SwizzleSrc(instr, 3, src3, comp, Vec(SRC3));
+        Compile_SanitizedMul(Vec(RESULT + comp), Vec(SRC1), Vec(SRC2));
+        vaddps(Vec(RESULT + comp), Vec(RESULT + comp), Vec(SRC3));
+    }
+
+    Compile_DestEnable(instr, false);
+}
+
+void JitBatchShader::Compile_IF(Instruction instr) {
+    Label l_else, l_endif;
+
+    const unsigned dest_offset = instr.flow_control.dest_offset;
+    const unsigned num_instructions = instr.flow_control.num_instructions;
+
+    if (instr.opcode.Value() == OpCode::Id::IFU) {
+        // The condition is the same for all vertices, so this is a regular branch
+        Compile_UniformCondition(instr);
+        jz(l_else, T_NEAR);
+
+        Compile_Block(dest_offset);
+
+        if (num_instructions == 0) {
+            L(l_else);
+            return;
+        }
+
+        jmp(l_endif, T_NEAR);
+
+        L(l_else);
+        Compile_Block(dest_offset + num_instructions);
+
+        L(l_endif);
+        return;
+    }
+
+    // Both blocks run with the vertices that do not take them masked off, and are skipped if no
+    // vertex takes them. The execution mask and the condition are saved on the stack meanwhile.
+    Compile_EvaluateCondition(instr, Vec(SCRATCH2));
+    sub(rsp, 64);
+    vmovups(ptr[rsp], Vec(EXEC));
+    vmovups(ptr[rsp + 32], Vec(SCRATCH2));
+
+    vandps(Vec(EXEC), Vec(EXEC), Vec(SCRATCH2));
+    vmovmskps(eax, Vec(EXEC));
+    test(eax, eax);
+    jz(l_else, T_NEAR);
+
+    Compile_Block(dest_offset);
+
+    L(l_else);
+    if (num_instructions != 0) {
+        vmovups(Vec(EXEC), ptr[rsp]);
+        vmovups(Vec(SCRATCH2), ptr[rsp + 32]);
+        vandnps(Vec(EXEC), Vec(SCRATCH2), Vec(EXEC));
+        vmovmskps(eax, Vec(EXEC));
+        test(eax, eax);
+        jz(l_endif, T_NEAR);
+
+        Compile_Block(dest_offset + num_instructions);
+    }
+
+    L(l_endif);
+    vmovups(Vec(EXEC), ptr[rsp]);
+    add(rsp, 64);
+}
+
+void JitBatchShader::Compile_LOOP(Instruction instr) {
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
+    // The Y (LOOPCOUNT_REG) and Z (LOOPINC) component are kept multiplied by 16 (Left shifted by
+    // 4 bits) to be used as an offset into the 16-byte vector uniforms later
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(LOOPCOUNT_REG, LOOPCOUNT);
+    shr(LOOPCOUNT_REG, 4);
+    and_(LOOPCOUNT_REG, 0xFF0); // Y-component is the start
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 12);
+    and_(LOOPINC, 0xFF0);               // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    if (divergent) {
+        // BREAKC masks off vertices until the end of the loop
+        sub(rsp, 32);
+        vmovups(ptr[rsp], Vec(EXEC));
+    }
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    loop_break_label = Xbyak::Label();
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    sub(LOOPCOUNT, 1);           // Increment loop count by 1
+    jnz(l_loop_start, T_NEAR);   // Loop if not equal
+    L(*loop_break_label);
+    loop_break_label.reset();
+
+    if (divergent) {
+        vmovups(Vec(EXEC), ptr[rsp]);
+        add(rsp, 32);
+    }
+}
+
+void JitBatchShader::Compile_JMP(Instruction instr) {
+    // Only JMPU is compiled, its condition is the same for all vertices
+    Compile_UniformCondition(instr);
+
+    bool inverted_condition = (instr.flow_control.num_instructions & 1) != 0;
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        jz(b, T_NEAR);
+    } else {
+        jnz(b, T_NEAR);
+    }
+}
+
+void JitBatchShader::Compile_Block(unsigned end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitBatchShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitBatchShader::Compile_NextInstr() {
+    if (!reachable[program_counter]) {
+        ++program_counter;
+        return;
+    }
+
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    // Reachable instructions were all checked to be supported
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = batch_instr_table[static_cast<unsigned>(opcode)];
+    ((*this).*instr_func)(instr);
+}
+
+std::unique_ptr<JitBatchShader> JitBatchShader::Compile(const ProgramCode& program_code,
+                                                        const SwizzleData& swizzle_data,
+                                                        unsigned entry_point) {
+    // Integer operations on YMM registers need AVX2, otherwise XMM registers are used
+    const auto& caps = Common::GetCPUCaps();
+    const std::size_t lanes = caps.avx2 ? 8 : caps.avx ? 4 : 0;
+    if (lanes == 0) {
+        return nullptr;
+    }
+
+    const auto info = AnalyzeProgram(program_code, entry_point);
+    if (!info || !IsVertexIndependent(program_code, swizzle_data, entry_point)) {
+        LOG_DEBUG(HW_GPU, "Shader at offset {} cannot run in batches", entry_point);
+        return nullptr;
+    }
+
+    std::unique_ptr<JitBatchShader> shader(new JitBatchShader(*info, lanes));
+    shader->CompileProgram(&program_code, &swizzle_data, entry_point);
+    return shader;
+}
+
+JitBatchShader::JitBatchShader(const ProgramInfo& info, std::size_t lanes)
+    : Xbyak::CodeGenerator(info.code_size), lanes(lanes), divergent(info.divergent),
+      reachable(info.reachable), input_mask(info.input_mask),
+      temporary_mask(info.temporary_mask), output_mask(info.output_mask),
+      return_offsets(info.return_offsets) {
+    CompilePrelude();
+}
+
+void JitBatchShader::CompileProgram(const ProgramCode* program_code_,
+                                    const SwizzleData* swizzle_data_, unsigned entry_point) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+
+    program = (CompiledShader*)getCurr();
+    program_counter = 0;
+
+    // The stack pointer is 8 modulo 16 at the entry of a procedure
+    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine.
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+
+    // Load the loop register
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(BatchUnitState, loop_register)]);
+    shl(LOOPCOUNT_REG, 4);
+
+    vbroadcastss(Vec(ONE), dword[rip + one_constant]);
+    vbroadcastss(Vec(NEGBIT), dword[rip + negbit_constant]);
+    if (divergent) {
+        vmovaps(Vec(EXEC), ptr[STATE + offsetof(BatchUnitState, execution_mask)]);
+    }
+
+    // Jump to start of the shader program
+    jmp(instruction_labels[entry_point], T_NEAR);
+
+    // Compile the reachable part of the program
+    Compile_Block(MAX_PROGRAM_CODE_LENGTH);
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    reachable.clear();
+    reachable.shrink_to_fit();
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    ready();
+
+    LOG_DEBUG(HW_GPU, "Compiled batch shader size={} lanes={}", getSize(), lanes);
+}
+
+void JitBatchShader::Run(const ShaderSetup& setup, UnitState* states, std::size_t count) const {
+    ASSERT(count > 0 && count <= lanes);
+
+    const s32 loop_register = states[0].address_registers[2];
+    BatchUnitState batch;
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        // Unused lanes repeat the last vertex, so that they compute harmless values
+        const UnitState& unit = states[std::min(lane, count - 1)];
+        TransposeIn(unit.registers.input, batch.registers.input, input_mask, lane);
+        // Only the first unit has the registers left by the previous vertex. The program doesn't
+        // read them before writing them, but the outputs it doesn't write are kept.
+        TransposeIn(states[0].registers.temporary, batch.registers.temporary, temporary_mask,
+                    lane);
+        TransposeIn(states[0].registers.output, batch.registers.output, output_mask, lane);
+        for (std::size_t i = 0; i < 2; ++i) {
+            batch.conditional_code[i][lane] = states[0].conditional_code[i] ? 0xFFFFFFFF : 0;
+            batch.address_registers[i][lane] = states[0].address_registers[i];
+        }
+        batch.execution_mask[lane] = lane < count ? 0xFFFFFFFF : 0;
+    }
+    batch.loop_register = loop_register;
+
+    program(&setup.uniforms, &batch);
+
+    for (std::size_t lane = 0; lane < count; ++lane) {
+        UnitState& unit = states[lane];
+        TransposeOut(batch.registers.temporary, unit.registers.temporary, temporary_mask, lane);
+        TransposeOut(batch.registers.output, unit.registers.output, output_mask, lane);
+        for (std::size_t i = 0; i < 2; ++i) {
+            unit.conditional_code[i] = batch.conditional_code[i][lane] != 0;
+            unit.address_registers[i] = batch.address_registers[i][lane];
+        }
+        unit.address_registers[2] = batch.loop_register;
+    }
+}
+
+void JitBatchShader::CompilePrelude() {
+    align(32);
+    one_constant = getCurr();
+    dd(0x3f800000);
+    negbit_constant = getCurr();
+    dd(0x80000000);
+
+    align(32);
+    all_ones_constant = getCurr();
+    for (std::size_t lane = 0; lane < MAX_BATCH_LANES; ++lane) {
+        dd(0xffffffff);
+    }
+
+    log2_subroutine = CompilePrelude_Log2();
+    exp2_subroutine = CompilePrelude_Exp2();
+}
+
+Xbyak::Label JitBatchShader::CompilePrelude_Log2() {
+    Xbyak::Label subroutine;
+
+    // This evaluates the same approximation as the per-vertex JIT, with the same operations in
+    // the same order so that the results are identical. Only the edge cases are handled with
+    // masks instead of branches.
+    // Input and output are in SRC1, this clobbers SRC2, the scratches and the temporaries.
+    align(16);
+    const void* c0 = getCurr();
+    dd(0x3d74552f);
+    const void* c1 = getCurr();
+    dd(0xbeee7397);
+    const void* c2 = getCurr();
+    dd(0x3fbd96dd);
+    const void* c3 = getCurr();
+    dd(0xc02153f6);
+    const void* c4 = getCurr();
+    dd(0x4038d96c);
+    const void* mantissa_mask = getCurr();
+    dd(0x007fffff);
+    const void* exponent_bias = getCurr();
+    dd(0x7f);
+    const void* negative_infinity = getCurr();
+    dd(0xff800000);
+    const void* default_qnan = getCurr();
+    dd(0x7fc00000);
+
+    align(16);
+    L(subroutine);
+
+    // Edge cases: NaN is returned as is, zero gives -inf and negative numbers give NaN
+    vxorps(Vec(SCRATCH), Vec(SCRATCH), Vec(SCRATCH));
+    vcmpunordps(Vec(TEMP), Vec(SRC1), Vec(SRC1));
+    vcmpeqps(Vec(TEMP + 1), Vec(SRC1), Vec(SCRATCH));
+    vcmpltps(Vec(TEMP + 2), Vec(SRC1), Vec(SCRATCH));
+    vmovaps(Vec(TEMP + 3), Vec(SRC1));
+
+    // Split input
+    vpsrld(Vec(SCRATCH2), Vec(SRC1), 23);
+    vbroadcastss(Vec(SCRATCH), dword[rip + exponent_bias]);
+    vpsubd(Vec(SCRATCH2), Vec(SCRATCH2), Vec(SCRATCH));
+    vcvtdq2ps(Vec(SCRATCH2), Vec(SCRATCH2));
+    // SCRATCH2 now contains the exponent of the input.
+    vbroadcastss(Vec(SCRATCH), dword[rip + mantissa_mask]);
+    vandps(Vec(SRC1), Vec(SRC1), Vec(SCRATCH));
+    vorps(Vec(SRC1), Vec(SRC1), Vec(ONE));
+    // SRC1 now contains the mantissa of the input.
+
+    // Complete computation of polynomial
+    vbroadcastss(Vec(SCRATCH), dword[rip + c0]);
+    vmulps(Vec(SCRATCH), Vec(SCRATCH), Vec(SRC1));
+    for (const void* coefficient : {c1, c2, c3}) {
+        vbroadcastss(Vec(SRC2), dword[rip + coefficient]);
+        vaddps(Vec(SCRATCH), Vec(SCRATCH), Vec(SRC2));
+        vmulps(Vec(SCRATCH), Vec(SCRATCH), Vec(SRC1));
+    }
+    vsubps(Vec(SRC1), Vec(SRC1), Vec(ONE));
+    vbroadcastss(Vec(SRC2), dword[rip + c4]);
+    vaddps(Vec(SCRATCH), Vec(SCRATCH), Vec(SRC2));
+    vmulps(Vec(SCRATCH), Vec(SCRATCH), Vec(SRC1));
+    vaddps(Vec(SRC1), Vec(SCRATCH2), Vec(SCRATCH));
+
+    vbroadcastss(Vec(SRC2), dword[rip + negative_infinity]);
+    vblendvps(Vec(SRC1), Vec(SRC1), Vec(SRC2), Vec(TEMP + 1));
+    vbroadcastss(Vec(SRC2), dword[rip + default_qnan]);
+    vblendvps(Vec(SRC1), Vec(SRC1), Vec(SRC2), Vec(TEMP + 2));
+    vblendvps(Vec(SRC1), Vec(SRC1), Vec(TEMP + 3), Vec(TEMP));
+
+    ret();
+
+    return subroutine;
+}
+
+Xbyak::Label JitBatchShader::CompilePrelude_Exp2() {
+    Xbyak::Label subroutine;
+
+    // This evaluates the same approximation as the per-vertex JIT, with the same operations in
+    // the same order so that the results are identical.
+    // Input and output are in SRC1, this clobbers SRC2, the scratches and the temporaries.
+    align(16);
+    const void* input_max = getCurr();
+    dd(0x43010000);
+    const void* input_min = getCurr();
+    dd(0xc2fdffff);
+    const void* c0 = getCurr();
+    dd(0x3c5dbe69);
+    const void* half = getCurr();
+    dd(0x3f000000);
+    const void* c1 = getCurr();
+    dd(0x3d5509f9);
+    const void* c2 = getCurr();
+    dd(0x3e773cc5);
+    const void* c3 = getCurr();
+    dd(0x3f3168b3);
+    const void* c4 = getCurr();
+    dd(0x3f800016);
+    const void* exponent_bias = getCurr();
+    dd(0x7f);
+
+    align(16);
+    L(subroutine);
+
+    // NaN is returned as is
+    vcmpunordps(Vec(TEMP), Vec(SRC1), Vec(SRC1));
+    vmovaps(Vec(TEMP + 1), Vec(SRC1));
+
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    vbroadcastss(Vec(SCRATCH), dword[rip + input_max]);
+    vminps(Vec(SRC1), Vec(SRC1), Vec(SCRATCH));
+    vbroadcastss(Vec(SCRATCH), dword[rip + input_min]);
+    vmaxps(Vec(SRC1), Vec(SRC1), Vec(SCRATCH));
+
+    // Decompose input
+    vbroadcastss(Vec(SCRATCH), dword[rip + half]);
+    vsubps(Vec(SCRATCH), Vec(SRC1), Vec(SCRATCH));
+    vcvtps2dq(Vec(TEMP + 2), Vec(SCRATCH));
+    vcvtdq2ps(Vec(SCRATCH), Vec(TEMP + 2));
+    // SCRATCH now contains input rounded to the nearest integer.
+    vsubps(Vec(SRC1), Vec(SRC1), Vec(SCRATCH));
+    // SRC1 contains input - round(input), which is in [-0.5, 0.5).
+    vbroadcastss(Vec(SCRATCH2), dword[rip + c0]);
+    vmulps(Vec(SCRATCH2), Vec(SCRATCH2), Vec(SRC1));
+    vbroadcastss(Vec(SCRATCH), dword[rip + exponent_bias]);
+    vpaddd(Vec(TEMP + 2), Vec(TEMP + 2), Vec(SCRATCH));
+    vpslld(Vec(TEMP + 2), Vec(TEMP + 2), 23);
+    // TEMP + 2 contains 2^(round(input)).
+
+    // Complete computation of polynomial.
+    for (const void* coefficient : {c1, c2}) {
+        vbroadcastss(Vec(SRC2), dword[rip + coefficient]);
+        vaddps(Vec(SCRATCH2), Vec(SCRATCH2), Vec(SRC2));
+        vmulps(Vec(SCRATCH2), Vec(SCRATCH2), Vec(SRC1));
+    }
+    vbroadcastss(Vec(SRC2), dword[rip + c3]);
+    vaddps(Vec(SCRATCH2), Vec(SCRATCH2), Vec(SRC2));
+    vmulps(Vec(SRC1), Vec(SRC1), Vec(SCRATCH2));
+    vbroadcastss(Vec(SRC2), dword[rip + c4]);
+    vaddps(Vec(SRC1), Vec(SRC1), Vec(SRC2));
+    vmulps(Vec(SRC1), Vec(SRC1), Vec(TEMP + 2));
+
+    vblendvps(Vec(SRC1), Vec(SRC1), Vec(TEMP + 1), Vec(TEMP));
+
+    ret();
+
+    return subroutine;
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,253 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/shader/shader.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SwizzlePattern;
+
+namespace Pica::Shader {
+
+/// Maximum number of vertices processed by one invocation of a batch shader
+constexpr std::size_t MAX_BATCH_LANES = 8;
+
+/**
+ * Shader unit state of a batch of vertices in structure-of-arrays form. Every register component
+ * holds the values of all vertices in the batch, so that one SIMD instruction processes the same
+ * component of all vertices at once.
+ */
+struct BatchUnitState {
+    using Component = std::array<float, MAX_BATCH_LANES>;
+    using Register = std::array<Component, 4>;
+
+    struct Registers {
+        alignas(32) Register input[16];
+        alignas(32) Register temporary[16];
+        alignas(32) Register output[16];
+    } registers;
+
+    /// Conditional codes of each vertex, as masks with all bits set when true
+    alignas(32) std::array<u32, MAX_BATCH_LANES> conditional_code[2];
+
+    /// The two address registers of each vertex
+    alignas(32) std::array<s32, MAX_BATCH_LANES> address_registers[2];
+
+    /// Masks with all bits set for the vertices that are being executed
+    alignas(32) std::array<u32, MAX_BATCH_LANES> execution_mask;
+
+    /// Used when each vertex reads a different register through an address register
+    alignas(32) Component gather;
+
+    /// The loop counter register, which is the same for all vertices of a batch
+    s32 loop_register;
+
+    static std::size_t InputOffset(const SourceRegister& reg) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Input:
+            return offsetof(BatchUnitState, registers.input) + reg.GetIndex() * sizeof(Register);
+
+        case RegisterType::Temporary:
+            return offsetof(BatchUnitState, registers.temporary) +
+                   reg.GetIndex() * sizeof(Register);
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+
+    static std::size_t OutputOffset(const DestRegister& reg) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Output:
+            return offsetof(BatchUnitState, registers.output) + reg.GetIndex() * sizeof(Register);
+
+        case RegisterType::Temporary:
+            return offsetof(BatchUnitState, registers.temporary) +
+                   reg.GetIndex() * sizeof(Register);
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+};
+
+/**
+ * Second compilation mode of the shader JIT. It recompiles a Pica shader program into x86_64 code
+ * that runs several vertices at once, 8 per invocation with AVX2 and 4 with AVX. Each register
+ * component of all vertices lives in one YMM or XMM register. Conditional control flow that can
+ * diverge between vertices is handled by masking the vertices that do not take a branch.
+ */
+class JitBatchShader : public Xbyak::CodeGenerator {
+public:
+    /**
+     * Compiles the program for batch execution starting at the entry point. Returns nullptr if the
+     * host lacks AVX or the program uses features that cannot run in batches, such as geometry
+     * shader instructions or data-dependent jumps, or reads registers left by the previous vertex.
+     * These programs have to be run per vertex.
+     */
+    static std::unique_ptr<JitBatchShader> Compile(const ProgramCode& program_code,
+                                                   const SwizzleData& swizzle_data,
+                                                   unsigned entry_point);
+
+    /// Returns the number of vertices processed by one invocation
+    std::size_t GetLaneCount() const {
+        return lanes;
+    }
+
+    /**
+     * Runs the shader on at most GetLaneCount() units, with the same results as running it on
+     * each of them in order, carrying the registers over as in ShaderEngine::RunBatch. Only the
+     * programs whose vertices don't depend on the previous ones are compiled for batches.
+     */
+    void Run(const ShaderSetup& setup, UnitState* states, std::size_t count) const;
+
+    struct ProgramInfo;
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOVA(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_BREAKC(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLC(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_CMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+
+private:
+    JitBatchShader(const ProgramInfo& info, std::size_t lanes);
+
+    void CompileProgram(const ProgramCode* program_code, const SwizzleData* swizzle_data,
+                        unsigned entry_point);
+
+    void Compile_Block(unsigned end);
+    void Compile_NextInstr();
+
+    /// Computes op(result, src1, src2) for each enabled component and stores the results
+    template <typename Op>
+    void Compile_ComponentWise(Instruction instr, unsigned num_sources, Op op);
+
+    /// Computes the dot product of the sources, replacing src1.w by 1.0 if homogeneous is true
+    void Compile_DotProduct(Instruction instr, unsigned num_components, bool homogeneous);
+
+    /// Returns the XMM or YMM register with the index, depending on the lane count
+    Xbyak::Xmm Vec(int index) const;
+
+    /**
+     * Loads one component of a swizzled source register for all vertices.
+     * @param instr Instruction, used for determining how to load the source register
+     * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, ...)
+     * @param src_reg SourceRegister object corresponding to the source register to load
+     * @param component Component of the swizzled register to load
+     * @param dest Destination register
+     */
+    void Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                            unsigned component, Xbyak::Xmm dest);
+
+    /**
+     * Loads the 32-bit values at base + address_register * (1 << shift) + offset of each vertex,
+     * adding lane * 4 to the offset when each vertex has its own copy of the data.
+     */
+    void Compile_Gather(Xbyak::Reg64 base, int offset, unsigned address_register, int shift,
+                        bool per_lane, Xbyak::Xmm dest);
+
+    /**
+     * Stores the result registers to the enabled components of the destination register. If
+     * scalar_result is true, the first result register is stored to all enabled components.
+     */
+    void Compile_DestEnable(Instruction instr, bool scalar_result);
+
+    /// Stores the value for the vertices that are being executed
+    void Compile_MaskedStore(const Xbyak::Address& dest, Xbyak::Xmm value);
+
+    /// Computes dest = src1 * src2 with the PICA semantics for 0 * inf. Clobbers the scratches.
+    void Compile_SanitizedMul(Xbyak::Xmm dest, Xbyak::Xmm src1, Xbyak::Xmm src2);
+
+    /// Computes the mask of the vertices for which the flow control condition is true
+    void Compile_EvaluateCondition(Instruction instr, Xbyak::Xmm dest);
+    void Compile_UniformCondition(Instruction instr);
+
+    /**
+     * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
+     */
+    void Compile_Return();
+
+    /**
+     * Emits data and code for utility functions.
+     */
+    void CompilePrelude();
+    Xbyak::Label CompilePrelude_Log2();
+    Xbyak::Label CompilePrelude_Exp2();
+
+    const ProgramCode* program_code = nullptr;
+    const SwizzleData* swizzle_data = nullptr;
+
+    /// Number of vertices processed by one invocation
+    std::size_t lanes;
+
+    /// True if the program contains conditional control flow that can diverge between vertices
+    bool divergent = false;
+
+    /// Instructions that can be reached from the entry point. Only these are compiled.
+    std::vector<bool> reachable;
+
+    /// Registers read or written by the program, which are the ones transposed by Run
+    u16 input_mask = 0;
+    u16 temporary_mask = 0;
+    u16 output_mask = 0;
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Label pointing to the end of the current LOOP block. Used by the BREAKC instruction to break
+    /// out of the loop.
+    std::optional<Xbyak::Label> loop_break_label;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<unsigned> return_offsets;
+
+    unsigned program_counter = 0; ///< Offset of the next instruction to decode
+
+    using CompiledShader = void(const void* setup, void* state);
+    CompiledShader* program = nullptr;
+
+    Xbyak::Label log2_subroutine;
+    Xbyak::Label exp2_subroutine;
+
+    /// Broadcast constants emitted by the prelude
+    const void* one_constant = nullptr;
+    const void* negbit_constant = nullptr;
+    const void* all_ones_constant = nullptr;
+};
+
+} // namespace Pica::Shader
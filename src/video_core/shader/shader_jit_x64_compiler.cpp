@@ -164,11 +164,25 @@ static void LogCritical(const char* msg) {
 
 void JitShader::Compile_Assert(bool condition, const char* msg) {
     if (!condition) {
-        mov(ABI_PARAM1, reinterpret_cast<std::size_t>(msg));
-        CallFarFunction(*this, LogCritical);
+        Compile_LogCritical(msg);
     }
 }
 
+void JitShader::Compile_LogCritical(const char* msg) {
+    // The message is copied into the code, so that it stays valid when the code is serialized
+    Label message, skip;
+    jmp(skip, T_NEAR);
+    L(message);
+    for (const char* c = msg; *c != '\0'; ++c) {
+        db(*c);
+    }
+    db(0);
+    L(skip);
+
+    lea(ABI_PARAM1, ptr[rip + message]);
+    call(qword[rip + host_function_table + HOST_FUNCTION_LOG_CRITICAL * sizeof(u64)]);
+}
+
 /**
  * Loads and swizzles a source register into the specified XMM register.
  * @param instr VS instruction, used for determining how to load the source register
@@ -788,8 +802,7 @@ void JitShader::Compile_EMIT(Instruction instr) {
     jnz(have_emitter);
 
     ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-    mov(ABI_PARAM1, reinterpret_cast<std::size_t>("Execute EMIT on VS"));
-    CallFarFunction(*this, LogCritical);
+    Compile_LogCritical("Execute EMIT on VS");
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     jmp(end);
 
@@ -798,7 +811,7 @@ void JitShader::Compile_EMIT(Instruction instr) {
     mov(ABI_PARAM1, rax);
     mov(ABI_PARAM2, STATE);
     add(ABI_PARAM2, static_cast<Xbyak::uint32>(offsetof(UnitState, registers.output)));
-    CallFarFunction(*this, Emit);
+    call(qword[rip + host_function_table + HOST_FUNCTION_EMIT * sizeof(u64)]);
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     L(end);
 }
@@ -810,8 +823,7 @@ void JitShader::Compile_SETE(Instruction instr) {
     jnz(have_emitter);
 
     ABI_PushRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
-    mov(ABI_PARAM1, reinterpret_cast<std::size_t>("Execute SETEMIT on VS"));
-    CallFarFunction(*this, LogCritical);
+    Compile_LogCritical("Execute SETEMIT on VS");
     ABI_PopRegistersAndAdjustStack(*this, PersistentCallerSavedRegs(), 0);
     jmp(end);
 
@@ -920,14 +932,10 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     mov(COND1, byte[STATE + offsetof(UnitState, conditional_code[1])]);
 
     // Used to set a register to one
-    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
-    mov(rax, reinterpret_cast<std::size_t>(&one));
-    movaps(ONE, xword[rax]);
+    movaps(ONE, xword[rip + one_vector]);
 
     // Used to negate registers
-    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
-    mov(rax, reinterpret_cast<std::size_t>(&neg));
-    movaps(NEGBIT, xword[rax]);
+    movaps(NEGBIT, xword[rip + negbit_vector]);
 
     // Jump to start of the shader program
     jmp(ABI_PARAM3);
@@ -943,15 +951,76 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
 
     ready();
 
+    program_offset = static_cast<u32>(reinterpret_cast<const u8*>(program) - getCode());
+    for (std::size_t i = 0; i < instruction_labels.size(); ++i) {
+        instruction_offsets[i] = static_cast<u32>(instruction_labels[i].getAddress() - getCode());
+    }
+
     ASSERT_MSG(getSize() <= MAX_SHADER_SIZE, "Compiled a shader that exceeds the allocated size!");
     LOG_DEBUG(HW_GPU, "Compiled shader size={}", getSize());
 }
 
+JitShaderImage JitShader::Serialize() const {
+    JitShaderImage image;
+    image.code.assign(getCode(), getCode() + getSize());
+    image.program_offset = program_offset;
+    image.instruction_offsets.assign(instruction_offsets.begin(), instruction_offsets.end());
+    return image;
+}
+
+bool JitShader::Deserialize(const JitShaderImage& image) {
+    if (image.code.size() > MAX_SHADER_SIZE || image.code.size() < HOST_FUNCTION_TABLE_SIZE ||
+        image.program_offset >= image.code.size() ||
+        image.instruction_offsets.size() != instruction_offsets.size()) {
+        return false;
+    }
+    for (u32 offset : image.instruction_offsets) {
+        if (offset >= image.code.size()) {
+            return false;
+        }
+    }
+
+    // The code only refers to itself relative to the instruction pointer, except for the host
+    // function table, which is emitted again for this process
+    reset();
+    EmitHostFunctionTable();
+    for (std::size_t i = HOST_FUNCTION_TABLE_SIZE; i < image.code.size(); ++i) {
+        db(image.code[i]);
+    }
+    ready();
+
+    program_offset = image.program_offset;
+    program = (CompiledShader*)(getCode() + program_offset);
+    std::copy(image.instruction_offsets.begin(), image.instruction_offsets.end(),
+              instruction_offsets.begin());
+    return true;
+}
+
 JitShader::JitShader() : Xbyak::CodeGenerator(MAX_SHADER_SIZE) {
     CompilePrelude();
 }
 
+void JitShader::EmitHostFunctionTable() {
+    host_function_table = getCurr();
+    dq(reinterpret_cast<u64>(&LogCritical));
+    dq(reinterpret_cast<u64>(&Emit));
+    ASSERT(getSize() == HOST_FUNCTION_TABLE_SIZE);
+}
+
 void JitShader::CompilePrelude() {
+    // The host function table comes first, so that it is at the same offset in every shader
+    EmitHostFunctionTable();
+
+    align(16);
+    one_vector = getCurr();
+    for (int i = 0; i < 4; ++i) {
+        dd(0x3f800000);
+    }
+    negbit_vector = getCurr();
+    for (int i = 0; i < 4; ++i) {
+        dd(0x80000000);
+    }
+
     log2_subroutine = CompilePrelude_Log2();
     exp2_subroutine = CompilePrelude_Exp2();
 }
@@ -24,6 +24,13 @@ namespace Pica::Shader {
 /// Memory allocated for each compiled shader
 constexpr std::size_t MAX_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 64;
 
+/// Compiled shader in a form that can be stored, and loaded again at any address
+struct JitShaderImage {
+    std::vector<u8> code;
+    u32 program_offset = 0;
+    std::vector<u32> instruction_offsets;
+};
+
 /**
  * This class implements the shader JIT compiler. It recompiles a Pica shader program into x86_64
  * code that can be executed on the host machine directly.
@@ -33,12 +40,21 @@ public:
     JitShader();
 
     void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
-        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+        program(&setup.uniforms, &state, getCode() + instruction_offsets[offset]);
     }
 
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
                  const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
 
+    /// Copies out the compiled shader
+    JitShaderImage Serialize() const;
+
+    /**
+     * Replaces the compiled shader by one copied out with Serialize, possibly by another process.
+     * Returns false if the image is malformed.
+     */
+    bool Deserialize(const JitShaderImage& image);
+
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
     void Compile_DP4(Instruction instr);
@@ -100,6 +116,9 @@ private:
      */
     void Compile_Assert(bool condition, const char* msg);
 
+    /// Emits a call logging the message, which is stored in the code
+    void Compile_LogCritical(const char* msg);
+
     /**
      * Analyzes the entire shader program for `CALL` instructions before emitting any code,
      * identifying the locations where a return needs to be inserted.
@@ -110,6 +129,7 @@ private:
      * Emits data and code for utility functions.
      */
     void CompilePrelude();
+    void EmitHostFunctionTable();
     Xbyak::Label CompilePrelude_Log2();
     Xbyak::Label CompilePrelude_Exp2();
 
@@ -119,6 +139,9 @@ private:
     /// Mapping of Pica VS instructions to pointers in the emitted code
     std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
 
+    /// Offsets of the instructions in the emitted code, which remain valid after Deserialize
+    std::array<u32, MAX_PROGRAM_CODE_LENGTH> instruction_offsets{};
+
     /// Label pointing to the end of the current LOOP block. Used by the BREAKC instruction to break
     /// out of the loop.
     std::optional<Xbyak::Label> loop_break_label;
@@ -131,9 +154,20 @@ private:
 
     using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
     CompiledShader* program = nullptr;
+    u32 program_offset = 0;
 
     Xbyak::Label log2_subroutine;
     Xbyak::Label exp2_subroutine;
+
+    // Host functions are called through a table of pointers, so that the code does not depend on
+    // where they are located in this process
+    enum HostFunction { HOST_FUNCTION_LOG_CRITICAL, HOST_FUNCTION_EMIT, NUM_HOST_FUNCTIONS };
+    static constexpr std::size_t HOST_FUNCTION_TABLE_SIZE = NUM_HOST_FUNCTIONS * sizeof(u64);
+    const u8* host_function_table = nullptr;
+
+    /// Constant vectors emitted by the prelude
+    const void* one_vector = nullptr;
+    const void* negbit_vector = nullptr;
 };
 
 } // namespace Pica::Shader
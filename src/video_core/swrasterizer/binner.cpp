@@ -0,0 +1,233 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/binner.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Pica::Rasterizer {
+
+MICROPROFILE_DEFINE(GPU_TileFlush, "GPU", "Tile Flush", MP_RGB(50, 50, 200));
+
+namespace {
+
+/// Width and height of a binning tile in pixels. Multiple of the 8x8 framebuffer morton blocks so
+/// that no two tiles ever write to the same block.
+constexpr u32 TILE_SIZE = 32;
+
+struct Triangle {
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+};
+
+class TileBinner {
+public:
+    explicit TileBinner(unsigned num_threads) {
+        for (unsigned i = 1; i < num_threads; ++i) {
+            workers.emplace_back(&TileBinner::WorkerThread, this);
+        }
+    }
+
+    ~TileBinner() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        work_cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+        if (triangles.empty()) {
+            // The framebuffer configuration cannot change while triangles are queued, so the tile
+            // grid only needs to be set up once per batch.
+            const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+            tiles_x = std::max<u32>(1, (framebuffer.GetWidth() + TILE_SIZE - 1) / TILE_SIZE);
+            tiles_y = std::max<u32>(1, (framebuffer.GetHeight() + TILE_SIZE - 1) / TILE_SIZE);
+            if (bins.size() < tiles_x * tiles_y) {
+                bins.resize(tiles_x * tiles_y);
+            }
+        }
+
+        // Use the same fixed-point conversion as the rasterizer so that the bounding box matches
+        // the pixels it is going to visit exactly.
+        auto FloatToFix = [](float24 flt) {
+            return static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f));
+        };
+        const u16 x[3] = {FloatToFix(v0.screenpos.x), FloatToFix(v1.screenpos.x),
+                          FloatToFix(v2.screenpos.x)};
+        const u16 y[3] = {FloatToFix(v0.screenpos.y), FloatToFix(v1.screenpos.y),
+                          FloatToFix(v2.screenpos.y)};
+
+        const u32 min_x = std::min({x[0], x[1], x[2]}) >> 4;
+        const u32 min_y = std::min({y[0], y[1], y[2]}) >> 4;
+        const u32 max_x = (std::max({x[0], x[1], x[2]}) + 0xF) >> 4;
+        const u32 max_y = (std::max({y[0], y[1], y[2]}) + 0xF) >> 4;
+        if (min_x >= max_x || min_y >= max_y) {
+            return;
+        }
+
+        // Pixels beyond the framebuffer size are assigned to the last row and column of tiles
+        const u32 tile_x0 = std::min(min_x / TILE_SIZE, tiles_x - 1);
+        const u32 tile_y0 = std::min(min_y / TILE_SIZE, tiles_y - 1);
+        const u32 tile_x1 = std::min((max_x - 1) / TILE_SIZE, tiles_x - 1);
+        const u32 tile_y1 = std::min((max_y - 1) / TILE_SIZE, tiles_y - 1);
+
+        const u32 index = static_cast<u32>(triangles.size());
+        triangles.push_back({v0, v1, v2});
+
+        for (u32 tile_y = tile_y0; tile_y <= tile_y1; ++tile_y) {
+            for (u32 tile_x = tile_x0; tile_x <= tile_x1; ++tile_x) {
+                const u32 tile = tile_y * tiles_x + tile_x;
+                if (bins[tile].empty()) {
+                    active_tiles.push_back(tile);
+                }
+                bins[tile].push_back(index);
+            }
+        }
+    }
+
+    void Flush() {
+        if (triangles.empty()) {
+            return;
+        }
+
+        MICROPROFILE_SCOPE(GPU_TileFlush);
+
+        next_tile = 0;
+        if (!workers.empty()) {
+            {
+                std::lock_guard lock{mutex};
+                ++generation;
+                pending_workers = static_cast<u32>(workers.size());
+            }
+            work_cv.notify_all();
+        }
+
+        ProcessTiles();
+
+        if (!workers.empty()) {
+            std::unique_lock lock{mutex};
+            done_cv.wait(lock, [this] { return pending_workers == 0; });
+        }
+
+        for (u32 tile : active_tiles) {
+            bins[tile].clear();
+        }
+        active_tiles.clear();
+        triangles.clear();
+    }
+
+private:
+    void WorkerThread() {
+        Common::SetCurrentThreadName("SWRasterizer");
+
+        u64 seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock{mutex};
+                work_cv.wait(lock, [&] { return stop || generation != seen_generation; });
+                if (stop) {
+                    return;
+                }
+                seen_generation = generation;
+            }
+
+            ProcessTiles();
+
+            {
+                std::lock_guard lock{mutex};
+                if (--pending_workers == 0) {
+                    done_cv.notify_one();
+                }
+            }
+        }
+    }
+
+    void ProcessTiles() {
+        const u32 num_tiles = static_cast<u32>(active_tiles.size());
+        for (u32 i = next_tile++; i < num_tiles; i = next_tile++) {
+            const u32 tile = active_tiles[i];
+            const u32 tile_x = tile % tiles_x;
+            const u32 tile_y = tile / tiles_x;
+
+            const u16 left = static_cast<u16>(tile_x * TILE_SIZE);
+            const u16 top = static_cast<u16>(tile_y * TILE_SIZE);
+            const u16 right =
+                tile_x == tiles_x - 1 ? FULL_SCREEN.right : static_cast<u16>(left + TILE_SIZE);
+            const u16 bottom =
+                tile_y == tiles_y - 1 ? FULL_SCREEN.bottom : static_cast<u16>(top + TILE_SIZE);
+            const Common::Rectangle<u16> clip{left, top, right, bottom};
+
+            for (u32 index : bins[tile]) {
+                const Triangle& triangle = triangles[index];
+                ProcessTriangle(triangle.v0, triangle.v1, triangle.v2, clip);
+            }
+        }
+    }
+
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<u32>> bins;
+    std::vector<u32> active_tiles;
+    u32 tiles_x = 1;
+    u32 tiles_y = 1;
+    std::atomic<u32> next_tile{0};
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    u64 generation = 0;
+    u32 pending_workers = 0;
+    bool stop = false;
+};
+
+std::unique_ptr<TileBinner> g_binner;
+
+} // Anonymous namespace
+
+void InitBinning(unsigned num_threads) {
+    ShutdownBinning();
+    if (num_threads > 1) {
+        g_binner = std::make_unique<TileBinner>(num_threads);
+    }
+}
+
+void ShutdownBinning() {
+    if (g_binner) {
+        g_binner->Flush();
+        g_binner.reset();
+    }
+}
+
+bool IsBinningEnabled() {
+    return g_binner != nullptr;
+}
+
+void BinTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    g_binner->AddTriangle(v0, v1, v2);
+}
+
+void FlushBinnedTriangles() {
+    if (g_binner) {
+        g_binner->Flush();
+    }
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,34 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+namespace Pica::Rasterizer {
+
+struct Vertex;
+
+/**
+ * Enables tile-binned rasterization. Triangles are bucketed into screen tiles and the per-pixel
+ * stages are run by num_threads threads (the calling thread included) when the batch is flushed.
+ * A value of 0 or 1 keeps rasterizing every triangle immediately on the calling thread.
+ */
+void InitBinning(unsigned num_threads);
+
+/// Flushes any pending triangles and stops the worker threads
+void ShutdownBinning();
+
+/// Returns true if triangles should be queued with BinTriangle instead of being drawn directly
+bool IsBinningEnabled();
+
+/// Queues a clipped, screen-space triangle for rasterization at the next flush
+void BinTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+/**
+ * Rasterizes all queued triangles and blocks until every tile is done. Each tile processes its
+ * triangles in submission order, so the result is identical to drawing them one by one.
+ * Must be called before the framebuffer is read back or the PICA registers change.
+ */
+void FlushBinnedTriangles();
+
+} // namespace Pica::Rasterizer
@@ -11,6 +11,7 @@
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
 #include "common/vector_math.h"
@@ -23,11 +24,14 @@
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_texturing.h"
 #include "video_core/shader/shader.h"
+#include "video_core/swrasterizer/binner.h"
 #include "video_core/swrasterizer/framebuffer.h"
 #include "video_core/swrasterizer/lighting.h"
 #include "video_core/swrasterizer/proctex.h"
 #include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/swrasterizer/span.h"
 #include "video_core/swrasterizer/texturing.h"
+#include "video_core/swrasterizer/tile_cache.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
@@ -117,6 +121,741 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
     return std::make_tuple(x / z * half + half, y / z * half + half, z_abs, addr);
 }
 
+using TevStageConfig = TexturingRegs::TevStageConfig;
+
+/// Fragments of a triangle that passed the coverage test, waiting for the combiner stages
+struct FragmentSpan {
+    std::size_t size = 0;
+
+    // Positions in 12.4 rasterizer coordinates
+    std::array<u16, SPAN_SIZE> x{};
+    std::array<u16, SPAN_SIZE> y{};
+    std::array<float, SPAN_SIZE> depth{};
+
+    SpanColor primary_color;
+    SpanColor primary_fragment_color;
+    SpanColor secondary_fragment_color;
+    std::array<SpanColor, 4> texture_color;
+};
+
+/// Returns the channels a color modifier reads from, inverting them into scratch if required
+static std::array<const u8*, 3> GetColorModifierSpan(TevStageConfig::ColorModifier factor,
+                                                      const SpanColor& values,
+                                                      SpanColor& scratch) {
+    using ColorModifier = TevStageConfig::ColorModifier;
+
+    const auto& channels = values.channels;
+    const auto Invert = [&](std::size_t src, std::size_t dst) -> const u8* {
+        for (std::size_t i = 0; i < SPAN_SIZE; ++i)
+            scratch.channels[dst][i] = 255 - channels[src][i];
+        return scratch.channels[dst].data();
+    };
+    const auto Replicate = [](const u8* channel) -> std::array<const u8*, 3> {
+        return {channel, channel, channel};
+    };
+
+    switch (factor) {
+    case ColorModifier::SourceColor:
+        return {channels[0].data(), channels[1].data(), channels[2].data()};
+
+    case ColorModifier::OneMinusSourceColor:
+        return {Invert(0, 0), Invert(1, 1), Invert(2, 2)};
+
+    case ColorModifier::SourceAlpha:
+        return Replicate(channels[3].data());
+
+    case ColorModifier::OneMinusSourceAlpha:
+        return Replicate(Invert(3, 0));
+
+    case ColorModifier::SourceRed:
+        return Replicate(channels[0].data());
+
+    case ColorModifier::OneMinusSourceRed:
+        return Replicate(Invert(0, 0));
+
+    case ColorModifier::SourceGreen:
+        return Replicate(channels[1].data());
+
+    case ColorModifier::OneMinusSourceGreen:
+        return Replicate(Invert(1, 0));
+
+    case ColorModifier::SourceBlue:
+        return Replicate(channels[2].data());
+
+    case ColorModifier::OneMinusSourceBlue:
+        return Replicate(Invert(2, 0));
+    }
+
+    UNREACHABLE();
+    return {channels[0].data(), channels[1].data(), channels[2].data()};
+}
+
+/// Returns the channel an alpha modifier reads from, inverting it into scratch if required
+static const u8* GetAlphaModifierSpan(TevStageConfig::AlphaModifier factor,
+                                      const SpanColor& values, SpanChannel& scratch) {
+    using AlphaModifier = TevStageConfig::AlphaModifier;
+
+    const auto& channels = values.channels;
+    const auto Invert = [&](std::size_t src) -> const u8* {
+        for (std::size_t i = 0; i < SPAN_SIZE; ++i)
+            scratch[i] = 255 - channels[src][i];
+        return scratch.data();
+    };
+
+    switch (factor) {
+    case AlphaModifier::SourceAlpha:
+        return channels[3].data();
+
+    case AlphaModifier::OneMinusSourceAlpha:
+        return Invert(3);
+
+    case AlphaModifier::SourceRed:
+        return channels[0].data();
+
+    case AlphaModifier::OneMinusSourceRed:
+        return Invert(0);
+
+    case AlphaModifier::SourceGreen:
+        return channels[1].data();
+
+    case AlphaModifier::OneMinusSourceGreen:
+        return Invert(1);
+
+    case AlphaModifier::SourceBlue:
+        return channels[2].data();
+
+    case AlphaModifier::OneMinusSourceBlue:
+        return Invert(2);
+    }
+
+    UNREACHABLE();
+    return channels[3].data();
+}
+
+/// Converts a combiner multiplier (1, 2 or 4) to the shift applied by the span kernels
+static unsigned MultiplierToShift(unsigned multiplier) {
+    return multiplier == 4 ? 2 : (multiplier == 2 ? 1 : 0);
+}
+
+/**
+ * Texture environment - consists of 6 stages of color and alpha combining.
+ *
+ * Color combiners take three input color values from some source (e.g. interpolated vertex color,
+ * texture color, previous stage, etc), perform some very simple operations on each of them (e.g.
+ * inversion) and then calculate the output color with some basic arithmetic. Alpha combiners can
+ * be configured separately but work analogously.
+ *
+ * All fragments of the span are combined at once by the SIMD span kernels. The Dot3 operations
+ * are rare enough to be evaluated per fragment with the scalar functions.
+ */
+static void CombineSpan(const FragmentSpan& span, SpanColor& combiner_output) {
+    const auto& regs = g_state.regs;
+    const auto& kernels = GetSpanKernels();
+    const auto tev_stages = regs.texturing.GetTevStages();
+
+    SpanColor combiner_buffer;
+    SpanColor next_combiner_buffer;
+    next_combiner_buffer.Fill(Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
+                                              regs.texturing.tev_combiner_buffer_color.g.Value(),
+                                              regs.texturing.tev_combiner_buffer_color.b.Value(),
+                                              regs.texturing.tev_combiner_buffer_color.a.Value())
+                                  .Cast<u8>());
+
+    SpanColor constant;
+    SpanColor stage_output;
+    SpanColor unknown_source;
+    std::array<SpanColor, 3> color_scratch;
+    std::array<SpanChannel, 3> alpha_scratch;
+
+    for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
+        const auto& tev_stage = tev_stages[tev_stage_index];
+        using Operation = TevStageConfig::Operation;
+        using Source = TevStageConfig::Source;
+
+        constant.Fill(Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                      tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                          .Cast<u8>());
+
+        auto GetSource = [&](Source source) -> const SpanColor& {
+            switch (source) {
+            case Source::PrimaryColor:
+                return span.primary_color;
+
+            case Source::PrimaryFragmentColor:
+                return span.primary_fragment_color;
+
+            case Source::SecondaryFragmentColor:
+                return span.secondary_fragment_color;
+
+            case Source::Texture0:
+                return span.texture_color[0];
+
+            case Source::Texture1:
+                return span.texture_color[1];
+
+            case Source::Texture2:
+                return span.texture_color[2];
+
+            case Source::Texture3:
+                return span.texture_color[3];
+
+            case Source::PreviousBuffer:
+                return combiner_buffer;
+
+            case Source::Constant:
+                return constant;
+
+            case Source::Previous:
+                return combiner_output;
+
+            default:
+                LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
+                UNIMPLEMENTED();
+                return unknown_source;
+            }
+        };
+
+        const unsigned color_multiplier = tev_stage.GetColorMultiplier();
+        const unsigned alpha_multiplier = tev_stage.GetAlphaMultiplier();
+
+        // color combiner
+        // NOTE: The results are written to stage_output, so that the alpha combiner still sees
+        //       the color output of the previous stage.
+        if (IsSpanOperation(tev_stage.color_op)) {
+            const std::array<std::array<const u8*, 3>, 3> color_result = {{
+                GetColorModifierSpan(tev_stage.color_modifier1,
+                                     GetSource(tev_stage.color_source1), color_scratch[0]),
+                GetColorModifierSpan(tev_stage.color_modifier2,
+                                     GetSource(tev_stage.color_source2), color_scratch[1]),
+                GetColorModifierSpan(tev_stage.color_modifier3,
+                                     GetSource(tev_stage.color_source3), color_scratch[2]),
+            }};
+            for (std::size_t c = 0; c < 3; ++c) {
+                kernels.combine(tev_stage.color_op, color_result[0][c], color_result[1][c],
+                                color_result[2][c], stage_output.channels[c].data(),
+                                MultiplierToShift(color_multiplier));
+            }
+        } else {
+            for (std::size_t i = 0; i < span.size; ++i) {
+                Common::Vec3<u8> color_result[3] = {
+                    GetColorModifier(tev_stage.color_modifier1,
+                                     GetSource(tev_stage.color_source1).Get(i)),
+                    GetColorModifier(tev_stage.color_modifier2,
+                                     GetSource(tev_stage.color_source2).Get(i)),
+                    GetColorModifier(tev_stage.color_modifier3,
+                                     GetSource(tev_stage.color_source3).Get(i)),
+                };
+                auto color_output = ColorCombine(tev_stage.color_op, color_result);
+
+                for (std::size_t c = 0; c < 3; ++c) {
+                    stage_output.channels[c][i] =
+                        std::min((unsigned)255, color_output[c] * color_multiplier);
+                }
+
+                if (tev_stage.color_op == Operation::Dot3_RGBA) {
+                    // result of Dot3_RGBA operation is also placed to the alpha component
+                    stage_output.channels[3][i] =
+                        std::min((unsigned)255, color_output.x * alpha_multiplier);
+                }
+            }
+        }
+
+        // alpha combiner
+        if (tev_stage.color_op == Operation::Dot3_RGBA) {
+            // Already written by the color combiner
+        } else if (IsSpanOperation(tev_stage.alpha_op)) {
+            kernels.combine(
+                tev_stage.alpha_op,
+                GetAlphaModifierSpan(tev_stage.alpha_modifier1,
+                                     GetSource(tev_stage.alpha_source1), alpha_scratch[0]),
+                GetAlphaModifierSpan(tev_stage.alpha_modifier2,
+                                     GetSource(tev_stage.alpha_source2), alpha_scratch[1]),
+                GetAlphaModifierSpan(tev_stage.alpha_modifier3,
+                                     GetSource(tev_stage.alpha_source3), alpha_scratch[2]),
+                stage_output.channels[3].data(), MultiplierToShift(alpha_multiplier));
+        } else {
+            for (std::size_t i = 0; i < span.size; ++i) {
+                std::array<u8, 3> alpha_result = {{
+                    GetAlphaModifier(tev_stage.alpha_modifier1,
+                                     GetSource(tev_stage.alpha_source1).Get(i)),
+                    GetAlphaModifier(tev_stage.alpha_modifier2,
+                                     GetSource(tev_stage.alpha_source2).Get(i)),
+                    GetAlphaModifier(tev_stage.alpha_modifier3,
+                                     GetSource(tev_stage.alpha_source3).Get(i)),
+                }};
+                u8 alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+                stage_output.channels[3][i] =
+                    std::min((unsigned)255, alpha_output * alpha_multiplier);
+            }
+        }
+
+        combiner_output = stage_output;
+        combiner_buffer = next_combiner_buffer;
+
+        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
+                tev_stage_index)) {
+            for (std::size_t c = 0; c < 3; ++c)
+                next_combiner_buffer.channels[c] = combiner_output.channels[c];
+        }
+
+        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
+                tev_stage_index)) {
+            next_combiner_buffer.channels[3] = combiner_output.channels[3];
+        }
+    }
+}
+
+/// Computes one channel of a blend factor for the first count fragments of the span
+static void LookupBlendFactorSpan(FramebufferRegs::BlendFactor factor, std::size_t channel,
+                                  const SpanColor& src, const SpanColor& dest,
+                                  const Common::Vec4<u8>& blend_const, std::size_t count,
+                                  SpanChannel& out) {
+    DEBUG_ASSERT(channel < 4);
+
+    const auto Copy = [&](const SpanChannel& values) { out = values; };
+    const auto Invert = [&](const SpanChannel& values) {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = 255 - values[i];
+    };
+
+    switch (factor) {
+    case FramebufferRegs::BlendFactor::Zero:
+        out.fill(0);
+        break;
+
+    case FramebufferRegs::BlendFactor::One:
+        out.fill(255);
+        break;
+
+    case FramebufferRegs::BlendFactor::SourceColor:
+        Copy(src.channels[channel]);
+        break;
+
+    case FramebufferRegs::BlendFactor::OneMinusSourceColor:
+        Invert(src.channels[channel]);
+        break;
+
+    case FramebufferRegs::BlendFactor::DestColor:
+        Copy(dest.channels[channel]);
+        break;
+
+    case FramebufferRegs::BlendFactor::OneMinusDestColor:
+        Invert(dest.channels[channel]);
+        break;
+
+    case FramebufferRegs::BlendFactor::SourceAlpha:
+        Copy(src.channels[3]);
+        break;
+
+    case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
+        Invert(src.channels[3]);
+        break;
+
+    case FramebufferRegs::BlendFactor::DestAlpha:
+        Copy(dest.channels[3]);
+        break;
+
+    case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
+        Invert(dest.channels[3]);
+        break;
+
+    case FramebufferRegs::BlendFactor::ConstantColor:
+        out.fill(blend_const[channel]);
+        break;
+
+    case FramebufferRegs::BlendFactor::OneMinusConstantColor:
+        out.fill(255 - blend_const[channel]);
+        break;
+
+    case FramebufferRegs::BlendFactor::ConstantAlpha:
+        out.fill(blend_const.a());
+        break;
+
+    case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
+        out.fill(255 - blend_const.a());
+        break;
+
+    case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
+        // Returns 1.0 for the alpha channel
+        if (channel == 3) {
+            out.fill(255);
+            break;
+        }
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = std::min(src.channels[3][i], static_cast<u8>(255 - dest.channels[3][i]));
+        break;
+
+    default:
+        LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", static_cast<u32>(factor));
+        UNIMPLEMENTED();
+        Copy(src.channels[channel]);
+        break;
+    }
+}
+
+/**
+ * Runs the combiner and the output merger for all fragments of the span. The fragments of a span
+ * always belong to the same triangle and cover distinct pixels, so all framebuffer reads for the
+ * alpha blending step can be batched before any blended color is written back.
+ */
+static void ProcessSpan(const FragmentSpan& span) {
+    const auto& regs = g_state.regs;
+
+    SpanColor tev_output;
+    CombineSpan(span, tev_output);
+
+    bool stencil_action_enable =
+        g_state.regs.framebuffer.output_merger.stencil_test.enable &&
+        g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
+    const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
+
+    // Fragments that passed all tests and wait for alpha blending
+    std::size_t num_blended = 0;
+    std::array<std::size_t, SPAN_SIZE> blended_fragments;
+    SpanColor blend_src;
+    SpanColor blend_dest;
+
+    for (std::size_t fragment = 0; fragment < span.size; ++fragment) {
+        const u16 x = span.x[fragment];
+        const u16 y = span.y[fragment];
+        const float depth = span.depth[fragment];
+        Common::Vec4<u8> combiner_output = tev_output.Get(fragment);
+
+        const auto& output_merger = regs.framebuffer.output_merger;
+
+        if (output_merger.fragment_operation_mode ==
+            FramebufferRegs::FragmentOperationMode::Shadow) {
+            u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
+            // use green color as the shadow intensity
+            u8 stencil = combiner_output.y;
+            DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
+            // skip the normal output merger pipeline if it is in shadow mode
+            continue;
+        }
+
+        // TODO: Does alpha testing happen before or after stencil?
+        if (output_merger.alpha_test.enable) {
+            bool pass = false;
+
+            switch (output_merger.alpha_test.func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
+
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
+
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = combiner_output.a() == output_merger.alpha_test.ref;
+                break;
+
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = combiner_output.a() != output_merger.alpha_test.ref;
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = combiner_output.a() < output_merger.alpha_test.ref;
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = combiner_output.a() <= output_merger.alpha_test.ref;
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = combiner_output.a() > output_merger.alpha_test.ref;
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = combiner_output.a() >= output_merger.alpha_test.ref;
+                break;
+            }
+
+            if (!pass)
+                continue;
+        }
+
+        // Apply fog combiner
+        // Not fully accurate. We'd have to know what data type is used to
+        // store the depth etc. Using float for now until we know more
+        // about Pica datatypes
+        if (regs.texturing.fog_mode == TexturingRegs::FogMode::Fog) {
+            const Common::Vec3<u8> fog_color =
+                Common::MakeVec(regs.texturing.fog_color.r.Value(),
+                                regs.texturing.fog_color.g.Value(),
+                                regs.texturing.fog_color.b.Value())
+                    .Cast<u8>();
+
+            // Get index into fog LUT
+            float fog_index;
+            if (g_state.regs.texturing.fog_flip) {
+                fog_index = (1.0f - depth) * 128.0f;
+            } else {
+                fog_index = depth * 128.0f;
+            }
+
+            // Generate clamped fog factor from LUT for given fog index
+            float fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
+            float fog_f = fog_index - fog_i;
+            const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
+            float fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
+            fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
+
+            // Blend the fog
+            for (unsigned i = 0; i < 3; i++) {
+                combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
+                                                     (1.0f - fog_factor) * fog_color[i]);
+            }
+        }
+
+        u8 old_stencil = 0;
+
+        auto UpdateStencil = [stencil_test, x, y,
+                              &old_stencil](Pica::FramebufferRegs::StencilAction action) {
+            u8 new_stencil =
+                PerformStencilAction(action, old_stencil, stencil_test.reference_value);
+            if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
+                SetStencil(x >> 4, y >> 4,
+                           (new_stencil & stencil_test.write_mask) |
+                               (old_stencil & ~stencil_test.write_mask));
+        };
+
+        if (stencil_action_enable) {
+            old_stencil = GetStencil(x >> 4, y >> 4);
+            u8 dest = old_stencil & stencil_test.input_mask;
+            u8 ref = stencil_test.reference_value & stencil_test.input_mask;
+
+            bool pass = false;
+            switch (stencil_test.func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
+
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
+
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = (ref == dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = (ref != dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = (ref < dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = (ref <= dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = (ref > dest);
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = (ref >= dest);
+                break;
+            }
+
+            if (!pass) {
+                UpdateStencil(stencil_test.action_stencil_fail);
+                continue;
+            }
+        }
+
+        // Convert float to integer
+        unsigned num_bits =
+            FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
+        u32 z = (u32)(depth * ((1 << num_bits) - 1));
+
+        if (output_merger.depth_test_enable) {
+            u32 ref_z = GetDepth(x >> 4, y >> 4);
+
+            bool pass = false;
+
+            switch (output_merger.depth_test_func) {
+            case FramebufferRegs::CompareFunc::Never:
+                pass = false;
+                break;
+
+            case FramebufferRegs::CompareFunc::Always:
+                pass = true;
+                break;
+
+            case FramebufferRegs::CompareFunc::Equal:
+                pass = z == ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::NotEqual:
+                pass = z != ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThan:
+                pass = z < ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::LessThanOrEqual:
+                pass = z <= ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThan:
+                pass = z > ref_z;
+                break;
+
+            case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+                pass = z >= ref_z;
+                break;
+            }
+
+            if (!pass) {
+                if (stencil_action_enable)
+                    UpdateStencil(stencil_test.action_depth_fail);
+                continue;
+            }
+        }
+
+        if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
+            output_merger.depth_write_enable) {
+
+            SetDepth(x >> 4, y >> 4, z);
+        }
+
+        // The stencil depth_pass action is executed even if depth testing is disabled
+        if (stencil_action_enable)
+            UpdateStencil(stencil_test.action_depth_pass);
+
+        auto dest = GetPixel(x >> 4, y >> 4);
+
+        if (output_merger.alphablend_enable) {
+            // Blended below once all fragments of the span have been through the tests
+            blend_src.Set(num_blended, combiner_output);
+            blend_dest.Set(num_blended, dest);
+            blended_fragments[num_blended++] = fragment;
+            continue;
+        }
+
+        const Common::Vec4<u8> blend_output =
+            Common::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
+                            LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
+                            LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
+                            LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
+
+        const Common::Vec4<u8> result = {
+            output_merger.red_enable ? blend_output.r() : dest.r(),
+            output_merger.green_enable ? blend_output.g() : dest.g(),
+            output_merger.blue_enable ? blend_output.b() : dest.b(),
+            output_merger.alpha_enable ? blend_output.a() : dest.a(),
+        };
+
+        if (regs.framebuffer.framebuffer.allow_color_write != 0)
+            DrawPixel(x >> 4, y >> 4, result);
+    }
+
+    if (num_blended == 0)
+        return;
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    const auto params = output_merger.alpha_blending;
+    const Common::Vec4<u8> blend_const =
+        Common::MakeVec(output_merger.blend_const.r.Value(), output_merger.blend_const.g.Value(),
+                        output_merger.blend_const.b.Value(), output_merger.blend_const.a.Value())
+            .Cast<u8>();
+
+    SpanColor blend_output;
+    SpanChannel src_factor;
+    SpanChannel dest_factor;
+    const auto& kernels = GetSpanKernels();
+    for (std::size_t c = 0; c < 4; ++c) {
+        const bool is_alpha = c == 3;
+        const auto equation =
+            is_alpha ? params.blend_equation_a.Value() : params.blend_equation_rgb.Value();
+
+        LookupBlendFactorSpan(
+            is_alpha ? params.factor_source_a.Value() : params.factor_source_rgb.Value(), c,
+            blend_src, blend_dest, blend_const, num_blended, src_factor);
+        LookupBlendFactorSpan(
+            is_alpha ? params.factor_dest_a.Value() : params.factor_dest_rgb.Value(), c, blend_src,
+            blend_dest, blend_const, num_blended, dest_factor);
+
+        if (IsSpanBlendEquation(equation)) {
+            kernels.blend(equation, blend_src.channels[c].data(), src_factor.data(),
+                          blend_dest.channels[c].data(), dest_factor.data(),
+                          blend_output.channels[c].data());
+            continue;
+        }
+
+        // Unknown equations are reported and handled by the scalar implementation
+        for (std::size_t i = 0; i < num_blended; ++i) {
+            Common::Vec4<u8> srcfactor{};
+            Common::Vec4<u8> dstfactor{};
+            srcfactor[c] = src_factor[i];
+            dstfactor[c] = dest_factor[i];
+            blend_output.channels[c][i] = EvaluateBlendEquation(blend_src.Get(i), srcfactor,
+                                                                blend_dest.Get(i), dstfactor,
+                                                                equation)[c];
+        }
+    }
+
+    if (regs.framebuffer.framebuffer.allow_color_write == 0)
+        return;
+
+    for (std::size_t i = 0; i < num_blended; ++i) {
+        const std::size_t fragment = blended_fragments[i];
+        const Common::Vec4<u8> dest = blend_dest.Get(i);
+        const Common::Vec4<u8> result = {
+            output_merger.red_enable ? blend_output.channels[0][i] : dest.r(),
+            output_merger.green_enable ? blend_output.channels[1][i] : dest.g(),
+            output_merger.blue_enable ? blend_output.channels[2][i] : dest.b(),
+            output_merger.alpha_enable ? blend_output.channels[3][i] : dest.a(),
+        };
+        DrawPixel(span.x[fragment] >> 4, span.y[fragment] >> 4, result);
+    }
+}
+
+/**
+ * Whether the texture unit samples memory that the draw renders to. The tiles decoded from it would
+ * go stale during the draw, so it is sampled without the tile cache then.
+ */
+static bool SamplesRenderTarget(const Regs& regs, const TexturingRegs::FullTextureConfig& texture,
+                                std::size_t unit) {
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+    const u32 num_pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    const PAddr color_address = framebuffer.GetColorBufferPhysicalAddress();
+    const u32 color_size =
+        num_pixels * FramebufferRegs::BytesPerColorPixel(framebuffer.color_format);
+    const PAddr depth_address = framebuffer.GetDepthBufferPhysicalAddress();
+    const u32 depth_size =
+        num_pixels * FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
+    const auto overlaps = [&](PAddr address, u32 size) {
+        const auto overlaps_buffer = [&](PAddr buffer_address, u32 buffer_size) {
+            return address < buffer_address + buffer_size && buffer_address < address + size;
+        };
+        return (framebuffer.allow_color_write != 0 && overlaps_buffer(color_address, color_size)) ||
+               (framebuffer.allow_depth_stencil_write != 0 &&
+                overlaps_buffer(depth_address, depth_size));
+    };
+
+    const auto info = Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
+    const u32 size = static_cast<u32>(info.stride * (info.height / 8));
+    // Only unit 0 can be a cube map, whose faces are at their own addresses
+    const auto type = texture.config.type.Value();
+    if (unit == 0 && (type == TexturingRegs::TextureConfig::TextureCube ||
+                      type == TexturingRegs::TextureConfig::ShadowCube)) {
+        for (std::size_t face = 0; face < 6; ++face) {
+            const PAddr address = regs.texturing.GetCubePhysicalAddress(
+                static_cast<TexturingRegs::CubeFace>(face));
+            if (overlaps(address, size)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return overlaps(texture.config.GetPhysicalAddress(), size);
+}
+
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
 /**
@@ -124,7 +863,7 @@ MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 24
  * culling via recursion.
  */
 static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                    bool reversed = false) {
+                                    const Common::Rectangle<u16>& clip, bool reversed = false) {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
 
@@ -145,13 +884,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, clip, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, clip, true);
             return;
         }
 
@@ -185,6 +924,12 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
+    // Restrict the bounding box to the clip rectangle (a screen tile when binning is enabled)
+    min_x = static_cast<u16>(std::max<int>(min_x, clip.left << 4));
+    min_y = static_cast<u16>(std::max<int>(min_y, clip.top << 4));
+    max_x = static_cast<u16>(std::min<int>(max_x, clip.right << 4));
+    max_y = static_cast<u16>(std::min<int>(max_y, clip.bottom << 4));
+
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -213,12 +958,12 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
 
     auto textures = regs.texturing.GetTextures();
-    auto tev_stages = regs.texturing.GetTevStages();
+    std::array<bool, 3> use_tile_cache{};
+    for (std::size_t i = 0; i < textures.size(); ++i) {
+        use_tile_cache[i] = textures[i].enabled && !SamplesRenderTarget(regs, textures[i], i);
+    }
 
-    bool stencil_action_enable =
-        g_state.regs.framebuffer.output_merger.stencil_test.enable &&
-        g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
-    const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
+    FragmentSpan span;
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
@@ -410,7 +1155,9 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
 
                     // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = Texture::LookupTexture(texture_data, s, t, info);
+                    texture_color[i] = use_tile_cache[i]
+                                           ? LookupCachedTexel(texture_data, s, t, info)
+                                           : Texture::LookupTexture(texture_data, s, t, info);
                 }
 
                 if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -436,23 +1183,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
                                            g_state.regs.texturing, g_state.proctex);
             }
-
-            // Texture environment - consists of 6 stages of color and alpha combining.
-            //
-            // Color combiners take three input color values from some source (e.g. interpolated
-            // vertex color, texture color, previous stage, etc), perform some very simple
-            // operations on each of them (e.g. inversion) and then calculate the output color
-            // with some basic arithmetic. Alpha combiners can be configured separately but work
-            // analogously.
-            Common::Vec4<u8> combiner_output;
-            Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-            Common::Vec4<u8> next_combiner_buffer =
-                Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                                regs.texturing.tev_combiner_buffer_color.g.Value(),
-                                regs.texturing.tev_combiner_buffer_color.b.Value(),
-                                regs.texturing.tev_combiner_buffer_color.a.Value())
-                    .Cast<u8>();
-
             Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
             Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
 
@@ -475,424 +1205,37 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
             }
 
-            for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
-                 ++tev_stage_index) {
-                const auto& tev_stage = tev_stages[tev_stage_index];
-                using Source = TexturingRegs::TevStageConfig::Source;
-
-                auto GetSource = [&](Source source) -> Common::Vec4<u8> {
-                    switch (source) {
-                    case Source::PrimaryColor:
-                        return primary_color;
-
-                    case Source::PrimaryFragmentColor:
-                        return primary_fragment_color;
-
-                    case Source::SecondaryFragmentColor:
-                        return secondary_fragment_color;
-
-                    case Source::Texture0:
-                        return texture_color[0];
-
-                    case Source::Texture1:
-                        return texture_color[1];
-
-                    case Source::Texture2:
-                        return texture_color[2];
-
-                    case Source::Texture3:
-                        return texture_color[3];
-
-                    case Source::PreviousBuffer:
-                        return combiner_buffer;
-
-                    case Source::Constant:
-                        return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                               tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                            .Cast<u8>();
-
-                    case Source::Previous:
-                        return combiner_output;
-
-                    default:
-                        LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
-                        UNIMPLEMENTED();
-                        return {0, 0, 0, 0};
-                    }
-                };
-
-                // color combiner
-                // NOTE: Not sure if the alpha combiner might use the color output of the previous
-                //       stage as input. Hence, we currently don't directly write the result to
-                //       combiner_output.rgb(), but instead store it in a temporary variable until
-                //       alpha combining has been done.
-                Common::Vec3<u8> color_result[3] = {
-                    GetColorModifier(tev_stage.color_modifier1, GetSource(tev_stage.color_source1)),
-                    GetColorModifier(tev_stage.color_modifier2, GetSource(tev_stage.color_source2)),
-                    GetColorModifier(tev_stage.color_modifier3, GetSource(tev_stage.color_source3)),
-                };
-                auto color_output = ColorCombine(tev_stage.color_op, color_result);
-
-                u8 alpha_output;
-                if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
-                    // result of Dot3_RGBA operation is also placed to the alpha component
-                    alpha_output = color_output.x;
-                } else {
-                    // alpha combiner
-                    std::array<u8, 3> alpha_result = {{
-                        GetAlphaModifier(tev_stage.alpha_modifier1,
-                                         GetSource(tev_stage.alpha_source1)),
-                        GetAlphaModifier(tev_stage.alpha_modifier2,
-                                         GetSource(tev_stage.alpha_source2)),
-                        GetAlphaModifier(tev_stage.alpha_modifier3,
-                                         GetSource(tev_stage.alpha_source3)),
-                    }};
-                    alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
-                }
-
-                combiner_output[0] =
-                    std::min((unsigned)255, color_output.r() * tev_stage.GetColorMultiplier());
-                combiner_output[1] =
-                    std::min((unsigned)255, color_output.g() * tev_stage.GetColorMultiplier());
-                combiner_output[2] =
-                    std::min((unsigned)255, color_output.b() * tev_stage.GetColorMultiplier());
-                combiner_output[3] =
-                    std::min((unsigned)255, alpha_output * tev_stage.GetAlphaMultiplier());
-
-                combiner_buffer = next_combiner_buffer;
-
-                if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                        tev_stage_index)) {
-                    next_combiner_buffer.r() = combiner_output.r();
-                    next_combiner_buffer.g() = combiner_output.g();
-                    next_combiner_buffer.b() = combiner_output.b();
-                }
-
-                if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                        tev_stage_index)) {
-                    next_combiner_buffer.a() = combiner_output.a();
-                }
-            }
-
-            const auto& output_merger = regs.framebuffer.output_merger;
-
-            if (output_merger.fragment_operation_mode ==
-                FramebufferRegs::FragmentOperationMode::Shadow) {
-                u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
-                // use green color as the shadow intensity
-                u8 stencil = combiner_output.y;
-                DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
-                // skip the normal output merger pipeline if it is in shadow mode
-                continue;
-            }
-
-            // TODO: Does alpha testing happen before or after stencil?
-            if (output_merger.alpha_test.enable) {
-                bool pass = false;
-
-                switch (output_merger.alpha_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = combiner_output.a() == output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = combiner_output.a() != output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = combiner_output.a() < output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = combiner_output.a() <= output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = combiner_output.a() > output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = combiner_output.a() >= output_merger.alpha_test.ref;
-                    break;
-                }
-
-                if (!pass)
-                    continue;
+            span.x[span.size] = x;
+            span.y[span.size] = y;
+            span.depth[span.size] = depth;
+            span.primary_color.Set(span.size, primary_color);
+            span.primary_fragment_color.Set(span.size, primary_fragment_color);
+            span.secondary_fragment_color.Set(span.size, secondary_fragment_color);
+            for (std::size_t i = 0; i < span.texture_color.size(); ++i)
+                span.texture_color[i].Set(span.size, texture_color[i]);
+
+            if (++span.size == SPAN_SIZE) {
+                ProcessSpan(span);
+                span.size = 0;
             }
-
-            // Apply fog combiner
-            // Not fully accurate. We'd have to know what data type is used to
-            // store the depth etc. Using float for now until we know more
-            // about Pica datatypes
-            if (regs.texturing.fog_mode == TexturingRegs::FogMode::Fog) {
-                const Common::Vec3<u8> fog_color =
-                    Common::MakeVec(regs.texturing.fog_color.r.Value(),
-                                    regs.texturing.fog_color.g.Value(),
-                                    regs.texturing.fog_color.b.Value())
-                        .Cast<u8>();
-
-                // Get index into fog LUT
-                float fog_index;
-                if (g_state.regs.texturing.fog_flip) {
-                    fog_index = (1.0f - depth) * 128.0f;
-                } else {
-                    fog_index = depth * 128.0f;
-                }
-
-                // Generate clamped fog factor from LUT for given fog index
-                float fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
-                float fog_f = fog_index - fog_i;
-                const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
-                float fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
-                fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
-
-                // Blend the fog
-                for (unsigned i = 0; i < 3; i++) {
-                    combiner_output[i] = static_cast<u8>(fog_factor * combiner_output[i] +
-                                                         (1.0f - fog_factor) * fog_color[i]);
-                }
-            }
-
-            u8 old_stencil = 0;
-
-            auto UpdateStencil = [stencil_test, x, y,
-                                  &old_stencil](Pica::FramebufferRegs::StencilAction action) {
-                u8 new_stencil =
-                    PerformStencilAction(action, old_stencil, stencil_test.reference_value);
-                if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4,
-                               (new_stencil & stencil_test.write_mask) |
-                                   (old_stencil & ~stencil_test.write_mask));
-            };
-
-            if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
-                u8 dest = old_stencil & stencil_test.input_mask;
-                u8 ref = stencil_test.reference_value & stencil_test.input_mask;
-
-                bool pass = false;
-                switch (stencil_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = (ref == dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = (ref != dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = (ref < dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = (ref <= dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = (ref > dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = (ref >= dest);
-                    break;
-                }
-
-                if (!pass) {
-                    UpdateStencil(stencil_test.action_stencil_fail);
-                    continue;
-                }
-            }
-
-            // Convert float to integer
-            unsigned num_bits =
-                FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
-            u32 z = (u32)(depth * ((1 << num_bits) - 1));
-
-            if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
-
-                bool pass = false;
-
-                switch (output_merger.depth_test_func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = z == ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = z != ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = z < ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = z <= ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = z > ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = z >= ref_z;
-                    break;
-                }
-
-                if (!pass) {
-                    if (stencil_action_enable)
-                        UpdateStencil(stencil_test.action_depth_fail);
-                    continue;
-                }
-            }
-
-            if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
-                output_merger.depth_write_enable) {
-
-                SetDepth(x >> 4, y >> 4, z);
-            }
-
-            // The stencil depth_pass action is executed even if depth testing is disabled
-            if (stencil_action_enable)
-                UpdateStencil(stencil_test.action_depth_pass);
-
-            auto dest = GetPixel(x >> 4, y >> 4);
-            Common::Vec4<u8> blend_output = combiner_output;
-
-            if (output_merger.alphablend_enable) {
-                auto params = output_merger.alpha_blending;
-
-                auto LookupFactor = [&](unsigned channel,
-                                        FramebufferRegs::BlendFactor factor) -> u8 {
-                    DEBUG_ASSERT(channel < 4);
-
-                    const Common::Vec4<u8> blend_const =
-                        Common::MakeVec(output_merger.blend_const.r.Value(),
-                                        output_merger.blend_const.g.Value(),
-                                        output_merger.blend_const.b.Value(),
-                                        output_merger.blend_const.a.Value())
-                            .Cast<u8>();
-
-                    switch (factor) {
-                    case FramebufferRegs::BlendFactor::Zero:
-                        return 0;
-
-                    case FramebufferRegs::BlendFactor::One:
-                        return 255;
-
-                    case FramebufferRegs::BlendFactor::SourceColor:
-                        return combiner_output[channel];
-
-                    case FramebufferRegs::BlendFactor::OneMinusSourceColor:
-                        return 255 - combiner_output[channel];
-
-                    case FramebufferRegs::BlendFactor::DestColor:
-                        return dest[channel];
-
-                    case FramebufferRegs::BlendFactor::OneMinusDestColor:
-                        return 255 - dest[channel];
-
-                    case FramebufferRegs::BlendFactor::SourceAlpha:
-                        return combiner_output.a();
-
-                    case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
-                        return 255 - combiner_output.a();
-
-                    case FramebufferRegs::BlendFactor::DestAlpha:
-                        return dest.a();
-
-                    case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
-                        return 255 - dest.a();
-
-                    case FramebufferRegs::BlendFactor::ConstantColor:
-                        return blend_const[channel];
-
-                    case FramebufferRegs::BlendFactor::OneMinusConstantColor:
-                        return 255 - blend_const[channel];
-
-                    case FramebufferRegs::BlendFactor::ConstantAlpha:
-                        return blend_const.a();
-
-                    case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
-                        return 255 - blend_const.a();
-
-                    case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
-                        // Returns 1.0 for the alpha channel
-                        if (channel == 3)
-                            return 255;
-                        return std::min(combiner_output.a(), static_cast<u8>(255 - dest.a()));
-
-                    default:
-                        LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", static_cast<u32>(factor));
-                        UNIMPLEMENTED();
-                        break;
-                    }
-
-                    return combiner_output[channel];
-                };
-
-                auto srcfactor = Common::MakeVec(LookupFactor(0, params.factor_source_rgb),
-                                                 LookupFactor(1, params.factor_source_rgb),
-                                                 LookupFactor(2, params.factor_source_rgb),
-                                                 LookupFactor(3, params.factor_source_a));
-
-                auto dstfactor = Common::MakeVec(LookupFactor(0, params.factor_dest_rgb),
-                                                 LookupFactor(1, params.factor_dest_rgb),
-                                                 LookupFactor(2, params.factor_dest_rgb),
-                                                 LookupFactor(3, params.factor_dest_a));
-
-                blend_output = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
-                                                     params.blend_equation_rgb);
-                blend_output.a() = EvaluateBlendEquation(combiner_output, srcfactor, dest,
-                                                         dstfactor, params.blend_equation_a)
-                                       .a();
-            } else {
-                blend_output =
-                    Common::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
-                                    LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
-                                    LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
-                                    LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
-            }
-
-            const Common::Vec4<u8> result = {
-                output_merger.red_enable ? blend_output.r() : dest.r(),
-                output_merger.green_enable ? blend_output.g() : dest.g(),
-                output_merger.blue_enable ? blend_output.b() : dest.b(),
-                output_merger.alpha_enable ? blend_output.a() : dest.a(),
-            };
-
-            if (regs.framebuffer.framebuffer.allow_color_write != 0)
-                DrawPixel(x >> 4, y >> 4, result);
         }
     }
+
+    if (span.size != 0)
+        ProcessSpan(span);
 }
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+    if (IsBinningEnabled()) {
+        BinTriangle(v0, v1, v2);
+        return;
+    }
+    ProcessTriangleInternal(v0, v1, v2, FULL_SCREEN);
+}
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const Common::Rectangle<u16>& clip) {
+    ProcessTriangleInternal(v0, v1, v2, clip);
 }
 
 } // namespace Pica::Rasterizer
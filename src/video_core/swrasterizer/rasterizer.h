@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/math_util.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Rasterizer {
@@ -39,6 +40,14 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/// Pixel rectangle covering every position addressable by the 12.4 rasterizer coordinates
+constexpr Common::Rectangle<u16> FULL_SCREEN{0, 0, 4096, 4096};
+
+/// Rasterizes the triangle, or queues it in the tile binner if binning is enabled
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/// Rasterizes the part of the triangle that covers the pixels in [left, right) x [top, bottom)
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const Common::Rectangle<u16>& clip);
+
 } // namespace Pica::Rasterizer
@@ -0,0 +1,83 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "video_core/swrasterizer/span.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Pica::Rasterizer {
+
+namespace {
+
+/// Scalar fallback used on hosts without a SIMD backend
+struct GenericVector {
+    using Reg = u16;
+    static constexpr std::size_t LANES = 1;
+
+    static Reg Load(const u8* p) {
+        return *p;
+    }
+    static void Store(u8* p, Reg v) {
+        *p = static_cast<u8>(v);
+    }
+    static Reg Set(u16 v) {
+        return v;
+    }
+    static Reg Add(Reg a, Reg b) {
+        return static_cast<Reg>(a + b);
+    }
+    static Reg AddSat(Reg a, Reg b) {
+        return static_cast<Reg>(std::min(a + b, 0xFFFF));
+    }
+    static Reg SubSat(Reg a, Reg b) {
+        return static_cast<Reg>(a > b ? a - b : 0);
+    }
+    static Reg Mul(Reg a, Reg b) {
+        return static_cast<Reg>(a * b);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return std::min(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return std::max(a, b);
+    }
+    static Reg Div255(Reg a) {
+        return static_cast<Reg>(a / 255);
+    }
+    static Reg ShiftLeft(Reg a, unsigned shift) {
+        return static_cast<Reg>(a << shift);
+    }
+};
+
+constexpr SpanKernels generic_kernels = SpanImpl::MakeSpanKernels<GenericVector>();
+
+} // Anonymous namespace
+
+const SpanKernels& GetGenericSpanKernels() {
+    return generic_kernels;
+}
+
+const SpanKernels& GetSpanKernels() {
+#ifdef ARCHITECTURE_x86_64
+    static const SpanKernels& kernels = []() -> const SpanKernels& {
+        const auto& caps = Common::GetCPUCaps();
+        if (caps.avx2) {
+            return GetAVX2SpanKernels();
+        }
+        if (caps.sse4_1) {
+            return GetSSE41SpanKernels();
+        }
+        return generic_kernels;
+    }();
+    return kernels;
+#else
+    return generic_kernels;
+#endif
+}
+
+} // namespace Pica::Rasterizer
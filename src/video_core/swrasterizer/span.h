@@ -0,0 +1,90 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/regs_texturing.h"
+
+namespace Pica::Rasterizer {
+
+/// Number of fragments that are evaluated together by the span kernels
+constexpr std::size_t SPAN_SIZE = 16;
+
+/// One color channel of every fragment in a span
+using SpanChannel = std::array<u8, SPAN_SIZE>;
+
+/**
+ * RGBA colors of a span of fragments. The channels are stored one after another so that the
+ * kernels can process one channel of the whole span with a single SIMD register.
+ */
+struct alignas(16) SpanColor {
+    std::array<SpanChannel, 4> channels{};
+
+    Common::Vec4<u8> Get(std::size_t i) const {
+        return {channels[0][i], channels[1][i], channels[2][i], channels[3][i]};
+    }
+
+    void Set(std::size_t i, const Common::Vec4<u8>& color) {
+        channels[0][i] = color.r();
+        channels[1][i] = color.g();
+        channels[2][i] = color.b();
+        channels[3][i] = color.a();
+    }
+
+    void Fill(const Common::Vec4<u8>& color) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            channels[c].fill(color[c]);
+        }
+    }
+};
+
+/**
+ * Arithmetic kernels operating on SPAN_SIZE fragments at once. All kernels are bit-exact with the
+ * per-fragment functions in texturing.cpp and framebuffer.cpp.
+ */
+struct SpanKernels {
+    /**
+     * Computes out = min(255, op(in0, in1, in2) * (1 << shift)) for one channel, matching
+     * ColorCombine/AlphaCombine. The Dot3 operations are not supported.
+     */
+    void (*combine)(TexturingRegs::TevStageConfig::Operation op, const u8* in0, const u8* in1,
+                    const u8* in2, u8* out, unsigned shift);
+
+    /// Evaluates the blend equation for one channel, matching EvaluateBlendEquation
+    void (*blend)(FramebufferRegs::BlendEquation equation, const u8* src, const u8* src_factor,
+                  const u8* dest, const u8* dest_factor, u8* out);
+};
+
+/// Returns true if the combiner operation can be evaluated by SpanKernels::combine
+constexpr bool IsSpanOperation(TexturingRegs::TevStageConfig::Operation op) {
+    using Operation = TexturingRegs::TevStageConfig::Operation;
+    return op <= Operation::AddThenMultiply && op != Operation::Dot3_RGB &&
+           op != Operation::Dot3_RGBA;
+}
+
+/// Returns true if the blend equation can be evaluated by SpanKernels::blend
+constexpr bool IsSpanBlendEquation(FramebufferRegs::BlendEquation equation) {
+    return equation <= FramebufferRegs::BlendEquation::Max;
+}
+
+/// Returns the portable scalar kernels
+const SpanKernels& GetGenericSpanKernels();
+
+/// Returns the fastest kernels supported by the host CPU
+const SpanKernels& GetSpanKernels();
+
+#ifdef ARCHITECTURE_x86_64
+/// Kernels processing 8 fragments per instruction, requires SSE4.1
+const SpanKernels& GetSSE41SpanKernels();
+
+/// Kernels processing 16 fragments per instruction, requires AVX2
+const SpanKernels& GetAVX2SpanKernels();
+#endif
+
+} // namespace Pica::Rasterizer
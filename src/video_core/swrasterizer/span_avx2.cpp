@@ -0,0 +1,66 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is compiled with AVX2 code generation enabled. Nothing in it may be called before
+// checking Common::GetCPUCaps().avx2.
+
+#include <immintrin.h>
+#include "video_core/swrasterizer/span.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+namespace Pica::Rasterizer {
+
+namespace {
+
+struct AVX2Vector {
+    using Reg = __m256i;
+    static constexpr std::size_t LANES = 16;
+
+    static Reg Load(const u8* p) {
+        return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    static void Store(u8* p, Reg v) {
+        const __m128i lo = _mm256_castsi256_si128(v);
+        const __m128i hi = _mm256_extracti128_si256(v, 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(lo, hi));
+    }
+    static Reg Set(u16 v) {
+        return _mm256_set1_epi16(static_cast<short>(v));
+    }
+    static Reg Add(Reg a, Reg b) {
+        return _mm256_add_epi16(a, b);
+    }
+    static Reg AddSat(Reg a, Reg b) {
+        return _mm256_adds_epu16(a, b);
+    }
+    static Reg SubSat(Reg a, Reg b) {
+        return _mm256_subs_epu16(a, b);
+    }
+    static Reg Mul(Reg a, Reg b) {
+        return _mm256_mullo_epi16(a, b);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm256_min_epu16(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm256_max_epu16(a, b);
+    }
+    static Reg Div255(Reg a) {
+        // floor(x / 255) == (x * 0x8081) >> 23 for every 16-bit x
+        return _mm256_srli_epi16(_mm256_mulhi_epu16(a, Set(0x8081)), 7);
+    }
+    static Reg ShiftLeft(Reg a, unsigned shift) {
+        return _mm256_sll_epi16(a, _mm_cvtsi32_si128(static_cast<int>(shift)));
+    }
+};
+
+constexpr SpanKernels avx2_kernels = SpanImpl::MakeSpanKernels<AVX2Vector>();
+
+} // Anonymous namespace
+
+const SpanKernels& GetAVX2SpanKernels() {
+    return avx2_kernels;
+}
+
+} // namespace Pica::Rasterizer
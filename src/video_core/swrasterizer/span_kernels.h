@@ -0,0 +1,120 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/assert.h"
+#include "video_core/swrasterizer/span.h"
+
+// Kernel bodies shared by every span backend. Each backend translation unit instantiates them with
+// a vector type V that wraps its register type and provides the following static operations on
+// V::LANES unsigned 16-bit lanes:
+//   Load/Store     widen u8 to u16 and narrow back (values are always <= 255 when stored)
+//   Set            broadcast a constant
+//   Add/Mul        wrapping add and low 16 bits of the product
+//   AddSat/SubSat  unsigned saturating add and subtract
+//   Min/Max        unsigned minimum and maximum
+//   Div255         exact floor(x / 255) for any 16-bit x
+//   ShiftLeft      logical left shift
+
+namespace Pica::Rasterizer::SpanImpl {
+
+template <typename V>
+void Combine(TexturingRegs::TevStageConfig::Operation op, const u8* in0, const u8* in1,
+             const u8* in2, u8* out, unsigned shift) {
+    using Operation = TexturingRegs::TevStageConfig::Operation;
+    static_assert(SPAN_SIZE % V::LANES == 0);
+
+    const auto c255 = V::Set(255);
+    for (std::size_t i = 0; i < SPAN_SIZE; i += V::LANES) {
+        const auto a = V::Load(in0 + i);
+        const auto b = V::Load(in1 + i);
+        const auto c = V::Load(in2 + i);
+
+        typename V::Reg result;
+        switch (op) {
+        case Operation::Replace:
+            result = a;
+            break;
+        case Operation::Modulate:
+            result = V::Div255(V::Mul(a, b));
+            break;
+        case Operation::Add:
+            result = V::Min(V::Add(a, b), c255);
+            break;
+        case Operation::AddSigned:
+            result = V::Min(V::SubSat(V::Add(a, b), V::Set(128)), c255);
+            break;
+        case Operation::Lerp:
+            result = V::Div255(V::Add(V::Mul(a, c), V::Mul(b, V::SubSat(c255, c))));
+            break;
+        case Operation::Subtract:
+            result = V::SubSat(a, b);
+            break;
+        case Operation::MultiplyThenAdd:
+            // (a * b + 255 * c) / 255 == a * b / 255 + c, which keeps the sum within 16 bits
+            result = V::Min(V::Add(V::Div255(V::Mul(a, b)), c), c255);
+            break;
+        case Operation::AddThenMultiply:
+            result = V::Div255(V::Mul(V::Min(V::Add(a, b), c255), c));
+            break;
+        default:
+            UNREACHABLE();
+            return;
+        }
+
+        V::Store(out + i, V::Min(V::ShiftLeft(result, shift), c255));
+    }
+}
+
+template <typename V>
+void Blend(FramebufferRegs::BlendEquation equation, const u8* src, const u8* src_factor,
+           const u8* dest, const u8* dest_factor, u8* out) {
+    using BlendEquation = FramebufferRegs::BlendEquation;
+    static_assert(SPAN_SIZE % V::LANES == 0);
+
+    const auto c255 = V::Set(255);
+    for (std::size_t i = 0; i < SPAN_SIZE; i += V::LANES) {
+        const auto s = V::Load(src + i);
+        const auto d = V::Load(dest + i);
+
+        typename V::Reg result;
+        switch (equation) {
+        case BlendEquation::Add: {
+            // Saturating at 65535 is harmless since any sum >= 255 * 256 gets clamped to 255
+            const auto sum = V::AddSat(V::Mul(s, V::Load(src_factor + i)),
+                                       V::Mul(d, V::Load(dest_factor + i)));
+            result = V::Min(V::Div255(sum), c255);
+            break;
+        }
+        case BlendEquation::Subtract:
+            // Negative differences truncate towards zero and then clamp to 0
+            result = V::Div255(V::SubSat(V::Mul(s, V::Load(src_factor + i)),
+                                         V::Mul(d, V::Load(dest_factor + i))));
+            break;
+        case BlendEquation::ReverseSubtract:
+            result = V::Div255(V::SubSat(V::Mul(d, V::Load(dest_factor + i)),
+                                         V::Mul(s, V::Load(src_factor + i))));
+            break;
+        case BlendEquation::Min:
+            result = V::Min(s, d);
+            break;
+        case BlendEquation::Max:
+            result = V::Max(s, d);
+            break;
+        default:
+            UNREACHABLE();
+            return;
+        }
+
+        V::Store(out + i, result);
+    }
+}
+
+template <typename V>
+constexpr SpanKernels MakeSpanKernels() {
+    return {&Combine<V>, &Blend<V>};
+}
+
+} // namespace Pica::Rasterizer::SpanImpl
@@ -0,0 +1,64 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is compiled with SSE4.1 code generation enabled. Nothing in it may be called before
+// checking Common::GetCPUCaps().sse4_1.
+
+#include <smmintrin.h>
+#include "video_core/swrasterizer/span.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+namespace Pica::Rasterizer {
+
+namespace {
+
+struct SSE41Vector {
+    using Reg = __m128i;
+    static constexpr std::size_t LANES = 8;
+
+    static Reg Load(const u8* p) {
+        return _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+    static void Store(u8* p, Reg v) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(v, v));
+    }
+    static Reg Set(u16 v) {
+        return _mm_set1_epi16(static_cast<short>(v));
+    }
+    static Reg Add(Reg a, Reg b) {
+        return _mm_add_epi16(a, b);
+    }
+    static Reg AddSat(Reg a, Reg b) {
+        return _mm_adds_epu16(a, b);
+    }
+    static Reg SubSat(Reg a, Reg b) {
+        return _mm_subs_epu16(a, b);
+    }
+    static Reg Mul(Reg a, Reg b) {
+        return _mm_mullo_epi16(a, b);
+    }
+    static Reg Min(Reg a, Reg b) {
+        return _mm_min_epu16(a, b);
+    }
+    static Reg Max(Reg a, Reg b) {
+        return _mm_max_epu16(a, b);
+    }
+    static Reg Div255(Reg a) {
+        // floor(x / 255) == (x * 0x8081) >> 23 for every 16-bit x
+        return _mm_srli_epi16(_mm_mulhi_epu16(a, Set(0x8081)), 7);
+    }
+    static Reg ShiftLeft(Reg a, unsigned shift) {
+        return _mm_sll_epi16(a, _mm_cvtsi32_si128(static_cast<int>(shift)));
+    }
+};
+
+constexpr SpanKernels sse41_kernels = SpanImpl::MakeSpanKernels<SSE41Vector>();
+
+} // Anonymous namespace
+
+const SpanKernels& GetSSE41SpanKernels() {
+    return sse41_kernels;
+}
+
+} // namespace Pica::Rasterizer
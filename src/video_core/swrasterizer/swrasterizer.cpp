@@ -2,15 +2,50 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <thread>
+#include "core/settings.h"
+#include "video_core/swrasterizer/binner.h"
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/swrasterizer/tile_cache.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    unsigned num_threads = Settings::values.sw_rasterizer_threads;
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    Pica::Rasterizer::InitBinning(num_threads);
+}
+
+SWRasterizer::~SWRasterizer() {
+    Pica::Rasterizer::ShutdownBinning();
+}
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::DrawTriangles() {
+    Pica::Rasterizer::FlushBinnedTriangles();
+    // Decoded texture tiles are only reused within a draw, since the CPU and the other GPU
+    // engines may write to texture memory in between.
+    Pica::Rasterizer::InvalidateTileCache();
+}
+
+void SWRasterizer::FlushAll() {
+    Pica::Rasterizer::FlushBinnedTriangles();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::FlushBinnedTriangles();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::FlushBinnedTriangles();
+}
+
 } // namespace VideoCore
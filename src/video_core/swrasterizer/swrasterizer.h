@@ -14,14 +14,18 @@ struct OutputVertex;
 namespace VideoCore {
 
 class SWRasterizer : public RasterizerInterface {
+public:
+    SWRasterizer();
+    ~SWRasterizer() override;
+
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
-    void DrawTriangles() override {}
+    void DrawTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
 };
 
 } // namespace VideoCore
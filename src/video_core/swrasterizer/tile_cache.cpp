@@ -0,0 +1,76 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "common/common_types.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/swrasterizer/tile_cache.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Pica::Rasterizer {
+
+namespace {
+
+/// Number of decoded tiles kept per thread. Must be a power of two.
+constexpr std::size_t NUM_CACHED_TILES = 64;
+
+struct CachedTile {
+    const u8* source = nullptr;
+    TexturingRegs::TextureFormat format{};
+    Texture::DecodedTile texels;
+};
+
+/// Direct-mapped cache. Every rasterizer thread owns one, so lookups need no locking.
+struct TileCache {
+    u64 generation = 0;
+    std::array<CachedTile, NUM_CACHED_TILES> tiles;
+};
+
+/// Bumped on every invalidation. Thread caches compare it with their own value before a lookup.
+std::atomic<u64> cache_generation{1};
+
+thread_local TileCache tile_cache;
+
+std::size_t GetCacheIndex(const u8* tile) {
+    // Tiles are at least 32 bytes apart, so drop the low bits before hashing
+    const u32 key = static_cast<u32>(reinterpret_cast<std::uintptr_t>(tile) >> 5);
+    return (key * 0x9E3779B1u) >> (32 - 6);
+}
+
+static_assert(NUM_CACHED_TILES == 1 << 6, "GetCacheIndex produces 6-bit indices");
+
+} // Anonymous namespace
+
+Common::Vec4<u8> LookupCachedTexel(const u8* source, unsigned int x, unsigned int y,
+                                   const Texture::TextureInfo& info) {
+    TileCache& cache = tile_cache;
+
+    const u64 generation = cache_generation.load(std::memory_order_relaxed);
+    if (cache.generation != generation) {
+        for (auto& tile : cache.tiles) {
+            tile.source = nullptr;
+        }
+        cache.generation = generation;
+    }
+
+    const u8* tile_source =
+        source + (y / 8) * info.stride + (x / 8) * Texture::CalculateTileSize(info.format);
+
+    CachedTile& tile = cache.tiles[GetCacheIndex(tile_source)];
+    if (tile.source != tile_source || tile.format != info.format) {
+        Texture::DecodeTile(tile_source, info, tile.texels);
+        tile.source = tile_source;
+        tile.format = info.format;
+    }
+
+    return tile.texels[(y % 8) * 8 + x % 8];
+}
+
+void InvalidateTileCache() {
+    cache_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,27 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "common/vector_math.h"
+
+namespace Pica::Texture {
+struct TextureInfo;
+} // namespace Pica::Texture
+
+namespace Pica::Rasterizer {
+
+/**
+ * Looks up a texel through a small per-thread cache of decoded 8x8 tiles, keyed by the tile
+ * address and the texture format. On a miss, the whole tile containing the texel is decoded.
+ * Returns the same color as Texture::LookupTexture.
+ */
+Common::Vec4<u8> LookupCachedTexel(const u8* source, unsigned int x, unsigned int y,
+                                   const Texture::TextureInfo& info);
+
+/// Drops the cached tiles of all threads. Must be called whenever texture memory may have changed.
+void InvalidateTileCache();
+
+} // namespace Pica::Rasterizer
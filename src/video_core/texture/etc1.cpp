@@ -10,6 +10,10 @@
 #include "common/vector_math.h"
 #include "video_core/texture/etc1.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace Pica::Texture {
 
 namespace {
@@ -69,19 +73,14 @@ union ETC1Tile {
         BitField<60, 4, u64> r1;
     } separate;
 
-    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
-        int texel = 4 * x + y;
-
-        if (flip)
-            std::swap(x, y);
-
-        // Lookup base value
+    /// Returns the base color of the left (half 0) or right (half 1) half of the unflipped subtile
+    Common::Vec3<int> GetBaseColor(unsigned half) const {
         Common::Vec3<int> ret;
         if (differential_mode) {
             ret.r() = static_cast<int>(differential.r);
             ret.g() = static_cast<int>(differential.g);
             ret.b() = static_cast<int>(differential.b);
-            if (x >= 2) {
+            if (half != 0) {
                 ret.r() += static_cast<int>(differential.dr);
                 ret.g() += static_cast<int>(differential.dg);
                 ret.b() += static_cast<int>(differential.db);
@@ -90,7 +89,7 @@ union ETC1Tile {
             ret.g() = Color::Convert5To8(ret.g());
             ret.b() = Color::Convert5To8(ret.b());
         } else {
-            if (x < 2) {
+            if (half == 0) {
                 ret.r() = Color::Convert4To8(static_cast<u8>(separate.r1));
                 ret.g() = Color::Convert4To8(static_cast<u8>(separate.g1));
                 ret.b() = Color::Convert4To8(static_cast<u8>(separate.b1));
@@ -100,21 +99,138 @@ union ETC1Tile {
                 ret.b() = Color::Convert4To8(static_cast<u8>(separate.b2));
             }
         }
+        return ret;
+    }
 
-        // Add modifier
+    /// Returns the signed intensity modifier of the given texel (x * 4 + y) in the given half
+    int GetModifier(unsigned half, unsigned texel) const {
         unsigned table_index =
-            static_cast<int>((x < 2) ? table_index_1.Value() : table_index_2.Value());
+            static_cast<int>((half == 0) ? table_index_1.Value() : table_index_2.Value());
 
         int modifier = etc1_modifier_table[table_index][GetTableSubIndex(texel)];
         if (GetNegationFlag(texel))
             modifier *= -1;
+        return modifier;
+    }
 
-        ret.r() = std::clamp(ret.r() + modifier, 0, 255);
-        ret.g() = std::clamp(ret.g() + modifier, 0, 255);
-        ret.b() = std::clamp(ret.b() + modifier, 0, 255);
+    static Common::Vec3<u8> ApplyModifier(const Common::Vec3<int>& base, int modifier) {
+        return Common::MakeVec(std::clamp(base.r() + modifier, 0, 255),
+                               std::clamp(base.g() + modifier, 0, 255),
+                               std::clamp(base.b() + modifier, 0, 255))
+            .Cast<u8>();
+    }
 
-        return ret.Cast<u8>();
+    const Common::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
+        int texel = 4 * x + y;
+
+        if (flip)
+            std::swap(x, y);
+
+        const unsigned half = (x < 2) ? 0 : 1;
+        return ApplyModifier(GetBaseColor(half), GetModifier(half, texel));
+    }
+
+    void Decode(u64 alpha, Common::Vec4<u8>* output, std::size_t stride) const {
+        // Both base colors are only computed once for the whole subtile
+        const std::array<Common::Vec3<int>, 2> base{{GetBaseColor(0), GetBaseColor(1)}};
+
+        for (unsigned y = 0; y < 4; ++y) {
+            for (unsigned x = 0; x < 4; ++x) {
+                const unsigned texel = 4 * x + y;
+                const unsigned half = ((flip ? y : x) < 2) ? 0 : 1;
+                const u8 a = Color::Convert4To8((alpha >> (4 * texel)) & 0xF);
+                output[y * stride + x] =
+                    Common::MakeVec(ApplyModifier(base[half], GetModifier(half, texel)), a);
+            }
+        }
+    }
+
+#ifdef ARCHITECTURE_x86_64
+    /**
+     * SSE2 version of Decode. The texels are processed in bitstream order (x * 4 + y) with one
+     * 16-bit lane per texel, so that the lookup flags can be tested with a single mask per lane.
+     * The resulting columns are transposed to rows at the end.
+     */
+    void DecodeSSE2(u64 alpha, Common::Vec4<u8>* output, std::size_t stride) const {
+        const std::array<Common::Vec3<int>, 2> base{{GetBaseColor(0), GetBaseColor(1)}};
+        const auto& table1 = etc1_modifier_table[table_index_1];
+        const auto& table2 = etc1_modifier_table[table_index_2];
+
+        // Builds a register holding value1 for the texels of the first half and value2 for the
+        // texels of the second one. The first register holds the columns x = 0, 1, the second
+        // one the columns x = 2, 3.
+        const auto PerHalf = [this](int value1, int value2, bool second_register) {
+            const auto v1 = static_cast<short>(value1);
+            const auto v2 = static_cast<short>(value2);
+            if (flip) {
+                // Halves are split along y, which is the fastest changing texel coordinate
+                return _mm_setr_epi16(v1, v1, v2, v2, v1, v1, v2, v2);
+            }
+            return second_register ? _mm_set1_epi16(v2) : _mm_set1_epi16(v1);
+        };
+
+        const __m128i subindexes = _mm_set1_epi16(static_cast<short>(table_subindexes.Value()));
+        const __m128i negations = _mm_set1_epi16(static_cast<short>(negation_flags.Value()));
+
+        __m128i channels[3][2];
+        for (std::size_t half = 0; half < 2; ++half) {
+            const __m128i texel_bits =
+                half == 0 ? _mm_setr_epi16(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80)
+                          : _mm_setr_epi16(0x100, 0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000,
+                                           static_cast<short>(0x8000));
+            const __m128i use_large =
+                _mm_cmpeq_epi16(_mm_and_si128(subindexes, texel_bits), texel_bits);
+            const __m128i negate = _mm_cmpeq_epi16(_mm_and_si128(negations, texel_bits), texel_bits);
+
+            const __m128i small = PerHalf(table1[0], table2[0], half != 0);
+            const __m128i large = PerHalf(table1[1], table2[1], half != 0);
+            __m128i modifier =
+                _mm_or_si128(_mm_and_si128(use_large, large), _mm_andnot_si128(use_large, small));
+            // Two's complement negation of the lanes where negate is all ones
+            modifier = _mm_sub_epi16(_mm_xor_si128(modifier, negate), negate);
+
+            for (std::size_t c = 0; c < 3; ++c) {
+                channels[c][half] =
+                    _mm_add_epi16(PerHalf(base[0][c], base[1][c], half != 0), modifier);
+            }
+        }
+
+        // Saturating packs clamp the results to [0, 255]
+        const __m128i r = _mm_packus_epi16(channels[0][0], channels[0][1]);
+        const __m128i g = _mm_packus_epi16(channels[1][0], channels[1][1]);
+        const __m128i b = _mm_packus_epi16(channels[2][0], channels[2][1]);
+
+        // Each byte of alpha holds the nibbles of two consecutive texels
+        const __m128i packed_alpha = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&alpha));
+        const __m128i nibble_mask = _mm_set1_epi8(0xF);
+        const __m128i nibbles =
+            _mm_unpacklo_epi8(_mm_and_si128(packed_alpha, nibble_mask),
+                              _mm_and_si128(_mm_srli_epi16(packed_alpha, 4), nibble_mask));
+        const __m128i a = _mm_or_si128(nibbles, _mm_slli_epi16(nibbles, 4));
+
+        const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+        const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+        const __m128i ba_lo = _mm_unpacklo_epi8(b, a);
+        const __m128i ba_hi = _mm_unpackhi_epi8(b, a);
+        const __m128i column0 = _mm_unpacklo_epi16(rg_lo, ba_lo);
+        const __m128i column1 = _mm_unpackhi_epi16(rg_lo, ba_lo);
+        const __m128i column2 = _mm_unpacklo_epi16(rg_hi, ba_hi);
+        const __m128i column3 = _mm_unpackhi_epi16(rg_hi, ba_hi);
+
+        const __m128i t0 = _mm_unpacklo_epi32(column0, column1);
+        const __m128i t1 = _mm_unpacklo_epi32(column2, column3);
+        const __m128i t2 = _mm_unpackhi_epi32(column0, column1);
+        const __m128i t3 = _mm_unpackhi_epi32(column2, column3);
+
+        const auto StoreRow = [output, stride](std::size_t y, __m128i row) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + y * stride), row);
+        };
+        StoreRow(0, _mm_unpacklo_epi64(t0, t1));
+        StoreRow(1, _mm_unpackhi_epi64(t0, t1));
+        StoreRow(2, _mm_unpacklo_epi64(t2, t3));
+        StoreRow(3, _mm_unpackhi_epi64(t2, t3));
     }
+#endif
 };
 
 } // anonymous namespace
@@ -124,4 +240,13 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Block(u64 value, u64 alpha, Common::Vec4<u8>* output, std::size_t stride) {
+    ETC1Tile tile{value};
+#ifdef ARCHITECTURE_x86_64
+    tile.DecodeSSE2(alpha, output, stride);
+#else
+    tile.Decode(alpha, output, stride);
+#endif
+}
+
 } // namespace Pica::Texture
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
@@ -11,4 +12,13 @@ namespace Pica::Texture {
 
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all texels of a 4x4 subtile at once.
+ * @param value Color data of the subtile
+ * @param alpha 4-bit alpha of each texel as stored in ETC1A4 subtiles. Pass ~0 for opaque texels.
+ * @param output Receives the texel (x, y) at output[y * stride + x]
+ * @param stride Distance between two rows of output in texels
+ */
+void DecodeETC1Block(u64 value, u64 alpha, Common::Vec4<u8>* output, std::size_t stride);
+
 } // namespace Pica::Texture
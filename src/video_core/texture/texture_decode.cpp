@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -13,6 +16,10 @@
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 using TextureFormat = Pica::TexturingRegs::TextureFormat;
 
 namespace Pica::Texture {
@@ -211,6 +218,321 @@ Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned in
     }
 }
 
+namespace {
+
+/// Linear index (y * 8 + x) of the first texel of each 2x2 quad, in morton order. The other three
+/// texels of a quad follow at +1, +8 and +9.
+constexpr std::array<u8, TILE_SIZE / 4> quad_offsets = [] {
+    std::array<u8, TILE_SIZE / 4> offsets{};
+    for (u32 y = 0; y < 8; y += 2) {
+        for (u32 x = 0; x < 8; x += 2) {
+            offsets[VideoCore::MortonInterleave(x, y) / 4] = static_cast<u8>(y * 8 + x);
+        }
+    }
+    return offsets;
+}();
+
+/// Calls decode with the morton index of every texel and stores the results in linear order
+template <typename Decode>
+void DecodeTexels(DecodedTile& output, Decode&& decode) {
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        const std::size_t offset = quad_offsets[i / 4] + (i & 1) + (i & 2) * 4;
+        output[offset] = decode(i);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+// SSE2 is part of the x86_64 baseline, so these kernels need no CPU feature check. Each register
+// holds the four RGBA8 texels of one 2x2 quad, with red in the lowest byte.
+
+void StoreQuad(DecodedTile& output, std::size_t quad, __m128i texels) {
+    u8* dest = reinterpret_cast<u8*>(output.data() + quad_offsets[quad]);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), texels);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 8 * sizeof(Common::Vec4<u8>)),
+                     _mm_unpackhi_epi64(texels, texels));
+}
+
+/// Loads four 16-bit texels into the low halves of the 32-bit lanes
+__m128i LoadQuad16(const u8* source, std::size_t quad) {
+    const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + quad * 8));
+    return _mm_unpacklo_epi16(packed, _mm_setzero_si128());
+}
+
+/// Loads four 8-bit texels into the lowest bytes of the 32-bit lanes
+__m128i LoadQuad8(const u8* source, std::size_t quad) {
+    u32 packed;
+    std::memcpy(&packed, source + quad * 4, sizeof(packed));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+}
+
+/// Replicates a value in the lowest byte of each lane to the three lowest bytes
+__m128i Replicate3(__m128i value) {
+    return _mm_or_si128(_mm_or_si128(value, _mm_slli_epi32(value, 8)), _mm_slli_epi32(value, 16));
+}
+
+bool DecodeTileSSE2(const u8* source, TextureFormat format, DecodedTile& output,
+                    bool disable_alpha) {
+    const __m128i opaque = _mm_set1_epi32(0xFF000000);
+    const __m128i mask4 = _mm_set1_epi32(0xF);
+    const __m128i mask5 = _mm_set1_epi32(0x1F);
+    const __m128i mask6 = _mm_set1_epi32(0x3F);
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+
+    // Convert4To8 for a value in the lowest bits of each lane
+    const auto Expand4 = [](__m128i v) { return _mm_or_si128(_mm_slli_epi32(v, 4), v); };
+    const auto Expand5 = [](__m128i v) {
+        return _mm_or_si128(_mm_slli_epi32(v, 3), _mm_srli_epi32(v, 2));
+    };
+    const auto Expand6 = [](__m128i v) {
+        return _mm_or_si128(_mm_slli_epi32(v, 2), _mm_srli_epi32(v, 4));
+    };
+
+    switch (format) {
+    case TextureFormat::RGBA8: {
+        // Stored as ABGR in memory, so each texel is byte swapped
+        const __m128i alpha_mask = disable_alpha ? opaque : _mm_setzero_si128();
+        for (std::size_t quad = 0; quad < TILE_SIZE / 4; ++quad) {
+            const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + quad * 16));
+            const __m128i outer = _mm_or_si128(_mm_slli_epi32(v, 24), _mm_srli_epi32(v, 24));
+            const __m128i inner =
+                _mm_or_si128(_mm_and_si128(_mm_slli_epi32(v, 8), _mm_set1_epi32(0xFF0000)),
+                             _mm_and_si128(_mm_srli_epi32(v, 8), _mm_set1_epi32(0xFF00)));
+            StoreQuad(output, quad, _mm_or_si128(_mm_or_si128(outer, inner), alpha_mask));
+        }
+        return true;
+    }
+
+    case TextureFormat::RGB565:
+        for (std::size_t quad = 0; quad < TILE_SIZE / 4; ++quad) {
+            const __m128i v = LoadQuad16(source, quad);
+            const __m128i r = Expand5(_mm_srli_epi32(v, 11));
+            const __m128i g = Expand6(_mm_and_si128(_mm_srli_epi32(v, 5), mask6));
+            const __m128i b = Expand5(_mm_and_si128(v, mask5));
+            const __m128i rg = _mm_or_si128(r, _mm_slli_epi32(g, 8));
+            const __m128i ba = _mm_or_si128(_mm_slli_epi32(b, 16), opaque);
+            StoreQuad(output, quad, _mm_or_si128(rg, ba));
+        }
+        return true;
+
+    case TextureFormat::RGBA4: {
+        const __m128i alpha_mask = disable_alpha ? opaque : _mm_setzero_si128();
+        for (std::size_t quad = 0; quad < TILE_SIZE / 4; ++quad) {
+            const __m128i v = LoadQuad16(source, quad);
+            const __m128i r = Expand4(_mm_srli_epi32(v, 12));
+            const __m128i g = Expand4(_mm_and_si128(_mm_srli_epi32(v, 8), mask4));
+            const __m128i b = Expand4(_mm_and_si128(_mm_srli_epi32(v, 4), mask4));
+            const __m128i a = Expand4(_mm_and_si128(v, mask4));
+            const __m128i rg = _mm_or_si128(r, _mm_slli_epi32(g, 8));
+            const __m128i ba = _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24));
+            StoreQuad(output, quad, _mm_or_si128(_mm_or_si128(rg, ba), alpha_mask));
+        }
+        return true;
+    }
+
+    case TextureFormat::IA8:
+        for (std::size_t quad = 0; quad < TILE_SIZE / 4; ++quad) {
+            // Alpha is stored in the first byte and intensity in the second one
+            const __m128i v = LoadQuad16(source, quad);
+            const __m128i i = _mm_srli_epi32(v, 8);
+            const __m128i a = _mm_and_si128(v, mask8);
+            if (disable_alpha) {
+                // Show intensity as red, alpha as green
+                StoreQuad(output, quad,
+                          _mm_or_si128(_mm_or_si128(i, _mm_slli_epi32(a, 8)), opaque));
+            } else {
+                StoreQuad(output, quad, _mm_or_si128(Replicate3(i), _mm_slli_epi32(a, 24)));
+            }
+        }
+        return true;
+
+    case TextureFormat::I8:
+        for (std::size_t quad = 0; quad < TILE_SIZE / 4; ++quad) {
+            StoreQuad(output, quad, _mm_or_si128(Replicate3(LoadQuad8(source, quad)), opaque));
+        }
+        return true;
+
+    case TextureFormat::A8:
+        for (std::size_t quad = 0; quad < TILE_SIZE / 4; ++quad) {
+            const __m128i v = LoadQuad8(source, quad);
+            if (disable_alpha) {
+                StoreQuad(output, quad, _mm_or_si128(Replicate3(v), opaque));
+            } else {
+                StoreQuad(output, quad, _mm_slli_epi32(v, 24));
+            }
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+#endif
+
+void DecodeETC1Tile(const u8* source, bool has_alpha, DecodedTile& output, bool disable_alpha) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+
+    // ETC1 further subdivides each 8x8 tile into four 4x4 subtiles
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+        const unsigned int subtile_x = (subtile_index % 2) * 4;
+        const unsigned int subtile_y = (subtile_index / 2) * 4;
+
+        u64_le packed_alpha = ~u64{0};
+        if (has_alpha) {
+            if (!disable_alpha) {
+                memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            }
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Block(subtile_data, packed_alpha, &output[subtile_y * 8 + subtile_x], 8);
+    }
+}
+
+} // Anonymous namespace
+
+void DecodeTile(const u8* source, const TextureInfo& info, DecodedTile& output,
+                bool disable_alpha) {
+#ifdef ARCHITECTURE_x86_64
+    if (DecodeTileSSE2(source, info.format, output, disable_alpha))
+        return;
+#endif
+
+    switch (info.format) {
+    case TextureFormat::RGBA8:
+        DecodeTexels(output, [&](std::size_t i) {
+            auto res = Color::DecodeRGBA8(source + i * 4);
+            return Common::Vec4<u8>{res.r(), res.g(), res.b(),
+                                    static_cast<u8>(disable_alpha ? 255 : res.a())};
+        });
+        break;
+
+    case TextureFormat::RGB8:
+        DecodeTexels(output, [&](std::size_t i) { return Color::DecodeRGB8(source + i * 3); });
+        break;
+
+    case TextureFormat::RGB5A1:
+        DecodeTexels(output, [&](std::size_t i) {
+            auto res = Color::DecodeRGB5A1(source + i * 2);
+            return Common::Vec4<u8>{res.r(), res.g(), res.b(),
+                                    static_cast<u8>(disable_alpha ? 255 : res.a())};
+        });
+        break;
+
+    case TextureFormat::RGB565:
+        DecodeTexels(output, [&](std::size_t i) { return Color::DecodeRGB565(source + i * 2); });
+        break;
+
+    case TextureFormat::RGBA4:
+        DecodeTexels(output, [&](std::size_t i) {
+            auto res = Color::DecodeRGBA4(source + i * 2);
+            return Common::Vec4<u8>{res.r(), res.g(), res.b(),
+                                    static_cast<u8>(disable_alpha ? 255 : res.a())};
+        });
+        break;
+
+    case TextureFormat::IA8:
+        DecodeTexels(output, [&](std::size_t i) {
+            const u8* source_ptr = source + i * 2;
+            if (disable_alpha) {
+                // Show intensity as red, alpha as green
+                return Common::Vec4<u8>{source_ptr[1], source_ptr[0], 0, 255};
+            }
+            return Common::Vec4<u8>{source_ptr[1], source_ptr[1], source_ptr[1], source_ptr[0]};
+        });
+        break;
+
+    case TextureFormat::RG8:
+        DecodeTexels(output, [&](std::size_t i) { return Color::DecodeRG8(source + i * 2); });
+        break;
+
+    case TextureFormat::I8:
+        DecodeTexels(output, [&](std::size_t i) {
+            return Common::Vec4<u8>{source[i], source[i], source[i], 255};
+        });
+        break;
+
+    case TextureFormat::A8:
+        DecodeTexels(output, [&](std::size_t i) {
+            if (disable_alpha) {
+                return Common::Vec4<u8>{source[i], source[i], source[i], 255};
+            }
+            return Common::Vec4<u8>{0, 0, 0, source[i]};
+        });
+        break;
+
+    case TextureFormat::IA4:
+        DecodeTexels(output, [&](std::size_t i) {
+            u8 intensity = Color::Convert4To8((source[i] & 0xF0) >> 4);
+            u8 alpha = Color::Convert4To8(source[i] & 0xF);
+            if (disable_alpha) {
+                // Show intensity as red, alpha as green
+                return Common::Vec4<u8>{intensity, alpha, 0, 255};
+            }
+            return Common::Vec4<u8>{intensity, intensity, intensity, alpha};
+        });
+        break;
+
+    case TextureFormat::I4:
+        DecodeTexels(output, [&](std::size_t i) {
+            u8 intensity = (i % 2) ? ((source[i / 2] & 0xF0) >> 4) : (source[i / 2] & 0xF);
+            intensity = Color::Convert4To8(intensity);
+            return Common::Vec4<u8>{intensity, intensity, intensity, 255};
+        });
+        break;
+
+    case TextureFormat::A4:
+        DecodeTexels(output, [&](std::size_t i) {
+            u8 alpha = (i % 2) ? ((source[i / 2] & 0xF0) >> 4) : (source[i / 2] & 0xF);
+            alpha = Color::Convert4To8(alpha);
+            if (disable_alpha) {
+                return Common::Vec4<u8>{alpha, alpha, alpha, 255};
+            }
+            return Common::Vec4<u8>{0, 0, 0, alpha};
+        });
+        break;
+
+    case TextureFormat::ETC1:
+    case TextureFormat::ETC1A4:
+        DecodeETC1Tile(source, info.format == TextureFormat::ETC1A4, output, disable_alpha);
+        break;
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown texture format: {:x}", (u32)info.format);
+        DEBUG_ASSERT(false);
+        output.fill({});
+        break;
+    }
+}
+
+void DecodeTexture(const u8* source, const TextureInfo& info, Common::Vec4<u8>* output,
+                   bool disable_alpha) {
+    const std::size_t tile_size = CalculateTileSize(info.format);
+    DecodedTile tile;
+
+    for (unsigned int coarse_y = 0; coarse_y * 8 < info.height; ++coarse_y) {
+        const u8* line = source + coarse_y * info.stride;
+        const unsigned int rows = std::min(8u, info.height - coarse_y * 8);
+
+        for (unsigned int coarse_x = 0; coarse_x * 8 < info.width; ++coarse_x) {
+            DecodeTile(line + coarse_x * tile_size, info, tile, disable_alpha);
+
+            const unsigned int columns = std::min(8u, info.width - coarse_x * 8);
+            for (unsigned int fine_y = 0; fine_y < rows; ++fine_y) {
+                Common::Vec4<u8>* dest =
+                    output + (coarse_y * 8 + fine_y) * info.width + coarse_x * 8;
+                std::copy_n(tile.begin() + fine_y * 8, columns, dest);
+            }
+        }
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
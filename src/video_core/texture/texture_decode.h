@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
@@ -55,4 +56,31 @@ Common::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                    const TextureInfo& info, bool disable_alpha);
 
+/// Texels of a decoded 8x8 tile, indexed by y * 8 + x using the in-tile coordinates
+using DecodedTile = std::array<Common::Vec4<u8>, 8 * 8>;
+
+/**
+ * Decodes all texels of a single 8x8 texture tile. Produces the same colors as calling
+ * LookupTexelInTile for every texel, but resolves the format and the morton order only once.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param info TextureInfo describing the texture format.
+ * @param output Decoded texels.
+ * @param disable_alpha See LookupTexelInTile.
+ */
+void DecodeTile(const u8* source, const TextureInfo& info, DecodedTile& output,
+                bool disable_alpha = false);
+
+/**
+ * Decodes a whole texture to linear RGBA8.
+ *
+ * @param source Source pointer to read data from
+ * @param info TextureInfo object describing the texture setup
+ * @param output Buffer of info.width * info.height texels, indexed by y * info.width + x using the
+ *               coordinates of LookupTexture.
+ * @param disable_alpha See LookupTexture.
+ */
+void DecodeTexture(const u8* source, const TextureInfo& info, Common::Vec4<u8>* output,
+                   bool disable_alpha = false);
+
 } // namespace Pica::Texture
@@ -0,0 +1,56 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Pica {
+
+/**
+ * Direct-mapped cache of processed vertices keyed by their index in the vertex arrays. Indices of
+ * a mesh are usually close to each other, so the low bits select a slot with few conflicts.
+ * Entries are tagged with a generation number, which makes invalidating the whole cache between
+ * draws free.
+ */
+template <typename VertexType, std::size_t Size>
+class VertexCache {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+public:
+    /// Invalidates all entries
+    void Clear() {
+        if (++generation == 0) {
+            // The generation wrapped around, so old tags could match again
+            tags.fill(0);
+            generation = 1;
+        }
+    }
+
+    /// Returns the cached vertex for the index, or nullptr if it is not cached
+    const VertexType* Lookup(u32 index) const {
+        const std::size_t slot = index & (Size - 1);
+        return tags[slot] == MakeTag(index) ? &entries[slot] : nullptr;
+    }
+
+    /// Returns the entry that caches the vertex for the index, replacing the previous one
+    VertexType& Insert(u32 index) {
+        const std::size_t slot = index & (Size - 1);
+        tags[slot] = MakeTag(index);
+        return entries[slot];
+    }
+
+private:
+    u64 MakeTag(u32 index) const {
+        return (static_cast<u64>(generation) << 32) | index;
+    }
+
+    std::array<u64, Size> tags{};
+    std::array<VertexType, Size> entries;
+    u32 generation = 1;
+};
+
+} // namespace Pica
@@ -14,18 +14,22 @@
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif
+
 namespace Pica {
 
 void VertexLoader::Setup(const PipelineRegs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
     const auto& attribute_config = regs.vertex_attributes;
-    num_total_attributes = attribute_config.GetNumTotalAttributes();
+    layout.num_total_attributes = attribute_config.GetNumTotalAttributes();
 
-    vertex_attribute_sources.fill(0xdeadbeef);
+    layout.sources.fill(0xdeadbeef);
 
     for (int i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
+        layout.is_default[i] = attribute_config.IsDefaultAttribute(i);
     }
 
     // Setup attribute data from loaders
@@ -47,12 +51,12 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
             if (attribute_index < 12) {
                 offset = Common::AlignUp(offset,
                                          attribute_config.GetElementSizeInBytes(attribute_index));
-                vertex_attribute_sources[attribute_index] = loader_config.data_offset + offset;
-                vertex_attribute_strides[attribute_index] =
+                layout.sources[attribute_index] = loader_config.data_offset + offset;
+                layout.strides[attribute_index] =
                     static_cast<u32>(loader_config.byte_count);
-                vertex_attribute_formats[attribute_index] =
+                layout.formats[attribute_index] =
                     attribute_config.GetFormat(attribute_index);
-                vertex_attribute_elements[attribute_index] =
+                layout.elements[attribute_index] =
                     attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
             } else if (attribute_index < 16) {
@@ -67,9 +71,38 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
         }
     }
 
+#ifdef ARCHITECTURE_x86_64
+    jit = &GetVertexLoaderJit(layout);
+#endif
+
     is_setup = true;
 }
 
+const std::array<const u8*, 16>& VertexLoader::GetSourcePointers(u32 base_address) {
+    if (!source_pointers_valid || source_pointers_base != base_address) {
+        for (int i = 0; i < layout.num_total_attributes; ++i) {
+            if (layout.elements[i] != 0) {
+                source_pointers[i] =
+                    VideoCore::Memory()->GetPhysicalPointer(base_address + layout.sources[i]);
+            }
+        }
+        source_pointers_base = base_address;
+        source_pointers_valid = true;
+    }
+    return source_pointers;
+}
+
+bool VertexLoader::UseJit() const {
+    if (jit == nullptr)
+        return false;
+#ifdef DEBUG_CONTEXT
+    // The compiled loader does not report its memory accesses
+    if (g_debug_context && g_debug_context->recorder)
+        return false;
+#endif
+    return true;
+}
+
 using CopyHandler = void (*)(int, int, Shader::AttributeBuffer&, u32);
 
 static void CopyBYTE(int i, int size, Shader::AttributeBuffer& input, u32 source_addr) {
@@ -109,33 +142,39 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
                               DebugUtils::MemoryAccessTracker& memory_accesses) {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
+#ifdef ARCHITECTURE_x86_64
+    if (UseJit()) {
+        const u32 vertex_index = static_cast<u32>(vertex);
+        jit->Load(GetSourcePointers(base_address).data(), &vertex_index, 1, &input);
+        return;
+    }
+#endif
+
     CopyHandler handlers[4] = {&CopyBYTE, &CopyUBYTE, &CopySHORT, &CopyFLOAT};
 
-    for (int i = 0; i < num_total_attributes; ++i) {
-        if (vertex_attribute_elements[i] != 0) {
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.elements[i] != 0) {
             // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+            u32 source_addr = base_address + layout.sources[i] + layout.strides[i] * vertex;
 #ifdef DEBUG_CONTEXT
             if (g_debug_context && Pica::g_debug_context->recorder) {
                 memory_accesses.AddAccess(
                     source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
+                    layout.elements[i] *
+                        ((layout.formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
                              ? 4
-                             : (vertex_attribute_formats[i] ==
-                                PipelineRegs::VertexAttributeFormat::SHORT)
+                             : (layout.formats[i] == PipelineRegs::VertexAttributeFormat::SHORT)
                                    ? 2
                                    : 1));
             }
 #endif
-            handlers[static_cast<int>(vertex_attribute_formats[i])](i, vertex_attribute_elements[i],
-                                                                    input, source_addr);
+            handlers[static_cast<int>(layout.formats[i])](i, layout.elements[i], input,
+                                                          source_addr);
 
             // Default attribute values set if array elements have < 4 components. This
             // is *not* carried over from the default attribute settings even if they're
             // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
+            for (unsigned int comp = layout.elements[i]; comp < 4; ++comp) {
                 input.attr[i][comp] =
                     comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
             }
@@ -143,11 +182,11 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             LOG_TRACE(HW_GPU,
                       "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
                       "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
-                      input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                      input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else if (vertex_attribute_is_default[i]) {
+                      layout.elements[i], i, vertex, index, base_address, layout.sources[i],
+                      layout.strides[i] * vertex, input.attr[i][0].ToFloat32(),
+                      input.attr[i][1].ToFloat32(), input.attr[i][2].ToFloat32(),
+                      input.attr[i][3].ToFloat32());
+        } else if (layout.is_default[i]) {
             // Load the default attribute if we're configured to do so
             input.attr[i] = g_state.input_default_attributes.attr[i];
             LOG_TRACE(
@@ -163,4 +202,22 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
     }
 }
 
+void VertexLoader::LoadVertices(u32 base_address, const u32* vertices, std::size_t count,
+                                Shader::AttributeBuffer* output,
+                                DebugUtils::MemoryAccessTracker& memory_accesses) {
+    ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
+
+#ifdef ARCHITECTURE_x86_64
+    if (UseJit()) {
+        jit->Load(GetSourcePointers(base_address).data(), vertices, count, output);
+        return;
+    }
+#endif
+
+    for (std::size_t i = 0; i < count; ++i) {
+        LoadVertex(base_address, static_cast<int>(i), static_cast<int>(vertices[i]), output[i],
+                   memory_accesses);
+    }
+}
+
 } // namespace Pica
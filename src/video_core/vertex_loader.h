@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include "common/common_types.h"
 #include "video_core/regs_pipeline.h"
 
@@ -14,8 +15,20 @@ namespace Shader {
 struct AttributeBuffer;
 }
 
+class VertexLoaderJit;
+
 class VertexLoader {
 public:
+    /// Where and how each attribute is read, as derived from the pipeline registers
+    struct Layout {
+        std::array<u32, 16> sources;
+        std::array<u32, 16> strides;
+        std::array<PipelineRegs::VertexAttributeFormat, 16> formats;
+        std::array<u32, 16> elements;
+        std::array<bool, 16> is_default;
+        int num_total_attributes;
+    };
+
     VertexLoader() = default;
     explicit VertexLoader(const PipelineRegs& regs) {
         Setup(regs);
@@ -25,17 +38,32 @@ public:
     void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input,
                     DebugUtils::MemoryAccessTracker& memory_accesses);
 
+    /**
+     * Loads several vertices at once.
+     * @param vertices Indices of the vertices to load
+     * @param count Number of vertices to load
+     * @param output Receives the attributes of vertices[i] in output[i]
+     */
+    void LoadVertices(u32 base_address, const u32* vertices, std::size_t count,
+                      Shader::AttributeBuffer* output,
+                      DebugUtils::MemoryAccessTracker& memory_accesses);
+
     int GetNumTotalAttributes() const {
-        return num_total_attributes;
+        return layout.num_total_attributes;
     }
 
 private:
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
-    int num_total_attributes = 0;
+    /// Returns the host pointers to the first element of each attribute array
+    const std::array<const u8*, 16>& GetSourcePointers(u32 base_address);
+
+    /// Returns true if the compiled loader can be used for the next load
+    bool UseJit() const;
+
+    Layout layout{};
+    const VertexLoaderJit* jit = nullptr;
+    std::array<const u8*, 16> source_pointers{};
+    u32 source_pointers_base = 0;
+    bool source_pointers_valid = false;
     bool is_setup = false;
 };
 
@@ -0,0 +1,206 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+
+namespace Pica {
+
+MICROPROFILE_DEFINE(GPU_VertexLoaderJit, "GPU", "Vertex Loader Compilation", MP_RGB(255, 160, 0));
+
+/// Memory allocated for each compiled loader. A loader needs at most 16 attributes with 4
+/// components each, which takes far less than this.
+constexpr std::size_t MAX_LOADER_SIZE = 4096;
+
+// Only caller-saved registers are used, so nothing needs to be preserved
+static const Xbyak::Reg64 SOURCES = ABI_PARAM1.cvt64();
+static const Xbyak::Reg64 VERTICES = ABI_PARAM2.cvt64();
+static const Xbyak::Reg32 COUNT = ABI_PARAM3.cvt32();
+static const Xbyak::Reg64 OUTPUT = ABI_PARAM4.cvt64();
+static const Xbyak::Reg64 VERTEX = r10;
+static const Xbyak::Reg64 ADDRESS = rax;
+static const Xbyak::Reg64 SCRATCH = r11;
+
+static u32 FloatBits(float value) {
+    u32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+VertexLoaderJit::VertexLoaderJit(const VertexLoader::Layout& layout)
+    : Xbyak::CodeGenerator(MAX_LOADER_SIZE) {
+    Compile(layout);
+}
+
+void VertexLoaderJit::Compile(const VertexLoader::Layout& layout) {
+    using Format = PipelineRegs::VertexAttributeFormat;
+
+    Label end;
+    Label loop;
+
+    test(COUNT, COUNT);
+    jz(end, T_NEAR);
+
+    L(loop);
+    mov(VERTEX.cvt32(), dword[VERTICES]);
+
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        const std::size_t attribute_offset = i * sizeof(Common::Vec4<float24>);
+        const u32 elements = layout.elements[i];
+
+        if (elements != 0) {
+            // Address of the element for this vertex
+            mov(ADDRESS, qword[SOURCES + i * sizeof(const u8*)]);
+            imul(SCRATCH, VERTEX, static_cast<int>(layout.strides[i]));
+            add(ADDRESS, SCRATCH);
+
+            for (u32 comp = 0; comp < elements; ++comp) {
+                const auto dest = dword[OUTPUT + attribute_offset + comp * sizeof(float24)];
+                switch (layout.formats[i]) {
+                case Format::BYTE:
+                    movsx(SCRATCH.cvt32(), byte[ADDRESS + comp]);
+                    cvtsi2ss(xmm0, SCRATCH.cvt32());
+                    movss(dest, xmm0);
+                    break;
+                case Format::UBYTE:
+                    movzx(SCRATCH.cvt32(), byte[ADDRESS + comp]);
+                    cvtsi2ss(xmm0, SCRATCH.cvt32());
+                    movss(dest, xmm0);
+                    break;
+                case Format::SHORT:
+                    movsx(SCRATCH.cvt32(), word[ADDRESS + comp * 2]);
+                    cvtsi2ss(xmm0, SCRATCH.cvt32());
+                    movss(dest, xmm0);
+                    break;
+                case Format::FLOAT:
+                    // float24 holds a host float, so the value is copied as is
+                    mov(SCRATCH.cvt32(), dword[ADDRESS + comp * 4]);
+                    mov(dest, SCRATCH.cvt32());
+                    break;
+                }
+            }
+
+            // Missing components default to (0, 0, 0, 1), like in VertexLoader::LoadVertex
+            for (u32 comp = elements; comp < 4; ++comp) {
+                mov(dword[OUTPUT + attribute_offset + comp * sizeof(float24)],
+                    FloatBits(comp == 3 ? 1.0f : 0.0f));
+            }
+        } else if (layout.is_default[i]) {
+            // The default attributes can change between draws, so they are read when running
+            const auto* default_attribute = &g_state.input_default_attributes.attr[i];
+            mov(SCRATCH, reinterpret_cast<std::uintptr_t>(default_attribute));
+            movups(xmm0, xword[SCRATCH]);
+            movups(xword[OUTPUT + attribute_offset], xmm0);
+        }
+    }
+
+    add(VERTICES, sizeof(u32));
+    add(OUTPUT, sizeof(Shader::AttributeBuffer));
+    dec(COUNT);
+    jnz(loop, T_NEAR);
+
+    L(end);
+    ret();
+
+    ready();
+    program = getCode<CompiledLoader*>();
+
+    ASSERT_MSG(getSize() <= MAX_LOADER_SIZE, "Compiled a vertex loader that exceeds the size!");
+    LOG_DEBUG(HW_GPU, "Compiled vertex loader size={}", getSize());
+}
+
+namespace {
+
+/// Number of compiled loaders kept, evicting the least recently used ones
+constexpr std::size_t MAX_CACHED_LOADERS = 64;
+
+/**
+ * The parts of a layout a loader is specialized on. The attribute offsets change between draws
+ * and are passed in the source pointers instead.
+ */
+struct LoaderKey {
+    std::array<u32, 16> strides{};
+    std::array<u8, 16> formats{};
+    std::array<u8, 16> elements{};
+    std::array<u8, 16> is_default{};
+    u32 num_total_attributes = 0;
+
+    explicit LoaderKey(const VertexLoader::Layout& layout)
+        : num_total_attributes(static_cast<u32>(layout.num_total_attributes)) {
+        // The attributes past the total are not compiled, and neither are the format and stride
+        // of those without elements
+        for (int i = 0; i < layout.num_total_attributes; ++i) {
+            if (layout.elements[i] != 0) {
+                strides[i] = layout.strides[i];
+                formats[i] = static_cast<u8>(layout.formats[i]);
+                elements[i] = static_cast<u8>(layout.elements[i]);
+            }
+            is_default[i] = layout.is_default[i];
+        }
+    }
+
+    bool operator==(const LoaderKey& other) const {
+        return std::memcmp(this, &other, sizeof(LoaderKey)) == 0;
+    }
+};
+static_assert(std::has_unique_object_representations_v<LoaderKey>,
+              "LoaderKey is compared and hashed bytewise, so it must not have padding");
+
+struct LoaderKeyHash {
+    std::size_t operator()(const LoaderKey& key) const {
+        return static_cast<std::size_t>(Common::ComputeHash64(&key, sizeof(key)));
+    }
+};
+
+struct CacheEntry {
+    std::unique_ptr<VertexLoaderJit> loader;
+    std::list<LoaderKey>::iterator lru_position;
+};
+
+} // Anonymous namespace
+
+const VertexLoaderJit& GetVertexLoaderJit(const VertexLoader::Layout& layout) {
+    static std::unordered_map<LoaderKey, CacheEntry, LoaderKeyHash> cache;
+    // Keys of the loaders, from the most to the least recently used
+    static std::list<LoaderKey> lru;
+
+    const LoaderKey key(layout);
+    auto iter = cache.find(key);
+    if (iter != cache.end()) {
+        lru.splice(lru.begin(), lru, iter->second.lru_position);
+        return *iter->second.loader;
+    }
+
+    // A loader is only used by the draw that set it up, so the evicted one is not in use
+    if (cache.size() >= MAX_CACHED_LOADERS) {
+        cache.erase(lru.back());
+        lru.pop_back();
+    }
+
+    MICROPROFILE_SCOPE(GPU_VertexLoaderJit);
+    lru.push_front(key);
+    CacheEntry& entry = cache.emplace(key, CacheEntry{}).first->second;
+    entry.loader = std::make_unique<VertexLoaderJit>(layout);
+    entry.lru_position = lru.begin();
+    return *entry.loader;
+}
+
+} // namespace Pica
@@ -0,0 +1,52 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+namespace Shader {
+struct AttributeBuffer;
+}
+
+/**
+ * x86_64 code specialized on one vertex attribute layout. It reads the attribute arrays and
+ * converts them to float24 without any per-attribute dispatch at runtime.
+ */
+class VertexLoaderJit : public Xbyak::CodeGenerator {
+public:
+    explicit VertexLoaderJit(const VertexLoader::Layout& layout);
+
+    /**
+     * Loads the given vertices.
+     * @param sources Host pointers to the first element of each attribute array
+     * @param vertices Indices of the vertices to load
+     * @param count Number of vertices to load
+     * @param output Receives the attributes of vertices[i] in output[i]
+     */
+    void Load(const u8* const* sources, const u32* vertices, std::size_t count,
+              Shader::AttributeBuffer* output) const {
+        program(sources, vertices, static_cast<u32>(count), output);
+    }
+
+private:
+    void Compile(const VertexLoader::Layout& layout);
+
+    using CompiledLoader = void(const u8* const* sources, const u32* vertices, u32 count,
+                                Shader::AttributeBuffer* output);
+    CompiledLoader* program = nullptr;
+};
+
+/**
+ * Returns the loader compiled for the layout. Loaders are compiled on first use and the most
+ * recently used ones are cached, so the returned one is only valid until it is evicted by others.
+ */
+const VertexLoaderJit& GetVertexLoaderJit(const VertexLoader::Layout& layout);
+
+} // namespace Pica
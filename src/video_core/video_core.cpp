@@ -63,7 +63,7 @@ ResultStatus Init(Frontend::EmuWindow& window, Memory::MemorySystem& memory) {
     ResultStatus result = g_renderer->Init();
     if (result == ResultStatus::Success) {
         if (Settings::values.use_hw_renderer) {
-            g_rasterizer = std::make_unique<OpenGL::RasterizerOpenGL>();
+            g_rasterizer = std::make_unique<OpenGL::RasterizerOpenGL>(window);
         } else {
             g_rasterizer = std::make_unique<VideoCore::SWRasterizer>();
         }
@@ -76,6 +76,15 @@ ResultStatus Init(Frontend::EmuWindow& window, Memory::MemorySystem& memory) {
     return result;
 }
 
+void InitHeadless(Memory::MemorySystem& memory, std::unique_ptr<RasterizerInterface> rasterizer) {
+    g_memory = &memory;
+    Pica::Init();
+
+    g_rasterizer = std::move(rasterizer);
+    g_scale_factor = 1;
+    g_current_frame = 0;
+}
+
 RendererBase* Renderer() {
     return g_renderer.get();
 }
@@ -40,6 +40,12 @@ enum class ResultStatus {
 /// Initialize the video core
 ResultStatus Init(Frontend::EmuWindow& window, Memory::MemorySystem& memory);
 
+/**
+ * Initialize the video core without a renderer, for tools that process GPU commands without a
+ * window. Drawing goes to the given rasterizer.
+ */
+void InitHeadless(Memory::MemorySystem& memory, std::unique_ptr<RasterizerInterface> rasterizer);
+
 RendererBase* Renderer();
 Memory::MemorySystem* Memory();
 RasterizerInterface* Rasterizer();